@@ -0,0 +1,269 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Time per call of encoding/base64 against the implementation it replaced
+ * (base64_ref.c and hex_ref_parse() below), for one payload of
+ * BASE64_BENCH_PAYLOAD_LEN bytes.
+ *
+ * The last line compares the two ways the shell NLIP transport has received
+ * a packet: decoding in place and copying into the packet chain, and
+ * decoding straight onto the end of the chain.
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "base64/base64.h"
+#include "base64/hex.h"
+#include "base64_ref.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_LEN           MYNEWT_VAL(BASE64_BENCH_PAYLOAD_LEN)
+#define BENCH_B64_LEN       BASE64_ENCODE_SIZE(BENCH_LEN)
+#define BENCH_MIN_US        (MYNEWT_VAL(BASE64_BENCH_MIN_MS) * 1000)
+
+#define BENCH_MBUF_DATA     128
+#define BENCH_MBUF_BLOCK    (sizeof(struct os_mbuf) + BENCH_MBUF_DATA)
+#define BENCH_MBUF_COUNT    (BENCH_LEN / (BENCH_MBUF_DATA - 16) + 4)
+
+static os_membuf_t bench_mbuf_membuf[
+    OS_MEMPOOL_SIZE(BENCH_MBUF_COUNT, BENCH_MBUF_BLOCK)];
+static struct os_mempool bench_mbuf_mempool;
+static struct os_mbuf_pool bench_mbuf_pool;
+
+static uint8_t bench_data[BENCH_LEN];
+static uint8_t bench_out[BENCH_LEN + 4];
+static char bench_b64[BENCH_B64_LEN + 1];
+static char bench_hex_str[BENCH_LEN * 2 + 1];
+static char bench_scratch[BENCH_B64_LEN + 1];
+
+/*
+ * hex_parse() as it was before it decoded two digits per iteration.
+ */
+static int
+hex_ref_parse(const char *src, int src_len, void *dst_v, int dst_len)
+{
+    int i;
+    uint8_t *dst = (uint8_t *)dst_v;
+    char c;
+
+    if (src_len & 0x1) {
+        return -1;
+    }
+    if (dst_len * 2 < src_len) {
+        return -1;
+    }
+    for (i = 0; i < src_len; i++, src++) {
+        c = *src;
+        if (isdigit((int) c)) {
+            c -= '0';
+        } else if (c >= 'a' && c <= 'f') {
+            c -= ('a' - 10);
+        } else if (c >= 'A' && c <= 'F') {
+            c -= ('A' - 10);
+        } else {
+            return -1;
+        }
+        if (i & 1) {
+            *dst |= c;
+            dst++;
+            dst_len--;
+        } else {
+            *dst = c << 4;
+        }
+    }
+    return src_len >> 1;
+}
+
+static void
+bench_decode_ref(void)
+{
+    int rc;
+
+    rc = base64_ref_decode(bench_b64, bench_out);
+    assert(rc == BENCH_LEN);
+}
+
+static void
+bench_decode(void)
+{
+    int rc;
+
+    rc = base64_decode(bench_b64, bench_out);
+    assert(rc == BENCH_LEN);
+}
+
+static void
+bench_encode_ref(void)
+{
+    base64_ref_encode(bench_data, BENCH_LEN, bench_scratch, 1);
+}
+
+static void
+bench_encode(void)
+{
+    base64_encode(bench_data, BENCH_LEN, bench_scratch, 1);
+}
+
+static void
+bench_hex_ref(void)
+{
+    int rc;
+
+    rc = hex_ref_parse(bench_hex_str, BENCH_LEN * 2, bench_out, BENCH_LEN);
+    assert(rc == BENCH_LEN);
+}
+
+static void
+bench_hex(void)
+{
+    int rc;
+
+    rc = hex_parse(bench_hex_str, BENCH_LEN * 2, bench_out, BENCH_LEN);
+    assert(rc == BENCH_LEN);
+}
+
+static void
+bench_nlip_ref(void)
+{
+    struct os_mbuf *om;
+    int rc;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    assert(om != NULL);
+
+    /* The old transport decoded into the line buffer itself. */
+    memcpy(bench_scratch, bench_b64, sizeof(bench_b64));
+    rc = base64_ref_decode(bench_scratch, bench_scratch);
+    assert(rc == BENCH_LEN);
+    rc = os_mbuf_copyinto(om, 0, bench_scratch, rc);
+    assert(rc == 0);
+
+    os_mbuf_free_chain(om);
+}
+
+static void
+bench_nlip(void)
+{
+    struct base64_decoder bd;
+    struct os_mbuf *om;
+    int rc;
+
+    om = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    assert(om != NULL);
+
+    /* Same copy of the line as above, to compare like with like. */
+    memcpy(bench_scratch, bench_b64, sizeof(bench_b64));
+    base64_decoder_init(&bd);
+    rc = base64_decoder_feed_mbuf(&bd, bench_scratch, BENCH_B64_LEN, om);
+    assert(rc == BENCH_LEN);
+    rc = base64_decoder_finish(&bd);
+    assert(rc == 0);
+
+    os_mbuf_free_chain(om);
+}
+
+/*
+ * Repeats fn for at least BENCH_MIN_US and returns the time per call in ns.
+ */
+static uint32_t
+bench_run(void (*fn)(void))
+{
+    uint32_t start;
+    uint32_t cnt;
+    uint32_t us;
+
+    start = os_cputime_get32();
+    cnt = 0;
+    do {
+        fn();
+        cnt++;
+        us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    } while (us < BENCH_MIN_US);
+
+    return (uint64_t)us * 1000 / cnt;
+}
+
+static void
+bench_report(const char *name, void (*ref_fn)(void), void (*fn)(void))
+{
+    uint32_t ref_ns;
+    uint32_t ns;
+
+    ref_ns = bench_run(ref_fn);
+    ns = bench_run(fn);
+    console_printf("%-20s old %7u ns, new %7u ns\n", name, (unsigned)ref_ns,
+                   (unsigned)ns);
+}
+
+int
+main(int argc, char **argv)
+{
+    int rc;
+    int i;
+
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    rc = os_mempool_init(&bench_mbuf_mempool, BENCH_MBUF_COUNT,
+                         BENCH_MBUF_BLOCK, bench_mbuf_membuf, "bench_mbuf");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&bench_mbuf_pool, &bench_mbuf_mempool,
+                           BENCH_MBUF_BLOCK, BENCH_MBUF_COUNT);
+    assert(rc == 0);
+
+    for (i = 0; i < BENCH_LEN; i++) {
+        bench_data[i] = i * 7 + 3;
+    }
+    rc = base64_encode(bench_data, BENCH_LEN, bench_b64, 1);
+    assert(rc == BENCH_B64_LEN);
+    hex_format(bench_data, BENCH_LEN, bench_hex_str, sizeof(bench_hex_str));
+
+    /* Both implementations have to agree before timing them. */
+    base64_ref_encode(bench_data, BENCH_LEN, bench_scratch, 1);
+    assert(strcmp(bench_scratch, bench_b64) == 0);
+    rc = base64_ref_decode(bench_b64, bench_out);
+    assert(rc == BENCH_LEN && memcmp(bench_out, bench_data, BENCH_LEN) == 0);
+
+    console_printf("%d byte payload, %d base64 characters\n", BENCH_LEN,
+                   BENCH_B64_LEN);
+    bench_report("base64_decode", bench_decode_ref, bench_decode);
+    bench_report("base64_encode", bench_encode_ref, bench_encode);
+    bench_report("hex_parse", bench_hex_ref, bench_hex);
+    bench_report("nlip line to mbuf", bench_nlip_ref, bench_nlip);
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
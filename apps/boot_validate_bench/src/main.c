@@ -0,0 +1,206 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Time spent validating the image in slot 0 at boot.  boot_go() is run once
+ * on a freshly written image, which hashes the whole image and records the
+ * result in the slot trailer, and then again, which only checks the record.
+ * bootutil_img_validate() is then timed for several hash buffer sizes, which
+ * is what BOOTUTIL_TMPBUF_SZ selects in the loader.
+ *
+ * Flash reads on the native BSP are plain memory copies, so the buffer size
+ * shows only the per-read overhead of the flash layers; on hardware, reads
+ * are slower and larger buffers matter more.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/bootutil.h"
+#include "bootutil/image.h"
+#include "bootutil/sign_key.h"
+#include "mbedtls/sha256.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_IMG_SIZE  MYNEWT_VAL(BOOT_VALIDATE_BENCH_IMG_SIZE)
+#define BENCH_RUNS      MYNEWT_VAL(BOOT_VALIDATE_BENCH_RUNS)
+#define BENCH_HDR_SIZE  32
+
+static uint8_t bench_buf[4096];
+static struct image_header bench_hdr;
+
+/* Not a secret; a real BSP returns a key the application cannot read. */
+int
+bootutil_validate_cache_key(uint8_t *key, int max_len)
+{
+    memset(key, 0x5a, 32);
+    return 32;
+}
+
+/**
+ * Writes an unsigned image with a SHA256 TLV to slot 0.  Erasing the slot
+ * also drops any validation record left by an earlier run.
+ */
+static void
+bench_write_image(void)
+{
+    mbedtls_sha256_context sha;
+    const struct flash_area *fa;
+    struct image_tlv tlv;
+    uint8_t hash[32];
+    uint32_t off;
+    uint32_t len;
+    uint32_t i;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    assert(rc == 0);
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    assert(rc == 0);
+
+    memset(&bench_hdr, 0, sizeof bench_hdr);
+    bench_hdr.ih_magic = IMAGE_MAGIC;
+    bench_hdr.ih_hdr_size = BENCH_HDR_SIZE;
+    bench_hdr.ih_img_size = BENCH_IMG_SIZE - BENCH_HDR_SIZE;
+    bench_hdr.ih_tlv_size = sizeof tlv + sizeof hash;
+    bench_hdr.ih_flags = IMAGE_F_SHA256;
+    bench_hdr.ih_ver.iv_major = 1;
+
+    mbedtls_sha256_init(&sha);
+    mbedtls_sha256_starts(&sha, 0);
+    for (off = 0; off < BENCH_IMG_SIZE; off += len) {
+        len = min(sizeof bench_buf, BENCH_IMG_SIZE - off);
+        for (i = 0; i < len; i++) {
+            bench_buf[i] = (off + i) * 31 + 7;
+        }
+        if (off == 0) {
+            memset(bench_buf, 0, BENCH_HDR_SIZE);
+            memcpy(bench_buf, &bench_hdr, sizeof bench_hdr);
+        }
+        rc = flash_area_write(fa, off, bench_buf, len);
+        assert(rc == 0);
+        mbedtls_sha256_update(&sha, bench_buf, len);
+    }
+    mbedtls_sha256_finish(&sha, hash);
+
+    tlv.it_type = IMAGE_TLV_SHA256;
+    tlv._pad = 0;
+    tlv.it_len = sizeof hash;
+    rc = flash_area_write(fa, off, &tlv, sizeof tlv);
+    assert(rc == 0);
+    rc = flash_area_write(fa, off + sizeof tlv, hash, sizeof hash);
+    assert(rc == 0);
+
+    flash_area_close(fa);
+}
+
+static uint32_t
+bench_boot_go(void)
+{
+    struct boot_rsp rsp;
+    uint32_t start;
+    int rc;
+
+    start = os_cputime_get32();
+    rc = boot_go(&rsp);
+    assert(rc == 0);
+
+    return os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+}
+
+static void
+bench_run_boot(void)
+{
+    uint32_t full;
+    uint32_t cached;
+    int i;
+
+    full = 0;
+    cached = 0;
+    for (i = 0; i < BENCH_RUNS; i++) {
+        bench_write_image();
+        full += bench_boot_go();
+        cached += bench_boot_go();
+    }
+
+    console_printf("boot_go, %u byte image: full check %u us, "
+                   "cached %u us\n", (unsigned)BENCH_IMG_SIZE,
+                   (unsigned)(full / BENCH_RUNS),
+                   (unsigned)(cached / BENCH_RUNS));
+}
+
+static void
+bench_run_tmpbuf(void)
+{
+    static const uint32_t sizes[] = { 64, 256, 1024, 4096 };
+    const struct flash_area *fa;
+    uint32_t start;
+    uint32_t us;
+    int rc;
+    int i;
+    int j;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    assert(rc == 0);
+
+    for (i = 0; i < sizeof sizes / sizeof sizes[0]; i++) {
+        start = os_cputime_get32();
+        for (j = 0; j < BENCH_RUNS; j++) {
+            rc = bootutil_img_validate(&bench_hdr, fa, bench_buf, sizes[i],
+                                       NULL, 0, NULL);
+            assert(rc == 0);
+        }
+        us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+
+        console_printf("bootutil_img_validate, %4u byte buffer: %u us, "
+                       "%u flash reads\n", (unsigned)sizes[i],
+                       (unsigned)(us / BENCH_RUNS),
+                       (unsigned)((BENCH_IMG_SIZE + sizes[i] - 1) / sizes[i]));
+    }
+
+    flash_area_close(fa);
+}
+
+int
+main(int argc, char **argv)
+{
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    bench_run_boot();
+    bench_run_tmpbuf();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
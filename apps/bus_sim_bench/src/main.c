@@ -0,0 +1,223 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Throughput of blocking and asynchronous writes on two simulated buses.
+ *
+ * Each line shows wall time and the share of it each bus was busy.  Blocking
+ * writes from one task keep one bus busy at a time; asynchronous writes keep
+ * both buses busy.  The last run holds bus A locked from this task and shows
+ * that the queue of bus B is still served.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "bus/bus.h"
+#include "bus/drivers/bus_sim.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_XFER_LEN  MYNEWT_VAL(BUS_SIM_BENCH_XFER_LEN)
+#define BENCH_XFERS     MYNEWT_VAL(BUS_SIM_BENCH_XFERS)
+
+static struct bus_sim_dev bench_dev_a;
+static struct bus_sim_dev bench_dev_b;
+static struct bus_sim_node bench_node_a;
+static struct bus_sim_node bench_node_b;
+static uint8_t bench_wbuf[BENCH_XFER_LEN];
+
+static struct bus_xfer bench_xfer_a;
+static struct bus_xfer bench_xfer_b;
+static int bench_remaining_a;
+static int bench_remaining_b;
+static struct os_sem bench_sem;
+static uint32_t bench_start;
+
+static void
+bench_begin(void)
+{
+    bus_sim_reset_stats((struct os_dev *)&bench_dev_a);
+    bus_sim_reset_stats((struct os_dev *)&bench_dev_b);
+    bench_start = os_cputime_get32();
+}
+
+static void
+bench_end(const char *name)
+{
+    struct bus_sim_stats stats_a;
+    struct bus_sim_stats stats_b;
+    uint32_t us;
+
+    us = os_cputime_ticks_to_usecs(os_cputime_get32() - bench_start);
+    bus_sim_get_stats((struct os_dev *)&bench_dev_a, &stats_a);
+    bus_sim_get_stats((struct os_dev *)&bench_dev_b, &stats_b);
+
+    console_printf("%s: %u us; bus A %u xfers, %u%% busy; "
+                   "bus B %u xfers, %u%% busy\n",
+                   name, (unsigned)us,
+                   (unsigned)stats_a.xfers,
+                   (unsigned)((uint64_t)stats_a.busy_us * 100 / max(us, 1)),
+                   (unsigned)stats_b.xfers,
+                   (unsigned)((uint64_t)stats_b.busy_us * 100 / max(us, 1)));
+}
+
+static void
+bench_xfer_cb(struct bus_xfer *xfer, int status, void *arg)
+{
+    int *remaining = arg;
+    int rc;
+
+    assert(status == 0);
+
+    if (--*remaining > 0) {
+        rc = bus_xfer_submit(xfer);
+        assert(rc == 0);
+    } else {
+        os_sem_release(&bench_sem);
+    }
+}
+
+static void
+bench_xfer_init(struct bus_xfer *xfer, struct bus_sim_node *node,
+                int *remaining)
+{
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->node = (struct os_dev *)node;
+    xfer->wbuf = bench_wbuf;
+    xfer->wlength = sizeof(bench_wbuf);
+    xfer->cb = bench_xfer_cb;
+    xfer->cb_arg = remaining;
+}
+
+static void
+bench_run_blocking(void)
+{
+    int rc;
+    int i;
+
+    bench_begin();
+    for (i = 0; i < BENCH_XFERS; i++) {
+        rc = bus_node_simple_write((struct os_dev *)&bench_node_a, bench_wbuf,
+                                   sizeof(bench_wbuf));
+        assert(rc == 0);
+        rc = bus_node_simple_write((struct os_dev *)&bench_node_b, bench_wbuf,
+                                   sizeof(bench_wbuf));
+        assert(rc == 0);
+    }
+    bench_end("blocking");
+}
+
+static void
+bench_run_async(void)
+{
+    int rc;
+
+    bench_xfer_init(&bench_xfer_a, &bench_node_a, &bench_remaining_a);
+    bench_xfer_init(&bench_xfer_b, &bench_node_b, &bench_remaining_b);
+    bench_remaining_a = BENCH_XFERS;
+    bench_remaining_b = BENCH_XFERS;
+
+    bench_begin();
+    rc = bus_xfer_submit(&bench_xfer_a);
+    assert(rc == 0);
+    rc = bus_xfer_submit(&bench_xfer_b);
+    assert(rc == 0);
+    os_sem_pend(&bench_sem, OS_TIMEOUT_NEVER);
+    os_sem_pend(&bench_sem, OS_TIMEOUT_NEVER);
+    bench_end("async");
+}
+
+static void
+bench_run_locked(void)
+{
+    struct os_dev *node_a = (struct os_dev *)&bench_node_a;
+    int rc;
+
+    bench_xfer_init(&bench_xfer_a, &bench_node_a, &bench_remaining_a);
+    bench_xfer_init(&bench_xfer_b, &bench_node_b, &bench_remaining_b);
+    bench_remaining_a = 1;
+    bench_remaining_b = BENCH_XFERS;
+
+    rc = bus_node_lock(node_a, BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    assert(rc == 0);
+
+    bench_begin();
+    rc = bus_xfer_submit(&bench_xfer_a);
+    assert(rc == 0);
+    rc = bus_xfer_submit(&bench_xfer_b);
+    assert(rc == 0);
+    os_sem_pend(&bench_sem, OS_TIMEOUT_NEVER);
+    bench_end("async, bus A locked");
+
+    rc = bus_node_unlock(node_a);
+    assert(rc == 0);
+    os_sem_pend(&bench_sem, OS_TIMEOUT_NEVER);
+}
+
+int
+main(int argc, char **argv)
+{
+    struct bus_sim_dev_cfg dev_cfg = {
+        .bitrate = MYNEWT_VAL(BUS_SIM_BENCH_BITRATE),
+        .xfer_overhead_us = 0,
+    };
+    struct bus_sim_node_cfg node_a_cfg = {
+        .node_cfg.bus_name = "bench_a",
+    };
+    struct bus_sim_node_cfg node_b_cfg = {
+        .node_cfg.bus_name = "bench_b",
+    };
+    int rc;
+
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    rc = os_sem_init(&bench_sem, 0);
+    assert(rc == 0);
+
+    rc = bus_sim_dev_create("bench_a", &bench_dev_a, &dev_cfg);
+    assert(rc == 0);
+    rc = bus_sim_dev_create("bench_b", &bench_dev_b, &dev_cfg);
+    assert(rc == 0);
+    rc = bus_sim_node_create("bench_node_a", &bench_node_a, &node_a_cfg, NULL);
+    assert(rc == 0);
+    rc = bus_sim_node_create("bench_node_b", &bench_node_b, &node_b_cfg, NULL);
+    assert(rc == 0);
+
+    bench_run_blocking();
+    bench_run_async();
+    bench_run_locked();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
@@ -34,20 +34,25 @@ static void
 open_node_cb(struct bus_node *node)
 {
     struct os_dev *odev = (struct os_dev *)node;
-    struct reg_val reg;
+    static const uint8_t who_am_i = 0x0f; /* WHO_AM_I */
+    static const uint8_t ctrl_reg1[] = { 0x20, 0x37 }; /* CTRL_REG1 */
+    uint8_t id;
+    struct bus_op ops[] = {
+        { .type = BUS_OP_WRITE, .flags = BUS_F_NOSTOP, .length = 1,
+          .wbuf = &who_am_i },
+        { .type = BUS_OP_READ, .length = 1, .rbuf = &id },
+        { .type = BUS_OP_WRITE, .length = sizeof(ctrl_reg1),
+          .wbuf = ctrl_reg1 },
+    };
     int rc;
 
     console_printf("%s: node %p\n", __func__, node);
 
-    reg.addr = 0x0f; /* WHO_AM_I */
-    rc = bus_node_simple_write_read_transact(odev, &reg.addr, 1, reg.val, 1);
-    assert(rc == 0);
-    assert(reg.val[0] == 0x33);
-
-    reg.addr = 0x20; /* CTRL_REG1 */
-    reg.val[0] = 0x37;
-    rc = bus_node_simple_write(odev, &reg.addr, 2);
+    /* Identify and configure device with bus locked only once */
+    rc = bus_node_transact(odev, ops, ARRAY_SIZE(ops),
+                           os_time_ms_to_ticks32(MYNEWT_VAL(BUS_DEFAULT_TRANSACTION_TIMEOUT_MS)));
     assert(rc == 0);
+    assert(id == 0x33);
 }
 
 static void
@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Decode throughput of tinycbor from mbuf chains.
+ *
+ * The same map is decoded from chains that carry 256 down to 16 bytes per
+ * mbuf, once with cbor_mbuf_reader and once with a reference reader that
+ * resolves every access from the head of the chain, as cbor_mbuf_reader did
+ * before it kept track of the current mbuf.  The reference reader's
+ * throughput drops with chain length; cbor_mbuf_reader's should not.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "tinycbor/compilersupport_p.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_ENTRIES       MYNEWT_VAL(CBOR_MBUF_BENCH_ENTRIES)
+#define BENCH_MIN_US        (MYNEWT_VAL(CBOR_MBUF_BENCH_MIN_MS) * 1000)
+
+/* Key is "k" and up to 5 digits, value an integer of up to 8 bytes. */
+#define BENCH_ENTRY_MAX     16
+#define BENCH_DOC_MAX       (BENCH_ENTRIES * BENCH_ENTRY_MAX + 4)
+
+#define BENCH_MBUF_DATA     256
+#define BENCH_MBUF_BLOCK    (sizeof(struct os_mbuf) + BENCH_MBUF_DATA)
+#define BENCH_MBUF_COUNT    (BENCH_DOC_MAX / 16 + 4)
+
+static os_membuf_t bench_mbuf_membuf[
+    OS_MEMPOOL_SIZE(BENCH_MBUF_COUNT, BENCH_MBUF_BLOCK)];
+static struct os_mempool bench_mbuf_mempool;
+static struct os_mbuf_pool bench_mbuf_pool;
+
+static uint8_t bench_doc[BENCH_DOC_MAX];
+static int bench_doc_len;
+
+static const int bench_seg_lens[] = { 256, 128, 64, 16 };
+
+/*
+ * Reference reader: every access copies or compares from an absolute offset,
+ * walking the chain from its head each time.
+ */
+struct bench_ref_reader {
+    struct cbor_decoder_reader r;
+    struct os_mbuf *m;
+};
+
+static uint8_t
+bench_ref_get8(struct cbor_decoder_reader *d, int offset)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+    uint8_t val;
+
+    os_mbuf_copydata(rr->m, offset, sizeof(val), &val);
+    return val;
+}
+
+static uint16_t
+bench_ref_get16(struct cbor_decoder_reader *d, int offset)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+    uint16_t val;
+
+    os_mbuf_copydata(rr->m, offset, sizeof(val), &val);
+    return cbor_ntohs(val);
+}
+
+static uint32_t
+bench_ref_get32(struct cbor_decoder_reader *d, int offset)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+    uint32_t val;
+
+    os_mbuf_copydata(rr->m, offset, sizeof(val), &val);
+    return cbor_ntohl(val);
+}
+
+static uint64_t
+bench_ref_get64(struct cbor_decoder_reader *d, int offset)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+    uint64_t val;
+
+    os_mbuf_copydata(rr->m, offset, sizeof(val), &val);
+    return cbor_ntohll(val);
+}
+
+static uintptr_t
+bench_ref_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
+              size_t len)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+
+    return os_mbuf_cmpf(rr->m, offset, buf, len) == 0;
+}
+
+static uintptr_t
+bench_ref_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
+              size_t len)
+{
+    struct bench_ref_reader *rr = (struct bench_ref_reader *)d;
+
+    return os_mbuf_copydata(rr->m, offset, len, dst) == 0;
+}
+
+static void
+bench_ref_reader_init(struct bench_ref_reader *rr, struct os_mbuf *m)
+{
+    rr->r.get8 = &bench_ref_get8;
+    rr->r.get16 = &bench_ref_get16;
+    rr->r.get32 = &bench_ref_get32;
+    rr->r.get64 = &bench_ref_get64;
+    rr->r.cmp = &bench_ref_cmp;
+    rr->r.cpy = &bench_ref_cpy;
+    rr->r.message_size = OS_MBUF_PKTLEN(m);
+    rr->m = m;
+}
+
+static uint64_t
+bench_entry_val(int i)
+{
+    /* Cycle through every integer encoding width. */
+    switch (i % 4) {
+    case 0:
+        return i % 24;
+    case 1:
+        return 0x100 + i;
+    case 2:
+        return 0x10000 + i;
+    default:
+        return 0x100000000ULL + i;
+    }
+}
+
+static void
+bench_encode(void)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder enc;
+    CborEncoder map;
+    char key[8];
+    int rc;
+    int i;
+
+    cbor_buf_writer_init(&writer, bench_doc, sizeof(bench_doc));
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, BENCH_ENTRIES);
+    assert(rc == 0);
+    for (i = 0; i < BENCH_ENTRIES; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        rc = cbor_encode_text_stringz(&map, key);
+        assert(rc == 0);
+        rc = cbor_encode_uint(&map, bench_entry_val(i));
+        assert(rc == 0);
+    }
+    rc = cbor_encoder_close_container(&enc, &map);
+    assert(rc == 0);
+
+    bench_doc_len = cbor_buf_writer_buffer_size(&writer, bench_doc);
+}
+
+static struct os_mbuf *
+bench_chain(int seg_len)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *om;
+    int chunk;
+    int off;
+    int rc;
+
+    head = os_mbuf_get_pkthdr(&bench_mbuf_pool, 0);
+    assert(head != NULL);
+
+    for (off = 0; off < bench_doc_len; off += chunk) {
+        chunk = min(bench_doc_len - off, seg_len);
+        if (off == 0) {
+            om = head;
+        } else {
+            om = os_mbuf_get(&bench_mbuf_pool, 0);
+            assert(om != NULL);
+        }
+
+        rc = os_mbuf_append(om, bench_doc + off, chunk);
+        assert(rc == 0);
+
+        if (om != head) {
+            os_mbuf_concat(head, om);
+        }
+    }
+
+    return head;
+}
+
+static int
+bench_chain_len(const struct os_mbuf *om)
+{
+    int cnt;
+
+    for (cnt = 0; om != NULL; om = SLIST_NEXT(om, om_next)) {
+        cnt++;
+    }
+    return cnt;
+}
+
+/*
+ * Decodes the whole map, reading every key and value out of the chain.
+ */
+static void
+bench_decode(struct cbor_decoder_reader *reader)
+{
+    CborParser parser;
+    CborValue value;
+    CborValue map;
+    uint64_t u64;
+    size_t len;
+    char key[8];
+    int rc;
+    int i;
+
+    rc = cbor_parser_init(reader, 0, &parser, &value);
+    assert(rc == 0);
+    rc = cbor_value_enter_container(&value, &map);
+    assert(rc == 0);
+
+    for (i = 0; i < BENCH_ENTRIES; i++) {
+        len = sizeof(key);
+        rc = cbor_value_copy_text_string(&map, key, &len, &map);
+        assert(rc == 0);
+        rc = cbor_value_get_uint64(&map, &u64);
+        assert(rc == 0 && u64 == bench_entry_val(i));
+        rc = cbor_value_advance_fixed(&map);
+        assert(rc == 0);
+    }
+    assert(cbor_value_at_end(&map));
+}
+
+/*
+ * Repeats decoding for at least BENCH_MIN_US and returns throughput in
+ * KB/s.
+ */
+static uint32_t
+bench_run(struct os_mbuf *om, bool ref)
+{
+    struct cbor_mbuf_reader reader;
+    struct bench_ref_reader ref_reader;
+    uint32_t start;
+    uint32_t us;
+    uint32_t cnt;
+
+    start = os_cputime_get32();
+    cnt = 0;
+    do {
+        if (ref) {
+            bench_ref_reader_init(&ref_reader, om);
+            bench_decode(&ref_reader.r);
+        } else {
+            cbor_mbuf_reader_init(&reader, om, 0);
+            bench_decode(&reader.r);
+        }
+        cnt++;
+        us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    } while (us < BENCH_MIN_US);
+
+    return (uint64_t)cnt * bench_doc_len * 1000 / us;
+}
+
+int
+main(int argc, char **argv)
+{
+    struct os_mbuf *om;
+    uint32_t ref_kbs;
+    uint32_t kbs;
+    int rc;
+    int i;
+
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    rc = os_mempool_init(&bench_mbuf_mempool, BENCH_MBUF_COUNT,
+                         BENCH_MBUF_BLOCK, bench_mbuf_membuf, "bench_mbuf");
+    assert(rc == 0);
+    rc = os_mbuf_pool_init(&bench_mbuf_pool, &bench_mbuf_mempool,
+                           BENCH_MBUF_BLOCK, BENCH_MBUF_COUNT);
+    assert(rc == 0);
+
+    bench_encode();
+    console_printf("decoding %d byte map of %d entries\n", bench_doc_len,
+                   BENCH_ENTRIES);
+    console_printf("mbufs in chain  cbor_mbuf_reader  from chain head\n");
+
+    for (i = 0; i < ARRAY_SIZE(bench_seg_lens); i++) {
+        om = bench_chain(bench_seg_lens[i]);
+        kbs = bench_run(om, false);
+        ref_kbs = bench_run(om, true);
+        console_printf("%14d  %11u KB/s  %10u KB/s\n", bench_chain_len(om),
+                       (unsigned)kbs, (unsigned)ref_kbs);
+        os_mbuf_free_chain(om);
+    }
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Throughput of the CRC routines in util/crc for short, medium and long
+ * buffers.  Slicing factors and the hardware hook are build time settings,
+ * so each build measures one variant; the first line shows which one and
+ * how much table space it uses.
+ */
+
+#include <assert.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_BUF_LEN   MYNEWT_VAL(CRC_BENCH_BUF_LEN)
+#define BENCH_MIN_US    (MYNEWT_VAL(CRC_BENCH_MIN_MS) * 1000)
+
+static uint8_t bench_buf[BENCH_BUF_LEN];
+
+static const int bench_lens[] = { 16, 256, BENCH_BUF_LEN };
+
+static uint32_t
+bench_crc16(uint32_t crc, const void *buf, int len)
+{
+    return crc16_ccitt(crc, buf, len);
+}
+
+static uint32_t
+bench_crc32(uint32_t crc, const void *buf, int len)
+{
+    return crc32_ieee(crc, buf, len);
+}
+
+static uint32_t
+bench_crc32c(uint32_t crc, const void *buf, int len)
+{
+    return crc32c(crc, buf, len);
+}
+
+static const struct {
+    const char *name;
+    uint32_t (*fn)(uint32_t crc, const void *buf, int len);
+} bench_fns[] = {
+    { "crc16_ccitt", bench_crc16 },
+    { "crc32_ieee", bench_crc32 },
+    { "crc32c", bench_crc32c },
+};
+
+/* Keeps results live so that the calls are not optimized out. */
+static volatile uint32_t bench_sink;
+
+/*
+ * Repeats the checksum for at least BENCH_MIN_US and returns throughput in
+ * KB/s.  Each call continues the CRC of the previous one, as when a stream
+ * is checksummed in pieces, so calls cannot overlap each other.
+ */
+static uint32_t
+bench_run(uint32_t (*fn)(uint32_t crc, const void *buf, int len), int len)
+{
+    uint32_t start;
+    uint32_t cnt;
+    uint32_t crc;
+    uint32_t us;
+    int i;
+
+    start = os_cputime_get32();
+    cnt = 0;
+    crc = 0;
+    do {
+        /* Check the clock once per buffer length to keep short runs cheap. */
+        for (i = 0; i < BENCH_BUF_LEN / len; i++) {
+            crc = fn(crc, bench_buf, len);
+        }
+        cnt += i;
+        us = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+    } while (us < BENCH_MIN_US);
+    bench_sink = crc;
+
+    return (uint64_t)cnt * len * 1000 / us;
+}
+
+int
+main(int argc, char **argv)
+{
+    int i;
+    int j;
+
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    for (i = 0; i < BENCH_BUF_LEN; i++) {
+        bench_buf[i] = i * 7 + 3;
+    }
+
+    console_printf("CRC16_SLICE %d (%d byte tables), "
+                   "CRC32_SLICE %d (%d bytes per polynomial), CRC_HW %d\n",
+                   MYNEWT_VAL(CRC16_SLICE), 512 * MYNEWT_VAL(CRC16_SLICE),
+                   MYNEWT_VAL(CRC32_SLICE), 1024 * MYNEWT_VAL(CRC32_SLICE),
+                   MYNEWT_VAL(CRC_HW));
+
+    for (i = 0; i < ARRAY_SIZE(bench_fns); i++) {
+        for (j = 0; j < ARRAY_SIZE(bench_lens); j++) {
+            console_printf("%-12s %5d byte buffers: %7u KB/s\n",
+                           bench_fns[i].name, bench_lens[j],
+                           (unsigned)bench_run(bench_fns[i].fn,
+                                               bench_lens[j]));
+        }
+    }
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
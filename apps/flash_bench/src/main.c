@@ -0,0 +1,184 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Measures fcb_init() and nffs_detect() (full nffs restore) on populated
+ * flash areas.  Both scan flash and run blank checks, so comparing builds
+ * with and without HAL_FLASH_ERASED_MAP shows effect of the erased pages
+ * bitmap.  First iteration runs with whatever the bitmap learned while the
+ * areas were populated, following ones with bitmap filled by previous scans.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "fcb/fcb.h"
+#include "fs/fs.h"
+#include "nffs/nffs.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define BENCH_ITERS         MYNEWT_VAL(FLASH_BENCH_ITERATIONS)
+#define BENCH_MAX_SECTORS   32
+
+static struct flash_area bench_sectors[BENCH_MAX_SECTORS];
+static struct fcb bench_fcb;
+static uint32_t bench_us[BENCH_ITERS];
+
+static void
+bench_report(const char *name)
+{
+    uint32_t total;
+    int i;
+
+    total = 0;
+    for (i = 1; i < BENCH_ITERS; i++) {
+        total += bench_us[i];
+    }
+    console_printf("%s: first %u us, average of next %d: %u us\n", name,
+                   (unsigned)bench_us[0], BENCH_ITERS - 1,
+                   (unsigned)(total / max(BENCH_ITERS - 1, 1)));
+}
+
+static int
+bench_fcb_init(int cnt)
+{
+    memset(&bench_fcb, 0, sizeof(bench_fcb));
+    bench_fcb.f_magic = 0xbe9c4fcb;
+    bench_fcb.f_version = 1;
+    bench_fcb.f_sector_cnt = cnt;
+    bench_fcb.f_scratch_cnt = 0;
+    bench_fcb.f_sectors = bench_sectors;
+
+    return fcb_init(&bench_fcb);
+}
+
+static void
+bench_run_fcb(void)
+{
+    uint8_t data[MYNEWT_VAL(FLASH_BENCH_FCB_ENTRY_LEN)];
+    const struct flash_area *fa;
+    struct fcb_entry loc;
+    uint32_t start;
+    int cnt;
+    int rc;
+    int i;
+
+    rc = flash_area_to_sectors(MYNEWT_VAL(FLASH_BENCH_FCB_AREA), &cnt, NULL);
+    assert(rc == 0 && cnt <= BENCH_MAX_SECTORS);
+    flash_area_to_sectors(MYNEWT_VAL(FLASH_BENCH_FCB_AREA), &cnt,
+                          bench_sectors);
+
+    rc = flash_area_open(MYNEWT_VAL(FLASH_BENCH_FCB_AREA), &fa);
+    assert(rc == 0);
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    assert(rc == 0);
+
+    rc = bench_fcb_init(cnt);
+    assert(rc == 0);
+    for (i = 0; i < MYNEWT_VAL(FLASH_BENCH_FCB_ENTRIES); i++) {
+        memset(data, (uint8_t)i, sizeof(data));
+        rc = fcb_append(&bench_fcb, sizeof(data), &loc);
+        if (rc == FCB_ERR_NOSPACE) {
+            rc = fcb_rotate(&bench_fcb);
+            assert(rc == 0);
+            rc = fcb_append(&bench_fcb, sizeof(data), &loc);
+        }
+        assert(rc == 0);
+        rc = flash_area_write(loc.fe_area, loc.fe_data_off, data,
+                              sizeof(data));
+        assert(rc == 0);
+        rc = fcb_append_finish(&bench_fcb, &loc);
+        assert(rc == 0);
+    }
+
+    for (i = 0; i < BENCH_ITERS; i++) {
+        start = os_cputime_get32();
+        rc = bench_fcb_init(cnt);
+        bench_us[i] = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+        assert(rc == 0);
+    }
+    bench_report("fcb_init");
+}
+
+static void
+bench_run_nffs(void)
+{
+    struct nffs_area_desc descs[MYNEWT_VAL(NFFS_NUM_AREAS) + 1];
+    uint8_t data[MYNEWT_VAL(FLASH_BENCH_NFFS_FILE_LEN)];
+    struct fs_file *file;
+    char name[16];
+    uint32_t start;
+    int cnt;
+    int rc;
+    int i;
+
+    cnt = MYNEWT_VAL(NFFS_NUM_AREAS);
+    rc = nffs_misc_desc_from_flash_area(MYNEWT_VAL(NFFS_FLASH_AREA), &cnt,
+                                        descs);
+    assert(rc == 0);
+
+    for (i = 0; i < MYNEWT_VAL(FLASH_BENCH_NFFS_FILES); i++) {
+        snprintf(name, sizeof(name), "/bench%d", i);
+        memset(data, (uint8_t)i, sizeof(data));
+        rc = fs_open(name, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+        assert(rc == 0);
+        rc = fs_write(file, data, sizeof(data));
+        assert(rc == 0);
+        fs_close(file);
+    }
+
+    for (i = 0; i < BENCH_ITERS; i++) {
+        start = os_cputime_get32();
+        rc = nffs_detect(descs);
+        bench_us[i] = os_cputime_ticks_to_usecs(os_cputime_get32() - start);
+        assert(rc == 0);
+    }
+    bench_report("nffs_detect");
+}
+
+int
+main(int argc, char **argv)
+{
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+#ifdef ARCH_sim
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+#endif
+
+    console_printf("erased pages bitmap %s\n",
+                   MYNEWT_VAL(HAL_FLASH_ERASED_MAP) ? "enabled" : "disabled");
+    bench_run_fcb();
+    bench_run_nffs();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
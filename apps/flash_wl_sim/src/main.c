@@ -0,0 +1,189 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Projects flash lifetime under logging workload.
+ *
+ * Logical sectors of the wear leveled area are split between log FCB,
+ * config FCB and static data which is written once.  Log and config
+ * entries are appended at configured rates for FLASH_WL_SIM_HOURS of
+ * simulated time; when FCB is full, oldest sector is rotated out.  Without
+ * wear leveling every logical erase would hit the same physical sector, so
+ * lifetime is projected from most erased logical sector and compared to
+ * projection from most erased physical sector.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "flash_map/flash_wl.h"
+#include "fcb/fcb.h"
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+#define SIM_MAX_SECTORS     MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)
+
+static struct flash_area sim_sectors[SIM_MAX_SECTORS];
+static struct fcb sim_log_fcb;
+static struct fcb sim_conf_fcb;
+
+static int
+sim_fcb_init(struct fcb *fcb, uint32_t magic, struct flash_area *sectors,
+             int cnt)
+{
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = magic;
+    fcb->f_version = 1;
+    fcb->f_sector_cnt = cnt;
+    fcb->f_scratch_cnt = 0;
+    fcb->f_sectors = sectors;
+
+    return fcb_init(fcb);
+}
+
+static int
+sim_append(struct fcb *fcb, const void *data, uint16_t len)
+{
+    struct fcb_entry loc;
+    int rc;
+
+    rc = fcb_append(fcb, len, &loc);
+    if (rc == FCB_ERR_NOSPACE) {
+        rc = fcb_rotate(fcb);
+        if (rc) {
+            return rc;
+        }
+        rc = fcb_append(fcb, len, &loc);
+    }
+    if (rc) {
+        return rc;
+    }
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, data, len);
+    if (rc) {
+        return rc;
+    }
+    return fcb_append_finish(fcb, &loc);
+}
+
+static uint32_t
+sim_lifetime_days(uint32_t erases)
+{
+    if (erases == 0) {
+        return UINT32_MAX;
+    }
+    return (uint64_t)MYNEWT_VAL(FLASH_WL_SIM_ENDURANCE) *
+      MYNEWT_VAL(FLASH_WL_SIM_HOURS) / erases / 24;
+}
+
+static void
+sim_run(void)
+{
+    uint8_t log_data[MYNEWT_VAL(FLASH_WL_SIM_LOG_ENTRY_LEN)];
+    uint8_t conf_data[MYNEWT_VAL(FLASH_WL_SIM_CONF_ENTRY_LEN)];
+    struct flash_wl_stats start;
+    struct flash_wl_stats end;
+    struct flash_area *fa;
+    uint32_t hour;
+    uint32_t wl_erases;
+    int log_cnt;
+    int conf_cnt;
+    int cnt;
+    int rc;
+    int i;
+
+    rc = flash_area_to_sectors(MYNEWT_VAL(FLASH_MAP_WL_ID), &cnt, NULL);
+    assert(rc == 0 && cnt <= SIM_MAX_SECTORS);
+    flash_area_to_sectors(MYNEWT_VAL(FLASH_MAP_WL_ID), &cnt, sim_sectors);
+
+    log_cnt = MYNEWT_VAL(FLASH_WL_SIM_LOG_SECTORS);
+    conf_cnt = MYNEWT_VAL(FLASH_WL_SIM_CONF_SECTORS);
+    assert(log_cnt >= 2 && conf_cnt >= 2 && log_cnt + conf_cnt <= cnt);
+
+    rc = sim_fcb_init(&sim_conf_fcb, 0xc09f1ea5, sim_sectors, conf_cnt);
+    assert(rc == 0);
+    rc = sim_fcb_init(&sim_log_fcb, 0x109f1ea5, sim_sectors + conf_cnt,
+                      log_cnt);
+    assert(rc == 0);
+
+    /* Remaining sectors hold data which never changes. */
+    memset(log_data, 0x5a, sizeof(log_data));
+    for (i = conf_cnt + log_cnt; i < cnt; i++) {
+        fa = &sim_sectors[i];
+        rc = flash_area_erase(fa, 0, fa->fa_size);
+        assert(rc == 0);
+        rc = flash_area_write(fa, 0, log_data, sizeof(log_data));
+        assert(rc == 0);
+    }
+
+    flash_wl_stats_get(&start);
+    console_printf("simulating %u hours, %d log, %d config, %d static "
+                   "sectors of %u bytes\n",
+                   (unsigned)MYNEWT_VAL(FLASH_WL_SIM_HOURS), log_cnt, conf_cnt,
+                   cnt - log_cnt - conf_cnt, (unsigned)sim_sectors[0].fa_size);
+
+    for (hour = 0; hour < MYNEWT_VAL(FLASH_WL_SIM_HOURS); hour++) {
+        for (i = 0; i < MYNEWT_VAL(FLASH_WL_SIM_LOG_PER_HOUR); i++) {
+            memset(log_data, (uint8_t)i, sizeof(log_data));
+            rc = sim_append(&sim_log_fcb, log_data, sizeof(log_data));
+            assert(rc == 0);
+        }
+        for (i = 0; i < MYNEWT_VAL(FLASH_WL_SIM_CONF_PER_HOUR); i++) {
+            memset(conf_data, (uint8_t)hour, sizeof(conf_data));
+            rc = sim_append(&sim_conf_fcb, conf_data, sizeof(conf_data));
+            assert(rc == 0);
+        }
+    }
+
+    flash_wl_stats_get(&end);
+    /* Upper bound of erases added to the most worn physical sector. */
+    wl_erases = end.fws_erase_max - start.fws_erase_min;
+
+    console_printf("logical erases %u, cold sector moves %u\n",
+                   (unsigned)(end.fws_log_erases - start.fws_log_erases),
+                   (unsigned)(end.fws_moves - start.fws_moves));
+    console_printf("physical erase count min %u max %u\n",
+                   (unsigned)end.fws_erase_min, (unsigned)end.fws_erase_max);
+    console_printf("without wear leveling: %u erases, lifetime %u days\n",
+                   (unsigned)end.fws_log_erase_max,
+                   (unsigned)sim_lifetime_days(end.fws_log_erase_max));
+    console_printf("with wear leveling: %u erases, lifetime %u days\n",
+                   (unsigned)wl_erases,
+                   (unsigned)sim_lifetime_days(wl_erases));
+}
+
+int
+main(int argc, char **argv)
+{
+#ifdef ARCH_sim
+    mcu_sim_parse_args(argc, argv);
+#endif
+
+    sysinit();
+
+    sim_run();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
@@ -0,0 +1,369 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Throughput of FCB appends, log appends and NFFS file writes on the native
+ * flash simulator with a realistic timing model, followed by an FCB crash
+ * consistency fuzzer built on native_flash_power_loss_arm().
+ *
+ * Each throughput line shows wall time, the share of it spent in simulated
+ * program/erase busy time and the resulting payload rate; the rest is
+ * software overhead of the layer being measured.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "console/console.h"
+#include "flash_map/flash_map.h"
+#include "fcb/fcb.h"
+#include "fs/fs.h"
+#include "log/log.h"
+#include "mcu/mcu_sim.h"
+
+#define BENCH_MAX_SECTORS   32
+#define BENCH_ENTRY_LEN     MYNEWT_VAL(NATIVE_FLASH_BENCH_ENTRY_LEN)
+
+static struct flash_area bench_sectors[BENCH_MAX_SECTORS];
+static int bench_sector_cnt;
+static struct fcb bench_fcb;
+static struct fcb_log bench_fcb_log;
+static struct log bench_log;
+static uint32_t bench_start;
+
+static void
+bench_begin(void)
+{
+    native_flash_stats_get(NULL, 1);
+    bench_start = os_cputime_get32();
+}
+
+static void
+bench_end(const char *name, uint32_t payload)
+{
+    struct native_flash_stats stats;
+    uint32_t us;
+
+    us = os_cputime_ticks_to_usecs(os_cputime_get32() - bench_start);
+    native_flash_stats_get(&stats, 0);
+
+    console_printf("%s: %u bytes in %u us (busy %u us), %u B/s; "
+                   "%u bytes programmed, %u erases\n",
+                   name, (unsigned)payload, (unsigned)us,
+                   (unsigned)(stats.nfs_busy_ns / 1000),
+                   (unsigned)((uint64_t)payload * 1000000 / max(us, 1)),
+                   (unsigned)stats.nfs_bytes_written,
+                   (unsigned)stats.nfs_sector_erases);
+}
+
+static void
+bench_area_erase(void)
+{
+    const struct flash_area *fa;
+    int rc;
+
+    rc = flash_area_open(MYNEWT_VAL(NATIVE_FLASH_BENCH_AREA), &fa);
+    assert(rc == 0);
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    assert(rc == 0);
+    flash_area_close(fa);
+}
+
+static int
+bench_fcb_init(struct fcb *fcb, int cnt)
+{
+    memset(fcb, 0, sizeof(*fcb));
+    fcb->f_magic = 0x7e57fcb0;
+    fcb->f_version = 1;
+    fcb->f_sector_cnt = cnt;
+    fcb->f_sectors = bench_sectors;
+
+    return fcb_init(fcb);
+}
+
+static int
+bench_fcb_append(struct fcb *fcb, const void *data, int len)
+{
+    struct fcb_entry loc;
+    int rc;
+
+    rc = fcb_append(fcb, len, &loc);
+    if (rc == FCB_ERR_NOSPACE) {
+        rc = fcb_rotate(fcb);
+        if (rc != 0) {
+            return rc;
+        }
+        rc = fcb_append(fcb, len, &loc);
+    }
+    if (rc != 0) {
+        return rc;
+    }
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, data, len);
+    if (rc != 0) {
+        return rc;
+    }
+    return fcb_append_finish(fcb, &loc);
+}
+
+static void
+bench_run_fcb(void)
+{
+    uint8_t data[BENCH_ENTRY_LEN];
+    int rc;
+    int i;
+
+    bench_area_erase();
+    rc = bench_fcb_init(&bench_fcb, bench_sector_cnt);
+    assert(rc == 0);
+
+    bench_begin();
+    for (i = 0; i < MYNEWT_VAL(NATIVE_FLASH_BENCH_FCB_ENTRIES); i++) {
+        memset(data, (uint8_t)i, sizeof(data));
+        rc = bench_fcb_append(&bench_fcb, data, sizeof(data));
+        assert(rc == 0);
+    }
+    bench_end("fcb append", i * sizeof(data));
+}
+
+static void
+bench_run_log(void)
+{
+    uint8_t data[BENCH_ENTRY_LEN];
+    int rc;
+    int i;
+
+    bench_area_erase();
+    rc = bench_fcb_init(&bench_fcb_log.fl_fcb, bench_sector_cnt);
+    assert(rc == 0);
+    bench_fcb_log.fl_entries = 0;
+    rc = log_register("bench", &bench_log, &log_fcb_handler, &bench_fcb_log,
+                      LOG_SYSLEVEL);
+    assert(rc == 0);
+
+    bench_begin();
+    for (i = 0; i < MYNEWT_VAL(NATIVE_FLASH_BENCH_LOG_ENTRIES); i++) {
+        memset(data, 'a' + i % 26, sizeof(data));
+        rc = log_append_body(&bench_log, LOG_MODULE_DEFAULT, LOG_LEVEL_INFO,
+                             LOG_ETYPE_STRING, data, sizeof(data));
+        assert(rc == 0);
+    }
+    bench_end("log append", i * sizeof(data));
+}
+
+static void
+bench_run_nffs(void)
+{
+    uint8_t data[MYNEWT_VAL(NATIVE_FLASH_BENCH_NFFS_FILE_LEN)];
+    struct fs_file *file;
+    char name[16];
+    int rc;
+    int i;
+
+    bench_begin();
+    for (i = 0; i < MYNEWT_VAL(NATIVE_FLASH_BENCH_NFFS_FILES); i++) {
+        snprintf(name, sizeof(name), "/bench%d", i);
+        memset(data, (uint8_t)i, sizeof(data));
+        rc = fs_open(name, FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+        assert(rc == 0);
+        rc = fs_write(file, data, sizeof(data));
+        assert(rc == 0);
+        fs_close(file);
+    }
+    bench_end("nffs write", i * sizeof(data));
+}
+
+/*
+ * Fuzzer entries carry a sequence number and a payload derived from it, so
+ * that after recovery the FCB must hold a gap-free run of sequence numbers
+ * ending with the last acknowledged append (or the one interrupted after its
+ * CRC hit flash).
+ */
+struct fuzz_walk {
+    uint32_t fw_next;
+    int fw_cnt;
+    int fw_bad;
+};
+
+static int
+fuzz_entry_fill(uint8_t *buf, uint32_t seq)
+{
+    int len;
+
+    len = sizeof(seq) + seq % (BENCH_ENTRY_LEN - sizeof(seq) + 1);
+    memcpy(buf, &seq, sizeof(seq));
+    memset(buf + sizeof(seq), (uint8_t)seq, len - sizeof(seq));
+    return len;
+}
+
+static int
+fuzz_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    struct fuzz_walk *fw;
+    uint8_t expect[BENCH_ENTRY_LEN];
+    uint8_t buf[BENCH_ENTRY_LEN];
+    uint32_t seq;
+    int len;
+    int rc;
+
+    fw = arg;
+    if (loc->fe_data_len < sizeof(seq) || loc->fe_data_len > sizeof(buf)) {
+        fw->fw_bad++;
+        return 0;
+    }
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, buf,
+                         loc->fe_data_len);
+    if (rc != 0) {
+        fw->fw_bad++;
+        return 0;
+    }
+    memcpy(&seq, buf, sizeof(seq));
+    len = fuzz_entry_fill(expect, seq);
+    if (len != loc->fe_data_len || memcmp(buf, expect, len) != 0 ||
+        (fw->fw_cnt && seq != fw->fw_next)) {
+        fw->fw_bad++;
+    }
+    fw->fw_next = seq + 1;
+    fw->fw_cnt++;
+    return 0;
+}
+
+static int
+fuzz_one(uint32_t budget)
+{
+    uint8_t buf[BENCH_ENTRY_LEN];
+    struct fuzz_walk fw;
+    uint32_t seq;
+    int len;
+    int cnt;
+    int rc;
+
+    cnt = MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_SECTORS);
+
+    bench_area_erase();
+    rc = bench_fcb_init(&bench_fcb, cnt);
+    assert(rc == 0);
+
+    native_flash_power_loss_arm(budget, NULL, NULL);
+    for (seq = 0; ; seq++) {
+        len = fuzz_entry_fill(buf, seq);
+        if (bench_fcb_append(&bench_fcb, buf, len) != 0) {
+            break;
+        }
+    }
+    native_flash_power_loss_disarm();
+
+    rc = bench_fcb_init(&bench_fcb, cnt);
+    if (rc != 0) {
+        console_printf("budget %u: fcb_init failed after power loss, rc=%d\n",
+                       (unsigned)budget, rc);
+        return -1;
+    }
+
+    memset(&fw, 0, sizeof(fw));
+    rc = fcb_walk(&bench_fcb, NULL, fuzz_walk_cb, &fw);
+    if (rc != 0 || fw.fw_bad ||
+        (seq > 0 && fw.fw_cnt == 0) ||
+        (fw.fw_cnt && fw.fw_next != seq && fw.fw_next != seq + 1)) {
+        console_printf("budget %u: %d entries, %d bad, next seq %u, "
+                       "%u acknowledged\n", (unsigned)budget, fw.fw_cnt,
+                       fw.fw_bad, (unsigned)fw.fw_next, (unsigned)seq);
+        return -1;
+    }
+
+    /* Recovered FCB has to take new entries. */
+    len = fuzz_entry_fill(buf, fw.fw_next);
+    rc = bench_fcb_append(&bench_fcb, buf, len);
+    if (rc != 0) {
+        console_printf("budget %u: append after recovery failed, rc=%d\n",
+                       (unsigned)budget, rc);
+        return -1;
+    }
+    return 0;
+}
+
+static void
+bench_run_fuzz(void)
+{
+    uint32_t budget_max;
+    uint32_t start;
+    int failed;
+    int i;
+
+    if (MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_ITERATIONS) == 0) {
+        return;
+    }
+
+    /* Power-loss behaviour does not depend on timing; run at full speed. */
+    native_flash_set_timing(0, 0);
+    srand(MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_SEED));
+
+    budget_max = 0;
+    for (i = 0; i < MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_SECTORS); i++) {
+        budget_max += bench_sectors[i].fa_size;
+    }
+    /* Enough to fill all sectors and rotate a couple of times. */
+    budget_max *= 3;
+
+    failed = 0;
+    start = os_cputime_get32();
+    for (i = 0; i < MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_ITERATIONS); i++) {
+        if (fuzz_one(rand() % budget_max) != 0) {
+            failed++;
+        }
+    }
+    console_printf("fcb crash fuzz: %d runs, %d failed, %u us\n", i, failed,
+                   (unsigned)os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                                       start));
+}
+
+int
+main(int argc, char **argv)
+{
+    int rc;
+
+    mcu_sim_parse_args(argc, argv);
+
+    sysinit();
+
+    /* Native BSP does not start os_cputime */
+    os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+
+    rc = flash_area_to_sectors(MYNEWT_VAL(NATIVE_FLASH_BENCH_AREA),
+                               &bench_sector_cnt, NULL);
+    assert(rc == 0 && bench_sector_cnt <= BENCH_MAX_SECTORS);
+    assert(bench_sector_cnt >= MYNEWT_VAL(NATIVE_FLASH_BENCH_FUZZ_SECTORS));
+    flash_area_to_sectors(MYNEWT_VAL(NATIVE_FLASH_BENCH_AREA),
+                          &bench_sector_cnt, bench_sectors);
+
+    native_flash_set_timing(MYNEWT_VAL(NATIVE_FLASH_BENCH_WRITE_NS_PER_BYTE),
+                            MYNEWT_VAL(NATIVE_FLASH_BENCH_ERASE_US));
+    bench_run_fcb();
+    bench_run_log();
+    bench_run_nffs();
+
+    bench_run_fuzz();
+
+    while (1) {
+        os_eventq_run(os_eventq_dflt_get());
+    }
+    assert(0);
+    return 0;
+}
@@ -65,6 +65,16 @@ int boot_swap_type(void);
 int boot_set_pending(int permanent);
 int boot_set_confirmed(void);
 
+struct flash_area;
+/**
+ * Revokes the record that the image in slot 0 was validated
+ * (BOOTUTIL_VALIDATE_CACHE) if the given range of the slot lies before the
+ * trailer, so the next boot validates the image in full.  Called by
+ * flash_area_write() and flash_area_erase() before they modify slot 0.
+ */
+void boot_validated_revoke(const struct flash_area *fap, uint32_t off,
+                           uint32_t len);
+
 #define SPLIT_GO_OK                 (0)
 #define SPLIT_GO_NON_MATCHING       (-1)
 #define SPLIT_GO_ERR                (-2)
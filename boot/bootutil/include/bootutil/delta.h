@@ -0,0 +1,125 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#ifndef H_BOOTUTIL_DELTA_
+#define H_BOOTUTIL_DELTA_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_area;
+
+/*
+ * A delta image describes a new image as a sequence of edits against the
+ * image currently in slot 0.  It starts with a struct image_delta_hdr,
+ * followed by commands.  Each command is one opcode byte followed by an
+ * argument encoded as an unsigned LEB128 varint:
+ *
+ *     COPY n       Copy n bytes from the base image.
+ *     ADD n        n bytes follow; each is added (mod 256) to the next base
+ *                  byte.  This is the bsdiff "diff" block with its runs of
+ *                  zeros turned into COPY commands.
+ *     INSERT n     n bytes follow and are copied to the output as is.
+ *     SEEK n       Move the base read position by n bytes; n is zigzag
+ *                  encoded so it can be negative.
+ *
+ * COPY and ADD advance the base read position by n.  The output is an
+ * ordinary image; it is written to slot 1 and swapped in as usual.
+ */
+#define IMAGE_DELTA_MAGIC           0x9a1dbe5f
+
+#define IMAGE_DELTA_OP_COPY         0x01
+#define IMAGE_DELTA_OP_ADD          0x02
+#define IMAGE_DELTA_OP_INSERT       0x03
+#define IMAGE_DELTA_OP_SEEK         0x04
+
+/** Delta image header.  All fields are in little endian byte order. */
+struct image_delta_hdr {
+    uint32_t idh_magic;
+    uint32_t idh_src_size;  /* Size of the base image, including TLVs. */
+    uint32_t idh_dst_size;  /* Size of the image the delta produces. */
+    uint32_t _pad;
+    uint8_t idh_src_hash[32]; /* IMAGE_TLV_SHA256 of the base image. */
+};
+
+/**
+ * Receives delta output.  Must return 0 on success; any other value aborts
+ * the delta and is returned to the caller of boot_delta_feed().
+ */
+typedef int boot_delta_write_fn(const void *data, uint32_t len, void *arg);
+
+/** Streaming delta decoder.  Treat as opaque. */
+struct boot_delta {
+    const struct flash_area *bd_src;
+    boot_delta_write_fn *bd_write;
+    void *bd_arg;
+    uint32_t bd_src_size;
+    uint32_t bd_src_off;
+    uint32_t bd_dst_size;
+    uint32_t bd_dst_off;
+    uint32_t bd_hdr_left;
+    uint32_t bd_val;
+    uint8_t bd_state;
+    uint8_t bd_op;
+    uint8_t bd_shift;
+};
+
+/**
+ * Prepares a decoder for a delta image.
+ *
+ * @param bd                    The decoder to initialize.
+ * @param hdr                   The header of the delta image.
+ * @param src                   The flash area holding the base image.
+ * @param write_cb              Called with the decoded image, in order.
+ * @param arg                   Passed to write_cb.
+ *
+ * @return                      0 on success; nonzero if the header is invalid
+ *                                  or does not fit the base area.
+ */
+int boot_delta_init(struct boot_delta *bd, const struct image_delta_hdr *hdr,
+                    const struct flash_area *src,
+                    boot_delta_write_fn *write_cb, void *arg);
+
+/**
+ * Decodes the next part of a delta image.  The data may be split at any
+ * point; the header is part of the stream and is skipped.
+ *
+ * @return                      0 on success; nonzero if the delta is corrupt,
+ *                                  the base could not be read or write_cb
+ *                                  failed.
+ */
+int boot_delta_feed(struct boot_delta *bd, const void *data, uint32_t len);
+
+/**
+ * Checks that the whole delta has been decoded.
+ *
+ * @return                      0 if the complete image was produced;
+ *                                  nonzero otherwise.
+ */
+int boot_delta_finish(const struct boot_delta *bd);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -34,6 +34,22 @@ struct bootutil_key {
 extern const struct bootutil_key bootutil_keys[];
 extern const int bootutil_key_cnt;
 
+/**
+ * Supplies the key for the slot 0 validation cache
+ * (BOOTUTIL_VALIDATE_CACHE).  Must be provided by the BSP or the application
+ * when that option is enabled.  The key must be a per-device secret that the
+ * application cannot read, e.g. OTP or key storage that the loader locks
+ * before jumping to the image.
+ *
+ * @param key           Buffer to fill with the key.
+ * @param max_len       Size of the buffer.
+ *
+ * @return              Length of the key, at most max_len; <= 0 if no key is
+ *                          available, in which case every image is fully
+ *                          validated.
+ */
+int bootutil_validate_cache_key(uint8_t *key, int max_len);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,6 +52,9 @@ TEST_CASE_DECL(boot_test_revert)
 TEST_CASE_DECL(boot_test_revert_continue)
 TEST_CASE_DECL(boot_test_permanent)
 TEST_CASE_DECL(boot_test_permanent_continue)
+TEST_CASE_DECL(boot_test_delta)
+TEST_CASE_DECL(boot_test_delta_corrupt)
+TEST_CASE_DECL(boot_test_validated)
 
 TEST_SUITE(boot_test_main)
 {
@@ -74,6 +77,9 @@ TEST_SUITE(boot_test_main)
     boot_test_revert_continue();
     boot_test_permanent();
     boot_test_permanent_continue();
+    boot_test_delta();
+    boot_test_delta_corrupt();
+    boot_test_validated();
 }
 
 int
@@ -57,6 +57,9 @@ extern struct boot_test_img_addrs boot_test_img_addrs[];
 
 #define BOOT_TEST_AREA_IDX_SCRATCH 6
 
+extern uint8_t boot_test_cache_key[32];
+extern int boot_test_cache_key_len;
+
 uint8_t boot_test_util_byte_at(int img_msb, uint32_t image_offset);
 uint8_t boot_test_util_flash_align(void);
 void boot_test_util_init_flash(void);
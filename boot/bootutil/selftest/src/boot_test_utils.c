@@ -44,6 +44,20 @@ struct boot_test_img_addrs boot_test_img_addrs[] = {
 
 #define BOOT_TEST_AREA_IDX_SCRATCH 6
 
+/** Key for the validation cache; a zero length means no key is available. */
+uint8_t boot_test_cache_key[32] = "bootutil selftest cache key";
+int boot_test_cache_key_len = sizeof boot_test_cache_key;
+
+int
+bootutil_validate_cache_key(uint8_t *key, int max_len)
+{
+    if (boot_test_cache_key_len > max_len) {
+        return -1;
+    }
+    memcpy(key, boot_test_cache_key, boot_test_cache_key_len);
+    return boot_test_cache_key_len;
+}
+
 uint8_t
 boot_test_util_byte_at(int img_msb, uint32_t image_offset)
 {
@@ -0,0 +1,159 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "boot_test.h"
+#include "bootutil/delta.h"
+
+static uint8_t boot_test_delta_out[1024];
+static uint32_t boot_test_delta_out_len;
+
+static int
+boot_test_delta_write(const void *data, uint32_t len, void *arg)
+{
+    TEST_ASSERT_FATAL(boot_test_delta_out_len + len <=
+                      sizeof boot_test_delta_out);
+    memcpy(boot_test_delta_out + boot_test_delta_out_len, data, len);
+    boot_test_delta_out_len += len;
+    return 0;
+}
+
+static int
+boot_test_delta_cmd(uint8_t *dst, uint8_t op, uint32_t arg)
+{
+    int len;
+
+    len = 0;
+    dst[len++] = op;
+    do {
+        dst[len] = arg & 0x7f;
+        arg >>= 7;
+        if (arg != 0) {
+            dst[len] |= 0x80;
+        }
+        len++;
+    } while (arg != 0);
+
+    return len;
+}
+
+TEST_CASE_SELF(boot_test_delta)
+{
+    static const uint8_t add[4] = { 1, 2, 3, 0xff };
+    static const uint8_t ins[5] = { 'h', 'e', 'l', 'l', 'o' };
+    struct image_header hdr0 = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 0,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 4 * 1024,
+        .ih_flags = 0,
+        .ih_ver = { 0, 2, 3, 4 },
+    };
+    struct image_delta_hdr *dhdr;
+    const struct flash_area *fap;
+    struct boot_delta bd;
+    uint8_t expected[sizeof boot_test_delta_out];
+    uint8_t patch[256];
+    uint8_t base[2048];
+    uint32_t exp_len;
+    int patch_len;
+    int chunk;
+    int len;
+    int off;
+    int rc;
+    int i;
+
+    boot_test_util_init_flash();
+    boot_test_util_write_image(&hdr0, 0);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fap);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_read(fap, 0, base, sizeof base);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Build a patch exercising each command, and the image it produces. */
+    memset(patch, 0, sizeof *dhdr);
+    dhdr = (struct image_delta_hdr *)patch;
+    dhdr->idh_magic = IMAGE_DELTA_MAGIC;
+    dhdr->idh_src_size = IMAGE_SIZE(&hdr0);
+    patch_len = sizeof *dhdr;
+    exp_len = 0;
+
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_COPY, 256);
+    memcpy(expected + exp_len, base, 256);
+    exp_len += 256;
+
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_ADD, sizeof add);
+    memcpy(patch + patch_len, add, sizeof add);
+    patch_len += sizeof add;
+    for (i = 0; i < sizeof add; i++) {
+        expected[exp_len++] = base[256 + i] + add[i];
+    }
+
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_INSERT, sizeof ins);
+    memcpy(patch + patch_len, ins, sizeof ins);
+    patch_len += sizeof ins;
+    memcpy(expected + exp_len, ins, sizeof ins);
+    exp_len += sizeof ins;
+
+    /* Back 100 bytes (zigzag 199), then forward 1000 (zigzag 2000). */
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_SEEK, 199);
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_COPY, 200);
+    memcpy(expected + exp_len, base + 160, 200);
+    exp_len += 200;
+
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_SEEK, 2000);
+    patch_len += boot_test_delta_cmd(patch + patch_len,
+                                     IMAGE_DELTA_OP_COPY, 300);
+    memcpy(expected + exp_len, base + 1360, 300);
+    exp_len += 300;
+
+    dhdr->idh_dst_size = exp_len;
+
+    /* Result must not depend on how the patch is split up. */
+    for (chunk = 1; chunk <= patch_len; chunk = chunk * 3 + 1) {
+        boot_test_delta_out_len = 0;
+        rc = boot_delta_init(&bd, dhdr, fap, boot_test_delta_write, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        for (off = 0; off < patch_len; off += len) {
+            len = chunk;
+            if (off + len > patch_len) {
+                len = patch_len - off;
+            }
+            rc = boot_delta_feed(&bd, patch + off, len);
+            TEST_ASSERT_FATAL(rc == 0);
+
+            /* Image is incomplete until the last byte is fed. */
+            if (off + len < patch_len) {
+                TEST_ASSERT(boot_delta_finish(&bd) != 0);
+            }
+        }
+        TEST_ASSERT(boot_delta_finish(&bd) == 0);
+        TEST_ASSERT(boot_test_delta_out_len == exp_len);
+        TEST_ASSERT(memcmp(boot_test_delta_out, expected, exp_len) == 0);
+    }
+
+    flash_area_close(fap);
+}
@@ -0,0 +1,119 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "boot_test.h"
+#include "bootutil/delta.h"
+
+static int
+boot_test_delta_corrupt_write(const void *data, uint32_t len, void *arg)
+{
+    return 0;
+}
+
+static int
+boot_test_delta_corrupt_run(const struct image_delta_hdr *dhdr,
+                            const struct flash_area *fap,
+                            const uint8_t *cmds, int len)
+{
+    struct boot_delta bd;
+    int rc;
+
+    rc = boot_delta_init(&bd, dhdr, fap, boot_test_delta_corrupt_write, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = boot_delta_feed(&bd, dhdr, sizeof *dhdr);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = boot_delta_feed(&bd, cmds, len);
+    if (rc == 0) {
+        rc = boot_delta_finish(&bd);
+    }
+    return rc;
+}
+
+TEST_CASE_SELF(boot_test_delta_corrupt)
+{
+    /* Unknown opcode. */
+    static const uint8_t bad_op[] = { 0x09, 0x01 };
+    /* Copies past the end of the base image. */
+    static const uint8_t copy_past_src[] = {
+        IMAGE_DELTA_OP_SEEK, 0x7e, IMAGE_DELTA_OP_COPY, 0x02
+    };
+    /* Seeks before the start of the base image. */
+    static const uint8_t seek_neg[] = { IMAGE_DELTA_OP_SEEK, 0x01 };
+    /* Produces more than the declared image size. */
+    static const uint8_t too_long[] = {
+        IMAGE_DELTA_OP_INSERT, 0x11,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+    };
+    /* Stops in the middle of an INSERT. */
+    static const uint8_t truncated[] = { IMAGE_DELTA_OP_INSERT, 0x04, 0, 0 };
+    /* Argument wider than 32 bits. */
+    static const uint8_t wide_arg[] = {
+        IMAGE_DELTA_OP_COPY, 0xff, 0xff, 0xff, 0xff, 0x7f
+    };
+    /* Valid, for reference. */
+    static const uint8_t good[] = {
+        IMAGE_DELTA_OP_COPY, 0x08, IMAGE_DELTA_OP_INSERT, 0x08,
+        0, 0, 0, 0, 0, 0, 0, 0
+    };
+    struct image_delta_hdr dhdr;
+    const struct flash_area *fap;
+    struct boot_delta bd;
+    int rc;
+
+    boot_test_util_init_flash();
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fap);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(&dhdr, 0, sizeof dhdr);
+    dhdr.idh_magic = IMAGE_DELTA_MAGIC;
+    dhdr.idh_src_size = 64;
+    dhdr.idh_dst_size = 16;
+
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, good,
+                                            sizeof good) == 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, bad_op,
+                                            sizeof bad_op) != 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, copy_past_src,
+                                            sizeof copy_past_src) != 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, seek_neg,
+                                            sizeof seek_neg) != 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, too_long,
+                                            sizeof too_long) != 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, truncated,
+                                            sizeof truncated) != 0);
+    TEST_ASSERT(boot_test_delta_corrupt_run(&dhdr, fap, wide_arg,
+                                            sizeof wide_arg) != 0);
+
+    /* Bad magic and a base larger than the slot are rejected up front. */
+    dhdr.idh_magic = IMAGE_MAGIC;
+    rc = boot_delta_init(&bd, &dhdr, fap, boot_test_delta_corrupt_write,
+                         NULL);
+    TEST_ASSERT(rc != 0);
+
+    dhdr.idh_magic = IMAGE_DELTA_MAGIC;
+    dhdr.idh_src_size = fap->fa_size + 1;
+    rc = boot_delta_init(&bd, &dhdr, fap, boot_test_delta_corrupt_write,
+                         NULL);
+    TEST_ASSERT(rc != 0);
+
+    flash_area_close(fap);
+}
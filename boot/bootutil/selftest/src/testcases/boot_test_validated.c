@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "boot_test.h"
+
+TEST_CASE_SELF(boot_test_validated)
+{
+    struct image_header hdr0 = {
+        .ih_magic = IMAGE_MAGIC,
+        .ih_tlv_size = 4 + 32,
+        .ih_hdr_size = BOOT_TEST_HEADER_SIZE,
+        .ih_img_size = 12 * 1024,
+        .ih_flags = IMAGE_F_SHA256,
+        .ih_ver = { 0, 2, 3, 4 },
+    };
+    struct image_header other;
+    const struct flash_area *fap;
+    static uint8_t tmpbuf[BOOT_TMPBUF_SZ];
+    uint8_t buf[8];
+    uint32_t off;
+    int rc;
+
+    boot_test_util_init_flash();
+    boot_test_util_write_image(&hdr0, 0);
+    boot_test_util_write_hash(&hdr0, 0);
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fap);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* Nothing recorded yet. */
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+
+    rc = bootutil_img_validate(&hdr0, fap, tmpbuf, sizeof tmpbuf,
+                               NULL, 0, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = bootutil_img_set_validated(&hdr0, fap);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) == 0);
+
+    /* The record is written once. */
+    TEST_ASSERT(bootutil_img_set_validated(&hdr0, fap) != 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) == 0);
+
+    /* A different header does not match the record. */
+    other = hdr0;
+    other.ih_ver.iv_build_num++;
+    TEST_ASSERT(bootutil_img_validated(&other, fap) != 0);
+
+    /* Nor does a record made with another key, e.g. on another device. */
+    boot_test_cache_key[0] ^= 0x01;
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+    boot_test_cache_key[0] ^= 0x01;
+
+    /* Without a key, nothing is trusted. */
+    boot_test_cache_key_len = 0;
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+    boot_test_cache_key_len = sizeof boot_test_cache_key;
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) == 0);
+
+    /* The record does not disturb the swap state. */
+    rc = boot_write_magic(fap);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) == 0);
+
+    /* Confirming the image writes the trailer and keeps the record. */
+    rc = boot_write_image_ok(fap);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) == 0);
+
+    /* Any write to the slot before the trailer revokes the record. */
+    off = hdr0.ih_hdr_size + hdr0.ih_img_size + hdr0.ih_tlv_size;
+    memset(buf, 0, sizeof buf);
+    rc = flash_area_write(fap, off, buf, sizeof buf);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+
+    /* A revoked record cannot be written again. */
+    TEST_ASSERT(bootutil_img_set_validated(&hdr0, fap) != 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+
+    /* A new image in the slot does not match either. */
+    boot_test_util_init_flash();
+    hdr0.ih_img_size += 4;
+    boot_test_util_write_image(&hdr0, 0);
+    boot_test_util_write_hash(&hdr0, 0);
+    TEST_ASSERT(bootutil_img_validated(&hdr0, fap) != 0);
+
+    flash_area_close(fap);
+}
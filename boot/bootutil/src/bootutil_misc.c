@@ -161,10 +161,23 @@ boot_status_sz(uint8_t min_write_sz)
     return BOOT_STATUS_MAX_ENTRIES * BOOT_STATUS_STATE_COUNT * min_write_sz;
 }
 
+uint32_t
+boot_validated_sz(uint8_t min_write_sz)
+{
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    /* The record, then the revoked element. */
+    return (sizeof(struct boot_validated) + min_write_sz - 1) /
+           min_write_sz * min_write_sz + min_write_sz;
+#else
+    return 0;
+#endif
+}
+
 uint32_t
 boot_trailer_sz(uint8_t min_write_sz)
 {
-    return sizeof boot_img_magic            +
+    return boot_validated_sz(min_write_sz)  +
+           sizeof boot_img_magic            +
            boot_status_sz(min_write_sz)     +
            min_write_sz * 2;
 }
@@ -177,12 +190,25 @@ boot_magic_off(const struct flash_area *fap)
 
     elem_sz = flash_area_align(fap);
 
-    off_from_end = boot_trailer_sz(elem_sz);
+    /* The validated record precedes the magic; it does not move it. */
+    off_from_end = boot_trailer_sz(elem_sz) - boot_validated_sz(elem_sz);
 
     assert(off_from_end <= fap->fa_size);
     return fap->fa_size - off_from_end;
 }
 
+uint32_t
+boot_validated_off(const struct flash_area *fap)
+{
+    return boot_magic_off(fap) - boot_validated_sz(flash_area_align(fap));
+}
+
+uint32_t
+boot_validated_revoke_off(const struct flash_area *fap)
+{
+    return boot_magic_off(fap) - flash_area_align(fap);
+}
+
 uint32_t
 boot_status_off(const struct flash_area *fap)
 {
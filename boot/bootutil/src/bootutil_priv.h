@@ -37,7 +37,7 @@ struct flash_area;
 #define BOOT_ENOMEM     6
 #define BOOT_EBADARGS   7
 
-#define BOOT_TMPBUF_SZ  256
+#define BOOT_TMPBUF_SZ  MYNEWT_VAL(BOOTUTIL_TMPBUF_SZ)
 
 /*
  * Maintain state of copy progress.
@@ -57,6 +57,10 @@ struct boot_status {
  *  0                   1                   2                   3
  *  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
  * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * ~       Validated record (BOOTUTIL_VALIDATE_CACHE only, aligned)~
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+ * |    Revoked    |     0xff padding (up to min-write-sz - 1)     ~
+ * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  * ~                        MAGIC (16 octets)                      ~
  * +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  * ~                                                               ~
@@ -71,6 +75,20 @@ struct boot_status {
 
 extern const uint32_t boot_img_magic[4];
 
+/**
+ * Records that the image in slot 0 passed validation.  The tag is an
+ * HMAC-SHA256, keyed with the hardware ID, over the slot offset, the image
+ * header and the image hash TLV.  The record is ignored once the revoked
+ * element that follows it is written, see boot_validated_revoke().
+ */
+struct boot_validated {
+    uint32_t bv_magic;
+    uint32_t _pad;
+    uint8_t bv_tag[32];
+};
+
+#define BOOT_VALIDATED_MAGIC    0x7a11da7e
+
 struct boot_swap_state {
     uint8_t magic;  /* One of the BOOT_MAGIC_[...] values. */
     uint8_t copy_done;
@@ -100,6 +118,15 @@ int boot_write_copy_done(const struct flash_area *fap);
 int boot_write_image_ok(const struct flash_area *fap);
 
 uint32_t boot_status_sz(uint8_t min_write_sz);
+uint32_t boot_validated_sz(uint8_t min_write_sz);
+uint32_t boot_validated_off(const struct flash_area *fap);
+uint32_t boot_validated_revoke_off(const struct flash_area *fap);
+void bootutil_validated_revoke_hold(int hold);
+
+int bootutil_img_validated(const struct image_header *hdr,
+                           const struct flash_area *fap);
+int bootutil_img_set_validated(const struct image_header *hdr,
+                               const struct flash_area *fap);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,260 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+
+#include <stddef.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/delta.h"
+#include "bootutil_priv.h"
+
+#define BOOT_DELTA_STATE_HDR        0
+#define BOOT_DELTA_STATE_OP         1
+#define BOOT_DELTA_STATE_ARG        2
+#define BOOT_DELTA_STATE_DATA       3
+
+/** Size of the stack buffer used to read the base image. */
+#define BOOT_DELTA_BUF_SZ           64
+
+/**
+ * Emits len bytes read from the base image.  If add is not NULL, each byte
+ * of add is added to the corresponding base byte first.
+ */
+static int
+boot_delta_copy(struct boot_delta *bd, const uint8_t *add, uint32_t len)
+{
+    uint8_t buf[BOOT_DELTA_BUF_SZ];
+    uint32_t chunk;
+    uint32_t i;
+    int rc;
+
+    if (len > bd->bd_src_size - bd->bd_src_off ||
+        len > bd->bd_dst_size - bd->bd_dst_off) {
+
+        return BOOT_EBADIMAGE;
+    }
+
+    while (len > 0) {
+        chunk = len;
+        if (chunk > sizeof buf) {
+            chunk = sizeof buf;
+        }
+
+        rc = flash_area_read(bd->bd_src, bd->bd_src_off, buf, chunk);
+        if (rc != 0) {
+            return BOOT_EFLASH;
+        }
+
+        if (add != NULL) {
+            for (i = 0; i < chunk; i++) {
+                buf[i] += add[i];
+            }
+            add += chunk;
+        }
+
+        rc = bd->bd_write(buf, chunk, bd->bd_arg);
+        if (rc != 0) {
+            return rc;
+        }
+
+        bd->bd_src_off += chunk;
+        bd->bd_dst_off += chunk;
+        len -= chunk;
+    }
+
+    return 0;
+}
+
+static int
+boot_delta_insert(struct boot_delta *bd, const uint8_t *data, uint32_t len)
+{
+    int rc;
+
+    if (len > bd->bd_dst_size - bd->bd_dst_off) {
+        return BOOT_EBADIMAGE;
+    }
+
+    rc = bd->bd_write(data, len, bd->bd_arg);
+    if (rc != 0) {
+        return rc;
+    }
+
+    bd->bd_dst_off += len;
+    return 0;
+}
+
+/**
+ * Executes the current command now that its argument has been read.  COPY
+ * and SEEK complete immediately; ADD and INSERT wait for their data.
+ */
+static int
+boot_delta_exec(struct boot_delta *bd)
+{
+    int64_t off;
+
+    switch (bd->bd_op) {
+    case IMAGE_DELTA_OP_COPY:
+        bd->bd_state = BOOT_DELTA_STATE_OP;
+        return boot_delta_copy(bd, NULL, bd->bd_val);
+
+    case IMAGE_DELTA_OP_SEEK:
+        /* Undo zigzag encoding. */
+        off = (int64_t)bd->bd_src_off + (int32_t)((bd->bd_val >> 1) ^
+                                                  -(bd->bd_val & 1));
+        if (off < 0 || off > bd->bd_src_size) {
+            return BOOT_EBADIMAGE;
+        }
+        bd->bd_src_off = off;
+        bd->bd_state = BOOT_DELTA_STATE_OP;
+        return 0;
+
+    case IMAGE_DELTA_OP_ADD:
+        if (bd->bd_val > bd->bd_src_size - bd->bd_src_off) {
+            return BOOT_EBADIMAGE;
+        }
+        /* Fall through. */
+    case IMAGE_DELTA_OP_INSERT:
+        if (bd->bd_val > bd->bd_dst_size - bd->bd_dst_off) {
+            return BOOT_EBADIMAGE;
+        }
+        if (bd->bd_val == 0) {
+            bd->bd_state = BOOT_DELTA_STATE_OP;
+        } else {
+            bd->bd_state = BOOT_DELTA_STATE_DATA;
+        }
+        return 0;
+
+    default:
+        return BOOT_EBADIMAGE;
+    }
+}
+
+int
+boot_delta_init(struct boot_delta *bd, const struct image_delta_hdr *hdr,
+                const struct flash_area *src,
+                boot_delta_write_fn *write_cb, void *arg)
+{
+    if (hdr->idh_magic != IMAGE_DELTA_MAGIC ||
+        hdr->idh_src_size > src->fa_size) {
+
+        return BOOT_EBADIMAGE;
+    }
+
+    memset(bd, 0, sizeof *bd);
+    bd->bd_src = src;
+    bd->bd_write = write_cb;
+    bd->bd_arg = arg;
+    bd->bd_src_size = hdr->idh_src_size;
+    bd->bd_dst_size = hdr->idh_dst_size;
+    bd->bd_hdr_left = sizeof *hdr;
+    bd->bd_state = BOOT_DELTA_STATE_HDR;
+
+    return 0;
+}
+
+int
+boot_delta_feed(struct boot_delta *bd, const void *data, uint32_t len)
+{
+    const uint8_t *p;
+    uint32_t n;
+    uint8_t b;
+    int rc;
+
+    p = data;
+    while (len > 0) {
+        switch (bd->bd_state) {
+        case BOOT_DELTA_STATE_HDR:
+            n = len;
+            if (n > bd->bd_hdr_left) {
+                n = bd->bd_hdr_left;
+            }
+            bd->bd_hdr_left -= n;
+            if (bd->bd_hdr_left == 0) {
+                bd->bd_state = BOOT_DELTA_STATE_OP;
+            }
+            break;
+
+        case BOOT_DELTA_STATE_OP:
+            n = 1;
+            bd->bd_op = *p;
+            bd->bd_val = 0;
+            bd->bd_shift = 0;
+            bd->bd_state = BOOT_DELTA_STATE_ARG;
+            break;
+
+        case BOOT_DELTA_STATE_ARG:
+            n = 1;
+            b = *p;
+            if (bd->bd_shift > 28 || (bd->bd_shift == 28 && (b & 0x70))) {
+                /* Argument does not fit in 32 bits. */
+                return BOOT_EBADIMAGE;
+            }
+            bd->bd_val |= (uint32_t)(b & 0x7f) << bd->bd_shift;
+            bd->bd_shift += 7;
+            if (!(b & 0x80)) {
+                rc = boot_delta_exec(bd);
+                if (rc != 0) {
+                    return rc;
+                }
+            }
+            break;
+
+        case BOOT_DELTA_STATE_DATA:
+            n = len;
+            if (n > bd->bd_val) {
+                n = bd->bd_val;
+            }
+            if (bd->bd_op == IMAGE_DELTA_OP_ADD) {
+                rc = boot_delta_copy(bd, p, n);
+            } else {
+                rc = boot_delta_insert(bd, p, n);
+            }
+            if (rc != 0) {
+                return rc;
+            }
+            bd->bd_val -= n;
+            if (bd->bd_val == 0) {
+                bd->bd_state = BOOT_DELTA_STATE_OP;
+            }
+            break;
+
+        default:
+            return BOOT_EBADARGS;
+        }
+
+        p += n;
+        len -= n;
+    }
+
+    return 0;
+}
+
+int
+boot_delta_finish(const struct boot_delta *bd)
+{
+    if (bd->bd_state != BOOT_DELTA_STATE_OP ||
+        bd->bd_dst_off != bd->bd_dst_size) {
+
+        return BOOT_EBADIMAGE;
+    }
+
+    return 0;
+}
@@ -218,3 +218,201 @@ bootutil_img_validate(struct image_header *hdr, const struct flash_area *fap,
 #endif
     return 0;
 }
+
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+/* Set while the loader swaps images; the swap replaces the whole trailer. */
+static uint8_t bootutil_revoke_held;
+
+/*
+ * Read the value of the image hash TLV.
+ */
+static int
+bootutil_img_hash_tlv(const struct image_header *hdr,
+                      const struct flash_area *fap, uint8_t *hash)
+{
+    struct image_tlv tlv;
+    uint32_t size;
+    uint32_t off;
+
+    off = hdr->ih_img_size + hdr->ih_hdr_size;
+    size = off + hdr->ih_tlv_size;
+
+    for (; off < size; off += sizeof(tlv) + tlv.it_len) {
+        if (flash_area_read(fap, off, &tlv, sizeof tlv)) {
+            return -1;
+        }
+        if (tlv.it_type == IMAGE_TLV_SHA256 && tlv.it_len == 32) {
+            if (flash_area_read(fap, off + sizeof(tlv), hash, 32)) {
+                return -1;
+            }
+            return 0;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Compute the tag of a validated record: HMAC-SHA256 keyed with the device
+ * secret from bootutil_validate_cache_key(), so that the record cannot be
+ * forged by someone who can only write flash.
+ */
+static int
+bootutil_img_tag(const struct image_header *hdr, const struct flash_area *fap,
+                 const uint8_t *hash, uint8_t *tag)
+{
+    mbedtls_sha256_context sha256_ctx;
+    uint8_t pad[64];
+    uint8_t inner[32];
+    int rc;
+    int i;
+
+    memset(pad, 0, sizeof pad);
+    rc = bootutil_validate_cache_key(pad, sizeof pad);
+    if (rc <= 0 || rc > sizeof pad) {
+        memset(pad, 0, sizeof pad);
+        return -1;
+    }
+
+    for (i = 0; i < sizeof pad; i++) {
+        pad[i] ^= 0x36;
+    }
+    mbedtls_sha256_init(&sha256_ctx);
+    mbedtls_sha256_starts(&sha256_ctx, 0);
+    mbedtls_sha256_update(&sha256_ctx, pad, sizeof pad);
+    mbedtls_sha256_update(&sha256_ctx, (const uint8_t *)&fap->fa_off,
+                          sizeof fap->fa_off);
+    mbedtls_sha256_update(&sha256_ctx, (const uint8_t *)hdr, sizeof *hdr);
+    mbedtls_sha256_update(&sha256_ctx, hash, 32);
+    mbedtls_sha256_finish(&sha256_ctx, inner);
+
+    for (i = 0; i < sizeof pad; i++) {
+        pad[i] ^= 0x36 ^ 0x5c;
+    }
+    mbedtls_sha256_starts(&sha256_ctx, 0);
+    mbedtls_sha256_update(&sha256_ctx, pad, sizeof pad);
+    mbedtls_sha256_update(&sha256_ctx, inner, sizeof inner);
+    mbedtls_sha256_finish(&sha256_ctx, tag);
+
+    memset(pad, 0, sizeof pad);
+    return 0;
+}
+
+/*
+ * Check whether the slot trailer records that this image was validated.
+ * Return 0 if so; the image then does not need to be hashed again.
+ */
+int
+bootutil_img_validated(const struct image_header *hdr,
+                       const struct flash_area *fap)
+{
+    struct boot_validated bv;
+    uint8_t hash[32];
+    uint8_t tag[32];
+
+    if (flash_area_read(fap, boot_validated_off(fap), &bv, sizeof bv)) {
+        return -1;
+    }
+    if (bv.bv_magic != BOOT_VALIDATED_MAGIC) {
+        return -1;
+    }
+    if (flash_area_read_is_empty(fap, boot_validated_revoke_off(fap), hash,
+                                 flash_area_align(fap)) != 1) {
+        return -1;
+    }
+    if (bootutil_img_hash_tlv(hdr, fap, hash)) {
+        return -1;
+    }
+
+    if (bootutil_img_tag(hdr, fap, hash, tag)) {
+        return -1;
+    }
+    if (memcmp(tag, bv.bv_tag, sizeof tag)) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Record in the slot trailer that this image passed validation.  Call only
+ * after bootutil_img_validate() succeeded.  The record is written at most
+ * once; if the space already holds something, a revoked record included,
+ * it is left alone.
+ */
+int
+bootutil_img_set_validated(const struct image_header *hdr,
+                           const struct flash_area *fap)
+{
+    struct boot_validated bv;
+    uint8_t buf[64];
+    uint32_t off;
+    uint32_t sz;
+
+    off = boot_validated_off(fap);
+    sz = boot_validated_sz(flash_area_align(fap));
+    if (sz > sizeof buf || IMAGE_SIZE(hdr) > off) {
+        return -1;
+    }
+
+    if (flash_area_read_is_empty(fap, off, buf, sz) != 1) {
+        return -1;
+    }
+
+    memset(&bv, 0, sizeof bv);
+    bv.bv_magic = BOOT_VALIDATED_MAGIC;
+    if (bootutil_img_hash_tlv(hdr, fap, buf)) {
+        return -1;
+    }
+    if (bootutil_img_tag(hdr, fap, buf, bv.bv_tag)) {
+        return -1;
+    }
+
+    /* The revoked element stays erased. */
+    sz -= flash_area_align(fap);
+    memset(buf, flash_area_erased_val(fap), sz);
+    memcpy(buf, &bv, sizeof bv);
+    if (flash_area_write(fap, off, buf, sz)) {
+        return -1;
+    }
+    return 0;
+}
+
+void
+bootutil_validated_revoke_hold(int hold)
+{
+    bootutil_revoke_held = hold;
+}
+
+void
+boot_validated_revoke(const struct flash_area *fap, uint32_t off,
+                      uint32_t len)
+{
+    struct boot_validated bv;
+    uint32_t rec_off;
+    uint8_t buf[8];
+    uint8_t align;
+
+    if (bootutil_revoke_held || len == 0) {
+        return;
+    }
+
+    /* Trailer updates, e.g. confirming the image, keep the record. */
+    rec_off = boot_validated_off(fap);
+    if (off >= rec_off) {
+        return;
+    }
+
+    if (flash_area_read(fap, rec_off, &bv, sizeof bv) ||
+        bv.bv_magic != BOOT_VALIDATED_MAGIC) {
+        return;
+    }
+
+    align = flash_area_align(fap);
+    off = boot_validated_revoke_off(fap);
+    if (align > sizeof buf ||
+        flash_area_read_is_empty(fap, off, buf, align) != 1) {
+        return;
+    }
+    memset(buf, ~flash_area_erased_val(fap), sizeof buf);
+    (void)flash_area_write(fap, off, buf, align);
+}
+#endif
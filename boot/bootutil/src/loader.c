@@ -581,6 +581,17 @@ boot_validate_slot(int slot)
         return BOOT_EFLASH;
     }
 
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    /* Skip hashing an image in slot 0 that was validated on an earlier boot.
+     */
+    if (slot == 0 && boot_data.imgs[slot].hdr.ih_magic == IMAGE_MAGIC &&
+        bootutil_img_validated(&boot_data.imgs[slot].hdr, fap) == 0) {
+
+        flash_area_close(fap);
+        return 0;
+    }
+#endif
+
     if (boot_data.imgs[slot].hdr.ih_magic != IMAGE_MAGIC ||
         boot_image_check(&boot_data.imgs[slot].hdr, fap) != 0) {
 
@@ -592,6 +603,13 @@ boot_validate_slot(int slot)
         }
         return -1;
     }
+
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    if (slot == 0) {
+        /* Failure only means the next boot validates the image again. */
+        (void)bootutil_img_set_validated(&boot_data.imgs[slot].hdr, fap);
+    }
+#endif
     flash_area_close(fap);
 
     /* Image in slot 1 is valid. */
@@ -874,6 +892,11 @@ boot_copy_image(struct boot_status *bs)
     int last_sector_idx;
     int swap_idx;
 
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    /* The swap erases the validated record along with the trailer. */
+    bootutil_validated_revoke_hold(1);
+#endif
+
     swap_idx = 0;
     last_sector_idx = boot_data.imgs[0].num_sectors - 1;
     while (last_sector_idx >= 0) {
@@ -889,6 +912,10 @@ boot_copy_image(struct boot_status *bs)
         swap_idx++;
     }
 
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    bootutil_validated_revoke_hold(0);
+#endif
+
     return 0;
 }
 
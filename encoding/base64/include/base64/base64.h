@@ -26,6 +26,8 @@
 extern "C" {
 #endif
 
+struct os_mbuf;
+
 int base64_encode(const void *, int, char *, uint8_t);
 int base64_decode(const char *, void *buf);
 int base64_pad(char *, int);
@@ -33,6 +35,53 @@ int base64_decode_len(const char *str);
 
 #define BASE64_ENCODE_SIZE(__size) (((((__size) - 1) / 3) * 4) + 4)
 
+/** Upper bound on the number of bytes decoded from __len characters. */
+#define BASE64_DECODE_SIZE(__len) ((((__len) + 3) / 4) * 3)
+
+/**
+ * Incremental decoder.  Input can be fed in arbitrarily sized pieces; a
+ * group of four characters split across two calls is carried in the
+ * decoder.  Padding may end any group, after which decoding continues with
+ * the next group, the same as base64_decode().
+ */
+struct base64_decoder {
+    uint32_t bd_acc;
+    uint8_t bd_cnt;
+    uint8_t bd_pad;
+};
+
+void base64_decoder_init(struct base64_decoder *bd);
+
+/**
+ * Decodes len characters from src into dst.
+ *
+ * @return                      The number of bytes written to dst;
+ *                              -1 on invalid input or if dst_len is too
+ *                                  small.
+ */
+int base64_decoder_feed(struct base64_decoder *bd, const char *src, int len,
+                        void *dst, int dst_len);
+
+/**
+ * Decodes len characters from src and appends the result to the mbuf chain
+ * om.  Decoded bytes are written directly into the trailing space of the
+ * chain; further mbufs are allocated from om's pool as needed.
+ *
+ * @return                      The number of bytes appended;
+ *                              -1 on invalid input or allocation failure.
+ *                                  Bytes decoded before the failure remain
+ *                                  in the chain.
+ */
+int base64_decoder_feed_mbuf(struct base64_decoder *bd, const char *src,
+                             int len, struct os_mbuf *om);
+
+/**
+ * Checks that the input fed so far ended on a group boundary.
+ *
+ * @return                      0 if so; -1 if a partial group remains.
+ */
+int base64_decoder_finish(struct base64_decoder *bd);
+
 #ifdef __cplusplus
 }
 #endif
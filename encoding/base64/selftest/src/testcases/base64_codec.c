@@ -0,0 +1,94 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "base64/base64.h"
+#include "encoding_test_priv.h"
+
+TEST_CASE_SELF(base64_codec)
+{
+    static const struct {
+        const char *raw;
+        const char *pad;
+        const char *nopad;
+    } vec[] = {
+        /* RFC 4648 test vectors. */
+        { "",       "",         "" },
+        { "f",      "Zg==",     "Zg" },
+        { "fo",     "Zm8=",     "Zm8" },
+        { "foo",    "Zm9v",     "Zm9v" },
+        { "foob",   "Zm9vYg==", "Zm9vYg" },
+        { "fooba",  "Zm9vYmE=", "Zm9vYmE" },
+        { "foobar", "Zm9vYmFy", "Zm9vYmFy" },
+    };
+    uint8_t raw[64];
+    uint8_t out[64];
+    char enc[BASE64_ENCODE_SIZE(64) + 1];
+    int len;
+    int rc;
+    int i;
+
+    for (i = 0; i < sizeof(vec) / sizeof(vec[0]); i++) {
+        len = strlen(vec[i].raw);
+
+        rc = base64_encode(vec[i].raw, len, enc, 1);
+        TEST_ASSERT(rc == strlen(vec[i].pad));
+        TEST_ASSERT(!strcmp(enc, vec[i].pad));
+
+        rc = base64_encode(vec[i].raw, len, enc, 0);
+        TEST_ASSERT(rc == strlen(vec[i].nopad));
+        TEST_ASSERT(!strcmp(enc, vec[i].nopad));
+
+        rc = base64_decode(vec[i].pad, out);
+        TEST_ASSERT(rc == len);
+        TEST_ASSERT(!memcmp(out, vec[i].raw, len));
+    }
+
+    /* Every byte value, at every length. */
+    for (i = 0; i < sizeof(raw); i++) {
+        raw[i] = i * 53 + 7;
+    }
+    for (len = 0; len <= sizeof(raw); len++) {
+        base64_encode(raw, len, enc, 1);
+        rc = base64_decode(enc, out);
+        TEST_ASSERT(rc == len);
+        TEST_ASSERT(!memcmp(out, raw, len));
+    }
+
+    /* Decoding stops at the first character outside the alphabet. */
+    rc = base64_decode("Zm9v\r\n", out);
+    TEST_ASSERT(rc == 3);
+
+    /* Padded groups may be concatenated. */
+    rc = base64_decode("Zg==Zm8=", out);
+    TEST_ASSERT(rc == 3);
+    TEST_ASSERT(!memcmp(out, "ffo", 3));
+
+    /* In place, as done by the shell transport. */
+    strcpy(enc, "Zm9vYmFy");
+    rc = base64_decode(enc, enc);
+    TEST_ASSERT(rc == 6);
+    TEST_ASSERT(!memcmp(enc, "foobar", 6));
+
+    /* Invalid input. */
+    TEST_ASSERT(base64_decode("Zm9", out) < 0);
+    TEST_ASSERT(base64_decode("Z===", out) < 0);
+    TEST_ASSERT(base64_decode("====", out) < 0);
+    TEST_ASSERT(base64_decode("Zm=v", out) < 0);
+    TEST_ASSERT(base64_decode("Zm9vZm*v", out) < 0);
+}
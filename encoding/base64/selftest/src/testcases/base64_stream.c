@@ -0,0 +1,107 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "base64/base64.h"
+#include "encoding_test_priv.h"
+
+/* Small blocks, so decoded data straddles several mbufs. */
+#define BASE64_TEST_MBUF_BUF_SIZE   \
+    (sizeof(struct os_mbuf) + sizeof(struct os_mbuf_pkthdr) + 10)
+#define BASE64_TEST_MBUF_CNT        64
+
+static os_membuf_t base64_test_mbuf_buf[
+    OS_MEMPOOL_SIZE(BASE64_TEST_MBUF_CNT, BASE64_TEST_MBUF_BUF_SIZE)];
+static struct os_mbuf_pool base64_test_mbuf_pool;
+static struct os_mempool base64_test_mbuf_mempool;
+
+TEST_CASE_SELF(base64_stream)
+{
+    struct base64_decoder bd;
+    struct os_mbuf *om;
+    uint8_t raw[120];
+    uint8_t out[120];
+    char enc[BASE64_ENCODE_SIZE(120) + 1];
+    int enc_len;
+    int chunk;
+    int off;
+    int len;
+    int rc;
+    int i;
+
+    rc = os_mempool_init(&base64_test_mbuf_mempool, BASE64_TEST_MBUF_CNT,
+                         BASE64_TEST_MBUF_BUF_SIZE, base64_test_mbuf_buf,
+                         "b64test");
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_mbuf_pool_init(&base64_test_mbuf_pool, &base64_test_mbuf_mempool,
+                           BASE64_TEST_MBUF_BUF_SIZE, BASE64_TEST_MBUF_CNT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < sizeof(raw); i++) {
+        raw[i] = i * 29 + 3;
+    }
+    enc_len = base64_encode(raw, sizeof(raw), enc, 1);
+
+    /* Feed the encoded text in pieces of every size. */
+    for (chunk = 1; chunk <= 9; chunk++) {
+        base64_decoder_init(&bd);
+        len = 0;
+        for (off = 0; off < enc_len; off += chunk) {
+            rc = base64_decoder_feed(&bd, enc + off,
+                                     min(chunk, enc_len - off),
+                                     out + len, sizeof(out) - len);
+            TEST_ASSERT_FATAL(rc >= 0);
+            len += rc;
+        }
+        TEST_ASSERT(base64_decoder_finish(&bd) == 0);
+        TEST_ASSERT(len == sizeof(raw));
+        TEST_ASSERT(!memcmp(out, raw, sizeof(raw)));
+
+        om = os_mbuf_get_pkthdr(&base64_test_mbuf_pool, 0);
+        TEST_ASSERT_FATAL(om != NULL);
+        base64_decoder_init(&bd);
+        for (off = 0; off < enc_len; off += chunk) {
+            rc = base64_decoder_feed_mbuf(&bd, enc + off,
+                                          min(chunk, enc_len - off), om);
+            TEST_ASSERT_FATAL(rc >= 0);
+        }
+        TEST_ASSERT(base64_decoder_finish(&bd) == 0);
+        TEST_ASSERT(OS_MBUF_PKTLEN(om) == sizeof(raw));
+        TEST_ASSERT(os_mbuf_cmpf(om, 0, raw, sizeof(raw)) == 0);
+        os_mbuf_free_chain(om);
+    }
+
+    /* A partial group is reported by finish(). */
+    base64_decoder_init(&bd);
+    rc = base64_decoder_feed(&bd, "Zm9vY", 5, out, sizeof(out));
+    TEST_ASSERT(rc == 3);
+    TEST_ASSERT(base64_decoder_finish(&bd) < 0);
+
+    /* Output buffer too small. */
+    base64_decoder_init(&bd);
+    rc = base64_decoder_feed(&bd, "Zm9vYmFy", 8, out, 5);
+    TEST_ASSERT(rc < 0);
+
+    /* Invalid character. */
+    base64_decoder_init(&bd);
+    rc = base64_decoder_feed(&bd, "Zm9v!", 5, out, sizeof(out));
+    TEST_ASSERT(rc < 0);
+
+    TEST_ASSERT(base64_test_mbuf_mempool.mp_num_free == BASE64_TEST_MBUF_CNT);
+}
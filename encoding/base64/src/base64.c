@@ -38,67 +38,87 @@
  * SUCH DAMAGE.
  */
 
+
 #include <stdlib.h>
 #include <string.h>
 
 #include <stdio.h>
 
+#include "os/os_mbuf.h"
 #include <base64/base64.h>
 
 static const char base64_chars[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-static int
-pos(char c)
-{
-    const char *p;
-    for (p = base64_chars; *p; p++)
-        if (*p == c)
-            return p - base64_chars;
-    return -1;
-}
+/*
+ * Reverse of base64_chars: the 6-bit value of each input character,
+ * BASE64_DEC_PAD for '=' and BASE64_DEC_INV for anything else.  Both markers
+ * have the top two bits set, so a group of characters can be checked for
+ * validity with a single OR.
+ */
+#define BASE64_DEC_PAD  0xfe
+#define BASE64_DEC_INV  0xff
+
+static const uint8_t base64_dec_tab[256] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x3e, 0xff, 0xff, 0xff, 0x3f,
+    0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0xff, 0xff,
+    0xff, 0xfe, 0xff, 0xff, 0xff, 0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06,
+    0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10, 0x11, 0x12,
+    0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f, 0x20, 0x21, 0x22, 0x23, 0x24,
+    0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f, 0x30,
+    0x31, 0x32, 0x33, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff
+};
 
 int
 base64_encode(const void *data, int size, char *s, uint8_t should_pad)
 {
+    const unsigned char *q;
+    uint32_t c;
     char *p;
     int i;
-    int c;
-    const unsigned char *q;
-    char *last;
-    int diff;
 
     p = s;
-
     q = (const unsigned char *) data;
-    last = NULL;
-    i = 0;
-    while (i < size) {
-        c = q[i++];
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        c *= 256;
-        if (i < size)
-            c += q[i];
-        i++;
-        p[0] = base64_chars[(c & 0x00fc0000) >> 18];
-        p[1] = base64_chars[(c & 0x0003f000) >> 12];
-        p[2] = base64_chars[(c & 0x00000fc0) >> 6];
-        p[3] = base64_chars[(c & 0x0000003f) >> 0];
-        last = p;
+
+    for (i = 0; size - i >= 3; i += 3) {
+        c = (q[i] << 16) | (q[i + 1] << 8) | q[i + 2];
+        p[0] = base64_chars[(c >> 18) & 0x3f];
+        p[1] = base64_chars[(c >> 12) & 0x3f];
+        p[2] = base64_chars[(c >> 6) & 0x3f];
+        p[3] = base64_chars[c & 0x3f];
         p += 4;
     }
 
-    if (last) {
-        diff = i - size;
-        if (diff > 0) {
-            if (should_pad) {
-                memset(last + (4 - diff), '=', diff);
-            } else {
-                p = last + (4 - diff);
-            }
+    if (i < size) {
+        c = q[i] << 16;
+        if (size - i == 2) {
+            c |= q[i + 1] << 8;
+        }
+        p[0] = base64_chars[(c >> 18) & 0x3f];
+        p[1] = base64_chars[(c >> 12) & 0x3f];
+        p += 2;
+        if (size - i == 2) {
+            *p++ = base64_chars[(c >> 6) & 0x3f];
+        } else if (should_pad) {
+            *p++ = '=';
+        }
+        if (should_pad) {
+            *p++ = '=';
         }
     }
 
@@ -122,49 +142,200 @@ base64_pad(char *buf, int len)
     return (4 - remainder);
 }
 
-#define DECODE_ERROR -1
+void
+base64_decoder_init(struct base64_decoder *bd)
+{
+    memset(bd, 0, sizeof(*bd));
+}
 
-static unsigned int
-token_decode(const char *token)
+/*
+ * Decodes characters from src into dst until either all of src has been
+ * consumed or completing the next group of four would overflow dst.
+ *
+ * @param bd            Decoder state; carries a partial group between calls.
+ * @param src           Characters to decode.
+ * @param src_len       On entry, the number of characters in src; on return,
+ *                          the number consumed.
+ * @param dst           Where to write decoded bytes.
+ * @param dst_len       Space available at dst.
+ *
+ * @return              Number of bytes written to dst; -1 on invalid input.
+ */
+static int
+base64_decoder_run(struct base64_decoder *bd, const char *src, int *src_len,
+                   uint8_t *dst, int dst_len)
 {
+    const uint8_t *s;
+    uint32_t v;
+    int need;
+    int len;
+    int out;
     int i;
-    unsigned int val = 0;
-    int marker = 0;
-    if (strlen(token) < 4)
-        return DECODE_ERROR;
-    for (i = 0; i < 4; i++) {
-        val *= 64;
-        if (token[i] == '=')
-            marker++;
-        else if (marker > 0)
-            return DECODE_ERROR;
-        else
-            val += pos(token[i]);
+
+    s = (const uint8_t *)src;
+    len = *src_len;
+    out = 0;
+    i = 0;
+
+    while (i < len) {
+        /* Fast path: whole groups with no padding. */
+        while (bd->bd_cnt == 0 && len - i >= 4 && dst_len - out >= 3) {
+            v = base64_dec_tab[s[i]] | base64_dec_tab[s[i + 1]] |
+                base64_dec_tab[s[i + 2]] | base64_dec_tab[s[i + 3]];
+            if (v & 0xc0) {
+                break;
+            }
+            v = (base64_dec_tab[s[i]] << 18) |
+                (base64_dec_tab[s[i + 1]] << 12) |
+                (base64_dec_tab[s[i + 2]] << 6) |
+                base64_dec_tab[s[i + 3]];
+            dst[out++] = v >> 16;
+            dst[out++] = v >> 8;
+            dst[out++] = v;
+            i += 4;
+        }
+        if (i >= len) {
+            break;
+        }
+
+        v = base64_dec_tab[s[i]];
+        if (v == BASE64_DEC_INV) {
+            return -1;
+        }
+        if (v == BASE64_DEC_PAD) {
+            /* '=' may only fill the last one or two places of a group. */
+            if (bd->bd_cnt < 2) {
+                return -1;
+            }
+        } else if (bd->bd_pad) {
+            return -1;
+        }
+
+        if (bd->bd_cnt == 3) {
+            need = 3 - bd->bd_pad - (v == BASE64_DEC_PAD);
+            if (dst_len - out < need) {
+                break;
+            }
+            v = (bd->bd_acc << 6) | (v == BASE64_DEC_PAD ? 0 : v);
+            dst[out++] = v >> 16;
+            if (need > 1) {
+                dst[out++] = v >> 8;
+            }
+            if (need > 2) {
+                dst[out++] = v;
+            }
+            base64_decoder_init(bd);
+        } else {
+            if (v == BASE64_DEC_PAD) {
+                bd->bd_pad++;
+                v = 0;
+            }
+            bd->bd_acc = (bd->bd_acc << 6) | v;
+            bd->bd_cnt++;
+        }
+        i++;
     }
-    if (marker > 2)
-        return DECODE_ERROR;
-    return (marker << 24) | val;
+
+    *src_len = i;
+    return out;
+}
+
+int
+base64_decoder_feed(struct base64_decoder *bd, const char *src, int len,
+                    void *dst, int dst_len)
+{
+    int consumed;
+    int rc;
+
+    consumed = len;
+    rc = base64_decoder_run(bd, src, &consumed, dst, dst_len);
+    if (rc >= 0 && consumed != len) {
+        return -1;
+    }
+    return rc;
+}
+
+int
+base64_decoder_feed_mbuf(struct base64_decoder *bd, const char *src, int len,
+                         struct os_mbuf *om)
+{
+    struct os_mbuf *last;
+    uint8_t tmp[3];
+    int consumed;
+    int space;
+    int total;
+    int rc;
+
+    last = om;
+    while (SLIST_NEXT(last, om_next) != NULL) {
+        last = SLIST_NEXT(last, om_next);
+    }
+
+    total = 0;
+    while (len > 0) {
+        consumed = len;
+        space = OS_MBUF_TRAILINGSPACE(last);
+        if (space >= 3) {
+            /* Decode straight into the tail of the chain. */
+            rc = base64_decoder_run(bd, src, &consumed,
+                                    last->om_data + last->om_len, space);
+            if (rc < 0) {
+                return -1;
+            }
+            last->om_len += rc;
+            if (OS_MBUF_IS_PKTHDR(om)) {
+                OS_MBUF_PKTHDR(om)->omp_len += rc;
+            }
+        } else {
+            /*
+             * Not enough room for a whole group; let os_mbuf_append() split
+             * it across the tail and a freshly allocated buffer.
+             */
+            rc = base64_decoder_run(bd, src, &consumed, tmp, sizeof(tmp));
+            if (rc < 0) {
+                return -1;
+            }
+            if (rc > 0) {
+                if (os_mbuf_append(om, tmp, rc) != 0) {
+                    return -1;
+                }
+                while (SLIST_NEXT(last, om_next) != NULL) {
+                    last = SLIST_NEXT(last, om_next);
+                }
+            }
+        }
+        src += consumed;
+        len -= consumed;
+        total += rc;
+    }
+
+    return total;
+}
+
+int
+base64_decoder_finish(struct base64_decoder *bd)
+{
+    if (bd->bd_cnt != 0) {
+        return -1;
+    }
+    return 0;
 }
 
 int
 base64_decode(const char *str, void *data)
 {
-    const char *p;
-    unsigned char *q;
-
-    q = data;
-    for (p = str; *p && (*p == '=' || strchr(base64_chars, *p)); p += 4) {
-        unsigned int val = token_decode(p);
-        unsigned int marker = (val >> 24) & 0xff;
-        if (val == DECODE_ERROR)
-            return -1;
-        *q++ = (val >> 16) & 0xff;
-        if (marker < 2)
-            *q++ = (val >> 8) & 0xff;
-        if (marker < 1)
-            *q++ = val & 0xff;
+    struct base64_decoder bd;
+    int len;
+
+    /* Decode up to the first character which is not part of the alphabet. */
+    for (len = 0; base64_dec_tab[(uint8_t)str[len]] != BASE64_DEC_INV; len++);
+
+    if (len % 4 != 0) {
+        return -1;
     }
-    return q - (unsigned char *) data;
+
+    base64_decoder_init(&bd);
+    return base64_decoder_feed(&bd, str, len, data, len / 4 * 3);
 }
 
 
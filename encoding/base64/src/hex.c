@@ -18,13 +18,33 @@
  */
 
 #include <inttypes.h>
-#include <ctype.h>
 #include <stddef.h>
 
 #include "base64/hex.h"
 
 static const char hex_bytes[] = "0123456789abcdef";
 
+/*
+ * Value of a single hex digit, or -1.  Setting bit 5 folds 'A'-'F' onto
+ * 'a'-'f' and leaves digits unchanged, so two unsigned range checks cover
+ * every valid character.
+ */
+static inline int
+hex_nibble(char c)
+{
+    unsigned int v;
+
+    v = (uint8_t)c - '0';
+    if (v < 10) {
+        return v;
+    }
+    v = ((uint8_t)c | 0x20) - 'a';
+    if (v < 6) {
+        return v + 10;
+    }
+    return -1;
+}
+
 /*
  * Turn byte array into a printable array. I.e. "\x01" -> "01"
  *
@@ -70,7 +90,7 @@ hex_parse(const char *src, int src_len, void *dst_v, int dst_len)
 {
     int i;
     uint8_t *dst = (uint8_t *)dst_v;
-    char c;
+    int hi, lo;
 
     if (src_len & 0x1) {
         return -1;
@@ -78,24 +98,13 @@ hex_parse(const char *src, int src_len, void *dst_v, int dst_len)
     if (dst_len * 2 < src_len) {
         return -1;
     }
-    for (i = 0; i < src_len; i++, src++) {
-        c = *src;
-        if (isdigit((int) c)) {
-            c -= '0';
-        } else if (c >= 'a' && c <= 'f') {
-            c -= ('a' - 10);
-        } else if (c >= 'A' && c <= 'F') {
-            c -= ('A' - 10);
-        } else {
+    for (i = 0; i < src_len; i += 2) {
+        hi = hex_nibble(src[i]);
+        lo = hex_nibble(src[i + 1]);
+        if ((hi | lo) < 0) {
             return -1;
         }
-        if (i & 1) {
-            *dst |= c;
-            dst++;
-            dst_len--;
-        } else {
-            *dst = c << 4;
-        }
+        *dst++ = (hi << 4) | lo;
     }
     return src_len >> 1;
 }
@@ -88,8 +88,23 @@ struct json_encoder {
 };
 
 
+/*
+ * Output buffer for an encoder set up with json_encoder_buf_init().  Output
+ * that does not fit is dropped, but jeb_off keeps counting, so the encoding
+ * was complete if jeb_off <= jeb_len once done.
+ */
+struct json_encoder_buf {
+    char *jeb_buf;
+    int jeb_len;
+    int jeb_off;
+};
+
 #define JSON_NITEMS(x) (int)(sizeof(x)/sizeof(x[0]))
 
+void json_encoder_buf_init(struct json_encoder *encoder,
+        struct json_encoder_buf *jeb, char *buf, int len);
+int json_encoder_buf_write(void *buf, char *data, int len);
+
 int json_encode_object_start(struct json_encoder *);
 int json_encode_object_key(struct json_encoder *encoder, char *key);
 int json_encode_object_entry(struct json_encoder *, char *,
@@ -200,6 +215,68 @@ struct json_buffer {
 int json_read_object(struct json_buffer *, const struct json_attr_t *);
 int json_read_array(struct json_buffer *, const struct json_array_t *);
 
+/*
+ * Streaming pull tokenizer.  Input is supplied in chunks of any size (e.g.
+ * one mbuf at a time) with json_tokenizer_feed(); json_tokenizer_next() then
+ * returns one token at a time until the chunk is exhausted.  All state lives
+ * in struct json_tokenizer, so nothing is allocated and the document never
+ * needs to be flat in memory.
+ *
+ * Key, string and number text is returned in jt_buf (NUL-terminated, escapes
+ * decoded).  Strings longer than JSON_TOK_MAX are returned in several pieces
+ * of the same token type; jt_more is set on every piece but the last.
+ * \uXXXX escapes are decoded to UTF-8; surrogate pairs are not combined.
+ *
+ * json_tokenizer_next() returns a JSON_TOK_* value, JSON_TOK_NEED_MORE when
+ * the current chunk is used up, or a negative JSON_ERR_* value.  Once all
+ * input has been fed, call json_tokenizer_finish(); the next calls then
+ * return any last token followed by JSON_TOK_END, or -JSON_ERR_EOF if the
+ * document was incomplete.
+ */
+#define JSON_TOK_MAX        64        /* max chars returned per token piece */
+#define JSON_TOK_MAX_DEPTH  32        /* max nesting of objects and arrays */
+
+#define JSON_TOK_NEED_MORE      0     /* chunk consumed; feed more input */
+#define JSON_TOK_OBJECT_START   1
+#define JSON_TOK_OBJECT_END     2
+#define JSON_TOK_ARRAY_START    3
+#define JSON_TOK_ARRAY_END      4
+#define JSON_TOK_KEY            5
+#define JSON_TOK_STRING         6
+#define JSON_TOK_NUMBER         7
+#define JSON_TOK_TRUE           8
+#define JSON_TOK_FALSE          9
+#define JSON_TOK_NULL           10
+#define JSON_TOK_END            11    /* end of input after a full document */
+
+struct json_tokenizer {
+    /* Current token text. */
+    char jt_buf[JSON_TOK_MAX + 1];
+    uint16_t jt_len;
+    uint8_t jt_more:1;
+
+    /* Parser state; private. */
+    uint8_t jt_state;
+    uint8_t jt_flags;
+    uint8_t jt_depth;
+    uint8_t jt_lit;
+    uint8_t jt_lit_idx;
+    uint8_t jt_esc_cnt;
+    uint16_t jt_esc_val;
+    uint32_t jt_nest;
+    int jt_err;
+
+    /* Current input chunk. */
+    const char *jt_in;
+    int jt_in_len;
+};
+
+void json_tokenizer_init(struct json_tokenizer *jt);
+void json_tokenizer_feed(struct json_tokenizer *jt, const char *data,
+        int len);
+void json_tokenizer_finish(struct json_tokenizer *jt);
+int json_tokenizer_next(struct json_tokenizer *jt);
+
 #define JSON_ERR_OBSTART     1   /* non-WS when expecting object start */
 #define JSON_ERR_ATTRSTART   2   /* non-WS when expecting attrib start */
 #define JSON_ERR_BADATTR     3   /* unknown attribute name */
@@ -223,6 +300,9 @@ int json_read_array(struct json_buffer *, const struct json_array_t *);
 #define JSON_ERR_MISC        20  /* other data conversion error */
 #define JSON_ERR_BADNUM      21  /* error while parsing a numerical argument */
 #define JSON_ERR_NULLPTR     22  /* unexpected null value or attribute pointer */
+#define JSON_ERR_SYNTAX      23  /* unexpected character */
+#define JSON_ERR_DEPTH       24  /* objects and arrays nested too deeply */
+#define JSON_ERR_EOF         25  /* input ended in the middle of a document */
 
 /*
  * Use the following macros to declare template initializers for structobject
@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_json_priv.h"
+
+static void
+test_buf_encode_doc(struct json_encoder *encoder)
+{
+    struct json_value value;
+
+    json_encode_object_start(encoder);
+    JSON_VALUE_BOOL(&value, 1);
+    json_encode_object_entry(encoder, "KeyBool", &value);
+    JSON_VALUE_INT(&value, -1234);
+    json_encode_object_entry(encoder, "KeyInt", &value);
+    JSON_VALUE_UINT(&value, 1353214);
+    json_encode_object_entry(encoder, "KeyUint", &value);
+    JSON_VALUE_STRING(&value, "foobar");
+    json_encode_object_entry(encoder, "KeyString", &value);
+    JSON_VALUE_STRINGN(&value, "foobarlongstring", 10);
+    json_encode_object_entry(encoder, "KeyStringN", &value);
+    json_encode_array_name(encoder, "KeyIntArr");
+    json_encode_array_start(encoder);
+    JSON_VALUE_INT(&value, 153);
+    json_encode_array_value(encoder, &value);
+    JSON_VALUE_INT(&value, 2532);
+    json_encode_array_value(encoder, &value);
+    JSON_VALUE_INT(&value, -322);
+    json_encode_array_value(encoder, &value);
+    json_encode_array_finish(encoder);
+    json_encode_object_finish(encoder);
+}
+
+TEST_CASE_SELF(test_json_buf_encode)
+{
+    struct json_encoder encoder;
+    struct json_encoder_buf jeb;
+    struct json_value value;
+    char buf[192];
+    int len;
+
+    /* Same output as the callback encoder. */
+    memset(buf, 0xff, sizeof(buf));
+    json_encoder_buf_init(&encoder, &jeb, buf, sizeof(buf));
+    test_buf_encode_doc(&encoder);
+    len = strlen(output);
+    TEST_ASSERT_FATAL(jeb.jeb_off == len);
+    TEST_ASSERT(memcmp(buf, output, len) == 0);
+    TEST_ASSERT(buf[len] == (char)0xff);
+
+    /* Truncated output still reports the full length. */
+    memset(buf, 0xff, sizeof(buf));
+    json_encoder_buf_init(&encoder, &jeb, buf, 20);
+    test_buf_encode_doc(&encoder);
+    TEST_ASSERT(jeb.jeb_off == len);
+    TEST_ASSERT(memcmp(buf, output, 20) == 0);
+    TEST_ASSERT(buf[20] == (char)0xff);
+
+    /* Escapes and integer extremes. */
+    json_encoder_buf_init(&encoder, &jeb, buf, sizeof(buf));
+    json_encode_array_start(&encoder);
+    JSON_VALUE_STRING(&value, "a\"b/c\\d\te\r\n\f\b");
+    json_encode_array_value(&encoder, &value);
+    JSON_VALUE_INT(&value, INT64_MIN);
+    json_encode_array_value(&encoder, &value);
+    JSON_VALUE_UINT(&value, UINT64_MAX);
+    json_encode_array_value(&encoder, &value);
+    JSON_VALUE_INT(&value, 0);
+    json_encode_array_value(&encoder, &value);
+    json_encode_array_finish(&encoder);
+    buf[jeb.jeb_off] = '\0';
+    TEST_ASSERT(!strcmp(buf, "[\"a\\\"b\\/c\\\\d\\te\\r\\n\\f\\b\","
+                             "-9223372036854775808,"
+                             "18446744073709551615,0]"));
+}
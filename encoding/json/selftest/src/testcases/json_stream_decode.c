@@ -0,0 +1,157 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_json_priv.h"
+
+static const char *test_stream_doc =
+    " {\"name\": \"a\\\"b\\u00e9\\n\", \"n\": [0, -12, 3.5e+2, 1E3], "
+    "\"t\": true, \"f\" :false, \"z\": null, \"o\": {}, \"e\": [ ],"
+    " \"long\": \"0123456789012345678901234567890123456789"
+    "0123456789012345678901234567890123456789\"} ";
+
+struct test_stream_tok {
+    int tok;
+    const char *text;
+};
+
+/* A NULL text means the text is not checked. */
+static const struct test_stream_tok test_stream_toks[] = {
+    { JSON_TOK_OBJECT_START, NULL },
+    { JSON_TOK_KEY, "name" },
+    { JSON_TOK_STRING, "a\"b\xc3\xa9\n" },
+    { JSON_TOK_KEY, "n" },
+    { JSON_TOK_ARRAY_START, NULL },
+    { JSON_TOK_NUMBER, "0" },
+    { JSON_TOK_NUMBER, "-12" },
+    { JSON_TOK_NUMBER, "3.5e+2" },
+    { JSON_TOK_NUMBER, "1E3" },
+    { JSON_TOK_ARRAY_END, NULL },
+    { JSON_TOK_KEY, "t" },
+    { JSON_TOK_TRUE, NULL },
+    { JSON_TOK_KEY, "f" },
+    { JSON_TOK_FALSE, NULL },
+    { JSON_TOK_KEY, "z" },
+    { JSON_TOK_NULL, NULL },
+    { JSON_TOK_KEY, "o" },
+    { JSON_TOK_OBJECT_START, NULL },
+    { JSON_TOK_OBJECT_END, NULL },
+    { JSON_TOK_KEY, "e" },
+    { JSON_TOK_ARRAY_START, NULL },
+    { JSON_TOK_ARRAY_END, NULL },
+    { JSON_TOK_KEY, "long" },
+    { JSON_TOK_STRING, NULL },
+    { JSON_TOK_OBJECT_END, NULL },
+    { JSON_TOK_END, NULL },
+};
+
+/*
+ * Tokenizes str, feeding it chunk bytes at a time.  Pieces of long strings
+ * are joined into one token.  Returns the number of tokens, or a negative
+ * error.
+ */
+static int
+test_stream_run(const char *str, int chunk, int *toks, char texts[][96],
+                int max)
+{
+    struct json_tokenizer jt;
+    int len;
+    int off;
+    int cnt;
+    int n;
+    int rc;
+
+    json_tokenizer_init(&jt);
+    len = strlen(str);
+    off = 0;
+    cnt = 0;
+    texts[0][0] = '\0';
+    while (1) {
+        rc = json_tokenizer_next(&jt);
+        if (rc < 0) {
+            return rc;
+        }
+        if (rc == JSON_TOK_NEED_MORE) {
+            if (off == len) {
+                json_tokenizer_finish(&jt);
+            } else {
+                n = len - off < chunk ? len - off : chunk;
+                json_tokenizer_feed(&jt, str + off, n);
+                off += n;
+            }
+            continue;
+        }
+
+        TEST_ASSERT_FATAL(cnt < max);
+        TEST_ASSERT(jt.jt_len <= JSON_TOK_MAX);
+        TEST_ASSERT(strlen(texts[cnt]) + jt.jt_len < 96);
+        strcat(texts[cnt], jt.jt_buf);
+        if (jt.jt_more) {
+            continue;
+        }
+        toks[cnt++] = rc;
+        if (rc == JSON_TOK_END) {
+            return cnt;
+        }
+        texts[cnt][0] = '\0';
+    }
+}
+
+TEST_CASE_SELF(test_json_stream_decode)
+{
+    char texts[32][96];
+    int toks[32];
+    int chunk;
+    int cnt;
+    int i;
+
+    for (chunk = 1; chunk <= 17; chunk++) {
+        cnt = test_stream_run(test_stream_doc, chunk, toks, texts, 32);
+        TEST_ASSERT_FATAL(cnt == JSON_NITEMS(test_stream_toks));
+        for (i = 0; i < cnt; i++) {
+            TEST_ASSERT(toks[i] == test_stream_toks[i].tok);
+            if (test_stream_toks[i].text != NULL) {
+                TEST_ASSERT(!strcmp(texts[i], test_stream_toks[i].text));
+            }
+        }
+        TEST_ASSERT(strlen(texts[23]) == 80);
+    }
+
+    /* A bare number is only complete at the end of input. */
+    cnt = test_stream_run("42", 1, toks, texts, 32);
+    TEST_ASSERT(cnt == 2 && toks[0] == JSON_TOK_NUMBER);
+    TEST_ASSERT(!strcmp(texts[0], "42"));
+
+    TEST_ASSERT(test_stream_run("{\"a\": 1", 4, toks, texts, 32) ==
+                -JSON_ERR_EOF);
+    TEST_ASSERT(test_stream_run("[1,]", 4, toks, texts, 32) ==
+                -JSON_ERR_SYNTAX);
+    TEST_ASSERT(test_stream_run("[1 2]", 4, toks, texts, 32) ==
+                -JSON_ERR_BADTRAIL);
+    TEST_ASSERT(test_stream_run("{\"a\" 1}", 4, toks, texts, 32) ==
+                -JSON_ERR_SYNTAX);
+    TEST_ASSERT(test_stream_run("[01]", 4, toks, texts, 32) ==
+                -JSON_ERR_BADNUM);
+    TEST_ASSERT(test_stream_run("[tru]", 4, toks, texts, 32) ==
+                -JSON_ERR_SYNTAX);
+    TEST_ASSERT(test_stream_run("\"\\x\"", 4, toks, texts, 32) ==
+                -JSON_ERR_BADSTRING);
+    TEST_ASSERT(test_stream_run("{} {}", 4, toks, texts, 32) ==
+                -JSON_ERR_BADTRAIL);
+    TEST_ASSERT(test_stream_run("[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[", 4, toks,
+                                texts, 32) == -JSON_ERR_DEPTH);
+}
@@ -17,29 +17,161 @@
  * under the License.
  */
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <json/json.h>
 
 #define JSON_ENCODE_OBJECT_START(__e) \
-    (__e)->je_write((__e)->je_arg, "{", sizeof("{")-1);
+    json_encode_write((__e), "{", sizeof("{")-1);
 
 #define JSON_ENCODE_OBJECT_END(__e) \
-    (__e)->je_write((__e)->je_arg, "}", sizeof("}")-1);
+    json_encode_write((__e), "}", sizeof("}")-1);
 
 #define JSON_ENCODE_ARRAY_START(__e) \
-    (__e)->je_write((__e)->je_arg, "[", sizeof("[")-1);
+    json_encode_write((__e), "[", sizeof("[")-1);
 
 #define JSON_ENCODE_ARRAY_END(__e) \
-    (__e)->je_write((__e)->je_arg, "]", sizeof("]")-1);
+    json_encode_write((__e), "]", sizeof("]")-1);
 
 
+static inline void
+json_encoder_buf_copy(struct json_encoder_buf *jeb, const char *data, int len)
+{
+    int n;
+
+    n = jeb->jeb_len - jeb->jeb_off;
+    if (n > len) {
+        n = len;
+    }
+    if (n > 0) {
+        memcpy(jeb->jeb_buf + jeb->jeb_off, data, n);
+    }
+    jeb->jeb_off += len;
+}
+
+/**
+ * Writes to an encoder.  Output of encoders set up with
+ * json_encoder_buf_init() is copied straight into the buffer, without a
+ * call through je_write.
+ */
+static void
+json_encode_write(struct json_encoder *encoder, const char *data, int len)
+{
+    if (encoder->je_write == json_encoder_buf_write) {
+        json_encoder_buf_copy(encoder->je_arg, data, len);
+    } else {
+        encoder->je_write(encoder->je_arg, (char *)data, len);
+    }
+}
+
+/**
+ * Writes a decimal integer without going through printf.
+ */
+static void
+json_encode_u64(struct json_encoder *encoder, uint64_t val, int neg)
+{
+    char *end;
+    char *p;
+
+    end = encoder->je_encode_buf + sizeof(encoder->je_encode_buf);
+    p = end;
+    do {
+        *--p = '0' + val % 10;
+        val /= 10;
+    } while (val != 0);
+    if (neg) {
+        *--p = '-';
+    }
+    json_encode_write(encoder, p, end - p);
+}
+
+/**
+ * Writes string contents, escaping as needed.  Runs of characters that need
+ * no escaping are written with a single call.
+ */
+static void
+json_encode_string(struct json_encoder *encoder, const char *str, int len)
+{
+    char buf[2];
+    int run;
+    int i;
+
+    run = 0;
+    for (i = 0; i < len; i++) {
+        switch (str[i]) {
+            case '"':
+            case '/':
+            case '\\':
+                buf[1] = str[i];
+                break;
+            case '\t':
+                buf[1] = 't';
+                break;
+            case '\r':
+                buf[1] = 'r';
+                break;
+            case '\n':
+                buf[1] = 'n';
+                break;
+            case '\f':
+                buf[1] = 'f';
+                break;
+            case '\b':
+                buf[1] = 'b';
+                break;
+            default:
+                continue;
+        }
+        if (i > run) {
+            json_encode_write(encoder, str + run, i - run);
+        }
+        buf[0] = '\\';
+        json_encode_write(encoder, buf, 2);
+        run = i + 1;
+    }
+    if (len > run) {
+        json_encode_write(encoder, str + run, len - run);
+    }
+}
+
+/**
+ * Sets up an encoder that writes into a caller-supplied buffer.
+ *
+ * @param encoder               The encoder to set up.
+ * @param jeb                   Tracks the buffer; must outlive the encoder.
+ * @param buf                   The buffer to write into.
+ * @param len                   The size of the buffer.
+ */
+void
+json_encoder_buf_init(struct json_encoder *encoder,
+        struct json_encoder_buf *jeb, char *buf, int len)
+{
+    memset(encoder, 0, sizeof(*encoder));
+    jeb->jeb_buf = buf;
+    jeb->jeb_len = len;
+    jeb->jeb_off = 0;
+    encoder->je_write = json_encoder_buf_write;
+    encoder->je_arg = jeb;
+}
+
+/**
+ * Write callback for struct json_encoder_buf.  The encoder itself does not
+ * call it; it copies into the buffer inline.
+ */
+int
+json_encoder_buf_write(void *buf, char *data, int len)
+{
+    json_encoder_buf_copy(buf, data, len);
+    return len;
+}
+
 int
 json_encode_object_start(struct json_encoder *encoder)
 {
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_encode_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
     JSON_ENCODE_OBJECT_START(encoder);
@@ -53,65 +185,29 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
 {
     int rc;
     int i;
-    int len;
 
     switch (jv->jv_type) {
         case JSON_VALUE_TYPE_BOOL:
-            len = sprintf(encoder->je_encode_buf, "%s",
-                    jv->jv_val.u > 0 ? "true" : "false");
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            if (jv->jv_val.u > 0) {
+                json_encode_write(encoder, "true", sizeof("true")-1);
+            } else {
+                json_encode_write(encoder, "false", sizeof("false")-1);
+            }
             break;
         case JSON_VALUE_TYPE_UINT64:
-            len = sprintf(encoder->je_encode_buf, "%llu",
-                    jv->jv_val.u);
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            json_encode_u64(encoder, jv->jv_val.u, 0);
             break;
         case JSON_VALUE_TYPE_INT64:
-            len = sprintf(encoder->je_encode_buf, "%lld",
-                    jv->jv_val.u);
-            encoder->je_write(encoder->je_arg, encoder->je_encode_buf, len);
+            if ((int64_t)jv->jv_val.u < 0) {
+                json_encode_u64(encoder, -jv->jv_val.u, 1);
+            } else {
+                json_encode_u64(encoder, jv->jv_val.u, 0);
+            }
             break;
         case JSON_VALUE_TYPE_STRING:
-            encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-            for (i = 0; i < jv->jv_len; i++) {
-                switch (jv->jv_val.str[i]) {
-                    case '"':
-                    case '/':
-                    case '\\':
-                        encoder->je_write(encoder->je_arg, "\\",
-                                sizeof("\\")-1);
-                        encoder->je_write(encoder->je_arg,
-                                (char *) &jv->jv_val.str[i], 1);
-
-                        break;
-                    case '\t':
-                        encoder->je_write(encoder->je_arg, "\\t",
-                                sizeof("\\t")-1);
-                        break;
-                    case '\r':
-                        encoder->je_write(encoder->je_arg, "\\r",
-                                sizeof("\\r")-1);
-                        break;
-                    case '\n':
-                        encoder->je_write(encoder->je_arg, "\\n",
-                                sizeof("\\n")-1);
-                        break;
-                    case '\f':
-                        encoder->je_write(encoder->je_arg, "\\f",
-                                sizeof("\\f")-1);
-                        break;
-                    case '\b':
-                        encoder->je_write(encoder->je_arg, "\\b",
-                                sizeof("\\b")-1);
-                        break;
-                   default:
-                        encoder->je_write(encoder->je_arg,
-                                (char *) &jv->jv_val.str[i], 1);
-                        break;
-                }
-
-            }
-            encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
+            json_encode_write(encoder, "\"", sizeof("\"")-1);
+            json_encode_string(encoder, jv->jv_val.str, jv->jv_len);
+            json_encode_write(encoder, "\"", sizeof("\"")-1);
             break;
         case JSON_VALUE_TYPE_ARRAY:
             JSON_ENCODE_ARRAY_START(encoder);
@@ -121,7 +217,7 @@ json_encode_value(struct json_encoder *encoder, struct json_value *jv)
                     goto err;
                 }
                 if (i != jv->jv_len - 1) {
-                    encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+                    json_encode_write(encoder, ",", sizeof(",")-1);
                 }
             }
             JSON_ENCODE_ARRAY_END(encoder);
@@ -153,14 +249,14 @@ int
 json_encode_object_key(struct json_encoder *encoder, char *key)
 {
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_encode_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
 
     /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_encode_write(encoder, "\"", sizeof("\"")-1);
+    json_encode_write(encoder, key, strlen(key));
+    json_encode_write(encoder, "\": ", sizeof("\": ")-1);
 
     return (0);
 }
@@ -172,13 +268,13 @@ json_encode_object_entry(struct json_encoder *encoder, char *key,
     int rc;
 
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_encode_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
     /* Write the key entry */
-    encoder->je_write(encoder->je_arg, "\"", sizeof("\"")-1);
-    encoder->je_write(encoder->je_arg, key, strlen(key));
-    encoder->je_write(encoder->je_arg, "\": ", sizeof("\": ")-1);
+    json_encode_write(encoder, "\"", sizeof("\"")-1);
+    json_encode_write(encoder, key, strlen(key));
+    json_encode_write(encoder, "\": ", sizeof("\": ")-1);
 
     rc = json_encode_value(encoder, val);
     if (rc != 0) {
@@ -222,7 +318,7 @@ json_encode_array_value(struct json_encoder *encoder, struct json_value *jv)
     int rc;
 
     if (encoder->je_wr_commas) {
-        encoder->je_write(encoder->je_arg, ",", sizeof(",")-1);
+        json_encode_write(encoder, ",", sizeof(",")-1);
         encoder->je_wr_commas = 0;
     }
 
@@ -0,0 +1,487 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include <json/json.h>
+
+/* Tokenizer states. */
+#define JT_VALUE        0   /* expecting a value */
+#define JT_KEY          1   /* expecting a key */
+#define JT_COLON        2   /* expecting ':' */
+#define JT_AFTER        3   /* expecting ',' or the end of a container */
+#define JT_STRING       4   /* inside a key or string */
+#define JT_ESC          5   /* after '\' in a string */
+#define JT_UESC         6   /* inside \uXXXX */
+#define JT_NUMBER       7   /* inside a number */
+#define JT_LITERAL      8   /* inside true, false or null */
+#define JT_DONE         9   /* top-level value complete */
+
+/* Returned by the character handlers when no token is complete yet. */
+#define JT_CONTINUE     0
+
+#define JT_F_KEY        0x01    /* string being read is a key */
+#define JT_F_EMPTY      0x02    /* container just opened; may close */
+#define JT_F_EOF        0x04    /* no more input */
+#define JT_F_EMITTED    0x08    /* jt_buf holds a returned token */
+
+static const char * const json_tok_literals[] = {
+    [JSON_TOK_TRUE] = "true",
+    [JSON_TOK_FALSE] = "false",
+    [JSON_TOK_NULL] = "null",
+};
+
+static int
+json_tok_is_ws(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static int
+json_tok_in_object(const struct json_tokenizer *jt)
+{
+    return (jt->jt_nest >> (jt->jt_depth - 1)) & 1;
+}
+
+static int
+json_tok_err(struct json_tokenizer *jt, int err)
+{
+    jt->jt_err = err;
+    return -err;
+}
+
+static int
+json_tok_emit(struct json_tokenizer *jt, int tok)
+{
+    jt->jt_buf[jt->jt_len] = '\0';
+    jt->jt_flags |= JT_F_EMITTED;
+    return tok;
+}
+
+static void
+json_tok_value_done(struct json_tokenizer *jt)
+{
+    jt->jt_state = jt->jt_depth == 0 ? JT_DONE : JT_AFTER;
+}
+
+static int
+json_tok_push(struct json_tokenizer *jt, int object)
+{
+    if (jt->jt_depth >= JSON_TOK_MAX_DEPTH) {
+        return json_tok_err(jt, JSON_ERR_DEPTH);
+    }
+    if (object) {
+        jt->jt_nest |= 1UL << jt->jt_depth;
+        jt->jt_state = JT_KEY;
+    } else {
+        jt->jt_nest &= ~(1UL << jt->jt_depth);
+        jt->jt_state = JT_VALUE;
+    }
+    jt->jt_depth++;
+    jt->jt_flags |= JT_F_EMPTY;
+
+    if (object) {
+        return json_tok_emit(jt, JSON_TOK_OBJECT_START);
+    }
+    return json_tok_emit(jt, JSON_TOK_ARRAY_START);
+}
+
+static int
+json_tok_pop(struct json_tokenizer *jt, int object)
+{
+    jt->jt_depth--;
+    jt->jt_flags &= ~JT_F_EMPTY;
+    json_tok_value_done(jt);
+
+    if (object) {
+        return json_tok_emit(jt, JSON_TOK_OBJECT_END);
+    }
+    return json_tok_emit(jt, JSON_TOK_ARRAY_END);
+}
+
+/*
+ * Checks number text against the JSON grammar:
+ * -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+ */
+static int
+json_tok_number_valid(const char *p)
+{
+    if (*p == '-') {
+        p++;
+    }
+    if (*p == '0') {
+        p++;
+    } else if (*p >= '1' && *p <= '9') {
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    } else {
+        return 0;
+    }
+    if (*p == '.') {
+        p++;
+        if (!(*p >= '0' && *p <= '9')) {
+            return 0;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    if (*p == 'e' || *p == 'E') {
+        p++;
+        if (*p == '+' || *p == '-') {
+            p++;
+        }
+        if (!(*p >= '0' && *p <= '9')) {
+            return 0;
+        }
+        while (*p >= '0' && *p <= '9') {
+            p++;
+        }
+    }
+    return *p == '\0';
+}
+
+static int
+json_tok_number_done(struct json_tokenizer *jt)
+{
+    jt->jt_buf[jt->jt_len] = '\0';
+    if (!json_tok_number_valid(jt->jt_buf)) {
+        return json_tok_err(jt, JSON_ERR_BADNUM);
+    }
+    json_tok_value_done(jt);
+
+    return json_tok_emit(jt, JSON_TOK_NUMBER);
+}
+
+static void
+json_tok_put_utf8(struct json_tokenizer *jt, uint16_t cp)
+{
+    char *p;
+
+    p = jt->jt_buf + jt->jt_len;
+    if (cp < 0x80) {
+        p[0] = cp;
+        jt->jt_len += 1;
+    } else if (cp < 0x800) {
+        p[0] = 0xc0 | (cp >> 6);
+        p[1] = 0x80 | (cp & 0x3f);
+        jt->jt_len += 2;
+    } else {
+        p[0] = 0xe0 | (cp >> 12);
+        p[1] = 0x80 | ((cp >> 6) & 0x3f);
+        p[2] = 0x80 | (cp & 0x3f);
+        jt->jt_len += 3;
+    }
+}
+
+static int
+json_tok_hex(char c)
+{
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    if (c >= 'a' && c <= 'f') {
+        return c - 'a' + 10;
+    }
+    if (c >= 'A' && c <= 'F') {
+        return c - 'A' + 10;
+    }
+    return -1;
+}
+
+/*
+ * Handles one character inside a string.  Returns JT_CONTINUE if the
+ * character was consumed, or a token / negative error to return to the
+ * caller.
+ */
+static int
+json_tok_string_char(struct json_tokenizer *jt, char c)
+{
+    static const char esc_in[] = "\"\\/bfnrt";
+    static const char esc_out[] = "\"\\/\b\f\n\r\t";
+    const char *e;
+    int tok;
+    int v;
+
+    tok = jt->jt_flags & JT_F_KEY ? JSON_TOK_KEY : JSON_TOK_STRING;
+
+    /* Leave room for the longest UTF-8 sequence an escape can produce. */
+    if (jt->jt_len + 3 > JSON_TOK_MAX &&
+        !(jt->jt_state == JT_STRING && c == '"')) {
+        jt->jt_more = 1;
+        return json_tok_emit(jt, tok);
+    }
+
+    switch (jt->jt_state) {
+    case JT_STRING:
+        if (c == '"') {
+            if (jt->jt_flags & JT_F_KEY) {
+                jt->jt_state = JT_COLON;
+            } else {
+                json_tok_value_done(jt);
+            }
+            jt->jt_in++;
+            jt->jt_in_len--;
+            return json_tok_emit(jt, tok);
+        }
+        if (c == '\\') {
+            jt->jt_state = JT_ESC;
+        } else if ((unsigned char)c < 0x20) {
+            return json_tok_err(jt, JSON_ERR_BADSTRING);
+        } else {
+            jt->jt_buf[jt->jt_len++] = c;
+        }
+        return JT_CONTINUE;
+
+    case JT_ESC:
+        if (c == 'u') {
+            jt->jt_state = JT_UESC;
+            jt->jt_esc_cnt = 0;
+            jt->jt_esc_val = 0;
+            return JT_CONTINUE;
+        }
+        e = c != '\0' ? strchr(esc_in, c) : NULL;
+        if (e == NULL) {
+            return json_tok_err(jt, JSON_ERR_BADSTRING);
+        }
+        jt->jt_buf[jt->jt_len++] = esc_out[e - esc_in];
+        jt->jt_state = JT_STRING;
+        return JT_CONTINUE;
+
+    default: /* JT_UESC */
+        v = json_tok_hex(c);
+        if (v < 0) {
+            return json_tok_err(jt, JSON_ERR_BADSTRING);
+        }
+        jt->jt_esc_val = (jt->jt_esc_val << 4) | v;
+        if (++jt->jt_esc_cnt == 4) {
+            json_tok_put_utf8(jt, jt->jt_esc_val);
+            jt->jt_state = JT_STRING;
+        }
+        return JT_CONTINUE;
+    }
+}
+
+/*
+ * Handles one character outside strings.  Returns JT_CONTINUE if the
+ * character was consumed without completing a token, or a token / negative
+ * error to return to the caller.  Characters that complete a token are
+ * consumed before returning, except the delimiter that ends a number.
+ */
+static int
+json_tok_char(struct json_tokenizer *jt, char c)
+{
+    int empty;
+
+    if (jt->jt_state == JT_NUMBER) {
+        if ((c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' ||
+            c == 'e' || c == 'E') {
+            if (jt->jt_len >= JSON_TOK_MAX) {
+                return json_tok_err(jt, JSON_ERR_TOKLONG);
+            }
+            jt->jt_buf[jt->jt_len++] = c;
+            jt->jt_in++;
+            jt->jt_in_len--;
+            return JT_CONTINUE;
+        }
+        return json_tok_number_done(jt);
+    }
+
+    if (jt->jt_state == JT_LITERAL) {
+        if (c != json_tok_literals[jt->jt_lit][jt->jt_lit_idx]) {
+            return json_tok_err(jt, JSON_ERR_SYNTAX);
+        }
+        jt->jt_in++;
+        jt->jt_in_len--;
+        if (json_tok_literals[jt->jt_lit][++jt->jt_lit_idx] == '\0') {
+            json_tok_value_done(jt);
+            return json_tok_emit(jt, jt->jt_lit);
+        }
+        return JT_CONTINUE;
+    }
+
+    if (json_tok_is_ws(c)) {
+        jt->jt_in++;
+        jt->jt_in_len--;
+        return JT_CONTINUE;
+    }
+
+    empty = jt->jt_flags & JT_F_EMPTY;
+    jt->jt_flags &= ~JT_F_EMPTY;
+    jt->jt_in++;
+    jt->jt_in_len--;
+
+    switch (jt->jt_state) {
+    case JT_VALUE:
+        switch (c) {
+        case '{':
+            return json_tok_push(jt, 1);
+        case '[':
+            return json_tok_push(jt, 0);
+        case ']':
+            if (empty) {
+                return json_tok_pop(jt, 0);
+            }
+            break;
+        case '"':
+            jt->jt_flags &= ~JT_F_KEY;
+            jt->jt_state = JT_STRING;
+            return JT_CONTINUE;
+        case 't':
+            jt->jt_lit = JSON_TOK_TRUE;
+            break;
+        case 'f':
+            jt->jt_lit = JSON_TOK_FALSE;
+            break;
+        case 'n':
+            jt->jt_lit = JSON_TOK_NULL;
+            break;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                jt->jt_buf[jt->jt_len++] = c;
+                jt->jt_state = JT_NUMBER;
+                return JT_CONTINUE;
+            }
+            break;
+        }
+        if (c == 't' || c == 'f' || c == 'n') {
+            jt->jt_lit_idx = 1;
+            jt->jt_state = JT_LITERAL;
+            return JT_CONTINUE;
+        }
+        break;
+
+    case JT_KEY:
+        if (c == '"') {
+            jt->jt_flags |= JT_F_KEY;
+            jt->jt_state = JT_STRING;
+            return JT_CONTINUE;
+        }
+        if (c == '}' && empty) {
+            return json_tok_pop(jt, 1);
+        }
+        break;
+
+    case JT_COLON:
+        if (c == ':') {
+            jt->jt_state = JT_VALUE;
+            return JT_CONTINUE;
+        }
+        break;
+
+    case JT_AFTER:
+        if (c == ',') {
+            jt->jt_state = json_tok_in_object(jt) ? JT_KEY : JT_VALUE;
+            return JT_CONTINUE;
+        }
+        if (c == '}' && json_tok_in_object(jt)) {
+            return json_tok_pop(jt, 1);
+        }
+        if (c == ']' && !json_tok_in_object(jt)) {
+            return json_tok_pop(jt, 0);
+        }
+        return json_tok_err(jt, JSON_ERR_BADTRAIL);
+
+    default: /* JT_DONE */
+        return json_tok_err(jt, JSON_ERR_BADTRAIL);
+    }
+
+    return json_tok_err(jt, JSON_ERR_SYNTAX);
+}
+
+/**
+ * Prepares a tokenizer for a new document.
+ */
+void
+json_tokenizer_init(struct json_tokenizer *jt)
+{
+    memset(jt, 0, sizeof(*jt));
+    jt->jt_state = JT_VALUE;
+}
+
+/**
+ * Supplies the next chunk of input.  The chunk must stay valid until
+ * json_tokenizer_next() returns JSON_TOK_NEED_MORE.
+ */
+void
+json_tokenizer_feed(struct json_tokenizer *jt, const char *data, int len)
+{
+    jt->jt_in = data;
+    jt->jt_in_len = len;
+}
+
+/**
+ * Indicates that all input has been supplied.
+ */
+void
+json_tokenizer_finish(struct json_tokenizer *jt)
+{
+    jt->jt_flags |= JT_F_EOF;
+}
+
+/**
+ * Returns the next token from the input fed so far.
+ */
+int
+json_tokenizer_next(struct json_tokenizer *jt)
+{
+    int rc;
+
+    if (jt->jt_err != 0) {
+        return -jt->jt_err;
+    }
+
+    /* The previous token's text is no longer needed. */
+    if (jt->jt_flags & JT_F_EMITTED) {
+        jt->jt_flags &= ~JT_F_EMITTED;
+        jt->jt_len = 0;
+        jt->jt_more = 0;
+    }
+
+    while (jt->jt_in_len > 0) {
+        if (jt->jt_state >= JT_STRING && jt->jt_state <= JT_UESC) {
+            rc = json_tok_string_char(jt, *jt->jt_in);
+            if (rc == JT_CONTINUE) {
+                jt->jt_in++;
+                jt->jt_in_len--;
+                continue;
+            }
+        } else {
+            rc = json_tok_char(jt, *jt->jt_in);
+            if (rc == JT_CONTINUE) {
+                continue;
+            }
+        }
+        return rc;
+    }
+
+    if (!(jt->jt_flags & JT_F_EOF)) {
+        return JSON_TOK_NEED_MORE;
+    }
+
+    switch (jt->jt_state) {
+    case JT_NUMBER:
+        return json_tok_number_done(jt);
+    case JT_DONE:
+        return JSON_TOK_END;
+    default:
+        return json_tok_err(jt, JSON_ERR_EOF);
+    }
+}
@@ -31,6 +31,8 @@ struct cbor_mbuf_reader {
     struct cbor_decoder_reader r;
     int init_off;                     /* initial offset into the data */
     struct os_mbuf *m;
+    struct os_mbuf *cur_m;            /* mbuf accessed by the last read */
+    int cur_off;                      /* chain offset of cur_m's data */
 };
 
 void cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
@@ -27,13 +27,49 @@
 extern "C" {
 #endif
 
+/**
+ * Allocates a packet header mbuf to hold the next fragment of the encoded
+ * output.  Same signature as mem_frag_alloc_fn.
+ */
+typedef struct os_mbuf *cbor_mbuf_frag_alloc_fn(uint16_t frag_size, void *arg);
+
 struct cbor_mbuf_writer {
     struct cbor_encoder_writer enc;
     struct os_mbuf *m;
+
+    /* Last mbuf in the chain of the packet currently being filled. */
+    struct os_mbuf *last;
+
+    /* Packet currently being filled; equal to m unless fragmenting. */
+    struct os_mbuf *frag;
+
+    /* Maximum packet length when fragmenting; 0 if not fragmenting. */
+    uint16_t frag_len;
+    cbor_mbuf_frag_alloc_fn *frag_alloc;
+    void *frag_arg;
 };
 
 void cbor_mbuf_writer_init(struct cbor_mbuf_writer *cb, struct os_mbuf *m);
 
+/**
+ * Initializes a writer which splits its output into packets of at most
+ * frag_len bytes as it encodes.  The first packet is m, which must have a
+ * packet header; its existing contents count towards its length.  When a
+ * packet is full, a new one is obtained from frag_alloc and linked to the
+ * previous one through its packet header (STAILQ_NEXT(pkthdr, omp_next)).
+ * Use cbor_mbuf_writer_next_frag() to walk the resulting packets.
+ */
+void cbor_mbuf_writer_init_frag(struct cbor_mbuf_writer *cb,
+                                struct os_mbuf *m, uint16_t frag_len,
+                                cbor_mbuf_frag_alloc_fn *frag_alloc,
+                                void *frag_arg);
+
+/**
+ * Unlinks and returns the packet following om in a fragmented writer's
+ * output, or NULL if om is the last packet.
+ */
+struct os_mbuf *cbor_mbuf_writer_next_frag(struct os_mbuf *om);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef TEST_TINYCBOR_H
+#define TEST_TINYCBOR_H
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_buf_writer.h"
+#include "tinycbor/cbor_mbuf_reader.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Initializes the mbuf pool used by the tests.
+ */
+void test_tinycbor_mbuf_setup(void);
+
+/*
+ * Allocates an empty packet header mbuf from the test pool.
+ */
+struct os_mbuf *test_tinycbor_mbuf_pkthdr(void);
+
+/*
+ * Copies a flat buffer into a new mbuf chain with at most seg_len bytes of
+ * data per mbuf.
+ */
+struct os_mbuf *test_tinycbor_mbuf_chain(const uint8_t *data, int len,
+                                         int seg_len);
+
+/*
+ * Testcases
+ */
+TEST_CASE_DECL(test_cbor_mbuf_reader_chain);
+TEST_CASE_DECL(test_cbor_mbuf_writer_frag);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TEST_TINYCBOR_H */
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "test_tinycbor.h"
+
+#define TEST_MBUF_BUF_SIZE      (64)
+#define TEST_MBUF_BUF_COUNT     (320)
+
+static os_membuf_t test_mbuf_membuf[
+    OS_MEMPOOL_SIZE(TEST_MBUF_BUF_COUNT, TEST_MBUF_BUF_SIZE)];
+static struct os_mempool test_mbuf_mempool;
+static struct os_mbuf_pool test_mbuf_pool;
+
+void
+test_tinycbor_mbuf_setup(void)
+{
+    int rc;
+
+    rc = os_mempool_init(&test_mbuf_mempool, TEST_MBUF_BUF_COUNT,
+                         TEST_MBUF_BUF_SIZE, test_mbuf_membuf, "cbor_mbuf");
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = os_mbuf_pool_init(&test_mbuf_pool, &test_mbuf_mempool,
+                           TEST_MBUF_BUF_SIZE, TEST_MBUF_BUF_COUNT);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+struct os_mbuf *
+test_tinycbor_mbuf_pkthdr(void)
+{
+    return os_mbuf_get_pkthdr(&test_mbuf_pool, 0);
+}
+
+struct os_mbuf *
+test_tinycbor_mbuf_chain(const uint8_t *data, int len, int seg_len)
+{
+    struct os_mbuf *head;
+    struct os_mbuf *om;
+    int chunk;
+    int off;
+    int rc;
+
+    head = os_mbuf_get_pkthdr(&test_mbuf_pool, 0);
+    TEST_ASSERT_FATAL(head != NULL);
+
+    for (off = 0; off < len; off += chunk) {
+        chunk = len - off;
+        if (chunk > seg_len) {
+            chunk = seg_len;
+        }
+
+        if (off == 0) {
+            om = head;
+        } else {
+            om = os_mbuf_get(&test_mbuf_pool, 0);
+            TEST_ASSERT_FATAL(om != NULL);
+        }
+
+        rc = os_mbuf_append(om, data + off, chunk);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        if (om != head) {
+            os_mbuf_concat(head, om);
+        }
+    }
+
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(head) == len);
+    return head;
+}
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_tinycbor.h"
+
+#define TEST_ENTRY_CNT      16
+
+static uint64_t
+test_entry_val(int i)
+{
+    /* Exercise every integer encoding width. */
+    switch (i % 4) {
+    case 0:
+        return i;
+    case 1:
+        return 0x100 + i;
+    case 2:
+        return 0x10000 + i;
+    default:
+        return 0x100000000ULL + i;
+    }
+}
+
+static int
+test_encode(uint8_t *buf, int buf_len)
+{
+    struct cbor_buf_writer writer;
+    CborEncoder enc;
+    CborEncoder map;
+    uint8_t bytes[9];
+    char key[8];
+    int i;
+
+    cbor_buf_writer_init(&writer, buf, buf_len);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    TEST_ASSERT_FATAL(cbor_encoder_create_map(&enc, &map,
+                                              TEST_ENTRY_CNT * 2) == 0);
+    for (i = 0; i < TEST_ENTRY_CNT; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        TEST_ASSERT_FATAL(cbor_encode_text_stringz(&map, key) == 0);
+        TEST_ASSERT_FATAL(cbor_encode_uint(&map, test_entry_val(i)) == 0);
+
+        snprintf(key, sizeof(key), "b%d", i);
+        memset(bytes, i, sizeof(bytes));
+        TEST_ASSERT_FATAL(cbor_encode_text_stringz(&map, key) == 0);
+        TEST_ASSERT_FATAL(cbor_encode_byte_string(&map, bytes,
+                                                  i % sizeof(bytes)) == 0);
+    }
+    TEST_ASSERT_FATAL(cbor_encoder_close_container(&enc, &map) == 0);
+
+    return cbor_buf_writer_buffer_size(&writer, buf);
+}
+
+static void
+test_decode(struct os_mbuf *om, int off)
+{
+    struct cbor_mbuf_reader reader;
+    CborParser parser;
+    CborValue value;
+    CborValue map;
+    uint8_t bytes[9];
+    uint8_t exp[9];
+    uint64_t u64;
+    size_t len;
+    char key[8];
+    bool eq;
+    int i;
+
+    cbor_mbuf_reader_init(&reader, om, off);
+    TEST_ASSERT_FATAL(cbor_parser_init(&reader.r, 0, &parser, &value) == 0);
+    TEST_ASSERT_FATAL(cbor_value_is_map(&value));
+    TEST_ASSERT_FATAL(cbor_value_enter_container(&value, &map) == 0);
+
+    for (i = 0; i < TEST_ENTRY_CNT; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        TEST_ASSERT_FATAL(cbor_value_text_string_equals(&map, key, &eq) == 0);
+        TEST_ASSERT(eq);
+        TEST_ASSERT_FATAL(cbor_value_advance(&map) == 0);
+        TEST_ASSERT_FATAL(cbor_value_get_uint64(&map, &u64) == 0);
+        TEST_ASSERT(u64 == test_entry_val(i));
+        TEST_ASSERT_FATAL(cbor_value_advance(&map) == 0);
+
+        snprintf(key, sizeof(key), "b%d", i);
+        TEST_ASSERT_FATAL(cbor_value_text_string_equals(&map, key, &eq) == 0);
+        TEST_ASSERT(eq);
+        TEST_ASSERT_FATAL(cbor_value_advance(&map) == 0);
+        len = sizeof(bytes);
+        TEST_ASSERT_FATAL(cbor_value_copy_byte_string(&map, bytes, &len,
+                                                      &map) == 0);
+        memset(exp, i, sizeof(exp));
+        TEST_ASSERT(len == i % sizeof(bytes));
+        TEST_ASSERT(memcmp(bytes, exp, len) == 0);
+    }
+    TEST_ASSERT(cbor_value_at_end(&map));
+}
+
+/*
+ * Decodes the same document from chains of varying fragmentation, so that
+ * every kind of value straddles mbuf boundaries at some point.
+ */
+TEST_CASE_SELF(test_cbor_mbuf_reader_chain)
+{
+    struct os_mbuf *om;
+    uint8_t buf[256];
+    uint8_t data[260];
+    int len;
+    int seg;
+
+    test_tinycbor_mbuf_setup();
+
+    len = test_encode(buf, sizeof(buf));
+    TEST_ASSERT_FATAL(len > 0 && len < sizeof(buf));
+
+    for (seg = 1; seg <= 32; seg++) {
+        om = test_tinycbor_mbuf_chain(buf, len, seg);
+        test_decode(om, 0);
+        os_mbuf_free_chain(om);
+
+        /* Same document behind a 4-byte header. */
+        memset(data, 0xa5, 4);
+        memcpy(data + 4, buf, len);
+        om = test_tinycbor_mbuf_chain(data, len + 4, seg);
+        test_decode(om, 4);
+        os_mbuf_free_chain(om);
+    }
+}
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "test_tinycbor.h"
+
+#define TEST_ENTRY_CNT      24
+
+static int test_frag_cnt;
+
+static struct os_mbuf *
+test_frag_alloc(uint16_t frag_size, void *arg)
+{
+    test_frag_cnt++;
+    return test_tinycbor_mbuf_pkthdr();
+}
+
+/*
+ * Encodes a document made up of many small writes, with a few strings long
+ * enough to span several mbufs.
+ */
+static void
+test_encode(struct cbor_encoder_writer *writer)
+{
+    CborEncoder enc;
+    CborEncoder map;
+    char str[64];
+    char key[8];
+    int i;
+
+    cbor_encoder_init(&enc, writer, 0);
+    TEST_ASSERT_FATAL(cbor_encoder_create_map(&enc, &map,
+                                              CborIndefiniteLength) == 0);
+    for (i = 0; i < TEST_ENTRY_CNT; i++) {
+        snprintf(key, sizeof(key), "k%d", i);
+        TEST_ASSERT_FATAL(cbor_encode_text_stringz(&map, key) == 0);
+        TEST_ASSERT_FATAL(cbor_encode_int(&map, i * 1000 - 5000) == 0);
+
+        snprintf(key, sizeof(key), "s%d", i);
+        memset(str, 'a' + i, sizeof(str));
+        TEST_ASSERT_FATAL(cbor_encode_text_stringz(&map, key) == 0);
+        TEST_ASSERT_FATAL(cbor_encode_text_string(&map, str,
+                                                  (i * 7) % sizeof(str)) == 0);
+    }
+    TEST_ASSERT_FATAL(cbor_encoder_close_container(&enc, &map) == 0);
+}
+
+/*
+ * Encodes the same document into a single chain, into a chain that gets
+ * appended to behind the writer's back, and into fragments of every length
+ * from 8 to 40 bytes; all must match a flat encoding byte for byte.
+ */
+TEST_CASE_SELF(test_cbor_mbuf_writer_frag)
+{
+    struct cbor_mbuf_writer mwriter;
+    struct cbor_buf_writer bwriter;
+    struct os_mbuf *next;
+    struct os_mbuf *om;
+    uint8_t flat[2048];
+    uint8_t data[2048];
+    int frag_len;
+    int len;
+    int off;
+    int rc;
+
+    test_tinycbor_mbuf_setup();
+
+    cbor_buf_writer_init(&bwriter, flat, sizeof(flat));
+    test_encode(&bwriter.enc);
+    len = cbor_buf_writer_buffer_size(&bwriter, flat);
+    TEST_ASSERT_FATAL(len > 0 && len < sizeof(flat));
+
+    /* Single chain. */
+    om = test_tinycbor_mbuf_pkthdr();
+    TEST_ASSERT_FATAL(om != NULL);
+    cbor_mbuf_writer_init(&mwriter, om);
+    test_encode(&mwriter.enc);
+    TEST_ASSERT(mwriter.enc.bytes_written == len);
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(om) == len);
+    TEST_ASSERT(os_mbuf_cmpf(om, 0, flat, len) == 0);
+
+    /* Data appended by the chain's owner lands after the writer's output. */
+    rc = os_mbuf_append(om, flat, 100);
+    TEST_ASSERT_FATAL(rc == 0);
+    test_encode(&mwriter.enc);
+    TEST_ASSERT_FATAL(OS_MBUF_PKTLEN(om) == len * 2 + 100);
+    TEST_ASSERT(os_mbuf_cmpf(om, len, flat, 100) == 0);
+    TEST_ASSERT(os_mbuf_cmpf(om, len + 100, flat, len) == 0);
+    os_mbuf_free_chain(om);
+
+    for (frag_len = 8; frag_len <= 40; frag_len++) {
+        /* Leading header, as newtmgr writes before encoding. */
+        om = test_tinycbor_mbuf_pkthdr();
+        TEST_ASSERT_FATAL(om != NULL);
+        rc = os_mbuf_append(om, "hdr", 3);
+        TEST_ASSERT_FATAL(rc == 0);
+        memcpy(data, "hdr", 3);
+        memcpy(data + 3, flat, len);
+
+        test_frag_cnt = 0;
+        cbor_mbuf_writer_init_frag(&mwriter, om, frag_len,
+                                   test_frag_alloc, NULL);
+        test_encode(&mwriter.enc);
+        TEST_ASSERT(mwriter.enc.bytes_written == len);
+
+        off = 0;
+        while (om != NULL) {
+            next = cbor_mbuf_writer_next_frag(om);
+            if (next != NULL) {
+                TEST_ASSERT(OS_MBUF_PKTLEN(om) == frag_len);
+            } else {
+                TEST_ASSERT(OS_MBUF_PKTLEN(om) <= frag_len);
+            }
+            TEST_ASSERT(os_mbuf_cmpf(om, 0, data + off,
+                                     OS_MBUF_PKTLEN(om)) == 0);
+            off += OS_MBUF_PKTLEN(om);
+            os_mbuf_free_chain(om);
+            om = next;
+        }
+        TEST_ASSERT(off == len + 3);
+        TEST_ASSERT(test_frag_cnt > 0);
+    }
+}
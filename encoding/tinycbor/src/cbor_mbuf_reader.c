@@ -17,18 +17,83 @@
  * under the License.
  */
 
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor_mbuf_reader.h>
 #include <tinycbor/compilersupport_p.h>
 
+/*
+ * Finds the mbuf holding the byte at the specified decoder offset.  The search
+ * resumes from the mbuf used by the previous read, so decoding a chain front
+ * to back walks it only once instead of once per read.
+ *
+ * Returns NULL if the offset lies beyond the end of the chain; otherwise,
+ * writes the offset relative to the returned mbuf's data to out_off.
+ */
+static struct os_mbuf *
+cbor_mbuf_reader_seek(struct cbor_mbuf_reader *cb, int offset, int *out_off)
+{
+    struct os_mbuf *om;
+    int om_off;
+    int off;
+
+    off = offset + cb->init_off;
+    if (off < cb->cur_off) {
+        om = cb->m;
+        om_off = 0;
+    } else {
+        om = cb->cur_m;
+        om_off = cb->cur_off;
+    }
+
+    while (om != NULL && off - om_off >= om->om_len) {
+        om_off += om->om_len;
+        om = SLIST_NEXT(om, om_next);
+    }
+    if (om == NULL) {
+        return NULL;
+    }
+
+    cb->cur_m = om;
+    cb->cur_off = om_off;
+    *out_off = off - om_off;
+    return om;
+}
+
+/*
+ * Reads a value of up to 8 bytes.  Values contained in a single mbuf are
+ * read in place; only values straddling mbufs are gathered with
+ * os_mbuf_copydata().
+ */
+static void
+cbor_mbuf_reader_read(struct cbor_mbuf_reader *cb, int offset, void *dst,
+                      int len)
+{
+    struct os_mbuf *om;
+    int off;
+
+    om = cbor_mbuf_reader_seek(cb, offset, &off);
+    if (om == NULL) {
+        memset(dst, 0, len);
+    } else if (off + len <= om->om_len) {
+        memcpy(dst, om->om_data + off, len);
+    } else if (os_mbuf_copydata(om, off, len, dst) != 0) {
+        memset(dst, 0, len);
+    }
+}
+
 static uint8_t
 cbor_mbuf_reader_get8(struct cbor_decoder_reader *d, int offset)
 {
-    uint8_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
+    struct os_mbuf *om;
+    int off;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
-    return val;
+    om = cbor_mbuf_reader_seek(cb, offset, &off);
+    if (om == NULL) {
+        return 0;
+    }
+    return om->om_data[off];
 }
 
 static uint16_t
@@ -37,7 +102,7 @@ cbor_mbuf_reader_get16(struct cbor_decoder_reader *d, int offset)
     uint16_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, offset, &val, sizeof(val));
     return cbor_ntohs(val);
 }
 
@@ -47,7 +112,7 @@ cbor_mbuf_reader_get32(struct cbor_decoder_reader *d, int offset)
     uint32_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, offset, &val, sizeof(val));
     return cbor_ntohl(val);
 }
 
@@ -57,7 +122,7 @@ cbor_mbuf_reader_get64(struct cbor_decoder_reader *d, int offset)
     uint64_t val;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
 
-    os_mbuf_copydata(cb->m, offset + cb->init_off, sizeof(val), &val);
+    cbor_mbuf_reader_read(cb, offset, &val, sizeof(val));
     return cbor_ntohll(val);
 }
 
@@ -66,7 +131,14 @@ cbor_mbuf_reader_cmp(struct cbor_decoder_reader *d, char *buf, int offset,
                      size_t len)
 {
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
-    return os_mbuf_cmpf(cb->m, offset + cb->init_off, buf, len) == 0;
+    struct os_mbuf *om;
+    int off;
+
+    om = cbor_mbuf_reader_seek(cb, offset, &off);
+    if (om == NULL) {
+        return len == 0;
+    }
+    return os_mbuf_cmpf(om, off, buf, len) == 0;
 }
 
 static uintptr_t
@@ -75,8 +147,14 @@ cbor_mbuf_reader_cpy(struct cbor_decoder_reader *d, char *dst, int offset,
 {
     int rc;
     struct cbor_mbuf_reader *cb = (struct cbor_mbuf_reader *) d;
+    struct os_mbuf *om;
+    int off;
 
-    rc = os_mbuf_copydata(cb->m, offset + cb->init_off, len, dst);
+    om = cbor_mbuf_reader_seek(cb, offset, &off);
+    if (om == NULL) {
+        return len == 0;
+    }
+    rc = os_mbuf_copydata(om, off, len, dst);
     if (rc == 0) {
         return true;
     }
@@ -100,5 +178,7 @@ cbor_mbuf_reader_init(struct cbor_mbuf_reader *cb, struct os_mbuf *m,
     hdr = OS_MBUF_PKTHDR(m);
     cb->m = m;
     cb->init_off = initial_offset;
+    cb->cur_m = m;
+    cb->cur_off = 0;
     cb->r.message_size = hdr->omp_len - initial_offset;
 }
@@ -17,31 +17,138 @@
  * under the License.
  */
 
+#include <assert.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include <tinycbor/cbor.h>
-#include <tinycbor/cbor.h>
 #include <tinycbor/cbor_mbuf_writer.h>
 
+/*
+ * Returns the last mbuf in the packet being filled.  The cached tail is only
+ * a starting point, as the owner of the chain may have appended to it since
+ * the previous write.
+ */
+static struct os_mbuf *
+cbor_mbuf_writer_tail(struct cbor_mbuf_writer *cb)
+{
+    struct os_mbuf *om;
+
+    om = cb->last;
+    while (SLIST_NEXT(om, om_next) != NULL) {
+        om = SLIST_NEXT(om, om_next);
+    }
+
+    return om;
+}
+
+/*
+ * Copies encoder output straight into the trailing space of the cached tail
+ * mbuf, allocating a full mbuf (or, when fragmenting, a new packet) only when
+ * the current one is exhausted.
+ */
 int
 cbor_mbuf_writer(struct cbor_encoder_writer *arg, const char *data, int len)
 {
-    int rc;
     struct cbor_mbuf_writer *cb = (struct cbor_mbuf_writer *) arg;
+    struct os_mbuf *last;
+    struct os_mbuf *om;
+    int space;
+    int room;
+    int rc;
+
+    rc = CborNoError;
+    last = cbor_mbuf_writer_tail(cb);
+
+    while (len > 0) {
+        room = len;
+        if (cb->frag_len != 0) {
+            room = cb->frag_len - OS_MBUF_PKTLEN(cb->frag);
+            if (room <= 0) {
+                om = cb->frag_alloc(cb->frag_len, cb->frag_arg);
+                if (om == NULL) {
+                    rc = CborErrorOutOfMemory;
+                    break;
+                }
+                STAILQ_NEXT(OS_MBUF_PKTHDR(cb->frag), omp_next) =
+                    OS_MBUF_PKTHDR(om);
+                cb->frag = om;
+                last = om;
+                continue;
+            }
+        }
 
-    rc = os_mbuf_append(cb->m, data, len);
-    if (rc) {
-        return CborErrorOutOfMemory;
+        space = OS_MBUF_TRAILINGSPACE(last);
+        if (space == 0) {
+            om = os_mbuf_get(cb->frag->om_omp, 0);
+            if (om == NULL) {
+                rc = CborErrorOutOfMemory;
+                break;
+            }
+            SLIST_NEXT(last, om_next) = om;
+            last = om;
+            continue;
+        }
+
+        if (space > room) {
+            space = room;
+        }
+        if (space > len) {
+            space = len;
+        }
+
+        memcpy(OS_MBUF_DATA(last, uint8_t *) + last->om_len, data, space);
+        last->om_len += space;
+        if (OS_MBUF_IS_PKTHDR(cb->frag)) {
+            OS_MBUF_PKTHDR(cb->frag)->omp_len += space;
+        }
+
+        data += space;
+        len -= space;
+        cb->enc.bytes_written += space;
     }
-    cb->enc.bytes_written += len;
-    return CborNoError;
-}
 
+    cb->last = last;
+    return rc;
+}
 
 void
 cbor_mbuf_writer_init(struct cbor_mbuf_writer *cb, struct os_mbuf *m)
 {
     cb->m = m;
+    cb->last = m;
+    cb->frag = m;
+    cb->frag_len = 0;
+    cb->frag_alloc = NULL;
+    cb->frag_arg = NULL;
     cb->enc.bytes_written = 0;
     cb->enc.write = &cbor_mbuf_writer;
 }
 
+void
+cbor_mbuf_writer_init_frag(struct cbor_mbuf_writer *cb, struct os_mbuf *m,
+                           uint16_t frag_len,
+                           cbor_mbuf_frag_alloc_fn *frag_alloc, void *frag_arg)
+{
+    assert(OS_MBUF_IS_PKTHDR(m));
+    assert(frag_len > 0 && frag_alloc != NULL);
+
+    cbor_mbuf_writer_init(cb, m);
+    cb->frag_len = frag_len;
+    cb->frag_alloc = frag_alloc;
+    cb->frag_arg = frag_arg;
+    STAILQ_NEXT(OS_MBUF_PKTHDR(m), omp_next) = NULL;
+}
+
+struct os_mbuf *
+cbor_mbuf_writer_next_frag(struct os_mbuf *om)
+{
+    struct os_mbuf_pkthdr *next;
+
+    next = STAILQ_NEXT(OS_MBUF_PKTHDR(om), omp_next);
+    if (next == NULL) {
+        return NULL;
+    }
+    STAILQ_NEXT(OS_MBUF_PKTHDR(om), omp_next) = NULL;
+
+    return OS_MBUF_PKTHDR_TO_MBUF(next);
+}
@@ -508,8 +508,8 @@ static struct disk_ops *dops_from_handle(BYTE pdrv)
     return NULL;
 }
 
-DRESULT
-disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+static DRESULT
+disk_read_raw(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
 {
     int rc;
     uint32_t address;
@@ -533,8 +533,8 @@ disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
     return RES_OK;
 }
 
-DRESULT
-disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+static DRESULT
+disk_write_raw(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
 {
     int rc;
     uint32_t address;
@@ -558,9 +558,226 @@ disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
     return RES_OK;
 }
 
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS)
+
+/*
+ * Small write-back cache of single sectors.
+ *
+ * FatFs accesses FAT and directory sectors one at a time through its window,
+ * often alternating between a few of them (e.g. when allocating clusters).
+ * Cluster data is mostly transferred in multi-sector requests, those bypass
+ * the cache so it is not flushed by large file transfers.
+ *
+ * Dirty sectors are written out when evicted and on CTRL_SYNC, which FatFs
+ * issues on f_sync()/f_close().
+ */
+#define FATFS_CACHE_VALID   0x01
+#define FATFS_CACHE_DIRTY   0x02
+
+struct fatfs_cache_entry {
+    DWORD sector;
+    uint32_t last_use;
+    BYTE pdrv;
+    uint8_t flags;
+    BYTE data[512];
+};
+
+static struct fatfs_cache_entry fatfs_cache[MYNEWT_VAL(FATFS_CACHE_SECTORS)];
+static uint32_t fatfs_cache_clock;
+
+static struct fatfs_cache_entry *
+fatfs_cache_find(BYTE pdrv, DWORD sector)
+{
+    struct fatfs_cache_entry *entry;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(fatfs_cache); i++) {
+        entry = &fatfs_cache[i];
+        if ((entry->flags & FATFS_CACHE_VALID) && entry->pdrv == pdrv &&
+            entry->sector == sector) {
+            entry->last_use = ++fatfs_cache_clock;
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+static DRESULT
+fatfs_cache_flush_entry(struct fatfs_cache_entry *entry)
+{
+    DRESULT res;
+
+    if (!(entry->flags & FATFS_CACHE_DIRTY)) {
+        return RES_OK;
+    }
+
+    res = disk_write_raw(entry->pdrv, entry->data, entry->sector, 1);
+    if (res == RES_OK) {
+        entry->flags &= ~FATFS_CACHE_DIRTY;
+    }
+
+    return res;
+}
+
+/*
+ * Returns least recently used entry, written back if needed, to be reused
+ * for another sector.
+ */
+static struct fatfs_cache_entry *
+fatfs_cache_evict(void)
+{
+    struct fatfs_cache_entry *entry;
+    struct fatfs_cache_entry *lru;
+    int i;
+
+    lru = &fatfs_cache[0];
+    for (i = 0; i < ARRAY_SIZE(fatfs_cache); i++) {
+        entry = &fatfs_cache[i];
+        if (!(entry->flags & FATFS_CACHE_VALID)) {
+            lru = entry;
+            break;
+        }
+        if ((int32_t)(entry->last_use - lru->last_use) < 0) {
+            lru = entry;
+        }
+    }
+
+    if (fatfs_cache_flush_entry(lru) != RES_OK) {
+        return NULL;
+    }
+    lru->flags = 0;
+
+    return lru;
+}
+
+static DRESULT
+fatfs_cache_sync(BYTE pdrv)
+{
+    DRESULT res = RES_OK;
+    int i;
+
+    for (i = 0; i < ARRAY_SIZE(fatfs_cache); i++) {
+        if ((fatfs_cache[i].flags & FATFS_CACHE_VALID) &&
+            fatfs_cache[i].pdrv == pdrv &&
+            fatfs_cache_flush_entry(&fatfs_cache[i]) != RES_OK) {
+            res = RES_ERROR;
+        }
+    }
+
+    return res;
+}
+
+DRESULT
+disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_entry *entry;
+    DRESULT res;
+    int i;
+
+    if (count == 1) {
+        entry = fatfs_cache_find(pdrv, sector);
+        if (entry == NULL) {
+            entry = fatfs_cache_evict();
+            if (entry == NULL) {
+                return RES_ERROR;
+            }
+            res = disk_read_raw(pdrv, entry->data, sector, 1);
+            if (res != RES_OK) {
+                return res;
+            }
+            entry->pdrv = pdrv;
+            entry->sector = sector;
+            entry->flags = FATFS_CACHE_VALID;
+            entry->last_use = ++fatfs_cache_clock;
+        }
+        memcpy(buff, entry->data, 512);
+        return RES_OK;
+    }
+
+    res = disk_read_raw(pdrv, buff, sector, count);
+    if (res != RES_OK) {
+        return res;
+    }
+
+    /* Cached copy is newer than disk for sectors not written back yet */
+    for (i = 0; i < ARRAY_SIZE(fatfs_cache); i++) {
+        entry = &fatfs_cache[i];
+        if ((entry->flags & FATFS_CACHE_DIRTY) && entry->pdrv == pdrv &&
+            entry->sector >= sector && entry->sector < sector + count) {
+            memcpy(buff + (entry->sector - sector) * 512, entry->data, 512);
+        }
+    }
+
+    return RES_OK;
+}
+
+DRESULT
+disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+    struct fatfs_cache_entry *entry;
+    DRESULT res;
+    int i;
+
+    if (count == 1) {
+        entry = fatfs_cache_find(pdrv, sector);
+        if (entry == NULL) {
+            entry = fatfs_cache_evict();
+            if (entry == NULL) {
+                return RES_ERROR;
+            }
+            entry->pdrv = pdrv;
+            entry->sector = sector;
+            entry->last_use = ++fatfs_cache_clock;
+        }
+        memcpy(entry->data, buff, 512);
+        entry->flags = FATFS_CACHE_VALID | FATFS_CACHE_DIRTY;
+        return RES_OK;
+    }
+
+    res = disk_write_raw(pdrv, buff, sector, count);
+    if (res != RES_OK) {
+        return res;
+    }
+
+    /* Keep cached copies in sync with what was just written */
+    for (i = 0; i < ARRAY_SIZE(fatfs_cache); i++) {
+        entry = &fatfs_cache[i];
+        if ((entry->flags & FATFS_CACHE_VALID) && entry->pdrv == pdrv &&
+            entry->sector >= sector && entry->sector < sector + count) {
+            memcpy(entry->data, buff + (entry->sector - sector) * 512, 512);
+            entry->flags &= ~FATFS_CACHE_DIRTY;
+        }
+    }
+
+    return RES_OK;
+}
+
+#else
+
+DRESULT
+disk_read(BYTE pdrv, BYTE* buff, DWORD sector, UINT count)
+{
+    return disk_read_raw(pdrv, buff, sector, count);
+}
+
+DRESULT
+disk_write(BYTE pdrv, const BYTE* buff, DWORD sector, UINT count)
+{
+    return disk_write_raw(pdrv, buff, sector, count);
+}
+
+#endif
+
 DRESULT
 disk_ioctl(BYTE pdrv, BYTE cmd, void* buff)
 {
+#if MYNEWT_VAL(FATFS_CACHE_SECTORS)
+    if (cmd == CTRL_SYNC) {
+        return fatfs_cache_sync(pdrv);
+    }
+#endif
+
     return RES_OK;
 }
 
@@ -147,6 +147,8 @@ TEST_CASE_DECL(fcb_test_rotate)
 TEST_CASE_DECL(fcb_test_multiple_scratch)
 TEST_CASE_DECL(fcb_test_last_of_n)
 TEST_CASE_DECL(fcb_test_area_info)
+TEST_CASE_DECL(fcb_test_power_loss)
+TEST_CASE_DECL(fcb_test_nor_overwrite)
 
 TEST_SUITE(fcb_test_all)
 {
@@ -161,6 +163,8 @@ TEST_SUITE(fcb_test_all)
     fcb_test_multiple_scratch();
     fcb_test_last_of_n();
     fcb_test_area_info();
+    fcb_test_power_loss();
+    fcb_test_nor_overwrite();
 }
 
 int
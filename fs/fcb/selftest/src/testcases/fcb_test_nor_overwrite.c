@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+#endif
+
+/**
+ * With NOR semantics the simulated flash accepts writes that only clear bits
+ * and rejects any write that would set one.
+ */
+TEST_CASE_SELF(fcb_test_nor_overwrite)
+{
+#ifdef ARCH_sim
+    const struct flash_area *fap;
+    uint8_t val;
+    int rc;
+
+    native_flash_set_nor(1);
+    fcb_test_wipe();
+    fap = &test_fcb_area[0];
+
+    val = 0xf0;
+    rc = flash_area_write(fap, 0, &val, 1);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    val = 0x30;
+    rc = flash_area_write(fap, 0, &val, 1);
+    TEST_ASSERT(rc == 0);
+
+    val = 0xff;
+    rc = flash_area_write(fap, 0, &val, 1);
+    TEST_ASSERT(rc != 0);
+
+    rc = flash_area_read(fap, 0, &val, 1);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(val == 0x30);
+
+    native_flash_set_nor(MYNEWT_VAL(MCU_NATIVE_FLASH_NOR));
+#endif
+}
@@ -0,0 +1,137 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "fcb_test.h"
+
+#ifdef ARCH_sim
+#include "mcu/mcu_sim.h"
+
+#define FCB_TEST_PL_ENTRY_LEN(idx)  (16 + ((idx) % 16))
+#define FCB_TEST_PL_BUDGET_MAX      512
+
+static int
+fcb_test_pl_append(int idx)
+{
+    struct fcb_entry loc;
+    uint8_t data[32];
+    int len;
+    int rc;
+    int i;
+
+    len = FCB_TEST_PL_ENTRY_LEN(idx);
+    for (i = 0; i < len; i++) {
+        data[i] = fcb_test_append_data(len, i);
+    }
+
+    rc = fcb_append(&test_fcb, len, &loc);
+    if (rc != 0) {
+        return rc;
+    }
+    rc = flash_area_write(loc.fe_area, loc.fe_data_off, data, len);
+    if (rc != 0) {
+        return rc;
+    }
+    return fcb_append_finish(&test_fcb, &loc);
+}
+
+static int
+fcb_test_pl_walk_cb(struct fcb_entry *loc, void *arg)
+{
+    uint8_t data[32];
+    int *cnt;
+    int rc;
+    int i;
+
+    cnt = arg;
+
+    TEST_ASSERT_FATAL(loc->fe_data_len == FCB_TEST_PL_ENTRY_LEN(*cnt));
+    rc = flash_area_read(loc->fe_area, loc->fe_data_off, data,
+                         loc->fe_data_len);
+    TEST_ASSERT_FATAL(rc == 0);
+    for (i = 0; i < loc->fe_data_len; i++) {
+        TEST_ASSERT(data[i] == fcb_test_append_data(loc->fe_data_len, i));
+    }
+
+    (*cnt)++;
+    return 0;
+}
+
+static void
+fcb_test_pl_reinit(void)
+{
+    int rc;
+
+    memset(&test_fcb, 0, sizeof(test_fcb));
+    test_fcb.f_sector_cnt = 2;
+    test_fcb.f_sectors = test_fcb_area;
+    rc = fcb_init(&test_fcb);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+#endif
+
+/**
+ * Cuts power at every point of a sequence of appends and verifies that the
+ * FCB recovers: all completed entries survive, the interrupted one is either
+ * fully present or dropped, and appending works again afterwards.  Runs
+ * with NOR semantics, like the flash parts FCB is used on.
+ */
+TEST_CASE_SELF(fcb_test_power_loss)
+{
+#ifdef ARCH_sim
+    struct native_flash_stats stats;
+    uint32_t budget;
+    int completed;
+    int cnt;
+    int rc;
+
+    native_flash_set_nor(1);
+    for (budget = 0; budget < FCB_TEST_PL_BUDGET_MAX; budget += 7) {
+        fcb_tc_pretest(2);
+
+        native_flash_stats_get(NULL, 1);
+        native_flash_power_loss_arm(budget, NULL, NULL);
+        for (completed = 0; ; completed++) {
+            rc = fcb_test_pl_append(completed);
+            if (rc != 0) {
+                break;
+            }
+        }
+        native_flash_stats_get(&stats, 1);
+        native_flash_power_loss_disarm();
+        TEST_ASSERT(stats.nfs_power_losses == 1);
+        TEST_ASSERT(stats.nfs_bytes_written <= budget);
+
+        fcb_test_pl_reinit();
+        cnt = 0;
+        rc = fcb_walk(&test_fcb, NULL, fcb_test_pl_walk_cb, &cnt);
+        TEST_ASSERT_FATAL(rc == 0);
+        TEST_ASSERT_FATAL(cnt == completed || cnt == completed + 1,
+                          "budget %u: %d entries, %d completed",
+                          (unsigned)budget, cnt, completed);
+
+        rc = fcb_test_pl_append(cnt);
+        TEST_ASSERT_FATAL(rc == 0);
+        completed = cnt + 1;
+        cnt = 0;
+        rc = fcb_walk(&test_fcb, NULL, fcb_test_pl_walk_cb, &cnt);
+        TEST_ASSERT(rc == 0);
+        TEST_ASSERT(cnt == completed);
+    }
+    native_flash_set_nor(MYNEWT_VAL(MCU_NATIVE_FLASH_NOR));
+#endif
+}
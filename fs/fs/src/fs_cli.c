@@ -22,6 +22,7 @@
 #if MYNEWT_VAL(FS_CLI)
 
 #include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <shell/shell.h>
@@ -34,6 +35,9 @@ static int fs_rm_cmd(int argc, char **argv);
 static int fs_mkdir_cmd(int argc, char **argv);
 static int fs_mv_cmd(int argc, char **argv);
 static int fs_cat_cmd(int argc, char **argv);
+#if MYNEWT_VAL(FS_CLI_BENCH)
+static int fs_bench_cmd(int argc, char **argv);
+#endif
 
 static struct shell_cmd fs_ls_struct = {
     .sc_cmd = "ls",
@@ -55,6 +59,12 @@ static struct shell_cmd fs_cat_struct = {
     .sc_cmd = "cat",
     .sc_cmd_func = fs_cat_cmd
 };
+#if MYNEWT_VAL(FS_CLI_BENCH)
+static struct shell_cmd fs_bench_struct = {
+    .sc_cmd = "fsbench",
+    .sc_cmd_func = fs_bench_cmd
+};
+#endif
 
 static void
 fs_ls_file(const char *name, struct fs_file *file)
@@ -220,6 +230,132 @@ fs_cat_cmd(int argc, char **argv)
     return 0;
 }
 
+#if MYNEWT_VAL(FS_CLI_BENCH)
+
+#define FS_BENCH_IO_SIZE    4096
+
+static uint8_t fs_bench_buf[FS_BENCH_IO_SIZE];
+
+static void
+fs_bench_report(const char *name, uint32_t bytes, int64_t start)
+{
+    uint32_t usecs;
+
+    usecs = (uint32_t)(os_get_uptime_usec() - start);
+    if (usecs == 0) {
+        usecs = 1;
+    }
+    console_printf("%-10s %6lu KB %8lu ms %6lu KB/s\n", name,
+                   (unsigned long)(bytes / 1024),
+                   (unsigned long)(usecs / 1000),
+                   (unsigned long)((uint64_t)bytes * 1000000 / 1024 / usecs));
+}
+
+/*
+ * Sequential and random 4 KB file I/O throughput.  The test file is
+ * created (truncated) and left in place.
+ */
+static int
+fs_bench_cmd(int argc, char **argv)
+{
+    struct fs_file *file;
+    uint32_t blocks;
+    uint32_t len;
+    uint32_t i;
+    int64_t start;
+    int rc;
+
+    if (argc < 2 || argc > 3) {
+        console_printf("fsbench <filename> [size_kb]\n");
+        return -1;
+    }
+
+    blocks = 64;
+    if (argc == 3) {
+        blocks = strtoul(argv[2], NULL, 0) * 1024 / FS_BENCH_IO_SIZE;
+        if (blocks == 0) {
+            blocks = 1;
+        }
+    }
+
+    for (i = 0; i < sizeof(fs_bench_buf); i++) {
+        fs_bench_buf[i] = (uint8_t)i;
+    }
+
+    /* Sequential write, including flush on close */
+    start = os_get_uptime_usec();
+    rc = fs_open(argv[1], FS_ACCESS_WRITE | FS_ACCESS_TRUNCATE, &file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    for (i = 0; i < blocks && rc == FS_EOK; i++) {
+        rc = fs_write(file, fs_bench_buf, sizeof(fs_bench_buf));
+    }
+    fs_close(file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    fs_bench_report("seq write", blocks * FS_BENCH_IO_SIZE, start);
+
+    /* Sequential read */
+    start = os_get_uptime_usec();
+    rc = fs_open(argv[1], FS_ACCESS_READ, &file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    for (i = 0; i < blocks && rc == FS_EOK; i++) {
+        rc = fs_read(file, sizeof(fs_bench_buf), fs_bench_buf, &len);
+    }
+    fs_close(file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    fs_bench_report("seq read", blocks * FS_BENCH_IO_SIZE, start);
+
+    /* Random read */
+    start = os_get_uptime_usec();
+    rc = fs_open(argv[1], FS_ACCESS_READ, &file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    for (i = 0; i < blocks && rc == FS_EOK; i++) {
+        rc = fs_seek(file, (rand() % blocks) * FS_BENCH_IO_SIZE);
+        if (rc == FS_EOK) {
+            rc = fs_read(file, sizeof(fs_bench_buf), fs_bench_buf, &len);
+        }
+    }
+    fs_close(file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    fs_bench_report("rand read", blocks * FS_BENCH_IO_SIZE, start);
+
+    /* Random write, including flush on close */
+    start = os_get_uptime_usec();
+    rc = fs_open(argv[1], FS_ACCESS_READ | FS_ACCESS_WRITE, &file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    for (i = 0; i < blocks && rc == FS_EOK; i++) {
+        rc = fs_seek(file, (rand() % blocks) * FS_BENCH_IO_SIZE);
+        if (rc == FS_EOK) {
+            rc = fs_write(file, fs_bench_buf, sizeof(fs_bench_buf));
+        }
+    }
+    fs_close(file);
+    if (rc != FS_EOK) {
+        goto err;
+    }
+    fs_bench_report("rand write", blocks * FS_BENCH_IO_SIZE, start);
+
+    return 0;
+
+err:
+    console_printf("Error accessing %s - %d\n", argv[1], rc);
+    return -1;
+}
+#endif
+
 void
 fs_cli_init(void)
 {
@@ -228,5 +364,8 @@ fs_cli_init(void)
     shell_cmd_register(&fs_mkdir_struct);
     shell_cmd_register(&fs_mv_struct);
     shell_cmd_register(&fs_cat_struct);
+#if MYNEWT_VAL(FS_CLI_BENCH)
+    shell_cmd_register(&fs_bench_struct);
+#endif
 }
 #endif /* MYNEWT_VAL(FS_CLI) */
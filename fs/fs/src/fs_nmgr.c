@@ -61,6 +61,7 @@ static struct mgmt_group fs_nmgr_group = {
     .mg_handlers = fs_nmgr_handlers,
     .mg_handlers_count = FS_NMGR_HANDLER_CNT,
     .mg_group_id = MGMT_GROUP_ID_FS,
+    .mg_max_inflight = 1,
 };
 
 static int
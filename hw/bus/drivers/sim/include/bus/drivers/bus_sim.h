@@ -0,0 +1,181 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef HW_BUS_DRIVERS_BUS_SIM_H_
+#define HW_BUS_DRIVERS_BUS_SIM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "os/mynewt.h"
+#include "bus/bus.h"
+#include "bus/bus_driver.h"
+#include "bus/bus_debug.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Simulated bus device configuration
+ */
+struct bus_sim_dev_cfg {
+    /** Bus bit rate [bit/s], used to calculate transfer duration */
+    uint32_t bitrate;
+    /** Fixed overhead of each transfer [us], e.g. addressing */
+    uint32_t xfer_overhead_us;
+};
+
+/**
+ * Simulated bus statistics
+ */
+struct bus_sim_stats {
+    /** Number of transfers */
+    uint32_t xfers;
+    /** Number of bytes transferred */
+    uint32_t bytes;
+    /** Time bus was busy with transfers [us] */
+    uint32_t busy_us;
+    /** Time since statistics were reset [us] */
+    uint32_t elapsed_us;
+};
+
+struct bus_sim_dev {
+    struct bus_dev bdev;
+    struct bus_sim_dev_cfg cfg;
+
+    struct hal_timer timer;
+    struct bus_sim_node *xfer_node;
+    uint8_t *xfer_rbuf;
+    const uint8_t *xfer_wbuf;
+    uint16_t xfer_length;
+
+    uint32_t stats_start;
+    struct bus_sim_stats stats;
+
+#if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
+    uint32_t devmagic;
+#endif
+};
+
+/**
+ * Simulated bus node configuration
+ */
+struct bus_sim_node_cfg {
+    /** General node configuration */
+    struct bus_node_cfg node_cfg;
+    /** Memory emulating node registers */
+    uint8_t *mem;
+    /** Size of node memory */
+    uint16_t mem_size;
+};
+
+/**
+ * Simulated bus node
+ *
+ * Node behaves like a typical register based device: first byte of write
+ * selects register address, remaining bytes are written to consecutive
+ * registers. Read returns data from consecutive registers starting at selected
+ * address. Address wraps at the end of node memory.
+ */
+struct bus_sim_node {
+    struct bus_node bnode;
+    uint8_t *mem;
+    uint16_t mem_size;
+    uint16_t addr;
+
+#if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
+    uint32_t nodemagic;
+#endif
+};
+
+/**
+ * Initialize os_dev as simulated bus device
+ *
+ * This can be passed as a parameter to os_dev_create() when creating os_dev
+ * object for simulated bus, however it's recommended to create devices using
+ * helper like bus_sim_dev_create().
+ *
+ * @param odev  Bus device object
+ * @param arg   Bus device configuration (struct bus_sim_dev_cfg)
+ */
+int
+bus_sim_dev_init_func(struct os_dev *odev, void *arg);
+
+/**
+ * Create simulated bus device
+ *
+ * @param name  Name of device
+ * @param dev   Device state object
+ * @param cfg   Configuration
+ */
+static inline int
+bus_sim_dev_create(const char *name, struct bus_sim_dev *dev,
+                   struct bus_sim_dev_cfg *cfg)
+{
+    struct os_dev *odev = (struct os_dev *)dev;
+
+    return os_dev_create(odev, name, OS_DEV_INIT_PRIMARY, 0,
+                         bus_sim_dev_init_func, cfg);
+}
+
+/**
+ * Create simulated bus node
+ *
+ * @param name  Name of node
+ * @param node  Node state object
+ * @param cfg   Configuration
+ * @param arg   Argument passed to node init callback
+ */
+static inline int
+bus_sim_node_create(const char *name, struct bus_sim_node *node,
+                    const struct bus_sim_node_cfg *cfg, void *arg)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct os_dev *odev = (struct os_dev *)node;
+
+    bnode->init_arg = arg;
+
+    return os_dev_create(odev, name, OS_DEV_INIT_PRIMARY, 1,
+                         bus_node_init_func, (void *)cfg);
+}
+
+/**
+ * Get simulated bus statistics
+ *
+ * Bus utilization can be calculated as busy_us / elapsed_us.
+ *
+ * @param bus    Bus device object
+ * @param stats  Statistics
+ */
+void
+bus_sim_get_stats(struct os_dev *bus, struct bus_sim_stats *stats);
+
+/**
+ * Reset simulated bus statistics
+ *
+ * @param bus  Bus device object
+ */
+void
+bus_sim_reset_stats(struct os_dev *bus);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HW_BUS_DRIVERS_BUS_SIM_H_ */
@@ -0,0 +1,268 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "defs/error.h"
+#include "bus/bus.h"
+#include "bus/bus_debug.h"
+#include "bus/drivers/bus_sim.h"
+
+static uint32_t
+bus_sim_xfer_usecs(struct bus_sim_dev *dev, uint16_t length)
+{
+    return dev->cfg.xfer_overhead_us +
+           (uint32_t)((uint64_t)length * 8 * 1000000 / dev->cfg.bitrate);
+}
+
+static void
+bus_sim_node_xfer(struct bus_sim_node *node, uint8_t *rbuf,
+                  const uint8_t *wbuf, uint16_t length)
+{
+    if (!node->mem_size) {
+        if (rbuf) {
+            memset(rbuf, 0xFF, length);
+        }
+        return;
+    }
+
+    if (wbuf) {
+        node->addr = wbuf[0] % node->mem_size;
+        while (--length) {
+            node->mem[node->addr] = *++wbuf;
+            node->addr = (node->addr + 1) % node->mem_size;
+        }
+    } else {
+        while (length--) {
+            *rbuf++ = node->mem[node->addr];
+            node->addr = (node->addr + 1) % node->mem_size;
+        }
+    }
+}
+
+static void
+bus_sim_stats_update(struct bus_sim_dev *dev, uint16_t length)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    dev->stats.xfers++;
+    dev->stats.bytes += length;
+    dev->stats.busy_us += bus_sim_xfer_usecs(dev, length);
+    OS_EXIT_CRITICAL(sr);
+}
+
+static int
+bus_sim_init_node(struct bus_dev *bdev, struct bus_node *bnode, void *arg)
+{
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+    struct bus_sim_node_cfg *cfg = arg;
+
+    BUS_DEBUG_POISON_NODE(node);
+
+    node->mem = cfg->mem;
+    node->mem_size = cfg->mem_size;
+    node->addr = 0;
+
+    return 0;
+}
+
+static int
+bus_sim_configure(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    BUS_DEBUG_VERIFY_DEV((struct bus_sim_dev *)bdev);
+    BUS_DEBUG_VERIFY_NODE((struct bus_sim_node *)bnode);
+
+    return 0;
+}
+
+static int
+bus_sim_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+             uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    /* Blocking transfer keeps calling task busy, just like PIO would */
+    os_cputime_delay_usecs(bus_sim_xfer_usecs(dev, length));
+
+    bus_sim_node_xfer(node, buf, NULL, length);
+    bus_sim_stats_update(dev, length);
+
+    return 0;
+}
+
+static int
+bus_sim_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
+              uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    os_cputime_delay_usecs(bus_sim_xfer_usecs(dev, length));
+
+    bus_sim_node_xfer(node, NULL, buf, length);
+    bus_sim_stats_update(dev, length);
+
+    return 0;
+}
+
+#if MYNEWT_VAL(BUS_ASYNC)
+static void
+bus_sim_timer_cb(void *arg)
+{
+    struct bus_sim_dev *dev = arg;
+    struct bus_sim_node *node = dev->xfer_node;
+
+    if (!node) {
+        return;
+    }
+
+    dev->xfer_node = NULL;
+
+    bus_sim_node_xfer(node, dev->xfer_rbuf, dev->xfer_wbuf, dev->xfer_length);
+    bus_sim_stats_update(dev, dev->xfer_length);
+
+    bus_dev_xfer_done(&dev->bdev, 0);
+}
+
+static int
+bus_sim_start_async(struct bus_sim_dev *dev, struct bus_sim_node *node,
+                    uint8_t *rbuf, const uint8_t *wbuf, uint16_t length)
+{
+    dev->xfer_node = node;
+    dev->xfer_rbuf = rbuf;
+    dev->xfer_wbuf = wbuf;
+    dev->xfer_length = length;
+
+    os_cputime_timer_relative(&dev->timer, bus_sim_xfer_usecs(dev, length));
+
+    return 0;
+}
+
+static int
+bus_sim_read_async(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+                   uint16_t length, uint16_t flags)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    return bus_sim_start_async(dev, node, buf, NULL, length);
+}
+
+static int
+bus_sim_write_async(struct bus_dev *bdev, struct bus_node *bnode,
+                    const uint8_t *buf, uint16_t length, uint16_t flags)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+    struct bus_sim_node *node = (struct bus_sim_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    return bus_sim_start_async(dev, node, NULL, buf, length);
+}
+
+static void
+bus_sim_abort_async(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bdev;
+
+    os_cputime_timer_stop(&dev->timer);
+    dev->xfer_node = NULL;
+}
+#endif
+
+static const struct bus_dev_ops bus_sim_ops = {
+    .init_node = bus_sim_init_node,
+    .configure = bus_sim_configure,
+    .read = bus_sim_read,
+    .write = bus_sim_write,
+#if MYNEWT_VAL(BUS_ASYNC)
+    .read_async = bus_sim_read_async,
+    .write_async = bus_sim_write_async,
+    .abort_async = bus_sim_abort_async,
+#endif
+};
+
+void
+bus_sim_get_stats(struct os_dev *bus, struct bus_sim_stats *stats)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bus;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = dev->stats;
+    stats->elapsed_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                                  dev->stats_start);
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+bus_sim_reset_stats(struct os_dev *bus)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)bus;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(dev);
+
+    OS_ENTER_CRITICAL(sr);
+    memset(&dev->stats, 0, sizeof(dev->stats));
+    dev->stats_start = os_cputime_get32();
+    OS_EXIT_CRITICAL(sr);
+}
+
+int
+bus_sim_dev_init_func(struct os_dev *odev, void *arg)
+{
+    struct bus_sim_dev *dev = (struct bus_sim_dev *)odev;
+    struct bus_sim_dev_cfg *cfg = arg;
+    int rc;
+
+    if (!cfg->bitrate) {
+        return SYS_EINVAL;
+    }
+
+    BUS_DEBUG_POISON_DEV(dev);
+
+    dev->cfg = *cfg;
+    dev->xfer_node = NULL;
+#if MYNEWT_VAL(BUS_ASYNC)
+    os_cputime_timer_init(&dev->timer, bus_sim_timer_cb, dev);
+#endif
+
+    bus_sim_reset_stats(odev);
+
+    rc = bus_dev_init_func(odev, (void *)&bus_sim_ops);
+    assert(rc == 0);
+
+    return 0;
+}
@@ -33,6 +33,13 @@ struct bus_spi_hal_dev {
     struct bus_spi_dev spi_dev;
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
     struct os_sem sem;
+#if MYNEWT_VAL(BUS_ASYNC)
+    /* Set while transfers are started by bus async task */
+    bool async_mode;
+    /* Node of non-blocking transfer in progress, NULL if none */
+    struct bus_spi_node *async_node;
+    uint16_t async_flags;
+#endif
 #endif
 };
 
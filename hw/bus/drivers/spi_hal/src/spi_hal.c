@@ -50,6 +50,22 @@ static void
 bus_spi_txrx_cb(void *arg, int len)
 {
     struct bus_spi_hal_dev *dev = arg;
+#if MYNEWT_VAL(BUS_ASYNC)
+    struct bus_spi_node *node = dev->async_node;
+
+    if (dev->async_mode) {
+        /* Late completion of aborted transfer */
+        if (!node) {
+            return;
+        }
+        dev->async_node = NULL;
+        if (!(dev->async_flags & BUS_F_NOSTOP)) {
+            hal_gpio_write(node->pin_cs, 1);
+        }
+        bus_dev_xfer_done(&dev->spi_dev.bdev, 0);
+        return;
+    }
+#endif
 
     os_sem_release(&dev->sem);
 }
@@ -145,6 +161,9 @@ bus_spi_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
     memset(buf, 0xFF, length);
 
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
+#if MYNEWT_VAL(BUS_ASYNC)
+    dev->async_mode = false;
+#endif
     rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, buf, buf, length);
     if (rc == 0) {
         os_sem_pend(&dev->sem, OS_TIMEOUT_NEVER);
@@ -176,6 +195,9 @@ bus_spi_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
     /* XXX update HAL to accept const instead */
 
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
+#if MYNEWT_VAL(BUS_ASYNC)
+    dev->async_mode = false;
+#endif
     rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, (uint8_t *)buf, NULL, length);
     if (rc == 0) {
         os_sem_pend(&dev->sem, OS_TIMEOUT_NEVER);
@@ -191,6 +213,75 @@ bus_spi_write(struct bus_dev *bdev, struct bus_node *bnode, const uint8_t *buf,
     return rc;
 }
 
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_ASYNC)
+static int
+bus_spi_txrx_async(struct bus_spi_hal_dev *dev, struct bus_spi_node *node,
+                   uint8_t *txbuf, uint8_t *rxbuf, uint16_t length,
+                   uint16_t flags)
+{
+    int rc;
+
+    hal_gpio_write(node->pin_cs, 0);
+
+    dev->async_mode = true;
+    dev->async_flags = flags;
+    dev->async_node = node;
+
+    rc = hal_spi_txrx_noblock(dev->spi_dev.cfg.spi_num, txbuf, rxbuf, length);
+    if (rc) {
+        dev->async_node = NULL;
+        hal_gpio_write(node->pin_cs, 1);
+        return SYS_EIO;
+    }
+
+    return 0;
+}
+
+static int
+bus_spi_read_async(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+                   uint16_t length, uint16_t flags)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    /* See bus_spi_read() */
+    memset(buf, 0xFF, length);
+
+    return bus_spi_txrx_async(dev, node, buf, buf, length, flags);
+}
+
+static int
+bus_spi_write_async(struct bus_dev *bdev, struct bus_node *bnode,
+                    const uint8_t *buf, uint16_t length, uint16_t flags)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+
+    BUS_DEBUG_VERIFY_DEV(&dev->spi_dev);
+    BUS_DEBUG_VERIFY_NODE(node);
+
+    return bus_spi_txrx_async(dev, node, (uint8_t *)buf, NULL, length, flags);
+}
+
+static void
+bus_spi_abort_async(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    struct bus_spi_hal_dev *dev = (struct bus_spi_hal_dev *)bdev;
+    struct bus_spi_node *node = (struct bus_spi_node *)bnode;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    dev->async_node = NULL;
+    hal_spi_abort(dev->spi_dev.cfg.spi_num);
+    OS_EXIT_CRITICAL(sr);
+
+    hal_gpio_write(node->pin_cs, 1);
+}
+#endif
+
 static int bus_spi_disable(struct bus_dev *bdev)
 {
     struct bus_spi_dev *spi_dev = (struct bus_spi_dev *)bdev;
@@ -213,6 +304,11 @@ static const struct bus_dev_ops bus_spi_ops = {
     .read = bus_spi_read,
     .write = bus_spi_write,
     .disable = bus_spi_disable,
+#if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK) && MYNEWT_VAL(BUS_ASYNC)
+    .read_async = bus_spi_read_async,
+    .write_async = bus_spi_write_async,
+    .abort_async = bus_spi_abort_async,
+#endif
 };
 
 int
@@ -241,6 +337,10 @@ bus_spi_hal_dev_init_func(struct os_dev *odev, void *arg)
 #if MYNEWT_VAL(SPI_HAL_USE_NOBLOCK)
     rc = os_sem_init(&dev->sem, 0);
     assert(rc == 0);
+#if MYNEWT_VAL(BUS_ASYNC)
+    dev->async_mode = false;
+    dev->async_node = NULL;
+#endif
 #endif
 
     rc = bus_dev_init_func(odev, (void*)&bus_spi_ops);
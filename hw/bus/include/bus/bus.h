@@ -24,6 +24,7 @@
 #include "os/os_dev.h"
 #include "os/os_mutex.h"
 #include "os/os_time.h"
+#include "os/queue.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -35,9 +36,39 @@ extern "C" {
 #define BUS_F_NONE          0
 #define BUS_F_NOSTOP        0x0001
 
+/**
+ * Operation types used in transaction lists
+ */
+#define BUS_OP_WRITE        0
+#define BUS_OP_READ         1
+
 /* Use as default timeout to lock node */
 #define BUS_NODE_LOCK_DEFAULT_TIMEOUT        ((os_time_t) -1)
 
+/**
+ * Single operation of transaction list
+ *
+ * Operations are executed one after another. Use BUS_F_NOSTOP in flags to
+ * keep node selected (i.e. CS asserted on SPI or no STOP condition on I2C)
+ * for next operation.
+ */
+struct bus_op {
+    /** Operation type, BUS_OP_WRITE or BUS_OP_READ */
+    uint8_t type;
+    /** Flags */
+    uint16_t flags;
+    /** Length of data to be written or read */
+    uint16_t length;
+    /** Delay after operation is completed [us], 0 for none */
+    uint32_t delay_us;
+    union {
+        /** Buffer with data to be written */
+        const void *wbuf;
+        /** Buffer to read data into */
+        void *rbuf;
+    };
+};
+
 /** Bus PM mode */
 typedef enum {
     /* Bus device enable/disable is controlled by application */
@@ -128,6 +159,32 @@ bus_node_write_read_transact(struct os_dev *node, const void  *wbuf,
                              uint16_t wlength, void *rbuf, uint16_t rlength,
                              os_time_t timeout, uint16_t flags);
 
+/**
+ * Execute transaction list on node
+ *
+ * Executes list of write and read operations with bus lock held during entire
+ * transaction, so the bus is locked and configured only once. This is intended
+ * for sequences like device configuration or FIFO drains which would otherwise
+ * require multiple transactions.
+ *
+ * All operations are verified before bus is locked, so invalid list is not
+ * executed partially. The list is invalid if it is empty, has an operation of
+ * unknown type, with unknown flags or without buffer, or if its last
+ * operation has BUS_F_NOSTOP set. Execution stops on first failed operation.
+ *
+ * The timeout parameter applies to each operation.
+ *
+ * @param node     Node device object
+ * @param ops      Operations to execute
+ * @param num_ops  Number of operations
+ * @param timeout  Operation timeout
+ *
+ * @return 0 on success, SYS_EINVAL if list is invalid, SYS_xxx on error
+ */
+int
+bus_node_transact(struct os_dev *node, const struct bus_op *ops,
+                  uint16_t num_ops, os_time_t timeout);
+
 /**
  * Read data from node
  *
@@ -265,6 +322,104 @@ int
 bus_dev_set_pm(struct os_dev *bus, bus_pm_mode_t pm_mode,
                union bus_pm_options *pm_opts);
 
+#if MYNEWT_VAL(BUS_ASYNC)
+
+struct bus_xfer;
+
+/**
+ * Asynchronous transaction completion callback
+ *
+ * Called from bus async task once transaction is completed, failed or timed
+ * out. Transaction object is not used by bus anymore when callback is called
+ * so it can be submitted again from callback.
+ *
+ * @param xfer    Transaction object
+ * @param status  0 on success, SYS_xxx on error
+ * @param arg     Callback argument as set in transaction object
+ */
+typedef void (*bus_xfer_cb_t)(struct bus_xfer *xfer, int status, void *arg);
+
+/**
+ * Asynchronous bus transaction
+ *
+ * Transaction is a write (wlength != 0), read (rlength != 0) or write-then-read
+ * (both set) executed on a node atomically, just like the corresponding
+ * blocking APIs. Object shall be zero-initialized before first use. Object
+ * shall be valid, and buffers shall not be accessed, until completion callback
+ * is called.
+ */
+struct bus_xfer {
+    /** Node device object */
+    struct os_dev *node;
+    /** Buffer with data to be written */
+    const void *wbuf;
+    /** Buffer to read data into */
+    void *rbuf;
+    /** Length of data to be written */
+    uint16_t wlength;
+    /** Length of data to be read */
+    uint16_t rlength;
+    /** Flags */
+    uint16_t flags;
+    /**
+     * Priority, lower value means higher priority. Transactions with the same
+     * priority are executed in order of submission.
+     */
+    uint8_t prio;
+    /** Operation timeout, counted since transaction is started on bus */
+    os_time_t timeout;
+    /** Completion callback */
+    bus_xfer_cb_t cb;
+    /** Completion callback argument */
+    void *cb_arg;
+
+    /* Internal state, managed by bus */
+    STAILQ_ENTRY(bus_xfer) next;
+    uint8_t state;
+};
+
+/**
+ * Submit asynchronous transaction
+ *
+ * Queues transaction on parent bus of node. Transactions are executed by bus
+ * async task in order of priority and completion callback is called when done.
+ * The bus is locked for the duration of each transaction so blocking and
+ * asynchronous APIs can be used on the same bus. While the bus is locked by
+ * another task, its queue waits until the bus is unlocked; queues of other
+ * buses are not affected.
+ *
+ * Bus drivers which support non-blocking transfers (e.g. DMA) do not block bus
+ * async task during transfer, so transactions on other buses are executed in
+ * parallel.
+ *
+ * @param xfer  Transaction object
+ *
+ * @return 0 on success
+ *         SYS_EINVAL if transaction is invalid
+ *         SYS_EBUSY if transaction is already queued or in progress
+ *         SYS_ENOTSUP if operation is not supported by bus driver
+ */
+int
+bus_xfer_submit(struct bus_xfer *xfer);
+
+/**
+ * Cancel asynchronous transaction
+ *
+ * Removes transaction from queue. Completion callback is not called for
+ * cancelled transaction. Transaction which was already started on bus cannot
+ * be cancelled.
+ *
+ * @param xfer  Transaction object
+ *
+ * @return 0 on success
+ *         SYS_EBUSY if transaction is in progress
+ *         SYS_ENOENT if transaction is not queued
+ */
+int
+bus_xfer_cancel(struct bus_xfer *xfer);
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -20,6 +20,7 @@
 #ifndef HW_BUS_DEBUG_H_
 #define HW_BUS_DEBUG_H_
 
+#include <stdint.h>
 #include "syscfg/syscfg.h"
 
 #ifdef __cplusplus
@@ -40,6 +41,48 @@ extern "C" {
 #define BUS_DEBUG_VERIFY_NODE(_node)    (void)(_node)
 #endif
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+struct os_dev;
+
+/**
+ * Bus lock timing statistics
+ *
+ * Wait time is measured from call to bus_node_lock() until the bus is locked,
+ * hold time is measured until the bus is unlocked. Nested locks are counted
+ * as a single lock.
+ */
+struct bus_debug_lock_stats {
+    /** Number of locks */
+    uint32_t locks;
+    /** Total time spent waiting for lock [us] */
+    uint32_t wait_total_us;
+    /** Longest time spent waiting for lock [us] */
+    uint32_t wait_max_us;
+    /** Total time bus was locked [us] */
+    uint32_t hold_total_us;
+    /** Longest time bus was locked [us] */
+    uint32_t hold_max_us;
+};
+
+/**
+ * Get lock timing statistics of bus device
+ *
+ * @param bus    Bus device object
+ * @param stats  Statistics
+ */
+void
+bus_debug_get_lock_stats(struct os_dev *bus,
+                         struct bus_debug_lock_stats *stats);
+
+/**
+ * Reset lock timing statistics of bus device
+ *
+ * @param bus  Bus device object
+ */
+void
+bus_debug_reset_lock_stats(struct os_dev *bus);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include "os/mynewt.h"
+#include "bus/bus_debug.h"
 #if MYNEWT_VAL(BUS_STATS)
 #include "stats/stats.h"
 #endif
@@ -63,6 +64,22 @@ struct bus_dev_ops {
                   uint16_t length, os_time_t timeout,  uint16_t flags);
     /* Disable bus device */
     int (* disable)(struct bus_dev *bus);
+#if MYNEWT_VAL(BUS_ASYNC)
+    /*
+     * Start non-blocking read from node, optional. Driver shall call
+     * bus_dev_xfer_done() once completed.
+     */
+    int (* read_async)(struct bus_dev *dev, struct bus_node *node, uint8_t *buf,
+                       uint16_t length, uint16_t flags);
+    /*
+     * Start non-blocking write to node, optional. Driver shall call
+     * bus_dev_xfer_done() once completed.
+     */
+    int (* write_async)(struct bus_dev *dev, struct bus_node *node,
+                        const uint8_t *buf, uint16_t length, uint16_t flags);
+    /* Abort non-blocking transfer in progress */
+    void (* abort_async)(struct bus_dev *dev, struct bus_node *node);
+#endif
 };
 
 /**
@@ -117,6 +134,22 @@ struct bus_dev {
 
     bool enabled;
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    struct bus_debug_lock_stats lock_stats;
+    uint32_t lock_acquired_at;
+#endif
+
+#if MYNEWT_VAL(BUS_ASYNC)
+    STAILQ_HEAD(, bus_xfer) xfer_q;
+    struct bus_xfer *xfer_cur;
+    struct os_event xfer_ev;
+    struct os_callout xfer_tmo;
+    int xfer_rc;
+    bool xfer_pending;
+    /* Async task waits for bus to be unlocked by another task */
+    bool xfer_lock_wait;
+#endif
+
 #if MYNEWT_VAL(BUS_DEBUG_OS_DEV)
     uint32_t devmagic;
 #endif
@@ -192,6 +225,20 @@ bus_node_init_func(struct os_dev *node, void *arg);
 void
 bus_node_set_callbacks(struct os_dev *node, struct bus_node_callbacks *cbs);
 
+#if MYNEWT_VAL(BUS_ASYNC)
+/**
+ * Notify completion of non-blocking transfer
+ *
+ * This shall be called by bus driver once transfer started by read_async or
+ * write_async operation is completed. It can be called from interrupt context.
+ *
+ * @param bus  Bus device object
+ * @param rc   0 on success, SYS_xxx on error
+ */
+void
+bus_dev_xfer_done(struct bus_dev *bus, int rc);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
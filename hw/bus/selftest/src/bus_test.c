@@ -0,0 +1,264 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "bus_test.h"
+
+struct bus_sim_dev bus_test_dev_a;
+struct bus_sim_dev bus_test_dev_b;
+struct bus_sim_node bus_test_node_a;
+struct bus_sim_node bus_test_node_b;
+
+static struct bus_dev bus_test_dev_err;
+struct bus_node bus_test_node_err;
+
+struct bus_dev bus_test_dev_rec;
+struct bus_node bus_test_node_rec;
+struct bus_test_rec bus_test_rec_ops[BUS_TEST_MAX_REC];
+int bus_test_rec_cnt;
+int bus_test_rec_fail_at;
+
+int bus_test_done_id[BUS_TEST_MAX_DONE];
+int bus_test_done_status[BUS_TEST_MAX_DONE];
+int bus_test_done_cnt;
+
+uint8_t bus_test_mem_a[BUS_TEST_MEM_SIZE];
+uint8_t bus_test_mem_b[BUS_TEST_MEM_SIZE];
+static uint8_t bus_test_wbuf[4] = { 0, 1, 2, 3 };
+
+static int
+bus_test_init_node(struct bus_dev *bdev, struct bus_node *bnode, void *arg)
+{
+    return 0;
+}
+
+static int
+bus_test_configure(struct bus_dev *bdev, struct bus_node *bnode)
+{
+    return 0;
+}
+
+static int
+bus_test_err_write(struct bus_dev *bdev, struct bus_node *bnode,
+                   const uint8_t *buf, uint16_t length, os_time_t timeout,
+                   uint16_t flags)
+{
+    return SYS_EIO;
+}
+
+/* Like a driver which sees a NACK right after starting the transfer. */
+static int
+bus_test_err_write_async(struct bus_dev *bdev, struct bus_node *bnode,
+                         const uint8_t *buf, uint16_t length, uint16_t flags)
+{
+    bus_dev_xfer_done(bdev, SYS_EIO);
+    return 0;
+}
+
+static const struct bus_dev_ops bus_test_err_ops = {
+    .init_node = bus_test_init_node,
+    .configure = bus_test_configure,
+    .write = bus_test_err_write,
+    .write_async = bus_test_err_write_async,
+};
+
+static int
+bus_test_rec_op(uint8_t type, uint16_t length, uint16_t flags)
+{
+    struct bus_test_rec *rec;
+    int idx;
+
+    idx = bus_test_rec_cnt++;
+    if (idx < BUS_TEST_MAX_REC) {
+        rec = &bus_test_rec_ops[idx];
+        rec->type = type;
+        rec->flags = flags;
+        rec->length = length;
+        rec->time = os_cputime_get32();
+    }
+
+    return idx == bus_test_rec_fail_at ? SYS_EIO : 0;
+}
+
+static int
+bus_test_rec_read(struct bus_dev *bdev, struct bus_node *bnode, uint8_t *buf,
+                  uint16_t length, os_time_t timeout, uint16_t flags)
+{
+    memset(buf, 0xa5, length);
+
+    return bus_test_rec_op(BUS_OP_READ, length, flags);
+}
+
+static int
+bus_test_rec_write(struct bus_dev *bdev, struct bus_node *bnode,
+                   const uint8_t *buf, uint16_t length, os_time_t timeout,
+                   uint16_t flags)
+{
+    return bus_test_rec_op(BUS_OP_WRITE, length, flags);
+}
+
+static const struct bus_dev_ops bus_test_rec_dev_ops = {
+    .init_node = bus_test_init_node,
+    .configure = bus_test_configure,
+    .read = bus_test_rec_read,
+    .write = bus_test_rec_write,
+};
+
+static void
+bus_test_cb(struct bus_xfer *xfer, int status, void *arg)
+{
+    if (bus_test_done_cnt < BUS_TEST_MAX_DONE) {
+        bus_test_done_id[bus_test_done_cnt] = (int)(intptr_t)arg;
+        bus_test_done_status[bus_test_done_cnt] = status;
+    }
+    bus_test_done_cnt++;
+}
+
+void
+bus_test_init(void)
+{
+    static struct bus_sim_dev_cfg dev_cfg = {
+        .bitrate = 1000000,
+        .xfer_overhead_us = 100,
+    };
+    static struct bus_sim_node_cfg node_a_cfg = {
+        .node_cfg.bus_name = "bus_test_a",
+        .mem = bus_test_mem_a,
+        .mem_size = sizeof(bus_test_mem_a),
+    };
+    static struct bus_sim_node_cfg node_b_cfg = {
+        .node_cfg.bus_name = "bus_test_b",
+        .mem = bus_test_mem_b,
+        .mem_size = sizeof(bus_test_mem_b),
+    };
+    static struct bus_node_cfg node_err_cfg = {
+        .bus_name = "bus_test_err",
+    };
+    static struct bus_node_cfg node_rec_cfg = {
+        .bus_name = "bus_test_rec",
+    };
+    static int created;
+    int rc;
+
+    /* The device list outlives sysinit; create devices only once. */
+    if (!created) {
+        /* Native BSP does not initialize cputime, bus_sim times with it. */
+        rc = os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = bus_sim_dev_create("bus_test_a", &bus_test_dev_a, &dev_cfg);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = bus_sim_dev_create("bus_test_b", &bus_test_dev_b, &dev_cfg);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = os_dev_create((struct os_dev *)&bus_test_dev_err, "bus_test_err",
+                           OS_DEV_INIT_PRIMARY, 0, bus_dev_init_func,
+                           (void *)&bus_test_err_ops);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = bus_sim_node_create("bus_test_node_a", &bus_test_node_a,
+                                 &node_a_cfg, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = bus_sim_node_create("bus_test_node_b", &bus_test_node_b,
+                                 &node_b_cfg, NULL);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = os_dev_create((struct os_dev *)&bus_test_node_err,
+                           "bus_test_node_err", OS_DEV_INIT_PRIMARY, 1,
+                           bus_node_init_func, &node_err_cfg);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = os_dev_create((struct os_dev *)&bus_test_dev_rec, "bus_test_rec",
+                           OS_DEV_INIT_PRIMARY, 0, bus_dev_init_func,
+                           (void *)&bus_test_rec_dev_ops);
+        TEST_ASSERT_FATAL(rc == 0);
+        rc = os_dev_create((struct os_dev *)&bus_test_node_rec,
+                           "bus_test_node_rec", OS_DEV_INIT_PRIMARY, 1,
+                           bus_node_init_func, &node_rec_cfg);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        created = 1;
+    }
+
+    bus_test_done_cnt = 0;
+    bus_test_rec_reset();
+}
+
+void
+bus_test_rec_reset(void)
+{
+    memset(bus_test_rec_ops, 0, sizeof(bus_test_rec_ops));
+    bus_test_rec_cnt = 0;
+    bus_test_rec_fail_at = -1;
+}
+
+/**
+ * Prepares a 4-byte write to node; id is reported by the completion
+ * callback.
+ */
+void
+bus_test_xfer_init(struct bus_xfer *xfer, struct os_dev *node, int id,
+                   uint8_t prio)
+{
+    memset(xfer, 0, sizeof(*xfer));
+    xfer->node = node;
+    xfer->wbuf = bus_test_wbuf;
+    xfer->wlength = sizeof(bus_test_wbuf);
+    xfer->prio = prio;
+    xfer->cb = bus_test_cb;
+    xfer->cb_arg = (void *)(intptr_t)id;
+}
+
+/**
+ * Waits up to 100 ms for cnt transactions to complete.  Returns the number
+ * of completed transactions.
+ */
+int
+bus_test_wait(int cnt)
+{
+    os_time_t end;
+
+    end = os_time_get() + os_time_ms_to_ticks32(100);
+    while (bus_test_done_cnt < cnt && OS_TIME_TICK_LT(os_time_get(), end)) {
+        os_time_delay(1);
+    }
+
+    return bus_test_done_cnt;
+}
+
+TEST_CASE_DECL(bus_test_async_queue)
+TEST_CASE_DECL(bus_test_transact_invalid)
+TEST_CASE_DECL(bus_test_transact_nostop)
+TEST_CASE_DECL(bus_test_transact_delay)
+TEST_CASE_DECL(bus_test_transact_lock)
+
+TEST_SUITE(bus_test_all)
+{
+    bus_test_async_queue();
+    bus_test_transact_invalid();
+    bus_test_transact_nostop();
+    bus_test_transact_delay();
+    bus_test_transact_lock();
+}
+
+int
+main(int argc, char **argv)
+{
+    bus_test_all();
+    return tu_any_failed;
+}
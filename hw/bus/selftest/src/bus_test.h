@@ -0,0 +1,81 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _BUS_TEST_H
+#define _BUS_TEST_H
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "bus/bus.h"
+#include "bus/bus_driver.h"
+#include "bus/drivers/bus_sim.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BUS_TEST_MAX_DONE   16
+#define BUS_TEST_MEM_SIZE   16
+#define BUS_TEST_MAX_REC    8
+
+/* Two simulated buses with one node each. */
+extern struct bus_sim_dev bus_test_dev_a;
+extern struct bus_sim_dev bus_test_dev_b;
+extern struct bus_sim_node bus_test_node_a;
+extern struct bus_sim_node bus_test_node_b;
+extern uint8_t bus_test_mem_a[BUS_TEST_MEM_SIZE];
+extern uint8_t bus_test_mem_b[BUS_TEST_MEM_SIZE];
+
+/* Node of a bus whose non-blocking write fails before it returns. */
+extern struct bus_node bus_test_node_err;
+
+/* Node of a bus which records operations instead of transferring data. */
+extern struct bus_node bus_test_node_rec;
+extern struct bus_dev bus_test_dev_rec;
+
+struct bus_test_rec {
+    uint8_t type;
+    uint16_t flags;
+    uint16_t length;
+    /* os_cputime when operation was started */
+    uint32_t time;
+};
+
+/* Operations seen by recording bus; failing one is recorded too. */
+extern struct bus_test_rec bus_test_rec_ops[BUS_TEST_MAX_REC];
+extern int bus_test_rec_cnt;
+/* Index of operation which fails with SYS_EIO, -1 for none. */
+extern int bus_test_rec_fail_at;
+
+/* Ids and status of completed transactions, in completion order. */
+extern int bus_test_done_id[BUS_TEST_MAX_DONE];
+extern int bus_test_done_status[BUS_TEST_MAX_DONE];
+extern int bus_test_done_cnt;
+
+void bus_test_init(void);
+void bus_test_rec_reset(void);
+void bus_test_xfer_init(struct bus_xfer *xfer, struct os_dev *node, int id,
+                        uint8_t prio);
+int bus_test_wait(int cnt);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _BUS_TEST_H */
@@ -0,0 +1,105 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "bus_test.h"
+
+#define BUS_TEST_ID_B   10
+#define BUS_TEST_ID_ERR 20
+
+/**
+ * Queued transactions run in order of priority once the bus is released by
+ * its blocking user, cancelled ones are never reported, a bus locked by
+ * another task does not stall the queue of another bus and an error reported
+ * by the driver while the transfer is being started is not lost.
+ */
+TEST_CASE_TASK(bus_test_async_queue)
+{
+    struct os_dev *node_a = (struct os_dev *)&bus_test_node_a;
+    struct os_dev *node_b = (struct os_dev *)&bus_test_node_b;
+    struct os_dev *node_err = (struct os_dev *)&bus_test_node_err;
+    struct bus_sim_stats stats;
+    struct bus_xfer xfer_a[4];
+    struct bus_xfer xfer_b;
+    struct bus_xfer xfer_err;
+    int rc;
+
+    bus_test_init();
+
+    /*** Bus A is held by this task; transactions wait in its queue. */
+    rc = bus_node_lock(node_a, BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    bus_test_xfer_init(&xfer_a[0], node_a, 0, 2);
+    bus_test_xfer_init(&xfer_a[1], node_a, 1, 1);
+    bus_test_xfer_init(&xfer_a[2], node_a, 2, 2);
+    bus_test_xfer_init(&xfer_a[3], node_a, 3, 2);
+    bus_sim_reset_stats((struct os_dev *)&bus_test_dev_a);
+
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_a[0]) == 0);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_a[1]) == 0);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_a[2]) == 0);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_a[3]) == 0);
+    TEST_ASSERT(bus_xfer_submit(&xfer_a[0]) == SYS_EBUSY);
+
+    /* Async task has seen the bus locked by now. */
+    TEST_ASSERT(bus_test_wait(1) == 0);
+
+    TEST_ASSERT(bus_xfer_cancel(&xfer_a[2]) == 0);
+    TEST_ASSERT(bus_xfer_cancel(&xfer_a[2]) == SYS_ENOENT);
+
+    /*** Bus B is served while bus A is locked. */
+    bus_test_xfer_init(&xfer_b, node_b, BUS_TEST_ID_B, 0);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_b) == 0);
+    TEST_ASSERT_FATAL(bus_test_wait(1) == 1);
+    TEST_ASSERT(bus_test_done_id[0] == BUS_TEST_ID_B);
+    TEST_ASSERT(bus_test_done_status[0] == 0);
+    /* Write of { 0, 1, 2, 3 } stores 1, 2, 3 at register 0. */
+    TEST_ASSERT(bus_test_mem_b[0] == 1);
+    TEST_ASSERT(bus_test_mem_b[1] == 2);
+    TEST_ASSERT(bus_test_mem_b[2] == 3);
+
+    /*** Releasing bus A kicks its queue: by priority, then FIFO. */
+    rc = bus_node_unlock(node_a);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    TEST_ASSERT_FATAL(bus_test_wait(4) == 4);
+    TEST_ASSERT(bus_test_done_id[1] == 1);
+    TEST_ASSERT(bus_test_done_id[2] == 0);
+    TEST_ASSERT(bus_test_done_id[3] == 3);
+    TEST_ASSERT(bus_test_done_status[1] == 0);
+    TEST_ASSERT(bus_test_done_status[2] == 0);
+    TEST_ASSERT(bus_test_done_status[3] == 0);
+
+    /* Cancelled transaction never reached the bus. */
+    bus_sim_get_stats((struct os_dev *)&bus_test_dev_a, &stats);
+    TEST_ASSERT(stats.xfers == 3);
+    TEST_ASSERT(bus_test_wait(5) == 4);
+
+    /* Completed transaction can be submitted again. */
+    TEST_ASSERT(bus_xfer_cancel(&xfer_a[1]) == SYS_ENOENT);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_a[1]) == 0);
+    TEST_ASSERT_FATAL(bus_test_wait(5) == 5);
+    TEST_ASSERT(bus_test_done_id[4] == 1);
+
+    /*** Error reported before write_async returns reaches the callback. */
+    bus_test_xfer_init(&xfer_err, node_err, BUS_TEST_ID_ERR, 0);
+    TEST_ASSERT_FATAL(bus_xfer_submit(&xfer_err) == 0);
+    TEST_ASSERT_FATAL(bus_test_wait(6) == 6);
+    TEST_ASSERT(bus_test_done_id[5] == BUS_TEST_ID_ERR);
+    TEST_ASSERT(bus_test_done_status[5] == SYS_EIO);
+}
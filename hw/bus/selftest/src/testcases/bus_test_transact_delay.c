@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "bus_test.h"
+
+#define BUS_TEST_DELAY_SHORT_US 500
+#define BUS_TEST_DELAY_LONG_US  25000
+
+/**
+ * Delay of an operation is made before the next operation starts; short
+ * delays are busy-waited and long ones sleep, both with the bus locked.
+ */
+TEST_CASE_TASK(bus_test_transact_delay)
+{
+    struct os_dev *node = (struct os_dev *)&bus_test_node_rec;
+    uint8_t buf[1] = { 0 };
+    struct bus_op ops[3];
+    uint32_t us;
+    int rc;
+
+    bus_test_init();
+
+    memset(ops, 0, sizeof(ops));
+    ops[0].type = BUS_OP_WRITE;
+    ops[0].length = sizeof(buf);
+    ops[0].wbuf = buf;
+    ops[0].delay_us = BUS_TEST_DELAY_SHORT_US;
+    ops[1].type = BUS_OP_WRITE;
+    ops[1].length = sizeof(buf);
+    ops[1].wbuf = buf;
+    ops[1].delay_us = BUS_TEST_DELAY_LONG_US;
+    ops[2].type = BUS_OP_READ;
+    ops[2].length = sizeof(buf);
+    ops[2].rbuf = buf;
+
+    rc = bus_node_transact(node, ops, 3, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(bus_test_rec_cnt == 3);
+
+    us = os_cputime_ticks_to_usecs(bus_test_rec_ops[1].time -
+                                   bus_test_rec_ops[0].time);
+    TEST_ASSERT(us >= BUS_TEST_DELAY_SHORT_US, "short delay %u us",
+                (unsigned)us);
+
+    us = os_cputime_ticks_to_usecs(bus_test_rec_ops[2].time -
+                                   bus_test_rec_ops[1].time);
+    TEST_ASSERT(us >= BUS_TEST_DELAY_LONG_US, "long delay %u us",
+                (unsigned)us);
+}
@@ -0,0 +1,79 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "bus_test.h"
+
+/**
+ * Empty and malformed transaction lists are rejected before the bus is
+ * locked, so no operation of an invalid list is executed.
+ */
+TEST_CASE_TASK(bus_test_transact_invalid)
+{
+    struct os_dev *node = (struct os_dev *)&bus_test_node_rec;
+    uint8_t buf[2] = { 0 };
+    struct bus_op ops[2];
+    int rc;
+
+    bus_test_init();
+
+    memset(ops, 0, sizeof(ops));
+    ops[0].type = BUS_OP_WRITE;
+    ops[0].length = sizeof(buf);
+    ops[0].wbuf = buf;
+    ops[1].type = BUS_OP_READ;
+    ops[1].length = sizeof(buf);
+    ops[1].rbuf = buf;
+
+    /*** Empty list */
+    rc = bus_node_transact(node, NULL, 0, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    rc = bus_node_transact(node, ops, 0, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    /*** Unknown operation type */
+    ops[1].type = 7;
+    rc = bus_node_transact(node, ops, 2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    ops[1].type = BUS_OP_READ;
+
+    /*** Missing buffer */
+    ops[1].rbuf = NULL;
+    rc = bus_node_transact(node, ops, 2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    ops[1].rbuf = buf;
+
+    /*** Unknown flags */
+    ops[0].flags = 0x8000;
+    rc = bus_node_transact(node, ops, 2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    ops[0].flags = BUS_F_NONE;
+
+    /*** Node left selected after last operation */
+    ops[1].flags = BUS_F_NOSTOP;
+    rc = bus_node_transact(node, ops, 2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EINVAL);
+    ops[1].flags = BUS_F_NONE;
+
+    /* Nothing reached the bus. */
+    TEST_ASSERT(bus_test_rec_cnt == 0);
+
+    /*** Valid list is executed. */
+    rc = bus_node_transact(node, ops, 2, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(bus_test_rec_cnt == 2);
+}
@@ -0,0 +1,72 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "bus_test.h"
+
+#define BUS_TEST_LOCK_OPS       4
+#define BUS_TEST_LOCK_DELAY_US  2000
+
+/**
+ * A transaction list locks the bus once for all its operations, and the
+ * lock is held for its delays too, while the same operations done one by
+ * one lock the bus once each.
+ */
+TEST_CASE_TASK(bus_test_transact_lock)
+{
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    struct os_dev *node = (struct os_dev *)&bus_test_node_rec;
+    struct os_dev *bus = (struct os_dev *)&bus_test_dev_rec;
+    struct bus_debug_lock_stats stats;
+    struct bus_op ops[BUS_TEST_LOCK_OPS];
+    uint8_t buf[2] = { 0 };
+    int rc;
+    int i;
+
+    bus_test_init();
+
+    memset(ops, 0, sizeof(ops));
+    for (i = 0; i < BUS_TEST_LOCK_OPS; i++) {
+        ops[i].type = BUS_OP_WRITE;
+        ops[i].length = sizeof(buf);
+        ops[i].wbuf = buf;
+        ops[i].delay_us = BUS_TEST_LOCK_DELAY_US;
+    }
+
+    bus_debug_reset_lock_stats(bus);
+    rc = bus_node_transact(node, ops, BUS_TEST_LOCK_OPS, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(bus_test_rec_cnt == BUS_TEST_LOCK_OPS);
+
+    bus_debug_get_lock_stats(bus, &stats);
+    TEST_ASSERT(stats.locks == 1, "locks %u", (unsigned)stats.locks);
+    TEST_ASSERT(stats.hold_max_us >=
+                BUS_TEST_LOCK_OPS * BUS_TEST_LOCK_DELAY_US,
+                "hold %u us", (unsigned)stats.hold_max_us);
+
+    /*** Same writes done one by one. */
+    bus_debug_reset_lock_stats(bus);
+    for (i = 0; i < BUS_TEST_LOCK_OPS; i++) {
+        rc = bus_node_simple_write(node, buf, sizeof(buf));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    bus_debug_get_lock_stats(bus, &stats);
+    TEST_ASSERT(stats.locks == BUS_TEST_LOCK_OPS, "locks %u",
+                (unsigned)stats.locks);
+#endif
+}
@@ -0,0 +1,77 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "bus_test.h"
+
+/**
+ * Operations are executed in list order with their flags, so BUS_F_NOSTOP
+ * chains a register address write with the read that follows it.  Execution
+ * stops at the first failed operation.
+ */
+TEST_CASE_TASK(bus_test_transact_nostop)
+{
+    struct os_dev *node_rec = (struct os_dev *)&bus_test_node_rec;
+    struct os_dev *node_a = (struct os_dev *)&bus_test_node_a;
+    uint8_t wbuf[3] = { 4, 0x11, 0x22 };
+    uint8_t addr = 4;
+    uint8_t rbuf[2];
+    struct bus_op ops[3];
+    int rc;
+
+    bus_test_init();
+
+    memset(ops, 0, sizeof(ops));
+    ops[0].type = BUS_OP_WRITE;
+    ops[0].length = sizeof(wbuf);
+    ops[0].wbuf = wbuf;
+    ops[1].type = BUS_OP_WRITE;
+    ops[1].flags = BUS_F_NOSTOP;
+    ops[1].length = 1;
+    ops[1].wbuf = &addr;
+    ops[2].type = BUS_OP_READ;
+    ops[2].length = sizeof(rbuf);
+    ops[2].rbuf = rbuf;
+
+    rc = bus_node_transact(node_rec, ops, 3, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(bus_test_rec_cnt == 3);
+    TEST_ASSERT(bus_test_rec_ops[0].type == BUS_OP_WRITE);
+    TEST_ASSERT(bus_test_rec_ops[0].flags == BUS_F_NONE);
+    TEST_ASSERT(bus_test_rec_ops[0].length == sizeof(wbuf));
+    TEST_ASSERT(bus_test_rec_ops[1].type == BUS_OP_WRITE);
+    TEST_ASSERT(bus_test_rec_ops[1].flags == BUS_F_NOSTOP);
+    TEST_ASSERT(bus_test_rec_ops[1].length == 1);
+    TEST_ASSERT(bus_test_rec_ops[2].type == BUS_OP_READ);
+    TEST_ASSERT(bus_test_rec_ops[2].flags == BUS_F_NONE);
+    TEST_ASSERT(bus_test_rec_ops[2].length == sizeof(rbuf));
+    TEST_ASSERT(rbuf[0] == 0xa5 && rbuf[1] == 0xa5);
+
+    /*** Same list on a register based node reads back what it wrote. */
+    memset(rbuf, 0, sizeof(rbuf));
+    rc = bus_node_transact(node_a, ops, 3, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(rbuf[0] == 0x11);
+    TEST_ASSERT(rbuf[1] == 0x22);
+
+    /*** Failed operation ends the transaction. */
+    bus_test_rec_reset();
+    bus_test_rec_fail_at = 1;
+    rc = bus_node_transact(node_rec, ops, 3, OS_TIMEOUT_NEVER);
+    TEST_ASSERT(rc == SYS_EIO);
+    TEST_ASSERT(bus_test_rec_cnt == 2);
+}
@@ -29,6 +29,21 @@
 
 static os_time_t g_bus_node_lock_timeout;
 
+#if MYNEWT_VAL(BUS_ASYNC)
+#define BUS_XFER_S_IDLE     0
+#define BUS_XFER_S_QUEUED   1
+#define BUS_XFER_S_WRITE    2
+#define BUS_XFER_S_READ     3
+
+static struct os_task g_bus_async_task;
+static struct os_eventq g_bus_async_evq;
+static os_stack_t g_bus_async_stack[OS_STACK_ALIGN(MYNEWT_VAL(BUS_ASYNC_TASK_STACK_SIZE))];
+
+static void bus_async_ev_func(struct os_event *ev);
+static void bus_async_tmo_func(struct os_event *ev);
+static void bus_async_lock_released(struct bus_dev *bdev);
+#endif
+
 #if MYNEWT_VAL(BUS_STATS)
 STATS_NAME_START(bus_stats_section)
     STATS_NAME(bus_stats_section, lock_timeouts)
@@ -56,6 +71,66 @@ STATS_NAME_END(bus_stats_section)
     } while (0)
 #endif
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+static void
+bus_debug_lock_acquired(struct bus_dev *bdev, uint32_t wait_start)
+{
+    struct bus_debug_lock_stats *stats = &bdev->lock_stats;
+    uint32_t wait_us;
+
+    bdev->lock_acquired_at = os_cputime_get32();
+    wait_us = os_cputime_ticks_to_usecs(bdev->lock_acquired_at - wait_start);
+
+    stats->locks++;
+    stats->wait_total_us += wait_us;
+    if (wait_us > stats->wait_max_us) {
+        stats->wait_max_us = wait_us;
+    }
+}
+
+static void
+bus_debug_lock_released(struct bus_dev *bdev)
+{
+    struct bus_debug_lock_stats *stats = &bdev->lock_stats;
+    uint32_t hold_us;
+
+    hold_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                        bdev->lock_acquired_at);
+
+    stats->hold_total_us += hold_us;
+    if (hold_us > stats->hold_max_us) {
+        stats->hold_max_us = hold_us;
+    }
+}
+
+void
+bus_debug_get_lock_stats(struct os_dev *bus,
+                         struct bus_debug_lock_stats *stats)
+{
+    struct bus_dev *bdev = (struct bus_dev *)bus;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+
+    OS_ENTER_CRITICAL(sr);
+    *stats = bdev->lock_stats;
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+bus_debug_reset_lock_stats(struct os_dev *bus)
+{
+    struct bus_dev *bdev = (struct bus_dev *)bus;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+
+    OS_ENTER_CRITICAL(sr);
+    memset(&bdev->lock_stats, 0, sizeof(bdev->lock_stats));
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
+
 static inline void
 bus_dev_enable(struct bus_dev *bdev)
 {
@@ -234,12 +309,26 @@ bus_dev_init_func(struct os_dev *odev, void *arg)
     bdev->configured_for = NULL;
 
     os_mutex_init(&bdev->lock);
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    memset(&bdev->lock_stats, 0, sizeof(bdev->lock_stats));
+#endif
 #if MYNEWT_VAL(BUS_PM)
     /* XXX allow custom eventq */
     os_callout_init(&bdev->inactivity_tmo, os_eventq_dflt_get(),
                     bus_dev_inactivity_tmo_func, odev);
 #endif
 
+#if MYNEWT_VAL(BUS_ASYNC)
+    STAILQ_INIT(&bdev->xfer_q);
+    bdev->xfer_cur = NULL;
+    bdev->xfer_pending = false;
+    bdev->xfer_lock_wait = false;
+    bdev->xfer_ev.ev_cb = bus_async_ev_func;
+    bdev->xfer_ev.ev_arg = bdev;
+    os_callout_init(&bdev->xfer_tmo, &g_bus_async_evq, bus_async_tmo_func,
+                    bdev);
+#endif
+
 #if MYNEWT_VAL(BUS_STATS)
     asprintf(&stats_name, "bd_%s", odev->od_name);
     /* XXX should we assert or return error on failure? */
@@ -439,30 +528,151 @@ done:
     return rc;
 }
 
+static void
+bus_delay_us(uint32_t delay_us)
+{
+    os_time_t ticks;
+
+    /* Busy-wait for short delays, otherwise let other tasks run */
+    if (delay_us < 1000000 / OS_TICKS_PER_SEC) {
+        os_cputime_delay_usecs(delay_us);
+    } else {
+        ticks = ((uint64_t)delay_us * OS_TICKS_PER_SEC + 999999) / 1000000;
+        os_time_delay(ticks);
+    }
+}
 
 int
-bus_node_lock(struct os_dev *node, os_time_t timeout)
+bus_node_transact(struct os_dev *node, const struct bus_op *ops,
+                  uint16_t num_ops, os_time_t timeout)
 {
     struct bus_node *bnode = (struct bus_node *)node;
     struct bus_dev *bdev = bnode->parent_bus;
+    const struct bus_op *op;
+    int rc;
+    int i;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (!ops || !num_ops) {
+        return SYS_EINVAL;
+    }
+
+    /* Last operation shall not leave node selected after bus is unlocked */
+    if (ops[num_ops - 1].flags & BUS_F_NOSTOP) {
+        return SYS_EINVAL;
+    }
+
+    for (i = 0; i < num_ops; i++) {
+        if ((ops[i].flags & ~BUS_F_NOSTOP) ||
+            (ops[i].length && !ops[i].wbuf)) {
+            return SYS_EINVAL;
+        }
+
+        switch (ops[i].type) {
+        case BUS_OP_WRITE:
+            if (!bdev->dops->write) {
+                return SYS_ENOTSUP;
+            }
+            break;
+        case BUS_OP_READ:
+            if (!bdev->dops->read) {
+                return SYS_ENOTSUP;
+            }
+            break;
+        default:
+            return SYS_EINVAL;
+        }
+    }
+
+    rc = bus_node_lock(node, bus_node_get_lock_timeout(node));
+    if (rc) {
+        return rc;
+    }
+
+    if (!bdev->enabled) {
+        rc = SYS_EIO;
+        goto done;
+    }
+
+    for (i = 0; i < num_ops; i++) {
+        op = &ops[i];
+
+        if (op->type == BUS_OP_WRITE) {
+            BUS_STATS_INC(bdev, bnode, write_ops);
+            rc = bdev->dops->write(bdev, bnode, op->wbuf, op->length, timeout,
+                                   op->flags);
+            if (rc) {
+                BUS_STATS_INC(bdev, bnode, write_errors);
+                goto done;
+            }
+        } else {
+            BUS_STATS_INC(bdev, bnode, read_ops);
+            rc = bdev->dops->read(bdev, bnode, op->rbuf, op->length, timeout,
+                                  op->flags);
+            if (rc) {
+                BUS_STATS_INC(bdev, bnode, read_errors);
+                goto done;
+            }
+        }
+
+        if (op->delay_us) {
+            bus_delay_us(op->delay_us);
+        }
+    }
+
+done:
+    (void)bus_node_unlock(node);
+
+    return rc;
+}
+
+/*
+ * Locks bus for node.  With try set, does not wait if bus is locked by another
+ * task and returns SYS_EAGAIN instead; this is not counted as lock timeout.
+ */
+static int
+bus_node_lock_internal(struct os_dev *node, os_time_t timeout, bool try)
+{
+    struct bus_node *bnode = (struct bus_node *)node;
+    struct bus_dev *bdev = bnode->parent_bus;
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    uint32_t wait_start;
+#endif
     os_error_t err;
     int rc;
 
     BUS_DEBUG_VERIFY_DEV(bdev);
     BUS_DEBUG_VERIFY_NODE(bnode);
 
-    if (timeout == BUS_NODE_LOCK_DEFAULT_TIMEOUT) {
+    if (try) {
+        timeout = 0;
+    } else if (timeout == BUS_NODE_LOCK_DEFAULT_TIMEOUT) {
         timeout = g_bus_node_lock_timeout;
     }
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    wait_start = os_cputime_get32();
+#endif
+
     err = os_mutex_pend(&bdev->lock, timeout);
     if (err == OS_TIMEOUT) {
+        if (try) {
+            return SYS_EAGAIN;
+        }
         BUS_STATS_INC(bdev, bnode, lock_timeouts);
         return SYS_ETIMEOUT;
     }
 
     assert(err == OS_OK || err == OS_NOT_STARTED);
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_debug_lock_acquired(bdev, wait_start);
+    }
+#endif
+
 #if MYNEWT_VAL(BUS_PM)
     /* In auto PM we need to enable bus device on first lock */
     if ((bdev->pm_mode == BUS_PM_MODE_AUTO) &&
@@ -498,6 +708,12 @@ bus_node_lock(struct os_dev *node, os_time_t timeout)
     return rc;
 }
 
+int
+bus_node_lock(struct os_dev *node, os_time_t timeout)
+{
+    return bus_node_lock_internal(node, timeout, false);
+}
+
 int
 bus_node_unlock(struct os_dev *node)
 {
@@ -521,6 +737,12 @@ bus_node_unlock(struct os_dev *node)
     }
 #endif
 
+#if MYNEWT_VAL(BUS_DEBUG_LOCK_TIMING)
+    if (os_mutex_get_level(&bdev->lock) == 1) {
+        bus_debug_lock_released(bdev);
+    }
+#endif
+
     err = os_mutex_release(&bdev->lock);
 
     /*
@@ -532,6 +754,10 @@ bus_node_unlock(struct os_dev *node)
      */
     assert(err == OS_OK || err == OS_NOT_STARTED);
 
+#if MYNEWT_VAL(BUS_ASYNC)
+    bus_async_lock_released(bdev);
+#endif
+
     return 0;
 }
 
@@ -572,12 +798,360 @@ bus_dev_set_pm(struct os_dev *bus, bus_pm_mode_t pm_mode,
 #endif
 }
 
+#if MYNEWT_VAL(BUS_ASYNC)
+static void
+bus_async_complete(struct bus_dev *bdev, struct bus_xfer *xfer, int rc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    bdev->xfer_cur = NULL;
+    xfer->state = BUS_XFER_S_IDLE;
+    OS_EXIT_CRITICAL(sr);
+
+    xfer->cb(xfer, rc, xfer->cb_arg);
+}
+
+/*
+ * Starts current phase of transaction. If driver supports non-blocking
+ * transfers, completion is notified with bus_dev_xfer_done(), otherwise
+ * transfer is done here and result is stored immediately.
+ */
+static void
+bus_async_start(struct bus_dev *bdev, struct bus_xfer *xfer)
+{
+    struct bus_node *bnode = (struct bus_node *)xfer->node;
+    os_time_t timeout;
+    uint16_t flags;
+    bool arm_tmo;
+    bool async;
+    os_sr_t sr;
+    int rc;
+
+    if (xfer->timeout) {
+        timeout = xfer->timeout;
+    } else {
+        timeout = os_time_ms_to_ticks32(MYNEWT_VAL(BUS_DEFAULT_TRANSACTION_TIMEOUT_MS));
+    }
+
+    if (xfer->state == BUS_XFER_S_WRITE) {
+        /* See bus_node_write_read_transact() regarding flags */
+        flags = xfer->rlength ? BUS_F_NOSTOP : xfer->flags;
+
+        BUS_STATS_INC(bdev, bnode, write_ops);
+        async = bdev->dops->write_async != NULL;
+        if (async) {
+            bdev->xfer_pending = true;
+            rc = bdev->dops->write_async(bdev, bnode, xfer->wbuf,
+                                         xfer->wlength, flags);
+        } else {
+            rc = bdev->dops->write(bdev, bnode, xfer->wbuf, xfer->wlength,
+                                   timeout, flags);
+        }
+    } else {
+        BUS_STATS_INC(bdev, bnode, read_ops);
+        async = bdev->dops->read_async != NULL;
+        if (async) {
+            bdev->xfer_pending = true;
+            rc = bdev->dops->read_async(bdev, bnode, xfer->rbuf, xfer->rlength,
+                                        xfer->flags);
+        } else {
+            rc = bdev->dops->read(bdev, bnode, xfer->rbuf, xfer->rlength,
+                                  timeout, xfer->flags);
+        }
+    }
+
+    if (!async) {
+        bdev->xfer_rc = rc;
+        return;
+    }
+
+    /*
+     * Driver may have already completed transfer with bus_dev_xfer_done(),
+     * from this call or from an interrupt, and its result shall not be
+     * overwritten.
+     */
+    arm_tmo = false;
+    OS_ENTER_CRITICAL(sr);
+    if (bdev->xfer_pending) {
+        if (rc) {
+            bdev->xfer_pending = false;
+            bdev->xfer_rc = rc;
+        } else {
+            /* Transfer can be only timed out if driver is able to abort it */
+            arm_tmo = bdev->dops->abort_async != NULL;
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    if (arm_tmo) {
+        os_callout_reset(&bdev->xfer_tmo, timeout);
+    }
+}
+
+/*
+ * Inserts transaction into bus queue, sorted by priority.  Transaction goes
+ * after others with the same priority, or before them if first is set.
+ * Shall be called with interrupts disabled.
+ */
+static void
+bus_async_enqueue(struct bus_dev *bdev, struct bus_xfer *xfer, bool first)
+{
+    struct bus_xfer *prev;
+    struct bus_xfer *cur;
+
+    prev = NULL;
+    STAILQ_FOREACH(cur, &bdev->xfer_q, next) {
+        if ((cur->prio > xfer->prio) || (first && (cur->prio == xfer->prio))) {
+            break;
+        }
+        prev = cur;
+    }
+    if (prev) {
+        STAILQ_INSERT_AFTER(&bdev->xfer_q, prev, xfer, next);
+    } else {
+        STAILQ_INSERT_HEAD(&bdev->xfer_q, xfer, next);
+    }
+    xfer->state = BUS_XFER_S_QUEUED;
+}
+
+static void
+bus_async_run(struct bus_dev *bdev)
+{
+    struct bus_xfer *xfer;
+    os_sr_t sr;
+    int rc;
+
+    while (1) {
+        xfer = bdev->xfer_cur;
+        if (xfer) {
+            /* Wait for driver to notify completion */
+            if (bdev->xfer_pending) {
+                return;
+            }
+
+            os_callout_stop(&bdev->xfer_tmo);
+
+            rc = bdev->xfer_rc;
+            if (rc) {
+                if (xfer->state == BUS_XFER_S_WRITE) {
+                    BUS_STATS_INC(bdev, (struct bus_node *)xfer->node,
+                                  write_errors);
+                } else {
+                    BUS_STATS_INC(bdev, (struct bus_node *)xfer->node,
+                                  read_errors);
+                }
+            } else if ((xfer->state == BUS_XFER_S_WRITE) && xfer->rlength) {
+                xfer->state = BUS_XFER_S_READ;
+                bus_async_start(bdev, xfer);
+                continue;
+            }
+
+            (void)bus_node_unlock(xfer->node);
+            bus_async_complete(bdev, xfer, rc);
+            continue;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        xfer = STAILQ_FIRST(&bdev->xfer_q);
+        if (xfer) {
+            STAILQ_REMOVE_HEAD(&bdev->xfer_q, next);
+            xfer->state = xfer->wlength ? BUS_XFER_S_WRITE : BUS_XFER_S_READ;
+            bdev->xfer_cur = xfer;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (!xfer) {
+            return;
+        }
+
+        /*
+         * Do not wait for bus locked by another task as this would also stall
+         * queues of other buses.  Transaction goes back to queue and queue is
+         * kicked again by bus_node_unlock().  Flag is set before trying so
+         * unlock done in between is not missed.
+         */
+        OS_ENTER_CRITICAL(sr);
+        bdev->xfer_lock_wait = true;
+        OS_EXIT_CRITICAL(sr);
+
+        rc = bus_node_lock_internal(xfer->node, 0, true);
+        if (rc == SYS_EAGAIN) {
+            OS_ENTER_CRITICAL(sr);
+            bdev->xfer_cur = NULL;
+            bus_async_enqueue(bdev, xfer, true);
+            OS_EXIT_CRITICAL(sr);
+            return;
+        }
+
+        OS_ENTER_CRITICAL(sr);
+        bdev->xfer_lock_wait = false;
+        OS_EXIT_CRITICAL(sr);
+
+        if (rc == 0 && !bdev->enabled) {
+            (void)bus_node_unlock(xfer->node);
+            rc = SYS_EIO;
+        }
+        if (rc) {
+            bus_async_complete(bdev, xfer, rc);
+            continue;
+        }
+
+        bus_async_start(bdev, xfer);
+    }
+}
+
+static void
+bus_async_ev_func(struct os_event *ev)
+{
+    bus_async_run(ev->ev_arg);
+}
+
+static void
+bus_async_tmo_func(struct os_event *ev)
+{
+    struct bus_dev *bdev = ev->ev_arg;
+    struct bus_xfer *xfer = bdev->xfer_cur;
+
+    if (!xfer || !bdev->xfer_pending) {
+        return;
+    }
+
+    bdev->dops->abort_async(bdev, (struct bus_node *)xfer->node);
+    bus_dev_xfer_done(bdev, SYS_ETIMEOUT);
+}
+
+void
+bus_dev_xfer_done(struct bus_dev *bdev, int rc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    /* Transfer may have been already timed out */
+    if (!bdev->xfer_pending) {
+        OS_EXIT_CRITICAL(sr);
+        return;
+    }
+    bdev->xfer_rc = rc;
+    bdev->xfer_pending = false;
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&g_bus_async_evq, &bdev->xfer_ev);
+}
+
+static void
+bus_async_lock_released(struct bus_dev *bdev)
+{
+    bool kick;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    kick = bdev->xfer_lock_wait;
+    bdev->xfer_lock_wait = false;
+    OS_EXIT_CRITICAL(sr);
+
+    if (kick) {
+        os_eventq_put(&g_bus_async_evq, &bdev->xfer_ev);
+    }
+}
+
+int
+bus_xfer_submit(struct bus_xfer *xfer)
+{
+    struct bus_node *bnode = (struct bus_node *)xfer->node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    bool kick;
+    os_sr_t sr;
+
+    BUS_DEBUG_VERIFY_DEV(bdev);
+    BUS_DEBUG_VERIFY_NODE(bnode);
+
+    if (!xfer->cb || (!xfer->wlength && !xfer->rlength)) {
+        return SYS_EINVAL;
+    }
+
+    if ((xfer->wlength && !bdev->dops->write) ||
+        (xfer->rlength && !bdev->dops->read)) {
+        return SYS_ENOTSUP;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (xfer->state != BUS_XFER_S_IDLE) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+
+    /* Keep queue sorted by priority, FIFO within the same priority */
+    bus_async_enqueue(bdev, xfer, false);
+
+    kick = (bdev->xfer_cur == NULL);
+
+    OS_EXIT_CRITICAL(sr);
+
+    if (kick) {
+        os_eventq_put(&g_bus_async_evq, &bdev->xfer_ev);
+    }
+
+    return 0;
+}
+
+int
+bus_xfer_cancel(struct bus_xfer *xfer)
+{
+    struct bus_node *bnode = (struct bus_node *)xfer->node;
+    struct bus_dev *bdev = bnode->parent_bus;
+    os_sr_t sr;
+    int rc;
+
+    OS_ENTER_CRITICAL(sr);
+
+    switch (xfer->state) {
+    case BUS_XFER_S_IDLE:
+        rc = SYS_ENOENT;
+        break;
+    case BUS_XFER_S_QUEUED:
+        STAILQ_REMOVE(&bdev->xfer_q, xfer, bus_xfer, next);
+        xfer->state = BUS_XFER_S_IDLE;
+        rc = 0;
+        break;
+    default:
+        rc = SYS_EBUSY;
+        break;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+static void
+bus_async_task_func(void *arg)
+{
+    while (1) {
+        os_eventq_run(&g_bus_async_evq);
+    }
+}
+#endif
+
 void
 bus_pkg_init(void)
 {
     uint32_t lock_timeout_ms;
+#if MYNEWT_VAL(BUS_ASYNC)
+    int rc;
+#endif
 
     lock_timeout_ms = MYNEWT_VAL(BUS_DEFAULT_LOCK_TIMEOUT_MS);
 
     g_bus_node_lock_timeout = os_time_ms_to_ticks32(lock_timeout_ms);
+
+#if MYNEWT_VAL(BUS_ASYNC)
+    os_eventq_init(&g_bus_async_evq);
+    rc = os_task_init(&g_bus_async_task, "bus_async", bus_async_task_func,
+                      NULL, MYNEWT_VAL(BUS_ASYNC_TASK_PRIO), OS_WAIT_FOREVER,
+                      g_bus_async_stack,
+                      MYNEWT_VAL(BUS_ASYNC_TASK_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
 }
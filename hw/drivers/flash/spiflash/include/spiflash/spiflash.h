@@ -72,6 +72,25 @@ struct spiflash_dev {
 #if MYNEWT_VAL(OS_SCHEDULING)
     struct os_mutex lock;
 #endif
+#if MYNEWT_VAL(OS_SCHEDULING) && \
+    (MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND) || MYNEWT_VAL(SPIFLASH_BG_ERASE))
+    bool erase_in_progress;         /* Erase issued and not yet completed */
+    int *erase_result;              /* Result of erase for its issuer */
+    uint32_t erase_addr;            /* Area being erased */
+    uint32_t erase_size;
+    uint32_t erase_start;           /* Erase start time (cputime) */
+    uint32_t erase_max_us;          /* Maximum erase time */
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    uint32_t erase_resumed_at;      /* Last erase resume time (cputime) */
+#endif
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    struct os_callout bg_erase_co;
+    /* Sectors known to be erased */
+    uint8_t erased_map[(MYNEWT_VAL(SPIFLASH_SECTOR_COUNT) + 7) / 8];
+    /* Sectors to be erased in background */
+    uint8_t bg_erase_map[(MYNEWT_VAL(SPIFLASH_SECTOR_COUNT) + 7) / 8];
+#endif
+#endif
 #if MYNEWT_VAL(SPIFLASH_AUTO_POWER_DOWN)
 #if MYNEWT_VAL(OS_SCHEDULING)
     struct os_callout apd_tmo_co;   /* Auto power down timeout callout */
@@ -147,6 +166,23 @@ int spiflash_block_64k_erase(struct spiflash_dev *dev, uint32_t addr);
 int spiflash_chip_erase(struct spiflash_dev *dev);
 int spiflash_erase(struct spiflash_dev *dev, uint32_t addr, uint32_t size);
 
+/**
+ * Request erase of area in background.
+ *
+ * Intended for areas which are known to be free (e.g. reported by file
+ * system), so they are erased before they are needed. Only sectors which are
+ * entirely within area are erased. Writing to a sector cancels its background
+ * erase.
+ *
+ * @param dev   Flash device
+ * @param addr  Area start address
+ * @param size  Area size
+ *
+ * @return 0 on success, -1 if background erase is not supported
+ */
+int spiflash_erase_background(struct spiflash_dev *dev, uint32_t addr,
+                              uint32_t size);
+
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
 int spiflash_create_spi_dev(struct bus_spi_node *node, const char *name,
                             const struct bus_spi_node_cfg *spi_cfg);
@@ -0,0 +1,135 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "spiflash_test.h"
+
+/* Below the test task, so erase runs only while the test task waits. */
+#define SPIFLASH_TEST_ERASER_PRIO   (OS_MAIN_TASK_PRIO + 3)
+
+static struct os_task spiflash_test_eraser;
+static os_stack_t spiflash_test_eraser_stack[OS_STACK_ALIGN(512)];
+static struct os_sem spiflash_test_start_sem;
+static struct os_sem spiflash_test_done_sem;
+static uint32_t spiflash_test_erase_addr;
+static int spiflash_test_erase_rc;
+
+static void
+spiflash_test_eraser_func(void *arg)
+{
+    while (1) {
+        os_sem_pend(&spiflash_test_start_sem, OS_TIMEOUT_NEVER);
+        spiflash_test_erase_rc = spiflash_sector_erase(&spiflash_dev,
+                                                       spiflash_test_erase_addr);
+        os_sem_release(&spiflash_test_done_sem);
+    }
+}
+
+/**
+ * Resets the simulated chip to all zeroes and (re)initializes the driver and
+ * the eraser task.
+ */
+void
+spiflash_test_init(void)
+{
+    int rc;
+
+    spiflash_test_chip_reset();
+
+    /* Native BSP does not start cputime, driver waits need it */
+    rc = os_cputime_init(MYNEWT_VAL(OS_CPUTIME_FREQ));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    spiflash_dev.ready = false;
+    spiflash_dev.erase_in_progress = false;
+    spiflash_dev.erase_result = NULL;
+    memset(spiflash_dev.erased_map, 0, sizeof(spiflash_dev.erased_map));
+    memset(spiflash_dev.bg_erase_map, 0, sizeof(spiflash_dev.bg_erase_map));
+
+    rc = spiflash_dev.hal.hf_itf->hff_init(&spiflash_dev.hal);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT_FATAL(spiflash_test_chip.errors == 0);
+
+    os_sem_init(&spiflash_test_start_sem, 0);
+    os_sem_init(&spiflash_test_done_sem, 0);
+    rc = os_task_init(&spiflash_test_eraser, "eraser",
+                      spiflash_test_eraser_func, NULL,
+                      SPIFLASH_TEST_ERASER_PRIO, OS_WAIT_FOREVER,
+                      spiflash_test_eraser_stack,
+                      OS_STACK_ALIGN(512));
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Makes the eraser task erase sector at addr.
+ */
+void
+spiflash_test_erase_start(uint32_t addr)
+{
+    spiflash_test_erase_addr = addr;
+    os_sem_release(&spiflash_test_start_sem);
+}
+
+/**
+ * Waits up to 1 s for erase started by spiflash_test_erase_start().
+ * Returns 0 and its result in rc if it completed.
+ */
+int
+spiflash_test_erase_wait(int *rc)
+{
+    if (os_sem_pend(&spiflash_test_done_sem, OS_TICKS_PER_SEC) != OS_OK) {
+        return -1;
+    }
+    *rc = spiflash_test_erase_rc;
+
+    return 0;
+}
+
+bool
+spiflash_test_erased(uint32_t addr, uint32_t size)
+{
+    uint32_t i;
+
+    for (i = addr; i < addr + size; i++) {
+        if (spiflash_test_chip.mem[i] != 0xFF) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+TEST_CASE_DECL(spiflash_test_erase_suspend)
+TEST_CASE_DECL(spiflash_test_erase_overlap)
+TEST_CASE_DECL(spiflash_test_erase_waiters)
+
+TEST_SUITE(spiflash_test_all)
+{
+    spiflash_test_erase_suspend();
+    spiflash_test_erase_overlap();
+    spiflash_test_erase_waiters();
+}
+
+int
+main(int argc, char **argv)
+{
+    spiflash_test_all();
+    return tu_any_failed;
+}
@@ -0,0 +1,70 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _SPIFLASH_TEST_H
+#define _SPIFLASH_TEST_H
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "spiflash/spiflash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPIFLASH_TEST_SECTOR_SIZE   MYNEWT_VAL(SPIFLASH_SECTOR_SIZE)
+#define SPIFLASH_TEST_SIZE          (MYNEWT_VAL(SPIFLASH_SECTOR_COUNT) * \
+                                     SPIFLASH_TEST_SECTOR_SIZE)
+
+/*
+ * Simulated flash chip behind hal_spi.  Erase is not completed until
+ * spiflash_test_chip_erase_done() is called.
+ */
+struct spiflash_test_chip {
+    uint8_t mem[SPIFLASH_TEST_SIZE];
+    bool wel;
+    bool erasing;
+    bool suspended;
+    uint32_t erase_addr;
+    uint32_t erase_size;
+
+    /* Number of erase commands accepted */
+    int erases;
+    int suspends;
+    int resumes;
+    /* Reads issued while erase was running, not suspended */
+    int busy_reads;
+    /* Commands the chip would reject or not understand */
+    int errors;
+};
+
+extern struct spiflash_test_chip spiflash_test_chip;
+
+void spiflash_test_chip_reset(void);
+void spiflash_test_chip_erase_done(void);
+
+void spiflash_test_init(void);
+void spiflash_test_erase_start(uint32_t addr);
+int spiflash_test_erase_wait(int *rc);
+bool spiflash_test_erased(uint32_t addr, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SPIFLASH_TEST_H */
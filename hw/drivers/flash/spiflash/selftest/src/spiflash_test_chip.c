@@ -0,0 +1,250 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "os/mynewt.h"
+#include "hal/hal_spi.h"
+#include "spiflash_test.h"
+
+/*
+ * Simulated flash chip.  The driver sends each command with a separate
+ * hal_spi call, followed by one call for the data phase of read, page
+ * program and read status commands, so calls are framed without looking at
+ * CS.
+ */
+
+struct spiflash_test_chip spiflash_test_chip;
+
+static enum {
+    SPIFLASH_TEST_ST_CMD,
+    SPIFLASH_TEST_ST_STATUS,
+    SPIFLASH_TEST_ST_READ,
+    SPIFLASH_TEST_ST_PROGRAM,
+} spiflash_test_state;
+static uint32_t spiflash_test_addr;
+
+static bool
+spiflash_test_chip_busy(void)
+{
+    return spiflash_test_chip.erasing && !spiflash_test_chip.suspended;
+}
+
+static uint8_t
+spiflash_test_chip_status(void)
+{
+    uint8_t status = 0;
+
+    if (spiflash_test_chip_busy()) {
+        status |= SPIFLASH_STATUS_BUSY;
+    }
+    if (spiflash_test_chip.wel) {
+        status |= SPIFLASH_STATUS_WRITE_ENABLE;
+    }
+
+    return status;
+}
+
+static uint32_t
+spiflash_test_cmd_addr(const uint8_t *tx)
+{
+    return ((tx[1] << 16) | (tx[2] << 8) | tx[3]) % SPIFLASH_TEST_SIZE;
+}
+
+static void
+spiflash_test_chip_erase(const uint8_t *tx, uint32_t size)
+{
+    struct spiflash_test_chip *chip = &spiflash_test_chip;
+
+    if (spiflash_test_chip_busy() || chip->suspended || !chip->wel) {
+        chip->errors++;
+        return;
+    }
+
+    chip->erase_addr = size == SPIFLASH_TEST_SIZE ? 0 :
+                       spiflash_test_cmd_addr(tx) & ~(size - 1);
+    chip->erase_size = size;
+    chip->erasing = true;
+    chip->wel = false;
+    chip->erases++;
+}
+
+static void
+spiflash_test_chip_cmd(const uint8_t *tx, uint8_t *rx, int cnt)
+{
+    struct spiflash_test_chip *chip = &spiflash_test_chip;
+
+    switch (tx[0]) {
+    case SPIFLASH_READ_JEDEC_ID:
+        if (rx && cnt >= 4) {
+            rx[1] = MYNEWT_VAL(SPIFLASH_MANUFACTURER);
+            rx[2] = MYNEWT_VAL(SPIFLASH_MEMORY_TYPE);
+            rx[3] = MYNEWT_VAL(SPIFLASH_MEMORY_CAPACITY);
+        }
+        break;
+    case SPIFLASH_READ_STATUS_REGISTER:
+        spiflash_test_state = SPIFLASH_TEST_ST_STATUS;
+        break;
+    case SPIFLASH_WRITE_ENABLE:
+        chip->wel = true;
+        break;
+    case SPIFLASH_SECTOR_ERASE:
+        spiflash_test_chip_erase(tx, SPIFLASH_TEST_SECTOR_SIZE);
+        break;
+    case SPIFLASH_BLOCK_ERASE_32KB:
+        spiflash_test_chip_erase(tx, 0x8000);
+        break;
+    case SPIFLASH_BLOCK_ERASE_64KB:
+        spiflash_test_chip_erase(tx, 0x10000);
+        break;
+    case SPIFLASH_CHIP_ERASE:
+        spiflash_test_chip_erase(tx, SPIFLASH_TEST_SIZE);
+        break;
+    case MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND_CMD):
+        if (spiflash_test_chip_busy()) {
+            chip->suspended = true;
+            chip->suspends++;
+        }
+        break;
+    case MYNEWT_VAL(SPIFLASH_ERASE_RESUME_CMD):
+        if (chip->suspended) {
+            chip->suspended = false;
+            chip->resumes++;
+        }
+        break;
+    case SPIFLASH_READ:
+    case SPIFLASH_FAST_READ:
+        spiflash_test_addr = spiflash_test_cmd_addr(tx);
+        spiflash_test_state = SPIFLASH_TEST_ST_READ;
+        break;
+    case SPIFLASH_PAGE_PROGRAM:
+        spiflash_test_addr = spiflash_test_cmd_addr(tx);
+        spiflash_test_state = SPIFLASH_TEST_ST_PROGRAM;
+        break;
+    case SPIFLASH_RELEASE_POWER_DOWN:
+    case SPIFLASH_DEEP_POWER_DOWN:
+        break;
+    default:
+        chip->errors++;
+        break;
+    }
+}
+
+static void
+spiflash_test_chip_xfer(const uint8_t *tx, uint8_t *rx, int cnt)
+{
+    struct spiflash_test_chip *chip = &spiflash_test_chip;
+    int i;
+
+    switch (spiflash_test_state) {
+    case SPIFLASH_TEST_ST_CMD:
+        spiflash_test_chip_cmd(tx, rx, cnt);
+        return;
+    case SPIFLASH_TEST_ST_STATUS:
+        if (rx) {
+            memset(rx, spiflash_test_chip_status(), cnt);
+        }
+        break;
+    case SPIFLASH_TEST_ST_READ:
+        if (spiflash_test_chip_busy()) {
+            chip->busy_reads++;
+        }
+        for (i = 0; i < cnt; i++) {
+            rx[i] = chip->mem[(spiflash_test_addr + i) % SPIFLASH_TEST_SIZE];
+        }
+        break;
+    case SPIFLASH_TEST_ST_PROGRAM:
+        if (chip->erasing || !chip->wel) {
+            chip->errors++;
+            break;
+        }
+        for (i = 0; i < cnt; i++) {
+            chip->mem[(spiflash_test_addr + i) % SPIFLASH_TEST_SIZE] &= tx[i];
+        }
+        chip->wel = false;
+        break;
+    }
+
+    spiflash_test_state = SPIFLASH_TEST_ST_CMD;
+}
+
+/**
+ * Completes erase in progress, as if the chip finished it.
+ */
+void
+spiflash_test_chip_erase_done(void)
+{
+    struct spiflash_test_chip *chip = &spiflash_test_chip;
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    if (chip->erasing) {
+        memset(chip->mem + chip->erase_addr, 0xFF, chip->erase_size);
+        chip->erasing = false;
+        chip->suspended = false;
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+void
+spiflash_test_chip_reset(void)
+{
+    memset(&spiflash_test_chip, 0, sizeof(spiflash_test_chip));
+    spiflash_test_state = SPIFLASH_TEST_ST_CMD;
+}
+
+int
+hal_spi_config(int spi_num, struct hal_spi_settings *psettings)
+{
+    return 0;
+}
+
+int
+hal_spi_set_txrx_cb(int spi_num, hal_spi_txrx_cb txrx_cb, void *arg)
+{
+    return 0;
+}
+
+int
+hal_spi_enable(int spi_num)
+{
+    return 0;
+}
+
+int
+hal_spi_disable(int spi_num)
+{
+    return 0;
+}
+
+uint16_t
+hal_spi_tx_val(int spi_num, uint16_t val)
+{
+    uint8_t b = val;
+
+    spiflash_test_chip_xfer(&b, &b, 1);
+
+    return b;
+}
+
+int
+hal_spi_txrx(int spi_num, void *txbuf, void *rxbuf, int cnt)
+{
+    spiflash_test_chip_xfer(txbuf, rxbuf, cnt);
+
+    return 0;
+}
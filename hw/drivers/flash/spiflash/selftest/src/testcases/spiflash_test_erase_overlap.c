@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "spiflash_test.h"
+
+/**
+ * Erase completed by another context, which then starts its own erase before
+ * the issuer checks again, is reported as successful to its issuer.
+ */
+TEST_CASE_TASK(spiflash_test_erase_overlap)
+{
+    uint32_t sector1 = SPIFLASH_TEST_SECTOR_SIZE;
+    uint32_t sector2 = 2 * SPIFLASH_TEST_SECTOR_SIZE;
+    int erase_rc;
+    int rc;
+
+    spiflash_test_init();
+
+    /*** Eraser has seen its erase of sector 1 busy and sleeps. */
+    spiflash_test_erase_start(sector1);
+    os_time_delay(os_time_ms_to_ticks32(50));
+    TEST_ASSERT_FATAL(spiflash_test_chip.erasing);
+    TEST_ASSERT(spiflash_test_chip.erase_addr == sector1);
+
+    /*
+     * Background erase of sector 2 waits for sector 1; it notices that chip
+     * is done first, completes erase of sector 1 and starts its own.
+     */
+    rc = spiflash_erase_background(&spiflash_dev, sector2,
+                                   SPIFLASH_TEST_SECTOR_SIZE);
+    TEST_ASSERT_FATAL(rc == 0);
+    spiflash_test_chip_erase_done();
+    os_time_delay(os_time_ms_to_ticks32(20));
+
+    TEST_ASSERT_FATAL(spiflash_test_chip.erasing);
+    TEST_ASSERT(spiflash_test_chip.erase_addr == sector2);
+    TEST_ASSERT(spiflash_test_chip.erases == 2);
+
+    /*** Eraser gets the result of its own erase, not of the running one. */
+    TEST_ASSERT_FATAL(spiflash_test_erase_wait(&erase_rc) == 0,
+                      "erase not completed");
+    TEST_ASSERT(erase_rc == 0);
+    TEST_ASSERT(spiflash_test_erased(sector1, SPIFLASH_TEST_SECTOR_SIZE));
+
+    /*** Background erase completes; sector 2 is then known to be erased. */
+    spiflash_test_chip_erase_done();
+    os_time_delay(os_time_ms_to_ticks32(50));
+    TEST_ASSERT(!spiflash_test_chip.erasing);
+
+    rc = spiflash_sector_erase(&spiflash_dev, sector2);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(spiflash_test_chip.erases == 2);
+    TEST_ASSERT(spiflash_test_erased(sector2, SPIFLASH_TEST_SECTOR_SIZE));
+
+    TEST_ASSERT(spiflash_test_chip.errors == 0);
+}
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "spiflash_test.h"
+
+/**
+ * Read issued while erase is in progress suspends the erase, reads and
+ * resumes it; the erase then completes successfully.
+ */
+TEST_CASE_TASK(spiflash_test_erase_suspend)
+{
+    static uint8_t buf[256];
+    const struct hal_flash_funcs *funcs;
+    int erase_rc;
+    int rc;
+    int i;
+
+    spiflash_test_init();
+    funcs = spiflash_dev.hal.hf_itf;
+
+    for (i = 0; i < sizeof(buf); i++) {
+        spiflash_test_chip.mem[i] = i;
+    }
+
+    /*** Erase of sector 1 is running; eraser waits for it to complete. */
+    spiflash_test_erase_start(SPIFLASH_TEST_SECTOR_SIZE);
+    os_time_delay(os_time_ms_to_ticks32(50));
+    TEST_ASSERT_FATAL(spiflash_test_chip.erasing);
+    TEST_ASSERT(spiflash_test_chip.erase_addr == SPIFLASH_TEST_SECTOR_SIZE);
+
+    /*** Read of sector 0 is served with erase suspended. */
+    rc = funcs->hff_read(&spiflash_dev.hal, 0, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    for (i = 0; i < sizeof(buf); i++) {
+        TEST_ASSERT_FATAL(buf[i] == (uint8_t)i, "bad data at %d", i);
+    }
+    TEST_ASSERT(spiflash_test_chip.suspends == 1);
+    TEST_ASSERT(spiflash_test_chip.resumes == 1);
+    TEST_ASSERT(spiflash_test_chip.busy_reads == 0);
+    TEST_ASSERT(spiflash_test_chip.erasing && !spiflash_test_chip.suspended);
+
+    /*** Erase completes after it was resumed. */
+    spiflash_test_chip_erase_done();
+    TEST_ASSERT_FATAL(spiflash_test_erase_wait(&erase_rc) == 0,
+                      "erase not completed");
+    TEST_ASSERT(erase_rc == 0);
+    TEST_ASSERT(spiflash_test_erased(SPIFLASH_TEST_SECTOR_SIZE,
+                                     SPIFLASH_TEST_SECTOR_SIZE));
+
+    /* Nothing to suspend now. */
+    rc = funcs->hff_read(&spiflash_dev.hal, 0, buf, sizeof(buf));
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(buf[1] == 1);
+    TEST_ASSERT(spiflash_test_chip.suspends == 1);
+
+    TEST_ASSERT(spiflash_test_chip.erases == 1);
+    TEST_ASSERT(spiflash_test_chip.errors == 0);
+}
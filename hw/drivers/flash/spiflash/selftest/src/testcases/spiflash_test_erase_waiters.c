@@ -0,0 +1,106 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include <string.h>
+#include "spiflash_test.h"
+
+#define SPIFLASH_TEST_WRITERS       2
+#define SPIFLASH_TEST_WRITE_LEN     64
+
+struct spiflash_test_writer {
+    struct os_task task;
+    os_stack_t stack[OS_STACK_ALIGN(512)];
+    uint32_t addr;
+    uint8_t data[SPIFLASH_TEST_WRITE_LEN];
+    int rc;
+};
+
+static struct spiflash_test_writer spiflash_test_writers[SPIFLASH_TEST_WRITERS];
+static struct os_sem spiflash_test_writers_sem;
+
+static void
+spiflash_test_writer_func(void *arg)
+{
+    struct spiflash_test_writer *w = arg;
+
+    w->rc = spiflash_dev.hal.hf_itf->hff_write(&spiflash_dev.hal, w->addr,
+                                               w->data, sizeof(w->data));
+    os_sem_release(&spiflash_test_writers_sem);
+
+    while (1) {
+        os_time_delay(OS_TICKS_PER_SEC);
+    }
+}
+
+/**
+ * Two writers waiting for erase to complete sleep at the same time, each is
+ * woken up and does its write once erase is done.
+ */
+TEST_CASE_TASK(spiflash_test_erase_waiters)
+{
+    struct spiflash_test_writer *w;
+    uint32_t sector1 = SPIFLASH_TEST_SECTOR_SIZE;
+    int erase_rc;
+    int rc;
+    int i;
+
+    spiflash_test_init();
+    os_sem_init(&spiflash_test_writers_sem, 0);
+
+    /*** Eraser has seen its erase of sector 1 busy and sleeps. */
+    spiflash_test_erase_start(sector1);
+    os_time_delay(os_time_ms_to_ticks32(50));
+    TEST_ASSERT_FATAL(spiflash_test_chip.erasing);
+
+    /*** Writers to sectors 3 and 4 wait for the erase, polling it. */
+    for (i = 0; i < SPIFLASH_TEST_WRITERS; i++) {
+        w = &spiflash_test_writers[i];
+        w->addr = (3 + i) * SPIFLASH_TEST_SECTOR_SIZE;
+        w->rc = -1;
+        memset(w->data, 0x10 + i, sizeof(w->data));
+        memset(spiflash_test_chip.mem + w->addr, 0xFF, sizeof(w->data));
+
+        rc = os_task_init(&w->task, "writer", spiflash_test_writer_func, w,
+                          OS_MAIN_TASK_PRIO + 4 + i, OS_WAIT_FOREVER,
+                          w->stack, OS_STACK_ALIGN(512));
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+    os_time_delay(os_time_ms_to_ticks32(50));
+    rc = os_sem_pend(&spiflash_test_writers_sem, 0);
+    TEST_ASSERT_FATAL(rc == OS_TIMEOUT, "write done during erase");
+
+    /*** Both writers complete once erase is done. */
+    spiflash_test_chip_erase_done();
+    for (i = 0; i < SPIFLASH_TEST_WRITERS; i++) {
+        rc = os_sem_pend(&spiflash_test_writers_sem, OS_TICKS_PER_SEC);
+        TEST_ASSERT_FATAL(rc == 0, "writer not woken up");
+    }
+
+    for (i = 0; i < SPIFLASH_TEST_WRITERS; i++) {
+        w = &spiflash_test_writers[i];
+        TEST_ASSERT(w->rc == 0);
+        TEST_ASSERT(memcmp(spiflash_test_chip.mem + w->addr, w->data,
+                           sizeof(w->data)) == 0);
+    }
+
+    TEST_ASSERT_FATAL(spiflash_test_erase_wait(&erase_rc) == 0,
+                      "erase not completed");
+    TEST_ASSERT(erase_rc == 0);
+    TEST_ASSERT(spiflash_test_erased(sector1, SPIFLASH_TEST_SECTOR_SIZE));
+    TEST_ASSERT(spiflash_test_chip.errors == 0);
+}
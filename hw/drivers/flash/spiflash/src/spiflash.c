@@ -52,6 +52,15 @@
 #error SPIFLASH_BAUDRATE must be set to the correct value in bsp syscfg.yml
 #endif
 
+#if (MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND) || MYNEWT_VAL(SPIFLASH_BG_ERASE)) && \
+    !MYNEWT_VAL(OS_SCHEDULING)
+#error SPIFLASH_ERASE_SUSPEND and SPIFLASH_BG_ERASE require OS_SCHEDULING
+#endif
+
+/* Erase completion is tracked when erase can be in progress without lock */
+#define SPIFLASH_ERASE_TRACK    (MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND) || \
+                                 MYNEWT_VAL(SPIFLASH_BG_ERASE))
+
 static void spiflash_release_power_down_macronix(struct spiflash_dev *dev) __attribute__((unused));
 static void spiflash_release_power_down_generic(struct spiflash_dev *dev) __attribute__((unused));
 
@@ -823,6 +832,14 @@ spiflash_apd_tmo_func(struct os_event *ev)
 
     spiflash_lock_no_apd(dev);
 
+#if SPIFLASH_ERASE_TRACK
+    /* Will be rescheduled on unlock once erase is completed */
+    if (dev->erase_in_progress) {
+        spiflash_unlock_no_apd(dev);
+        return;
+    }
+#endif
+
     if (dev->apd_tmo && !dev->pd_active) {
         spiflash_power_down(dev);
     }
@@ -892,6 +909,14 @@ spiflash_read_status(struct spiflash_dev *dev)
     return val;
 }
 
+#if MYNEWT_VAL(OS_SCHEDULING) && MYNEWT_VAL(SPIFLASH_WAIT_SLEEP_MIN_US)
+static void
+spiflash_wait_timer_cb(void *arg)
+{
+    os_sem_release(arg);
+}
+#endif
+
 static void
 spiflash_delay_us(uint32_t usecs)
 {
@@ -899,12 +924,26 @@ spiflash_delay_us(uint32_t usecs)
     uint32_t ticks = os_time_ms_to_ticks32(usecs / 1000);
     if (ticks > 1) {
         os_time_delay(ticks);
-    } else {
-        os_cputime_delay_usecs(usecs);
+        return;
+    }
+#if MYNEWT_VAL(SPIFLASH_WAIT_SLEEP_MIN_US)
+    /*
+     * Let other tasks run, timer interrupt will wake us up. Some waits are
+     * done without flash lock, so each one needs its own timer.
+     */
+    if (usecs >= MYNEWT_VAL(SPIFLASH_WAIT_SLEEP_MIN_US) && os_started()) {
+        struct hal_timer timer;
+        struct os_sem sem;
+
+        os_sem_init(&sem, 0);
+        os_cputime_timer_init(&timer, spiflash_wait_timer_cb, &sem);
+        os_cputime_timer_relative(&timer, usecs);
+        os_sem_pend(&sem, OS_TIMEOUT_NEVER);
+        return;
     }
-#else
-    os_cputime_delay_usecs(usecs);
 #endif
+#endif
+    os_cputime_delay_usecs(usecs);
 }
 
 bool
@@ -981,29 +1020,309 @@ spiflash_write_enable(struct spiflash_dev *dev)
     return 0;
 }
 
+#if SPIFLASH_ERASE_TRACK
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+static inline bool
+spiflash_map_test(const uint8_t *map, uint32_t idx)
+{
+    return map[idx / 8] & (1 << (idx % 8));
+}
+
+static void
+spiflash_map_update(struct spiflash_dev *dev, uint8_t *map, uint32_t addr,
+                    uint32_t size, bool val)
+{
+    uint32_t idx;
+    uint32_t end;
+
+    idx = addr / dev->sector_size;
+    end = min((addr + size + dev->sector_size - 1) / dev->sector_size,
+              MYNEWT_VAL(SPIFLASH_SECTOR_COUNT));
+
+    for (; idx < end; idx++) {
+        if (val) {
+            map[idx / 8] |= 1 << (idx % 8);
+        } else {
+            map[idx / 8] &= ~(1 << (idx % 8));
+        }
+    }
+}
+
+static bool
+spiflash_range_erased(struct spiflash_dev *dev, uint32_t addr, uint32_t size)
+{
+    uint32_t idx;
+    uint32_t end;
+
+    idx = addr / dev->sector_size;
+    end = (addr + size + dev->sector_size - 1) / dev->sector_size;
+    if (end > MYNEWT_VAL(SPIFLASH_SECTOR_COUNT)) {
+        return false;
+    }
+
+    for (; idx < end; idx++) {
+        if (!spiflash_map_test(dev->erased_map, idx)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+/*
+ * Sends erase command without waiting for completion. Shall be called with
+ * lock held and device ready.
+ */
+static void
+spiflash_erase_start(struct spiflash_dev *dev, const uint8_t *buf,
+                     uint32_t size, uint32_t erase_addr, uint32_t erase_size,
+                     uint32_t erase_max_us)
+{
+    spiflash_write_enable(dev);
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, buf, (uint16_t)size);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_txrx(dev->spi_num, (void *)buf, NULL, size);
+
+    spiflash_cs_deactivate(dev);
+#endif
+    /* Now we know that device is not ready */
+    dev->ready = false;
+
+    dev->erase_in_progress = true;
+    dev->erase_result = NULL;
+    dev->erase_addr = erase_addr;
+    dev->erase_size = erase_size;
+    dev->erase_start = os_cputime_get32();
+    dev->erase_max_us = erase_max_us;
+}
+
+static void
+spiflash_erase_end(struct spiflash_dev *dev, bool success)
+{
+    dev->erase_in_progress = false;
+
+    /* Whoever completes erase reports its result to the task which issued it */
+    if (dev->erase_result) {
+        *dev->erase_result = success ? 0 : -1;
+        dev->erase_result = NULL;
+    }
+
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    if (success) {
+        spiflash_map_update(dev, dev->erased_map, dev->erase_addr,
+                            dev->erase_size, true);
+    }
+    spiflash_map_update(dev, dev->bg_erase_map, dev->erase_addr,
+                        dev->erase_size, false);
+#endif
+}
+
+/*
+ * Checks if erase is still in progress, completes it if device is ready
+ * or erase timed out. Shall be called with lock held.
+ *
+ * Returns 0 if no erase is in progress, SYS_EBUSY if erase is still in
+ * progress, -1 if erase timed out.
+ */
+static int
+spiflash_erase_poll(struct spiflash_dev *dev)
+{
+    uint32_t elapsed_us;
+
+    if (!dev->erase_in_progress) {
+        return 0;
+    }
+
+    if (spiflash_device_ready(dev)) {
+        spiflash_erase_end(dev, true);
+        return 0;
+    }
+
+    elapsed_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                           dev->erase_start);
+    if (elapsed_us > dev->erase_max_us) {
+        spiflash_erase_end(dev, false);
+        return -1;
+    }
+
+    return SYS_EBUSY;
+}
+
+/*
+ * Waits for erase started by another context to complete. Shall be called
+ * with lock held (once), lock is released while waiting.
+ */
+static int
+spiflash_erase_wait(struct spiflash_dev *dev)
+{
+    int rc;
+
+    while ((rc = spiflash_erase_poll(dev)) == SYS_EBUSY) {
+        spiflash_unlock(dev);
+        spiflash_delay_us(1000);
+        spiflash_lock(dev);
+    }
+
+    return rc;
+}
+
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+static int
+spiflash_erase_suspend(struct spiflash_dev *dev)
+{
+    uint8_t cmd = MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND_CMD);
+    uint32_t since_resume_us;
+    uint32_t now;
+    int rc;
+
+    /* Let erase progress between suspends */
+    since_resume_us = os_cputime_ticks_to_usecs(os_cputime_get32() -
+                                                dev->erase_resumed_at);
+    if (since_resume_us < MYNEWT_VAL(SPIFLASH_ERASE_RESUME_INTERVAL)) {
+        os_cputime_delay_usecs(MYNEWT_VAL(SPIFLASH_ERASE_RESUME_INTERVAL) -
+                               since_resume_us);
+    }
+
+    now = os_cputime_get32();
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, &cmd, 1);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_tx_val(dev->spi_num, cmd);
+
+    spiflash_cs_deactivate(dev);
+#endif
+
+    rc = spiflash_wait_ready_till(dev, MYNEWT_VAL(SPIFLASH_TSUS_MAXIMUM),
+                                  MYNEWT_VAL(SPIFLASH_READ_STATUS_INTERVAL));
+
+    /* Suspended time does not count to erase timeout */
+    dev->erase_start += os_cputime_get32() - now;
+
+    return rc;
+}
+
+static void
+spiflash_erase_resume(struct spiflash_dev *dev)
+{
+    uint8_t cmd = MYNEWT_VAL(SPIFLASH_ERASE_RESUME_CMD);
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    bus_node_simple_write((struct os_dev *)&dev->dev, &cmd, 1);
+#else
+    spiflash_cs_activate(dev);
+
+    hal_spi_tx_val(dev->spi_num, cmd);
+
+    spiflash_cs_deactivate(dev);
+#endif
+
+    dev->ready = false;
+    dev->erase_resumed_at = os_cputime_get32();
+}
+#endif
+#endif
+
+#if MYNEWT_VAL(SPIFLASH_FAST_READ)
+#define SPIFLASH_READ_CMD       SPIFLASH_FAST_READ
+#define SPIFLASH_READ_CMD_LEN   5
+#else
+#define SPIFLASH_READ_CMD       SPIFLASH_READ
+#define SPIFLASH_READ_CMD_LEN   4
+#endif
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+static int
+spiflash_bus_read(struct spiflash_dev *dev, const uint8_t *cmd, uint8_t *buf,
+                  uint32_t len)
+{
+    struct os_dev *odev = (struct os_dev *)&dev->dev;
+    os_time_t timeout;
+    uint16_t chunk;
+    int rc;
+
+    timeout = os_time_ms_to_ticks32(MYNEWT_VAL(BUS_DEFAULT_TRANSACTION_TIMEOUT_MS));
+
+    rc = bus_node_lock(odev, BUS_NODE_LOCK_DEFAULT_TIMEOUT);
+    if (rc) {
+        return rc;
+    }
+
+    /*
+     * Single command is sent and data is read while CS stays asserted,
+     * bus read length is limited so split it if needed.
+     */
+    rc = bus_node_write(odev, cmd, SPIFLASH_READ_CMD_LEN, timeout,
+                        BUS_F_NOSTOP);
+    while (rc == 0 && len) {
+        chunk = min(len, UINT16_MAX);
+        len -= chunk;
+        rc = bus_node_read(odev, buf, chunk, timeout,
+                           len ? BUS_F_NOSTOP : BUS_F_NONE);
+        buf += chunk;
+    }
+
+    if (rc) {
+        spiflash_cs_deactivate(dev);
+    }
+
+    (void)bus_node_unlock(odev);
+
+    return rc;
+}
+#endif
+
 static int
 hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *buf,
                   uint32_t len)
 {
     int err = 0;
-    uint8_t cmd[] = { SPIFLASH_READ,
-        (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr) };
+    uint8_t cmd[] = { SPIFLASH_READ_CMD,
+        (uint8_t)(addr >> 16), (uint8_t)(addr >> 8), (uint8_t)(addr),
+        0xFF /* Dummy byte used by Fast Read */ };
     struct spiflash_dev *dev;
 
+    bool suspended = false;
+
     dev = (struct spiflash_dev *)hal_flash_dev;
 
     spiflash_lock(dev);
 
-    err = spiflash_wait_ready(dev, 100);
+#if SPIFLASH_ERASE_TRACK
+    err = spiflash_erase_poll(dev);
+    if (err == SYS_EBUSY) {
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+        suspended = true;
+        err = spiflash_erase_suspend(dev);
+        if (err) {
+            spiflash_erase_resume(dev);
+            suspended = false;
+            err = spiflash_erase_wait(dev);
+        }
+#else
+        err = spiflash_erase_wait(dev);
+#endif
+    }
+#endif
+
+    if (!err && !suspended) {
+        err = spiflash_wait_ready(dev, 100);
+    }
     if (!err) {
 #if MYNEWT_VAL(BUS_DRIVER_PRESENT)
-        bus_node_simple_write_read_transact((struct os_dev *)&dev->dev,
-            &cmd, 4, buf, len);
+        err = spiflash_bus_read(dev, cmd, buf, len);
 #else
         spiflash_cs_activate(dev);
 
         /* Send command + address */
-        hal_spi_txrx(dev->spi_num, cmd, NULL, sizeof cmd);
+        hal_spi_txrx(dev->spi_num, cmd, NULL, SPIFLASH_READ_CMD_LEN);
         /* For security mostly, do not output random data, fill it with FF */
         memset(buf, 0xFF, len);
         /* Tx buf does not matter, for simplicity pass read buffer */
@@ -1013,9 +1332,15 @@ hal_spiflash_read(const struct hal_flash *hal_flash_dev, uint32_t addr, void *bu
 #endif
     }
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    if (suspended) {
+        spiflash_erase_resume(dev);
+    }
+#endif
+
     spiflash_unlock(dev);
 
-    return 0;
+    return err;
 }
 
 static int
@@ -1035,6 +1360,18 @@ hal_spiflash_write(const struct hal_flash *hal_flash_dev, uint32_t addr,
 
     spiflash_lock(dev);
 
+#if SPIFLASH_ERASE_TRACK
+    if (spiflash_erase_wait(dev) != 0) {
+        rc = -1;
+        goto err;
+    }
+#endif
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    /* Sectors are no longer erased, nor free to be erased */
+    spiflash_map_update(dev, dev->erased_map, addr, len, false);
+    spiflash_map_update(dev, dev->bg_erase_map, addr, len, false);
+#endif
+
     if (spiflash_wait_ready(dev, 100) != 0) {
         rc = -1;
         goto err;
@@ -1107,20 +1444,39 @@ hal_spiflash_erase(const struct hal_flash *hal_flash_dev,
 
 static int
 spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
-                       uint32_t size,
+                       uint32_t size, uint32_t erase_addr, uint32_t erase_size,
                        const struct spiflash_time_spec *delay_spec)
 {
     int rc = 0;
     uint32_t wait_time_us;
     uint32_t start_time;
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    int result;
+#endif
 
     spiflash_lock(dev);
 
+#if SPIFLASH_ERASE_TRACK
+    if (spiflash_erase_wait(dev) != 0) {
+        rc = -1;
+        goto err;
+    }
+#endif
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    if (spiflash_range_erased(dev, erase_addr, erase_size)) {
+        goto err;
+    }
+#endif
+
     if (spiflash_wait_ready(dev, 100) != 0) {
         rc = -1;
         goto err;
     }
 
+#if SPIFLASH_ERASE_TRACK
+    spiflash_erase_start(dev, buf, size, erase_addr, erase_size,
+                         delay_spec->maximum);
+#else
     spiflash_write_enable(dev);
 
     spiflash_read_status(dev);
@@ -1136,7 +1492,34 @@ spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
 #endif
     /* Now we know that device is not ready */
     dev->ready = false;
+#endif
 
+#if MYNEWT_VAL(SPIFLASH_ERASE_SUSPEND)
+    /*
+     * Release lock while erase is in progress so flash can be read. Erase is
+     * completed by whoever notices that device is ready (or erase timed out)
+     * first, and it can be followed by another erase before we get the lock
+     * again, so its result is stored in result by spiflash_erase_end().
+     */
+    result = SYS_EBUSY;
+    dev->erase_result = &result;
+
+    spiflash_unlock(dev);
+    spiflash_delay_us(delay_spec->typical);
+    spiflash_lock(dev);
+
+    wait_time_us = min(max(delay_spec->maximum / 50,
+                           MYNEWT_VAL(SPIFLASH_READ_STATUS_INTERVAL)), 1000000);
+    while (result == SYS_EBUSY) {
+        if (spiflash_erase_poll(dev) == SYS_EBUSY && result == SYS_EBUSY) {
+            spiflash_unlock(dev);
+            spiflash_delay_us(wait_time_us);
+            spiflash_lock(dev);
+        }
+    }
+    rc = result;
+    (void)start_time;
+#else
     start_time = os_cputime_get32();
     /* Wait typical erase time before starting polling for ready */
     spiflash_delay_us(delay_spec->typical);
@@ -1150,6 +1533,10 @@ spiflash_execute_erase(struct spiflash_dev *dev, const uint8_t *buf,
 
     /* Poll status ready for remaining time */
     rc = spiflash_wait_ready_till(dev, wait_time_us, wait_time_us / 50);
+#if SPIFLASH_ERASE_TRACK
+    spiflash_erase_end(dev, rc == 0);
+#endif
+#endif
 err:
     spiflash_unlock(dev);
 
@@ -1169,11 +1556,12 @@ hal_spiflash_sector_info(const struct hal_flash *hal_flash_dev, int idx,
 
 static int
 spiflash_erase_cmd(struct spiflash_dev *dev, uint8_t cmd, uint32_t addr,
-                   const struct spiflash_time_spec *time_spec)
+                   uint32_t size, const struct spiflash_time_spec *time_spec)
 {
     uint8_t buf[4] = { cmd, (uint8_t)(addr >> 16U), (uint8_t)(addr >> 8U),
                        (uint8_t)addr };
-    return spiflash_execute_erase(dev, buf, sizeof(buf), time_spec);
+    return spiflash_execute_erase(dev, buf, sizeof(buf), addr & ~(size - 1),
+                                  size, time_spec);
 
 }
 
@@ -1181,14 +1569,14 @@ int
 spiflash_sector_erase(struct spiflash_dev *dev, uint32_t addr)
 {
     return spiflash_erase_cmd(dev, SPIFLASH_SECTOR_ERASE, addr,
-                              &dev->characteristics->tse);
+                              dev->sector_size, &dev->characteristics->tse);
 }
 
 #if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_32BK)
 int
 spiflash_block_32k_erase(struct spiflash_dev *dev, uint32_t addr)
 {
-    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_32KB, addr,
+    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_32KB, addr, 0x8000,
                               &dev->characteristics->tbe1);
 }
 #endif
@@ -1197,7 +1585,7 @@ spiflash_block_32k_erase(struct spiflash_dev *dev, uint32_t addr)
 int
 spiflash_block_64k_erase(struct spiflash_dev *dev, uint32_t addr)
 {
-    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_64KB, addr,
+    return spiflash_erase_cmd(dev, SPIFLASH_BLOCK_ERASE_64KB, addr, 0x10000,
                               &dev->characteristics->tbe2);
 }
 #endif
@@ -1207,7 +1595,7 @@ spiflash_chip_erase(struct spiflash_dev *dev)
 {
     uint8_t buf[1] = { SPIFLASH_CHIP_ERASE };
 
-    return spiflash_execute_erase(dev, buf, sizeof(buf),
+    return spiflash_execute_erase(dev, buf, sizeof(buf), 0, dev->hal.hf_size,
                                   &dev->characteristics->tce);
 }
 
@@ -1260,6 +1648,135 @@ err:
     return rc;
 }
 
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+#if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_32BK) || MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_64BK)
+/*
+ * Checks if all sectors of block starting at idx are either pending for
+ * background erase or already erased.
+ */
+static bool
+spiflash_bg_block_ready(struct spiflash_dev *dev, uint32_t idx, uint32_t count)
+{
+    uint32_t i;
+
+    if (idx % count || idx + count > MYNEWT_VAL(SPIFLASH_SECTOR_COUNT)) {
+        return false;
+    }
+    for (i = idx; i < idx + count; i++) {
+        if (!spiflash_map_test(dev->bg_erase_map, i) &&
+            !spiflash_map_test(dev->erased_map, i)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+#endif
+
+static void
+spiflash_bg_erase_func(struct os_event *ev)
+{
+    struct spiflash_dev *dev = ev->ev_arg;
+    const struct spiflash_time_spec *time_spec;
+    uint8_t cmd = SPIFLASH_SECTOR_ERASE;
+    uint32_t sectors = 1;
+    uint32_t addr;
+    uint32_t idx;
+    uint8_t buf[4];
+    int rc;
+
+    spiflash_lock(dev);
+
+    rc = spiflash_erase_poll(dev);
+    if (rc == SYS_EBUSY) {
+        /* Foreground or previous background erase still running */
+        os_callout_reset(&dev->bg_erase_co, max(os_time_ms_to_ticks32(1), 1));
+        goto end;
+    }
+
+    for (idx = 0; idx < MYNEWT_VAL(SPIFLASH_SECTOR_COUNT); idx++) {
+        if (!spiflash_map_test(dev->bg_erase_map, idx)) {
+            continue;
+        }
+        if (!spiflash_map_test(dev->erased_map, idx)) {
+            break;
+        }
+        /* Already erased, nothing to do */
+        dev->bg_erase_map[idx / 8] &= ~(1 << (idx % 8));
+    }
+    if (idx >= MYNEWT_VAL(SPIFLASH_SECTOR_COUNT)) {
+        goto end;
+    }
+
+    time_spec = &dev->characteristics->tse;
+#if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_32BK)
+    if (spiflash_bg_block_ready(dev, idx, 0x8000 / dev->sector_size)) {
+        cmd = SPIFLASH_BLOCK_ERASE_32KB;
+        sectors = 0x8000 / dev->sector_size;
+        time_spec = &dev->characteristics->tbe1;
+    }
+#endif
+#if MYNEWT_VAL(SPIFLASH_BLOCK_ERASE_64BK)
+    /* 64 KB erase if possible */
+    if (spiflash_bg_block_ready(dev, idx, 0x10000 / dev->sector_size)) {
+        cmd = SPIFLASH_BLOCK_ERASE_64KB;
+        sectors = 0x10000 / dev->sector_size;
+        time_spec = &dev->characteristics->tbe2;
+    }
+#endif
+
+    if (spiflash_wait_ready(dev, 100) != 0) {
+        os_callout_reset(&dev->bg_erase_co, 1);
+        goto end;
+    }
+
+    addr = idx * dev->sector_size;
+    buf[0] = cmd;
+    buf[1] = (uint8_t)(addr >> 16U);
+    buf[2] = (uint8_t)(addr >> 8U);
+    buf[3] = (uint8_t)addr;
+    spiflash_erase_start(dev, buf, sizeof(buf), addr,
+                         sectors * dev->sector_size, time_spec->maximum);
+
+    /* Check for completion after typical erase time */
+    os_callout_reset(&dev->bg_erase_co,
+                     os_time_ms_to_ticks32(time_spec->typical / 1000) + 1);
+end:
+    spiflash_unlock(dev);
+}
+#endif
+
+int
+spiflash_erase_background(struct spiflash_dev *dev, uint32_t addr,
+                          uint32_t size)
+{
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    uint32_t first;
+    uint32_t end;
+
+    /* Only sectors entirely within the area */
+    first = (addr + dev->sector_size - 1) / dev->sector_size;
+    end = (addr + size) / dev->sector_size;
+    if (first >= end) {
+        return 0;
+    }
+
+    spiflash_lock(dev);
+    spiflash_map_update(dev, dev->bg_erase_map, first * dev->sector_size,
+                        (end - first) * dev->sector_size, true);
+    os_callout_reset(&dev->bg_erase_co, 0);
+    spiflash_unlock(dev);
+
+    return 0;
+#else
+    (void)dev;
+    (void)addr;
+    (void)size;
+
+    return -1;
+#endif
+}
+
 int
 spiflash_identify(struct spiflash_dev *dev)
 {
@@ -1357,12 +1874,19 @@ hal_spiflash_init(const struct hal_flash *hal_flash_dev)
 
     dev = (struct spiflash_dev *)hal_flash_dev;
 
-#if MYNEWT_VAL(SPIFLASH_AUTO_POWER_DOWN)
+#if MYNEWT_VAL(OS_SCHEDULING)
     os_mutex_init(&dev->lock);
+#endif
+#if MYNEWT_VAL(SPIFLASH_AUTO_POWER_DOWN)
     os_callout_init(&dev->apd_tmo_co, os_eventq_dflt_get(),
                     spiflash_apd_tmo_func, dev);
 #endif
 
+#if MYNEWT_VAL(SPIFLASH_BG_ERASE)
+    os_callout_init(&dev->bg_erase_co, os_eventq_dflt_get(),
+                    spiflash_bg_erase_func, dev);
+#endif
+
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
     hal_gpio_init_out(dev->ss_pin, 1);
 
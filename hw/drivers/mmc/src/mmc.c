@@ -22,6 +22,7 @@
 #include <disk/disk.h>
 #include <mmc/mmc.h>
 #include <stdio.h>
+#include <string.h>
 
 #define MIN(n, m) (((n) < (m)) ? (n) : (m))
 
@@ -63,6 +64,9 @@
 
 #define BLOCK_LEN           (512)
 
+/* Number of back to back polls before sleeping while waiting for the card */
+#define MMC_SPIN_POLLS      (64)
+
 static uint8_t g_block_buf[BLOCK_LEN];
 
 static struct hal_spi_settings mmc_settings = {
@@ -336,102 +340,119 @@ out:
 }
 
 /**
- * Commands that return response in R1b format and write
- * commands enter busy state and keep return 0 while the
- * operations are in progress.
+ * Polls the card until it sends something other than the idle value or
+ * timeout expires. A completing operation is usually seen within a few
+ * polls, so the card is polled back to back first and only then the task
+ * sleeps between polls.
+ *
+ * @return last value read from the card
  */
 static uint8_t
-wait_busy(struct mmc_cfg *mmc)
+mmc_poll(struct mmc_cfg *mmc, uint8_t idle, os_time_t ticks)
 {
     os_time_t timeout;
     uint8_t res;
+    int n;
+
+    for (n = 0; n < MMC_SPIN_POLLS; n++) {
+        res = hal_spi_tx_val(mmc->spi_num, 0xff);
+        if (res != idle) {
+            return res;
+        }
+    }
 
-    timeout = os_time_get() + OS_TICKS_PER_SEC / 2;
+    timeout = os_time_get() + ticks;
     do {
+        os_time_delay(1);
         res = hal_spi_tx_val(mmc->spi_num, 0xff);
-        if (res) break;
-        os_time_delay(OS_TICKS_PER_SEC / 1000);
-    } while (os_time_get() < timeout);
+    } while (res == idle && OS_TIME_TICK_LT(os_time_get(), timeout));
 
     return res;
 }
 
 /**
- * @return 0 on success, non-zero on failure
+ * Commands that return response in R1b format and write
+ * commands enter busy state and keep return 0 while the
+ * operations are in progress.
  */
-int
-mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
+static uint8_t
+wait_busy(struct mmc_cfg *mmc)
 {
-    uint8_t cmd;
-    uint8_t res;
-    int rc;
-    uint32_t n;
-    size_t block_len;
-    size_t block_count;
-    os_time_t timeout;
-    uint32_t block_addr;
-    size_t offset;
-    size_t index;
-    size_t amount;
-    struct mmc_cfg *mmc;
-
-    mmc = mmc_cfg_dev(mmc_id);
-    if (mmc == NULL) {
-        return (MMC_DEVICE_ERROR);
-    }
-
-    rc = MMC_OK;
-
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
-    block_addr = addr / BLOCK_LEN;
-    offset = addr - (block_addr * BLOCK_LEN);
-
-    hal_gpio_write(mmc->ss_pin, 0);
+    return mmc_poll(mmc, 0x00, OS_TICKS_PER_SEC / 2);
+}
 
-    cmd = (block_count == 1) ? CMD17 : CMD18;
-    res = send_mmc_cmd(mmc, cmd, block_addr);
-    if (res) {
-        rc = error_by_response(res);
-        goto out;
-    }
+/**
+ * Receives one data block following CMD17/CMD18.
+ */
+static int
+mmc_read_block(struct mmc_cfg *mmc, uint8_t *dst)
+{
+    uint8_t res;
 
     /**
      * 7.3.3 Control tokens
      *   Wait up to 200ms for control token.
      */
-    timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-    do {
-        res = hal_spi_tx_val(mmc->spi_num, 0xff);
-        if (res != 0xFF) break;
-        os_time_delay(OS_TICKS_PER_SEC / 20);
-    } while (os_time_get() < timeout);
+    res = mmc_poll(mmc, 0xff, OS_TICKS_PER_SEC / 5);
 
     /**
      * 7.3.3.2 Start Block Tokens and Stop Tran Token
      */
     if (res != START_BLOCK) {
-        rc = MMC_TIMEOUT;
-        goto out;
+        return MMC_TIMEOUT;
     }
 
-    index = 0;
-    while (block_count--) {
-        for (n = 0; n < BLOCK_LEN; n++) {
-            g_block_buf[n] = hal_spi_tx_val(mmc->spi_num, 0xff);
-        }
+    /* Tx data does not matter, clock out 0xff using the read buffer */
+    memset(dst, 0xff, BLOCK_LEN);
+    hal_spi_txrx(mmc->spi_num, dst, dst, BLOCK_LEN);
 
-        /* TODO: CRC-16 not used here but would be cool to have */
-        hal_spi_tx_val(mmc->spi_num, 0xff);
-        hal_spi_tx_val(mmc->spi_num, 0xff);
+    /* TODO: CRC-16 not used here but would be cool to have */
+    hal_spi_tx_val(mmc->spi_num, 0xff);
+    hal_spi_tx_val(mmc->spi_num, 0xff);
+
+    return MMC_OK;
+}
+
+/**
+ * Reads whole blocks; a single command is used for all of them.
+ * Partial first and last blocks go through g_block_buf, all others are
+ * received directly into the caller's buffer.
+ */
+static int
+mmc_read_blocks(struct mmc_cfg *mmc, uint32_t block_addr, size_t offset,
+                uint8_t *buf, uint32_t len)
+{
+    uint8_t cmd;
+    uint8_t res;
+    size_t block_count;
+    size_t amount;
+    uint8_t *dst;
+    int rc;
 
+    block_count = (offset + len + BLOCK_LEN - 1) / BLOCK_LEN;
+
+    cmd = (block_count == 1) ? CMD17 : CMD18;
+    res = send_mmc_cmd(mmc, cmd, block_addr);
+    if (res) {
+        return error_by_response(res);
+    }
+
+    rc = MMC_OK;
+    while (block_count--) {
         amount = MIN(BLOCK_LEN - offset, len);
+        dst = (amount == BLOCK_LEN) ? buf : g_block_buf;
 
-        memcpy(((uint8_t *)buf + index), &g_block_buf[offset], amount);
+        rc = mmc_read_block(mmc, dst);
+        if (rc) {
+            break;
+        }
+        if (dst == g_block_buf) {
+            memcpy(buf, &g_block_buf[offset], amount);
+        }
 
         offset = 0;
         len -= amount;
-        index += amount;
+        buf += amount;
     }
 
     if (cmd == CMD18) {
@@ -439,28 +460,18 @@ mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
         wait_busy(mmc);
     }
 
-out:
-    hal_gpio_write(mmc->ss_pin, 1);
-    return (rc);
+    return rc;
 }
 
 /**
  * @return 0 on success, non-zero on failure
  */
 int
-mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
+mmc_read(uint8_t mmc_id, uint32_t addr, void *buf, uint32_t len)
 {
-    uint8_t cmd;
-    uint8_t res;
-    uint32_t n;
-    size_t block_len;
-    size_t block_count;
-    os_time_t timeout;
+    int rc;
     uint32_t block_addr;
     size_t offset;
-    size_t index;
-    size_t amount;
-    int rc;
     struct mmc_cfg *mmc;
 
     mmc = mmc_cfg_dev(mmc_id);
@@ -468,58 +479,42 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
         return (MMC_DEVICE_ERROR);
     }
 
-    block_len = (len + BLOCK_LEN - 1) & ~(BLOCK_LEN - 1);
-    block_count = block_len / BLOCK_LEN;
+    if (len == 0) {
+        return (MMC_OK);
+    }
+
     block_addr = addr / BLOCK_LEN;
     offset = addr - (block_addr * BLOCK_LEN);
 
     hal_gpio_write(mmc->ss_pin, 0);
 
-    /**
-     * This code ensures that if the requested address doesn't align with the
-     * beginning address of a sector, the initial bytes are first read to the
-     * buffer to be then written later.
-     *
-     * NOTE: this code will never run when using a FS that is sector addressed
-     * like FAT (offset is always 0).
-     */
-    if (offset) {
-        res = send_mmc_cmd(mmc, CMD17, block_addr);
-        if (res != 0) {
-            rc = error_by_response(res);
-            goto out;
-        }
-
-        timeout = os_time_get() + OS_TICKS_PER_SEC / 5;
-        do {
-            res = hal_spi_tx_val(mmc->spi_num, 0xff);
-            if (res != 0xff) break;
-            os_time_delay(OS_TICKS_PER_SEC / 20);
-        } while (os_time_get() < timeout);
-
-        if (res != START_BLOCK) {
-            rc = MMC_CARD_ERROR;
-            goto out;
-        }
-
-        for (n = 0; n < BLOCK_LEN; n++) {
-            g_block_buf[n] = hal_spi_tx_val(mmc->spi_num, 0xff);
-        }
+    rc = mmc_read_blocks(mmc, block_addr, offset, buf, len);
 
-        hal_spi_tx_val(mmc->spi_num, 0xff);
-        hal_spi_tx_val(mmc->spi_num, 0xff);
-    }
+    hal_gpio_write(mmc->ss_pin, 1);
+    return (rc);
+}
 
-    /* now start write */
+/**
+ * Writes whole blocks from buf, with CMD25 when there is more than one.
+ */
+static int
+mmc_write_blocks(struct mmc_cfg *mmc, uint32_t block_addr, const uint8_t *buf,
+                 size_t block_count)
+{
+    uint8_t cmd;
+    uint8_t res;
+    int rc;
 
     cmd = (block_count == 1) ? CMD24 : CMD25;
     res = send_mmc_cmd(mmc, cmd, block_addr);
     if (res) {
-        rc = error_by_response(res);
-        goto out;
+        return error_by_response(res);
     }
 
-    index = 0;
+    /* One byte gap before first data token */
+    hal_spi_tx_val(mmc->spi_num, 0xff);
+
+    res = 0x05;
     while (block_count--) {
         /**
          * 7.3.3.2 Start Block Tokens and Stop Tran Token
@@ -530,12 +525,8 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
             hal_spi_tx_val(mmc->spi_num, START_BLOCK_TOKEN);
         }
 
-        amount = MIN(BLOCK_LEN - offset, len);
-        memcpy(&g_block_buf[offset], ((uint8_t *)buf + index), amount);
-
-        for (n = 0; n < BLOCK_LEN; n++) {
-            hal_spi_tx_val(mmc->spi_num, g_block_buf[n]);
-        }
+        /* Nothing to receive, data goes straight from the caller's buffer */
+        hal_spi_txrx(mmc->spi_num, (void *)buf, NULL, BLOCK_LEN);
 
         /* CRC */
         hal_spi_tx_val(mmc->spi_num, 0xff);
@@ -549,17 +540,16 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
             break;
         }
 
-        if (cmd == CMD25) {
-            wait_busy(mmc);
-        }
+        /* Card is busy programming the block */
+        wait_busy(mmc);
 
-        offset = 0;
-        len -= amount;
-        index += amount;
+        buf += BLOCK_LEN;
     }
 
     if (cmd == CMD25) {
         hal_spi_tx_val(mmc->spi_num, STOP_TRAN_TOKEN);
+        /* Busy is signalled after one byte */
+        hal_spi_tx_val(mmc->spi_num, 0xff);
         wait_busy(mmc);
     }
 
@@ -576,7 +566,87 @@ mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
             rc = MMC_WRITE_ERROR;
     }
 
-    wait_busy(mmc);
+    return rc;
+}
+
+/**
+ * Updates part of a single block, by reading it first.
+ */
+static int
+mmc_write_partial(struct mmc_cfg *mmc, uint32_t block_addr, size_t offset,
+                  const uint8_t *buf, size_t len)
+{
+    int rc;
+
+    rc = mmc_read_blocks(mmc, block_addr, 0, g_block_buf, BLOCK_LEN);
+    if (rc) {
+        return rc;
+    }
+
+    memcpy(&g_block_buf[offset], buf, len);
+
+    return mmc_write_blocks(mmc, block_addr, g_block_buf, 1);
+}
+
+/**
+ * @return 0 on success, non-zero on failure
+ */
+int
+mmc_write(uint8_t mmc_id, uint32_t addr, const void *buf, uint32_t len)
+{
+    const uint8_t *src;
+    size_t block_count;
+    uint32_t block_addr;
+    size_t offset;
+    size_t amount;
+    int rc;
+    struct mmc_cfg *mmc;
+
+    mmc = mmc_cfg_dev(mmc_id);
+    if (mmc == NULL) {
+        return (MMC_DEVICE_ERROR);
+    }
+
+    rc = MMC_OK;
+    src = buf;
+    block_addr = addr / BLOCK_LEN;
+    offset = addr - (block_addr * BLOCK_LEN);
+
+    hal_gpio_write(mmc->ss_pin, 0);
+
+    /**
+     * This code ensures that if the requested address or length doesn't
+     * align with sector boundaries, the rest of the first and last sector is
+     * first read to the buffer to be then written back.
+     *
+     * NOTE: this code will never run when using a FS that is sector addressed
+     * like FAT (offset is always 0).
+     */
+    if (offset || (len && len < BLOCK_LEN)) {
+        amount = MIN(BLOCK_LEN - offset, len);
+        rc = mmc_write_partial(mmc, block_addr, offset, src, amount);
+        if (rc) {
+            goto out;
+        }
+        block_addr++;
+        src += amount;
+        len -= amount;
+    }
+
+    block_count = len / BLOCK_LEN;
+    if (block_count) {
+        rc = mmc_write_blocks(mmc, block_addr, src, block_count);
+        if (rc) {
+            goto out;
+        }
+        block_addr += block_count;
+        src += block_count * BLOCK_LEN;
+        len -= block_count * BLOCK_LEN;
+    }
+
+    if (len) {
+        rc = mmc_write_partial(mmc, block_addr, 0, src, len);
+    }
 
 out:
     hal_gpio_write(mmc->ss_pin, 1);
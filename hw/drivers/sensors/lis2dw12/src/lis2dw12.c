@@ -196,6 +196,8 @@ static int lis2dw12_sensor_unset_notification(struct sensor *,
                                               sensor_event_type_t);
 static int lis2dw12_sensor_handle_interrupt(struct sensor *);
 static int lis2dw12_sensor_set_config(struct sensor *, void *);
+static int lis2dw12_sensor_read_block(struct sensor *, sensor_type_t,
+                                      sensor_block_func_t, void *, uint32_t);
 
 static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_read               = lis2dw12_sensor_read,
@@ -203,8 +205,8 @@ static const struct sensor_driver g_lis2dw12_sensor_driver = {
     .sd_get_config         = lis2dw12_sensor_get_config,
     .sd_set_notification   = lis2dw12_sensor_set_notification,
     .sd_unset_notification = lis2dw12_sensor_unset_notification,
-    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt
-
+    .sd_handle_interrupt   = lis2dw12_sensor_handle_interrupt,
+    .sd_read_block         = lis2dw12_sensor_read_block,
 };
 
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
@@ -2502,6 +2504,35 @@ lis2dw12_get_fs(struct sensor_itf *itf, uint8_t *fs)
     return 0;
 }
 
+/**
+ * Converts a raw 6 byte OUT_X_L..OUT_Z_H sample to mg.
+ *
+ * @param The raw sample
+ * @param The full scale setting
+ * @param x axis data
+ * @param y axis data
+ * @param z axis data
+ */
+static void
+lis2dw12_convert_data(const uint8_t *payload, uint8_t fs,
+                      int16_t *x, int16_t *y, int16_t *z)
+{
+    *x = payload[0] | (payload[1] << 8);
+    *y = payload[2] | (payload[3] << 8);
+    *z = payload[4] | (payload[5] << 8);
+
+    /*
+     * Since full scale is +/-(fs)g,
+     * fs should be multiplied by 2 to account for full scale.
+     * To calculate mg from g we use the 1000 multiple.
+     * Since the full scale is represented by 16 bit value,
+     * we use that as a divisor.
+     */
+    *x = (fs * 2 * 1000 * *x)/UINT16_MAX;
+    *y = (fs * 2 * 1000 * *y)/UINT16_MAX;
+    *z = (fs * 2 * 1000 * *z)/UINT16_MAX;
+}
+
 /**
  * Gets a new data sample from the sensor.
  *
@@ -2525,20 +2556,7 @@ lis2dw12_get_data(struct sensor_itf *itf, uint8_t fs, int16_t *x, int16_t *y, in
         goto err;
     }
 
-    *x = payload[0] | (payload[1] << 8);
-    *y = payload[2] | (payload[3] << 8);
-    *z = payload[4] | (payload[5] << 8);
-
-    /*
-     * Since full scale is +/-(fs)g,
-     * fs should be multiplied by 2 to account for full scale.
-     * To calculate mg from g we use the 1000 multiple.
-     * Since the full scale is represented by 16 bit value,
-     * we use that as a divisor.
-     */
-    *x = (fs * 2 * 1000 * *x)/UINT16_MAX;
-    *y = (fs * 2 * 1000 * *y)/UINT16_MAX;
-    *z = (fs * 2 * 1000 * *z)/UINT16_MAX;
+    lis2dw12_convert_data(payload, fs, x, y, z);
 
     return 0;
 err:
@@ -2744,23 +2762,22 @@ err:
     }
 }
 
+/**
+ * Prepare the sensor interface for a read
+ *
+ * @param The sensor ptr
+ *
+ * @return 0 on success, non-zero on failure.
+ */
 static int
-lis2dw12_sensor_read(struct sensor *sensor, sensor_type_t type,
-        sensor_data_func_t data_func, void *data_arg, uint32_t timeout)
+lis2dw12_itf_setup(struct sensor *sensor)
 {
     int rc;
-    const struct lis2dw12_cfg *cfg;
-    struct lis2dw12 *lis2dw12;
     struct sensor_itf *itf;
 
-    /* If the read isn't looking for accel data, don't do anything. */
-    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
-        rc = SYS_EINVAL;
-        goto err;
-    }
-
     itf = SENSOR_GET_ITF(sensor);
     (void)itf;
+    rc = 0;
 
 #if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
     if (itf->si_type == SENSOR_ITF_SPI) {
@@ -2783,8 +2800,190 @@ lis2dw12_sensor_read(struct sensor *sensor, sensor_type_t type,
             goto err;
         }
     }
+err:
+#endif
+
+    return rc;
+}
+
+/* Sample period in microseconds, indexed by LIS2DW12_DATA_RATE_* >> 4. */
+static const uint32_t lis2dw12_rate_itvl_us[] = {
+    0, 625000, 80000, 40000, 20000, 10000, 5000, 2500, 1250, 625
+};
+
+/* Maximum number of readings passed in one block. */
+#define LIS2DW12_BLOCK_MAX  (8)
+
+/**
+ * Read full scale, FIFO level and FIFO contents with the interface locked
+ * once for the whole sequence.
+ *
+ * @param The sensor interface
+ * @param Pointer to store full scale in g
+ * @param Pointer to store number of samples read
+ * @param Buffer for LIS2DW12_FIFO_SAMPLES_MAX samples
+ *
+ * @return 0 on success, non-zero on failure
+ */
+static int
+lis2dw12_fifo_drain(struct sensor_itf *itf, uint8_t *fs, uint8_t *samples,
+                    uint8_t *payload)
+{
+    int rc;
+
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    rc = bus_node_lock(itf->si_dev, bus_node_get_lock_timeout(itf->si_dev));
+#else
+    rc = sensor_itf_lock(itf, MYNEWT_VAL(LIS2DW12_ITF_LOCK_TMO));
+#endif
+    if (rc) {
+        return rc;
+    }
+
+    rc = lis2dw12_get_fs(itf, fs);
+    if (rc) {
+        goto done;
+    }
+
+    rc = lis2dw12_get_fifo_samples(itf, samples);
+    if (rc) {
+        goto done;
+    }
+    *samples = min(*samples, LIS2DW12_FIFO_SAMPLES_MAX);
+    if (*samples == 0) {
+        goto done;
+    }
+
+    /* With the FIFO enabled, the register address rolls back from OUT_Z_H
+     * to OUT_X_L, so one burst returns consecutive FIFO entries.
+     */
+    rc = lis2dw12_readlen(itf, LIS2DW12_REG_OUT_X_L, payload, *samples * 6);
+
+done:
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    (void)bus_node_unlock(itf->si_dev);
+#else
+    sensor_itf_unlock(itf);
 #endif
 
+    return rc;
+}
+
+/**
+ * Read the whole FIFO in one bus transfer and pass the readings on in
+ * blocks.  Only available in poll mode with the FIFO enabled.
+ *
+ * @param The sensor ptr
+ * @param The sensor type
+ * @param The function to invoke for each block of readings.
+ * @param The opaque pointer that will be passed in to the function.
+ * @param Timeout, unused
+ *
+ * @return 0 on success, SYS_ENOTSUP if not in FIFO poll mode, other
+ *         non-zero on failure.
+ */
+static int
+lis2dw12_sensor_read_block(struct sensor *sensor, sensor_type_t type,
+        sensor_block_func_t block_func, void *block_arg, uint32_t timeout)
+{
+    uint8_t payload[LIS2DW12_FIFO_SAMPLES_MAX * 6];
+    struct sensor_accel_data sad[LIS2DW12_BLOCK_MAX];
+    struct sensor_block block;
+    const struct lis2dw12_cfg *cfg;
+    struct lis2dw12 *lis2dw12;
+    struct sensor_itf *itf;
+    int16_t x, y, z;
+    float fx, fy, fz;
+    uint8_t samples;
+    uint8_t fs;
+    uint32_t now;
+    int rc;
+    int i;
+    int j;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        return SYS_EINVAL;
+    }
+
+    lis2dw12 = (struct lis2dw12 *)SENSOR_GET_DEVICE(sensor);
+    itf = SENSOR_GET_ITF(sensor);
+    cfg = &lis2dw12->cfg;
+
+    if (cfg->read_mode.mode != LIS2DW12_READ_M_POLL ||
+        cfg->fifo_mode == LIS2DW12_FIFO_M_BYPASS) {
+        return SYS_ENOTSUP;
+    }
+
+    rc = lis2dw12_itf_setup(sensor);
+    if (rc) {
+        return SYS_EINVAL;
+    }
+
+    rc = lis2dw12_fifo_drain(itf, &fs, &samples, payload);
+    if (rc || samples == 0) {
+        return rc;
+    }
+    now = os_cputime_get32();
+
+    block.sb_type = SENSOR_TYPE_ACCELEROMETER;
+    block.sb_stride = sizeof(sad[0]);
+    block.sb_data = sad;
+    block.sb_itvl_us = 0;
+    if ((cfg->rate >> 4) < ARRAY_SIZE(lis2dw12_rate_itvl_us)) {
+        block.sb_itvl_us = lis2dw12_rate_itvl_us[cfg->rate >> 4];
+    }
+
+    for (i = 0; i < samples; i += block.sb_count) {
+        block.sb_count = min(samples - i, LIS2DW12_BLOCK_MAX);
+
+        for (j = 0; j < block.sb_count; j++) {
+            lis2dw12_convert_data(&payload[(i + j) * 6], fs, &x, &y, &z);
+
+            /* converting values from mg to ms^2 */
+            lis2dw12_calc_acc_ms2(x, &fx);
+            lis2dw12_calc_acc_ms2(y, &fy);
+            lis2dw12_calc_acc_ms2(z, &fz);
+
+            sad[j].sad_x = fx;
+            sad[j].sad_y = fy;
+            sad[j].sad_z = fz;
+
+            sad[j].sad_x_is_valid = 1;
+            sad[j].sad_y_is_valid = 1;
+            sad[j].sad_z_is_valid = 1;
+        }
+
+        block.sb_cputime = now - os_cputime_usecs_to_ticks(
+            (samples - i - block.sb_count) * block.sb_itvl_us);
+
+        rc = block_func(sensor, block_arg, &block);
+        if (rc) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+lis2dw12_sensor_read(struct sensor *sensor, sensor_type_t type,
+        sensor_data_func_t data_func, void *data_arg, uint32_t timeout)
+{
+    int rc;
+    const struct lis2dw12_cfg *cfg;
+    struct lis2dw12 *lis2dw12;
+
+    /* If the read isn't looking for accel data, don't do anything. */
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        rc = SYS_EINVAL;
+        goto err;
+    }
+
+    rc = lis2dw12_itf_setup(sensor);
+    if (rc) {
+        goto err;
+    }
+
     lis2dw12 = (struct lis2dw12 *)SENSOR_GET_DEVICE(sensor);
     cfg = &lis2dw12->cfg;
 
@@ -3214,90 +3413,61 @@ err:
 }
 
 /**
- * Configure the sensor
+ * Program the configuration registers, with the interface lock held
+ * across all of them.  The lock is recursive, so each register access
+ * below only nests in it and other nodes on the bus cannot get between
+ * the read-modify-write sequences.
  *
  * @param ptr to sensor driver
  * @param ptr to sensor driver config
+ *
+ * @return 0 on success, non-zero on failure
  */
-int
-lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
+static int
+lis2dw12_config_regs(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
 {
-    int rc;
     struct sensor_itf *itf;
-    uint8_t chip_id;
-    struct sensor *sensor;
+    int rc;
 
     itf = SENSOR_GET_ITF(&(lis2dw12->sensor));
 
-    (void)sensor;
-
-#if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
-    if (itf->si_type == SENSOR_ITF_SPI) {
-        sensor = &(lis2dw12->sensor);
-
-        rc = hal_spi_disable(sensor->s_itf.si_num);
-        if (rc) {
-            goto err;
-        }
-
-        rc = hal_spi_config(sensor->s_itf.si_num, &spi_lis2dw12_settings);
-        if (rc == EINVAL) {
-            /* If spi is already enabled, for nrf52, it returns -1, We should not
-             * fail if the spi is already enabled
-             */
-            goto err;
-        }
-
-        rc = hal_spi_enable(sensor->s_itf.si_num);
-        if (rc) {
-            goto err;
-        }
-    }
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    rc = bus_node_lock(itf->si_dev, bus_node_get_lock_timeout(itf->si_dev));
+#else
+    rc = sensor_itf_lock(itf, MYNEWT_VAL(LIS2DW12_ITF_LOCK_TMO));
 #endif
-
-    rc = lis2dw12_get_chip_id(itf, &chip_id);
-    if (rc) {
-        goto err;
-    }
-
-    if (chip_id != LIS2DW12_ID) {
-        rc = SYS_EINVAL;
-        goto err;
-    }
-
-    rc = lis2dw12_reset(itf);
     if (rc) {
-        goto err;
+        return rc;
     }
 
     rc = lis2dw12_set_int_pp_od(itf, cfg->int_pp_od);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.int_pp_od = cfg->int_pp_od;
 
     rc = lis2dw12_set_latched_int(itf, cfg->int_latched);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.int_latched = cfg->int_latched;
 
     rc = lis2dw12_set_int_active_low(itf, cfg->int_active_low);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.int_active_low = cfg->int_active_low;
 
     rc = lis2dw12_set_slp_mode(itf, cfg->slp_mode);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.slp_mode = cfg->slp_mode;
 
     rc = lis2dw12_set_offsets(itf, cfg->offset_x, cfg->offset_y, cfg->offset_z,
                               cfg->offset_weight);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.offset_x = cfg->offset_x;
@@ -3307,14 +3477,14 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
 
     rc = lis2dw12_set_offset_enable(itf, cfg->offset_en);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.offset_en = cfg->offset_en;
 
     rc = lis2dw12_set_filter_cfg(itf, cfg->filter_bw, cfg->high_pass);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.filter_bw = cfg->filter_bw;
@@ -3322,35 +3492,35 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
 
     rc = lis2dw12_set_full_scale(itf, cfg->fs);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.fs = cfg->fs;
 
     rc = lis2dw12_set_rate(itf, cfg->rate);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.rate = cfg->rate;
 
     rc = lis2dw12_set_power_mode(itf, cfg->power_mode);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.power_mode = cfg->power_mode;
 
     rc = lis2dw12_set_low_noise(itf, cfg->low_noise_enable);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.low_noise_enable = cfg->low_noise_enable;
 
     rc = lis2dw12_set_fifo_cfg(itf, cfg->fifo_mode, cfg->fifo_threshold);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.fifo_mode = cfg->fifo_mode;
@@ -3358,82 +3528,153 @@ lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
 
     rc = lis2dw12_set_wake_up_ths(itf, cfg->wake_up_ths);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.wake_up_ths = cfg->wake_up_ths;
 
     rc = lis2dw12_set_wake_up_dur(itf, cfg->wake_up_dur);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.wake_up_dur = cfg->wake_up_dur;
 
     rc = lis2dw12_set_sleep_dur(itf, cfg->sleep_duration);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.sleep_duration = cfg->sleep_duration;
 
     rc = lis2dw12_set_stationary_en(itf, cfg->stationary_detection_enable);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.stationary_detection_enable = cfg->stationary_detection_enable;
 
     rc = lis2dw12_set_inactivity_sleep_en(itf, cfg->inactivity_sleep_enable);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.inactivity_sleep_enable = cfg->inactivity_sleep_enable;
 
     rc = lis2dw12_set_double_tap_event_en(itf, cfg->double_tap_event_enable);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.double_tap_event_enable = cfg->double_tap_event_enable;
 
     rc = lis2dw12_set_freefall(itf, cfg->freefall_dur, cfg->freefall_ths);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.freefall_dur = cfg->freefall_dur;
     lis2dw12->cfg.freefall_ths = cfg->freefall_ths;
 
-
     rc = lis2dw12_set_int_enable(itf, cfg->int_enable);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.int_enable = cfg->int_enable;
 
     rc = lis2dw12_set_int1_pin_cfg(itf, cfg->int1_pin_cfg);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.int1_pin_cfg = cfg->int1_pin_cfg;
 
     rc = lis2dw12_set_int2_pin_cfg(itf, cfg->int2_pin_cfg);
     if (rc) {
-        goto err;
+        goto done;
     }
 
     lis2dw12->cfg.int2_pin_cfg = cfg->int2_pin_cfg;
 
     rc = lis2dw12_set_tap_cfg(itf, &cfg->tap);
     if (rc) {
-        goto err;
+        goto done;
     }
     lis2dw12->cfg.tap = cfg->tap;
 
     rc = lis2dw12_set_int2_on_int1_map(itf, cfg->map_int2_to_int1);
-    if(rc) {
-        goto err;
+    if (rc) {
+        goto done;
     }
     lis2dw12->cfg.map_int2_to_int1 = cfg->map_int2_to_int1;
 
+done:
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    (void)bus_node_unlock(itf->si_dev);
+#else
+    sensor_itf_unlock(itf);
+#endif
+
+    return rc;
+}
+
+/**
+ * Configure the sensor
+ *
+ * @param ptr to sensor driver
+ * @param ptr to sensor driver config
+ */
+int
+lis2dw12_config(struct lis2dw12 *lis2dw12, struct lis2dw12_cfg *cfg)
+{
+    int rc;
+    struct sensor_itf *itf;
+    uint8_t chip_id;
+    struct sensor *sensor;
+
+    itf = SENSOR_GET_ITF(&(lis2dw12->sensor));
+
+    (void)sensor;
+
+#if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    if (itf->si_type == SENSOR_ITF_SPI) {
+        sensor = &(lis2dw12->sensor);
+
+        rc = hal_spi_disable(sensor->s_itf.si_num);
+        if (rc) {
+            goto err;
+        }
+
+        rc = hal_spi_config(sensor->s_itf.si_num, &spi_lis2dw12_settings);
+        if (rc == EINVAL) {
+            /* If spi is already enabled, for nrf52, it returns -1, We should not
+             * fail if the spi is already enabled
+             */
+            goto err;
+        }
+
+        rc = hal_spi_enable(sensor->s_itf.si_num);
+        if (rc) {
+            goto err;
+        }
+    }
+#endif
+
+    rc = lis2dw12_get_chip_id(itf, &chip_id);
+    if (rc) {
+        goto err;
+    }
+
+    if (chip_id != LIS2DW12_ID) {
+        rc = SYS_EINVAL;
+        goto err;
+    }
+
+    rc = lis2dw12_reset(itf);
+    if (rc) {
+        goto err;
+    }
+
+    rc = lis2dw12_config_regs(lis2dw12, cfg);
+    if (rc) {
+        goto err;
+    }
+
     rc = sensor_set_type_mask(&(lis2dw12->sensor), cfg->mask);
     if (rc) {
         goto err;
@@ -83,6 +83,7 @@ extern "C" {
 #define LIS2DW12_FIFO_SAMPLES_FTH        (1 << 7)
 #define LIS2DW12_FIFO_SAMPLES_OVR        (1 << 6)
 #define LIS2DW12_FIFO_SAMPLES              (0x3F)
+#define LIS2DW12_FIFO_SAMPLES_MAX          (32)
     
 #define LIS2DW12_REG_TAP_THS_X               0x30
 #define LIS2DW12_TAP_THS_X_4D_EN         (1 << 7)
@@ -34,12 +34,18 @@ static int sim_accel_sensor_read(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 static int sim_accel_sensor_get_config(struct sensor *, sensor_type_t,
         struct sensor_cfg *);
+static int sim_accel_sensor_read_block(struct sensor *, sensor_type_t,
+        sensor_block_func_t, void *, uint32_t);
 
 static const struct sensor_driver g_sim_accel_sensor_driver = {
-    sim_accel_sensor_read,
-    sim_accel_sensor_get_config
+    .sd_read       = sim_accel_sensor_read,
+    .sd_get_config = sim_accel_sensor_get_config,
+    .sd_read_block = sim_accel_sensor_read_block,
 };
 
+/* Maximum number of readings passed in one block. */
+#define SIM_ACCEL_BLOCK_MAX (16)
+
 /**
  * Expects to be called back through os_dev_create().
  *
@@ -89,13 +95,51 @@ sim_accel_config(struct sim_accel *sa, struct sim_accel_cfg *cfg)
     return (0);
 }
 
+/**
+ * Returns the number of readings generated since the last read, based on
+ * the sample interval provided to sim_accel_config().
+ */
+static uint32_t
+sim_accel_num_samples(struct sim_accel *sa)
+{
+    os_time_t now;
+    uint32_t num_samples;
+
+    now = os_time_get();
+
+    num_samples = (now - sa->sa_last_read_time) / sa->sa_cfg.sac_sample_itvl;
+    return min(num_samples, sa->sa_cfg.sac_nr_samples);
+}
+
+static void
+sim_accel_fill(struct sim_accel *sa, struct sensor_accel_data *sad)
+{
+    /* By default only readings are provided for 1-axis (x), however,
+     * if number of axises is configured, up to 3-axises of data can be
+     * returned.
+     */
+    sad->sad_x = 0.0;
+    sad->sad_y = 0.0;
+    sad->sad_z = 0.0;
+
+    sad->sad_x_is_valid = 1;
+    sad->sad_y_is_valid = 0;
+    sad->sad_z_is_valid = 0;
+
+    if (sa->sa_cfg.sac_nr_axises > 1) {
+        sad->sad_y = 0.0;
+    }
+    if (sa->sa_cfg.sac_nr_axises > 2) {
+        sad->sad_z = 0.0;
+    }
+}
+
 static int
 sim_accel_sensor_read(struct sensor *sensor, sensor_type_t type,
         sensor_data_func_t data_func, void *data_arg, uint32_t timeout)
 {
     struct sim_accel *sa;
     struct sensor_accel_data sad;
-    os_time_t now;
     uint32_t num_samples;
     int i;
     int rc;
@@ -113,33 +157,68 @@ sim_accel_sensor_read(struct sensor *sensor, sensor_type_t type,
      * interval provided to sim_accel_config() and the last time this function
      * was called, 'n' samples are generated.
      */
-    now = os_time_get();
+    num_samples = sim_accel_num_samples(sa);
 
-    num_samples = (now - sa->sa_last_read_time) / sa->sa_cfg.sac_sample_itvl;
-    num_samples = min(num_samples, sa->sa_cfg.sac_nr_samples);
+    sim_accel_fill(sa, &sad);
 
-    /* By default only readings are provided for 1-axis (x), however,
-     * if number of axises is configured, up to 3-axises of data can be
-     * returned.
-     */
-    sad.sad_x = 0.0;
-    sad.sad_y = 0.0;
-    sad.sad_z = 0.0;
+    /* Call data function for each of the generated readings. */
+    for (i = 0; i < num_samples; i++) {
+        rc = data_func(sensor, data_arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+        if (rc != 0) {
+            goto err;
+        }
+    }
 
-    sad.sad_x_is_valid = 1;
-    sad.sad_y_is_valid = 0;
-    sad.sad_z_is_valid = 0;
+    return (0);
+err:
+    return (rc);
+}
 
-    if (sa->sa_cfg.sac_nr_axises > 1) {
-        sad.sad_y = 0.0;
+/**
+ * Same as sim_accel_sensor_read(), but passes the generated readings in
+ * blocks of up to SIM_ACCEL_BLOCK_MAX, as a driver reading a hardware FIFO
+ * would.
+ */
+static int
+sim_accel_sensor_read_block(struct sensor *sensor, sensor_type_t type,
+        sensor_block_func_t block_func, void *block_arg, uint32_t timeout)
+{
+    struct sensor_accel_data sad[SIM_ACCEL_BLOCK_MAX];
+    struct sensor_block block;
+    struct sim_accel *sa;
+    uint32_t num_samples;
+    uint32_t now;
+    int i;
+    int rc;
+
+    if (!(type & SENSOR_TYPE_ACCELEROMETER)) {
+        rc = SYS_EINVAL;
+        goto err;
     }
-    if (sa->sa_cfg.sac_nr_axises > 2) {
-        sad.sad_z = 0.0;
+
+    sa = (struct sim_accel *) SENSOR_GET_DEVICE(sensor);
+
+    num_samples = sim_accel_num_samples(sa);
+
+    for (i = 0; i < min(num_samples, SIM_ACCEL_BLOCK_MAX); i++) {
+        sim_accel_fill(sa, &sad[i]);
     }
 
-    /* Call data function for each of the generated readings. */
-    for (i = 0; i < num_samples; i++) {
-        rc = data_func(sensor, data_arg, &sad, SENSOR_TYPE_ACCELEROMETER);
+    now = os_cputime_get32();
+
+    block.sb_type = SENSOR_TYPE_ACCELEROMETER;
+    block.sb_stride = sizeof(sad[0]);
+    block.sb_data = sad;
+    block.sb_itvl_us = (uint64_t)sa->sa_cfg.sac_sample_itvl * 1000000 /
+                       OS_TICKS_PER_SEC;
+
+    while (num_samples > 0) {
+        block.sb_count = min(num_samples, SIM_ACCEL_BLOCK_MAX);
+        num_samples -= block.sb_count;
+        block.sb_cputime = now -
+            os_cputime_usecs_to_ticks(num_samples * block.sb_itvl_us);
+
+        rc = block_func(sensor, block_arg, &block);
         if (rc != 0) {
             goto err;
         }
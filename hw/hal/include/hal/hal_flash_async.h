@@ -0,0 +1,143 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * @addtogroup HAL
+ * @{
+ *   @defgroup HALFlashAsync HAL Flash asynchronous requests
+ *   @{
+ */
+
+#ifndef H_HAL_FLASH_ASYNC_
+#define H_HAL_FLASH_ASYNC_
+
+#include <inttypes.h>
+#include "syscfg/syscfg.h"
+#include "os/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+
+#define HAL_FLASH_OP_READ           0
+#define HAL_FLASH_OP_WRITE          1
+#define HAL_FLASH_OP_ERASE          2
+
+struct hal_flash_req;
+
+/**
+ * Request completion callback
+ *
+ * Called from flash device task once request is completed. Request object
+ * is not used anymore when callback is called so it can be submitted again
+ * from callback.
+ *
+ * @param req     Request object
+ * @param status  0 on success, SYS_Exxx on error
+ * @param arg     Callback argument as set in request object
+ */
+typedef void (*hal_flash_req_cb_t)(struct hal_flash_req *req, int status,
+                                   void *arg);
+
+/**
+ * Asynchronous flash request
+ *
+ * Object shall be zero-initialized before first use. Object shall be valid,
+ * and buffer shall not be accessed, until completion callback is called.
+ */
+struct hal_flash_req {
+    /** HAL_FLASH_OP_xxx */
+    uint8_t fr_op;
+    /** Flash device ID */
+    uint8_t fr_flash_id;
+    /** Address to read, write or erase */
+    uint32_t fr_addr;
+    /** Number of bytes to read, write or erase */
+    uint32_t fr_len;
+    /** Data buffer, not used for erase */
+    void *fr_buf;
+    /** Completion callback */
+    hal_flash_req_cb_t fr_cb;
+    /** Completion callback argument */
+    void *fr_cb_arg;
+
+    /* Internal state, managed by hal_flash */
+    STAILQ_ENTRY(hal_flash_req) fr_next;
+    uint32_t fr_start;
+    uint32_t fr_end;
+    uint8_t fr_prio;
+    uint8_t fr_state;
+};
+
+/**
+ * Submit asynchronous flash request
+ *
+ * Each flash device has its own queue and task executing requests, so
+ * requests to different devices are executed in parallel. Reads are
+ * executed before writes and writes before erases, unless request overlaps
+ * one which was submitted earlier; such requests are always executed in
+ * order of submission. Writes which were queued back-to-back to adjacent
+ * addresses are merged into single driver write.
+ *
+ * Synchronous hal_flash_xxx() calls take the same per-device lock as the
+ * device task, so both APIs can be used on the same device.
+ *
+ * @param req  Request object
+ *
+ * @return 0 on success
+ *         SYS_EINVAL if request is invalid or device does not support
+ *                    asynchronous requests
+ *         SYS_EBUSY if request is already queued or in progress
+ */
+int hal_flash_req_submit(struct hal_flash_req *req);
+
+/**
+ * Cancel asynchronous flash request
+ *
+ * Removes request from queue. Completion callback is not called for
+ * cancelled request.
+ *
+ * @param req  Request object
+ *
+ * @return 0 on success
+ *         SYS_EBUSY if request is in progress
+ *         SYS_ENOENT if request is not queued
+ */
+int hal_flash_req_cancel(struct hal_flash_req *req);
+
+/*
+ * Per-device lock, used internally by hal_flash.
+ */
+void hal_flash_async_lock(uint8_t flash_id);
+void hal_flash_async_unlock(uint8_t flash_id);
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_HAL_FLASH_ASYNC_ */
+
+/**
+ *   @} HALFlashAsync
+ * @} HAL
+ */
@@ -25,9 +25,143 @@
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
 #include "hal/hal_flash_int.h"
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+#include "hal/hal_flash_async.h"
+
+/* Serializes driver calls with asynchronous request tasks */
+#define HAL_FLASH_LOCK(id)      hal_flash_async_lock(id)
+#define HAL_FLASH_UNLOCK(id)    hal_flash_async_unlock(id)
+#else
+#define HAL_FLASH_LOCK(id)
+#define HAL_FLASH_UNLOCK(id)
+#endif
 
 static uint8_t protected_flash[1];
 
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+/*
+ * Pages of HAL_FLASH_ERASED_MAP_DEVICE which are known to be erased. Bit is
+ * set when page is erased, or found to be empty by blank check, and cleared
+ * before and after page is written. Generation counter is bumped on every
+ * clear, so blank check which raced with a write does not mark written page
+ * as erased.
+ */
+#define HAL_FLASH_EMAP_PAGE_SZ      MYNEWT_VAL(HAL_FLASH_ERASED_MAP_PAGE_SZ)
+#define HAL_FLASH_EMAP_PAGES        MYNEWT_VAL(HAL_FLASH_ERASED_MAP_PAGES)
+
+static uint32_t hal_flash_emap[(HAL_FLASH_EMAP_PAGES + 31) / 32];
+static uint32_t hal_flash_emap_gen;
+
+static inline bool
+hal_flash_emap_dev(uint8_t id)
+{
+    return id == MYNEWT_VAL(HAL_FLASH_ERASED_MAP_DEVICE);
+}
+
+static uint32_t
+hal_flash_emap_gen_get(void)
+{
+    return hal_flash_emap_gen;
+}
+
+/*
+ * Returns 1 if all pages covering range are known to be erased.
+ */
+static int
+hal_flash_emap_check(const struct hal_flash *hf, uint32_t address,
+                     uint32_t num_bytes)
+{
+    uint32_t first;
+    uint32_t last;
+    uint32_t i;
+
+    if (num_bytes == 0) {
+        return 0;
+    }
+    first = (address - hf->hf_base_addr) / HAL_FLASH_EMAP_PAGE_SZ;
+    last = (address - hf->hf_base_addr + num_bytes - 1) /
+           HAL_FLASH_EMAP_PAGE_SZ;
+    if (last >= HAL_FLASH_EMAP_PAGES) {
+        return 0;
+    }
+    for (i = first; i <= last; i++) {
+        if (!(hal_flash_emap[i / 32] & (1UL << (i % 32)))) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Marks pages fully inside range as erased, unless there was a write since
+ * gen was read.
+ */
+static void
+hal_flash_emap_set(const struct hal_flash *hf, uint32_t address,
+                   uint32_t num_bytes, uint32_t gen)
+{
+    uint32_t first;
+    uint32_t end;
+    uint32_t i;
+    os_sr_t sr;
+
+    first = (address - hf->hf_base_addr + HAL_FLASH_EMAP_PAGE_SZ - 1) /
+            HAL_FLASH_EMAP_PAGE_SZ;
+    end = (address - hf->hf_base_addr + num_bytes) / HAL_FLASH_EMAP_PAGE_SZ;
+    end = min(end, HAL_FLASH_EMAP_PAGES);
+
+    OS_ENTER_CRITICAL(sr);
+    if (gen == hal_flash_emap_gen) {
+        for (i = first; i < end; i++) {
+            hal_flash_emap[i / 32] |= 1UL << (i % 32);
+        }
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+/*
+ * Marks pages touched by range as not erased.
+ */
+static void
+hal_flash_emap_clear(const struct hal_flash *hf, uint32_t address,
+                     uint32_t num_bytes)
+{
+    uint32_t first;
+    uint32_t end;
+    uint32_t i;
+    os_sr_t sr;
+
+    first = (address - hf->hf_base_addr) / HAL_FLASH_EMAP_PAGE_SZ;
+    end = (address - hf->hf_base_addr + num_bytes + HAL_FLASH_EMAP_PAGE_SZ -
+           1) / HAL_FLASH_EMAP_PAGE_SZ;
+    end = min(end, HAL_FLASH_EMAP_PAGES);
+
+    OS_ENTER_CRITICAL(sr);
+    hal_flash_emap_gen++;
+    for (i = first; i < end; i++) {
+        hal_flash_emap[i / 32] &= ~(1UL << (i % 32));
+    }
+    OS_EXIT_CRITICAL(sr);
+}
+
+static void
+hal_flash_emap_erased_sector(const struct hal_flash *hf, uint32_t address,
+                             uint32_t gen)
+{
+    uint32_t start;
+    uint32_t size;
+    int i;
+
+    for (i = 0; i < hf->hf_sector_cnt; i++) {
+        if (hf->hf_itf->hff_sector_info(hf, i, &start, &size) == 0 &&
+            address >= start && address < start + size) {
+            hal_flash_emap_set(hf, start, size, gen);
+            break;
+        }
+    }
+}
+#endif
+
 int
 hal_flash_init(void)
 {
@@ -107,7 +241,17 @@ hal_flash_read(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
         return SYS_EINVAL;
     }
 
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (hal_flash_emap_dev(id) &&
+        hal_flash_emap_check(hf, address, num_bytes)) {
+        memset(dst, hf->hf_erased_val, num_bytes);
+        return 0;
+    }
+#endif
+
+    HAL_FLASH_LOCK(id);
     rc = hf->hf_itf->hff_read(hf, address, dst, num_bytes);
+    HAL_FLASH_UNLOCK(id);
     if (rc != 0) {
         return SYS_EIO;
     }
@@ -179,30 +323,79 @@ hal_flash_write(uint8_t id, uint32_t address, const void *src,
         return SYS_EACCES;
     }
 
-    rc = hf->hf_itf->hff_write(hf, address, src, num_bytes);
-    if (rc != 0) {
-        return SYS_EIO;
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (hal_flash_emap_dev(id)) {
+        hal_flash_emap_clear(hf, address, num_bytes);
     }
+#endif
 
+    HAL_FLASH_LOCK(id);
+    rc = hf->hf_itf->hff_write(hf, address, src, num_bytes);
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_WRITES)
-    assert(hal_flash_cmp(hf, address, src, num_bytes) == 0);
+    assert(rc != 0 || hal_flash_cmp(hf, address, src, num_bytes) == 0);
+#endif
+    HAL_FLASH_UNLOCK(id);
+
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    /* Blank check may have marked the pages while write was in progress */
+    if (hal_flash_emap_dev(id)) {
+        hal_flash_emap_clear(hf, address, num_bytes);
+    }
 #endif
+    if (rc != 0) {
+        return SYS_EIO;
+    }
 
     return 0;
 }
 
+#if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
+/*
+ * Reads range back from the driver to verify an erase. Does not consult
+ * erased pages bitmap, pages are marked only after this check passes.
+ */
+static int
+hal_flash_verify_erased(const struct hal_flash *hf, uint32_t address,
+                        uint32_t num_bytes)
+{
+    uint32_t buf[(MYNEWT_VAL(HAL_FLASH_VERIFY_BUF_SZ) + 3) / 4];
+    uint32_t blksz;
+    uint32_t rem;
+    uint32_t off;
+    int empty;
+
+    for (off = 0; off < num_bytes; off += sizeof buf) {
+        rem = num_bytes - off;
+
+        blksz = sizeof buf;
+        if (blksz > rem) {
+            blksz = rem;
+        }
+
+        empty = hal_flash_is_erased(hf, address + off, buf, blksz);
+        if (empty != 1) {
+            return empty;
+        }
+    }
+
+    return 1;
+}
+#endif
+
 int
 hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
 {
     const struct hal_flash *hf;
     uint32_t start;
     uint32_t size;
+    uint32_t gen;
     int rc;
     int i;
 
     (void) start;
     (void) size;
     (void) i;
+    (void) gen;
 
     hf = hal_bsp_flash_dev(id);
     if (!hf) {
@@ -216,8 +409,13 @@ hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
         return SYS_EACCES;
     }
 
+    HAL_FLASH_LOCK(id);
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    gen = hal_flash_emap_gen_get();
+#endif
     rc = hf->hf_itf->hff_erase_sector(hf, sector_address);
     if (rc != 0) {
+        HAL_FLASH_UNLOCK(id);
         return SYS_EIO;
     }
 
@@ -228,11 +426,17 @@ hal_flash_erase_sector(uint8_t id, uint32_t sector_address)
         assert(rc == 0);
 
         if (sector_address == start) {
-            assert(hal_flash_isempty_no_buf(id, start, size) == 1);
+            assert(hal_flash_verify_erased(hf, start, size) == 1);
             break;
         }
     }
 #endif
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (hal_flash_emap_dev(id)) {
+        hal_flash_emap_erased_sector(hf, sector_address, gen);
+    }
+#endif
+    HAL_FLASH_UNLOCK(id);
 
     return 0;
 }
@@ -244,9 +448,12 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
     uint32_t start, size;
     uint32_t end;
     uint32_t end_area;
+    uint32_t gen;
     int i;
     int rc;
 
+    (void) gen;
+
     hf = hal_bsp_flash_dev(id);
     if (!hf) {
         return SYS_EINVAL;
@@ -268,10 +475,19 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
         return SYS_EINVAL;
     }
 
+    HAL_FLASH_LOCK(id);
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    gen = hal_flash_emap_gen_get();
+#endif
     if (hf->hf_itf->hff_erase) {
-        hf->hf_itf->hff_erase(hf, address, num_bytes);
+        rc = hf->hf_itf->hff_erase(hf, address, num_bytes);
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
-        assert(hal_flash_isempty_no_buf(id, address, num_bytes) == 1);
+        assert(hal_flash_verify_erased(hf, address, num_bytes) == 1);
+#endif
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+        if (rc == 0 && hal_flash_emap_dev(id)) {
+            hal_flash_emap_set(hf, address, num_bytes, gen);
+        }
 #endif
     } else {
         for (i = 0; i < hf->hf_sector_cnt; i++) {
@@ -284,47 +500,84 @@ hal_flash_erase(uint8_t id, uint32_t address, uint32_t num_bytes)
                  * erase the sector.
                  */
                 if (hf->hf_itf->hff_erase_sector(hf, start)) {
+                    HAL_FLASH_UNLOCK(id);
                     return SYS_EIO;
                 }
-
 #if MYNEWT_VAL(HAL_FLASH_VERIFY_ERASES)
-                assert(hal_flash_isempty_no_buf(id, start, size) == 1);
+                assert(hal_flash_verify_erased(hf, start, size) == 1);
+#endif
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+                if (hal_flash_emap_dev(id)) {
+                    hal_flash_emap_set(hf, start, size, gen);
+                }
 #endif
             }
         }
     }
+    HAL_FLASH_UNLOCK(id);
     return 0;
 }
 
+/*
+ * Compares buffer to erased value, a word at a time once buffer pointer is
+ * aligned.
+ */
+static int
+hal_flash_buf_erased(const uint8_t *buf, uint32_t num_bytes, uint8_t val)
+{
+    const uint32_t *wp;
+    uint32_t word;
+
+    while (num_bytes && ((uintptr_t)buf & (sizeof(uint32_t) - 1))) {
+        if (*buf != val) {
+            return 0;
+        }
+        buf++;
+        num_bytes--;
+    }
+
+    word = val * 0x01010101UL;
+    for (wp = (const uint32_t *)buf; num_bytes >= sizeof(uint32_t);
+         num_bytes -= sizeof(uint32_t)) {
+        if (*wp++ != word) {
+            return 0;
+        }
+    }
+
+    buf = (const uint8_t *)wp;
+    while (num_bytes) {
+        if (*buf != val) {
+            return 0;
+        }
+        buf++;
+        num_bytes--;
+    }
+    return 1;
+}
+
 int
 hal_flash_is_erased(const struct hal_flash *hf, uint32_t address, void *dst,
         uint32_t num_bytes)
 {
-    uint32_t i;
-    uint8_t *buf;
     int rc;
 
-    buf = dst;
-
     rc = hf->hf_itf->hff_read(hf, address, dst, num_bytes);
     if (rc != 0) {
         return SYS_EIO;
     }
 
-    for (i = 0; i < num_bytes; i++) {
-        if (buf[i] != hf->hf_erased_val) {
-            return 0;
-        }
-    }
-    return 1;
+    return hal_flash_buf_erased(dst, num_bytes, hf->hf_erased_val);
 }
 
 int
 hal_flash_isempty(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
 {
     const struct hal_flash *hf;
+    uint32_t gen;
     int rc;
 
+    (void) gen;
+
     hf = hal_bsp_flash_dev(id);
     if (!hf) {
         return SYS_EINVAL;
@@ -333,26 +586,62 @@ hal_flash_isempty(uint8_t id, uint32_t address, void *dst, uint32_t num_bytes)
       hal_flash_check_addr(hf, address + num_bytes)) {
         return SYS_EINVAL;
     }
+
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (hal_flash_emap_dev(id)) {
+        if (hal_flash_emap_check(hf, address, num_bytes)) {
+            memset(dst, hf->hf_erased_val, num_bytes);
+            return 1;
+        }
+        gen = hal_flash_emap_gen_get();
+    }
+#endif
+
+    HAL_FLASH_LOCK(id);
     if (hf->hf_itf->hff_is_empty) {
         rc = hf->hf_itf->hff_is_empty(hf, address, dst, num_bytes);
         if (rc < 0) {
-            return SYS_EIO;
-        } else {
-            return rc;
+            rc = SYS_EIO;
         }
     } else {
-        return hal_flash_is_erased(hf, address, dst, num_bytes);
+        rc = hal_flash_is_erased(hf, address, dst, num_bytes);
+    }
+    HAL_FLASH_UNLOCK(id);
+
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (rc == 1 && hal_flash_emap_dev(id)) {
+        hal_flash_emap_set(hf, address, num_bytes, gen);
     }
+#endif
+
+    return rc;
 }
 
 int
 hal_flash_isempty_no_buf(uint8_t id, uint32_t address, uint32_t num_bytes)
 {
-    uint8_t buf[MYNEWT_VAL(HAL_FLASH_VERIFY_BUF_SZ)];
+    /* uint32_t for word-wise comparison in hal_flash_is_erased() */
+    uint32_t buf[(MYNEWT_VAL(HAL_FLASH_VERIFY_BUF_SZ) + 3) / 4];
     uint32_t blksz;
     uint32_t rem;
     uint32_t off;
     int empty;
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    const struct hal_flash *hf;
+    uint32_t gen;
+
+    hf = hal_bsp_flash_dev(id);
+    if (hf && hal_flash_emap_dev(id)) {
+        if (hal_flash_check_addr(hf, address) ||
+            hal_flash_check_addr(hf, address + num_bytes)) {
+            return SYS_EINVAL;
+        }
+        if (hal_flash_emap_check(hf, address, num_bytes)) {
+            return 1;
+        }
+    }
+    gen = hal_flash_emap_gen_get();
+#endif
 
     for (off = 0; off < num_bytes; off += sizeof buf) {
         rem = num_bytes - off;
@@ -368,6 +657,12 @@ hal_flash_isempty_no_buf(uint8_t id, uint32_t address, uint32_t num_bytes)
         }
     }
 
+#if MYNEWT_VAL(HAL_FLASH_ERASED_MAP)
+    if (hf && hal_flash_emap_dev(id)) {
+        hal_flash_emap_set(hf, address, num_bytes, gen);
+    }
+#endif
+
     return 1;
 }
 
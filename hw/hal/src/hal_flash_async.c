@@ -0,0 +1,407 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+
+#include <assert.h>
+#include <string.h>
+
+#include "hal/hal_bsp.h"
+#include "hal/hal_flash.h"
+#include "hal/hal_flash_int.h"
+#include "hal/hal_flash_async.h"
+
+#define HAL_FLASH_REQ_S_IDLE        0
+#define HAL_FLASH_REQ_S_QUEUED      1
+#define HAL_FLASH_REQ_S_RUNNING     2
+
+#define HAL_FLASH_ASYNC_DEVS        MYNEWT_VAL(HAL_FLASH_ASYNC_MAX_DEVICES)
+#if HAL_FLASH_ASYNC_DEVS > 4
+#error HAL_FLASH_ASYNC_MAX_DEVICES shall not be greater than 4
+#endif
+#define HAL_FLASH_ASYNC_STACK_SIZE  \
+    OS_STACK_ALIGN(MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_STACK_SIZE))
+
+STAILQ_HEAD(hal_flash_req_list, hal_flash_req);
+
+struct hal_flash_async_dev {
+    struct hal_flash_req_list fad_q;
+    struct os_mutex fad_lock;
+    struct os_eventq fad_evq;
+    struct os_event fad_ev;
+    struct os_task fad_task;
+    bool fad_active;
+    os_stack_t fad_stack[HAL_FLASH_ASYNC_STACK_SIZE];
+#if MYNEWT_VAL(HAL_FLASH_ASYNC_MERGE_BUF_SZ)
+    uint8_t fad_buf[MYNEWT_VAL(HAL_FLASH_ASYNC_MERGE_BUF_SZ)];
+#endif
+};
+
+/*
+ * Locks are initialized by hal_flash_async_init(). Synchronous API calls done
+ * before that do not need them, since OS is not started yet and locking is a
+ * no-op then.
+ */
+static struct hal_flash_async_dev hal_flash_async_devs[HAL_FLASH_ASYNC_DEVS];
+
+/* Each device task has own priority setting, so they can not collide */
+static const uint8_t hal_flash_async_prio[HAL_FLASH_ASYNC_DEVS] = {
+    MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_PRIO),
+#if HAL_FLASH_ASYNC_DEVS > 1
+    MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_PRIO_1),
+#endif
+#if HAL_FLASH_ASYNC_DEVS > 2
+    MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_PRIO_2),
+#endif
+#if HAL_FLASH_ASYNC_DEVS > 3
+    MYNEWT_VAL(HAL_FLASH_ASYNC_TASK_PRIO_3),
+#endif
+};
+
+void
+hal_flash_async_lock(uint8_t flash_id)
+{
+    if (flash_id < HAL_FLASH_ASYNC_DEVS) {
+        os_mutex_pend(&hal_flash_async_devs[flash_id].fad_lock,
+                      OS_TIMEOUT_NEVER);
+    }
+}
+
+void
+hal_flash_async_unlock(uint8_t flash_id)
+{
+    if (flash_id < HAL_FLASH_ASYNC_DEVS) {
+        os_mutex_release(&hal_flash_async_devs[flash_id].fad_lock);
+    }
+}
+
+static void
+hal_flash_async_complete(struct hal_flash_req *req, int rc)
+{
+    os_sr_t sr;
+
+    OS_ENTER_CRITICAL(sr);
+    req->fr_state = HAL_FLASH_REQ_S_IDLE;
+    OS_EXIT_CRITICAL(sr);
+
+    req->fr_cb(req, rc, req->fr_cb_arg);
+}
+
+#if MYNEWT_VAL(HAL_FLASH_ASYNC_MERGE_BUF_SZ)
+/*
+ * Takes writes which were queued right after req and continue where previous
+ * one ends. Returns total length of merged writes.
+ */
+static uint32_t
+hal_flash_async_merge(struct hal_flash_async_dev *fad,
+                      struct hal_flash_req *req,
+                      struct hal_flash_req_list *merged)
+{
+    struct hal_flash_req *next;
+    uint32_t len;
+    os_sr_t sr;
+
+    len = req->fr_len;
+    if (len >= sizeof(fad->fad_buf)) {
+        return len;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    while ((next = STAILQ_FIRST(&fad->fad_q)) != NULL) {
+        if (next->fr_op != HAL_FLASH_OP_WRITE ||
+            next->fr_addr != req->fr_addr + len ||
+            len + next->fr_len > sizeof(fad->fad_buf)) {
+            break;
+        }
+        STAILQ_REMOVE_HEAD(&fad->fad_q, fr_next);
+        next->fr_state = HAL_FLASH_REQ_S_RUNNING;
+        STAILQ_INSERT_TAIL(merged, next, fr_next);
+        len += next->fr_len;
+    }
+    OS_EXIT_CRITICAL(sr);
+
+    return len;
+}
+#endif
+
+static int
+hal_flash_async_write(struct hal_flash_async_dev *fad,
+                      struct hal_flash_req *req,
+                      struct hal_flash_req_list *merged)
+{
+#if MYNEWT_VAL(HAL_FLASH_ASYNC_MERGE_BUF_SZ)
+    struct hal_flash_req *next;
+    uint32_t len;
+    uint32_t off;
+
+    len = hal_flash_async_merge(fad, req, merged);
+    if (len > req->fr_len) {
+        memcpy(fad->fad_buf, req->fr_buf, req->fr_len);
+        off = req->fr_len;
+        STAILQ_FOREACH(next, merged, fr_next) {
+            memcpy(fad->fad_buf + off, next->fr_buf, next->fr_len);
+            off += next->fr_len;
+        }
+        return hal_flash_write(req->fr_flash_id, req->fr_addr, fad->fad_buf,
+                               len);
+    }
+#endif
+
+    return hal_flash_write(req->fr_flash_id, req->fr_addr, req->fr_buf,
+                           req->fr_len);
+}
+
+static void
+hal_flash_async_run(struct hal_flash_async_dev *fad)
+{
+    struct hal_flash_req_list merged;
+    struct hal_flash_req *req;
+    os_sr_t sr;
+    int rc;
+
+    while (1) {
+        OS_ENTER_CRITICAL(sr);
+        req = STAILQ_FIRST(&fad->fad_q);
+        if (req) {
+            STAILQ_REMOVE_HEAD(&fad->fad_q, fr_next);
+            req->fr_state = HAL_FLASH_REQ_S_RUNNING;
+        }
+        OS_EXIT_CRITICAL(sr);
+
+        if (!req) {
+            return;
+        }
+
+        STAILQ_INIT(&merged);
+
+        switch (req->fr_op) {
+        case HAL_FLASH_OP_READ:
+            rc = hal_flash_read(req->fr_flash_id, req->fr_addr, req->fr_buf,
+                                req->fr_len);
+            break;
+        case HAL_FLASH_OP_WRITE:
+            rc = hal_flash_async_write(fad, req, &merged);
+            break;
+        default:
+            rc = hal_flash_erase(req->fr_flash_id, req->fr_addr, req->fr_len);
+            break;
+        }
+
+        hal_flash_async_complete(req, rc);
+        while ((req = STAILQ_FIRST(&merged)) != NULL) {
+            STAILQ_REMOVE_HEAD(&merged, fr_next);
+            hal_flash_async_complete(req, rc);
+        }
+    }
+}
+
+static void
+hal_flash_async_ev_func(struct os_event *ev)
+{
+    hal_flash_async_run(ev->ev_arg);
+}
+
+static void
+hal_flash_async_task_func(void *arg)
+{
+    struct hal_flash_async_dev *fad = arg;
+
+    while (1) {
+        os_eventq_run(&fad->fad_evq);
+    }
+}
+
+/*
+ * Range of flash affected by request, used to keep overlapping requests in
+ * order. Erase affects whole sectors.
+ */
+static int
+hal_flash_async_range(const struct hal_flash *hf,
+                      const struct hal_flash_req *req, uint32_t *startp,
+                      uint32_t *endp)
+{
+    uint32_t start;
+    uint32_t size;
+    uint32_t end;
+    int i;
+
+    end = req->fr_addr + req->fr_len;
+    if (end <= req->fr_addr || req->fr_addr < hf->hf_base_addr ||
+        end > hf->hf_base_addr + hf->hf_size) {
+        return SYS_EINVAL;
+    }
+
+    *startp = req->fr_addr;
+    *endp = end;
+
+    if (req->fr_op == HAL_FLASH_OP_ERASE) {
+        for (i = 0; i < hf->hf_sector_cnt; i++) {
+            hf->hf_itf->hff_sector_info(hf, i, &start, &size);
+            if (req->fr_addr < start + size && end > start) {
+                *startp = min(*startp, start);
+                *endp = max(*endp, start + size);
+            }
+        }
+    }
+
+    return 0;
+}
+
+int
+hal_flash_req_submit(struct hal_flash_req *req)
+{
+    struct hal_flash_async_dev *fad;
+    const struct hal_flash *hf;
+    struct hal_flash_req *prev;
+    struct hal_flash_req *cur;
+    uint32_t start;
+    uint32_t end;
+    os_sr_t sr;
+    int rc;
+
+    if (req->fr_flash_id >= HAL_FLASH_ASYNC_DEVS || !req->fr_cb ||
+        req->fr_op > HAL_FLASH_OP_ERASE || req->fr_len == 0 ||
+        (req->fr_op != HAL_FLASH_OP_ERASE && !req->fr_buf)) {
+        return SYS_EINVAL;
+    }
+
+    fad = &hal_flash_async_devs[req->fr_flash_id];
+    if (!fad->fad_active) {
+        return SYS_EINVAL;
+    }
+
+    hf = hal_bsp_flash_dev(req->fr_flash_id);
+    rc = hal_flash_async_range(hf, req, &start, &end);
+    if (rc) {
+        return rc;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+
+    if (req->fr_state != HAL_FLASH_REQ_S_IDLE) {
+        OS_EXIT_CRITICAL(sr);
+        return SYS_EBUSY;
+    }
+
+    req->fr_start = start;
+    req->fr_end = end;
+    /* Reads first, then writes, then erases */
+    req->fr_prio = req->fr_op;
+
+    /*
+     * Request goes after last one which has higher priority, the same
+     * priority (except for reads, which can be done in any order), or which
+     * touches the same range of flash. Requests it overtakes do not overlap
+     * it.
+     */
+    prev = NULL;
+    STAILQ_FOREACH(cur, &fad->fad_q, fr_next) {
+        if (cur->fr_prio < req->fr_prio ||
+            (cur->fr_prio == req->fr_prio &&
+             req->fr_op != HAL_FLASH_OP_READ) ||
+            (cur->fr_start < req->fr_end && req->fr_start < cur->fr_end)) {
+            prev = cur;
+        }
+    }
+    if (prev) {
+        STAILQ_INSERT_AFTER(&fad->fad_q, prev, req, fr_next);
+    } else {
+        STAILQ_INSERT_HEAD(&fad->fad_q, req, fr_next);
+    }
+    req->fr_state = HAL_FLASH_REQ_S_QUEUED;
+
+    OS_EXIT_CRITICAL(sr);
+
+    os_eventq_put(&fad->fad_evq, &fad->fad_ev);
+
+    return 0;
+}
+
+int
+hal_flash_req_cancel(struct hal_flash_req *req)
+{
+    struct hal_flash_async_dev *fad;
+    os_sr_t sr;
+    int rc;
+
+    if (req->fr_flash_id >= HAL_FLASH_ASYNC_DEVS) {
+        return SYS_ENOENT;
+    }
+    fad = &hal_flash_async_devs[req->fr_flash_id];
+
+    OS_ENTER_CRITICAL(sr);
+
+    switch (req->fr_state) {
+    case HAL_FLASH_REQ_S_IDLE:
+        rc = SYS_ENOENT;
+        break;
+    case HAL_FLASH_REQ_S_QUEUED:
+        STAILQ_REMOVE(&fad->fad_q, req, hal_flash_req, fr_next);
+        req->fr_state = HAL_FLASH_REQ_S_IDLE;
+        rc = 0;
+        break;
+    default:
+        rc = SYS_EBUSY;
+        break;
+    }
+
+    OS_EXIT_CRITICAL(sr);
+
+    return rc;
+}
+
+void
+hal_flash_async_init(void)
+{
+    struct hal_flash_async_dev *fad;
+    int rc;
+    int i;
+
+    /* Ensure this function only gets called by sysinit. */
+    SYSINIT_ASSERT_ACTIVE();
+
+    for (i = 0; i < HAL_FLASH_ASYNC_DEVS; i++) {
+        fad = &hal_flash_async_devs[i];
+
+        rc = os_mutex_init(&fad->fad_lock);
+        SYSINIT_PANIC_ASSERT(rc == 0);
+
+        if (!hal_bsp_flash_dev(i)) {
+            continue;
+        }
+
+        STAILQ_INIT(&fad->fad_q);
+        os_eventq_init(&fad->fad_evq);
+        fad->fad_ev.ev_cb = hal_flash_async_ev_func;
+        fad->fad_ev.ev_arg = fad;
+
+        rc = os_task_init(&fad->fad_task, "flash_async",
+                          hal_flash_async_task_func, fad,
+                          hal_flash_async_prio[i],
+                          OS_WAIT_FOREVER, fad->fad_stack,
+                          HAL_FLASH_ASYNC_STACK_SIZE);
+        SYSINIT_PANIC_ASSERT(rc == 0);
+
+        fad->fad_active = true;
+    }
+}
+
+#endif
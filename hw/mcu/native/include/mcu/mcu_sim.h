@@ -19,6 +19,8 @@
 #ifndef __MCU_SIM_H__
 #define __MCU_SIM_H__
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,6 +33,62 @@ extern const char *native_uart_dev_strs[];
 
 void mcu_sim_parse_args(int argc, char **argv);
 
+/** Counters maintained by the simulated flash device. */
+struct native_flash_stats {
+    uint64_t nfs_bytes_read;
+    uint64_t nfs_bytes_written;
+    uint32_t nfs_sector_erases;
+    uint32_t nfs_power_losses;
+    /** Total simulated busy time of program and erase operations. */
+    uint64_t nfs_busy_ns;
+};
+
+typedef void native_flash_power_loss_fn(void *arg);
+
+/**
+ * Changes the simulated flash timing model.  Each write stalls the caller for
+ * write_ns_per_byte per programmed byte; each sector erase for erase_us.
+ * Defaults come from MCU_NATIVE_FLASH_WRITE_NS_PER_BYTE and
+ * MCU_NATIVE_FLASH_ERASE_US.
+ */
+void native_flash_set_timing(uint32_t write_ns_per_byte, uint32_t erase_us);
+
+/**
+ * Selects the simulated flash programming semantics.  With NOR semantics a
+ * write may clear bits of non-erased data and fails if it would set one;
+ * otherwise any write to non-erased flash triggers an assert.  The default
+ * comes from MCU_NATIVE_FLASH_NOR.
+ */
+void native_flash_set_nor(int nor);
+
+/**
+ * Reads the simulated flash counters.
+ *
+ * @param out_stats             On success, the counters get written here.
+ *                                  May be NULL.
+ * @param clear                 Whether to reset the counters afterwards.
+ */
+void native_flash_stats_get(struct native_flash_stats *out_stats, int clear);
+
+/**
+ * Arms power-loss injection.  After byte_cnt more bytes have been programmed
+ * or erased, the operation in progress is cut short, the callback is
+ * executed and all subsequent writes and erases fail without modifying flash
+ * until native_flash_power_loss_disarm() is called.
+ *
+ * @param byte_cnt              Number of bytes to process before losing
+ *                                  power.  A sector erase counts as the
+ *                                  sector size; an interrupted erase leaves
+ *                                  the tail of the sector unmodified.
+ * @param cb                    Called once when power is lost; may be NULL.
+ * @param arg                   Argument passed to the callback.
+ */
+void native_flash_power_loss_arm(uint32_t byte_cnt,
+                                 native_flash_power_loss_fn *cb, void *arg);
+
+/** Disarms power-loss injection and restores normal operation. */
+void native_flash_power_loss_disarm(void);
+
 #ifdef __cplusplus
 }
 #endif
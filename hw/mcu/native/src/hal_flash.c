@@ -24,6 +24,8 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
+#include <time.h>
 
 #include "os/mynewt.h"
 
@@ -34,6 +36,24 @@ char *native_flash_file;
 static int file = -1;
 static void *file_loc;
 
+/* Timing model; see native_flash_set_timing(). */
+static uint32_t flash_write_ns_per_byte =
+    MYNEWT_VAL(MCU_NATIVE_FLASH_WRITE_NS_PER_BYTE);
+static uint32_t flash_erase_us = MYNEWT_VAL(MCU_NATIVE_FLASH_ERASE_US);
+
+/* Programming semantics; see native_flash_set_nor(). */
+static int flash_nor = MYNEWT_VAL(MCU_NATIVE_FLASH_NOR);
+
+static struct native_flash_stats flash_stats;
+
+/* Power-loss injection; see native_flash_power_loss_arm(). */
+static int flash_pl_armed;
+static int flash_pl_tripped;
+static int flash_pl_reported;
+static uint32_t flash_pl_remaining;
+static native_flash_power_loss_fn *flash_pl_cb;
+static void *flash_pl_arg;
+
 static int native_flash_init(const struct hal_flash *dev);
 static int native_flash_read(const struct hal_flash *dev, uint32_t address,
         void *dst, uint32_t length);
@@ -91,6 +111,77 @@ flash_native_erase(uint32_t addr, uint32_t len)
     memset(file_loc + addr, 0xff, len);
 }
 
+/**
+ * Stalls the caller for the specified amount of simulated device busy time.
+ * Interruptions by the sim tick signal are absorbed.
+ */
+static void
+flash_native_busy(uint64_t ns)
+{
+    struct timespec ts;
+    int rc;
+
+    if (ns == 0) {
+        return;
+    }
+
+    flash_stats.nfs_busy_ns += ns;
+
+    ts.tv_sec = ns / 1000000000;
+    ts.tv_nsec = ns % 1000000000;
+    do {
+        rc = nanosleep(&ts, &ts);
+    } while (rc != 0 && errno == EINTR);
+}
+
+/**
+ * Consumes 'len' bytes from the power-loss budget.
+ *
+ * @return                      The number of bytes that may be processed
+ *                                  before power is lost; 'len' if the full
+ *                                  operation completes.
+ */
+static uint32_t
+flash_native_power_budget(uint32_t len)
+{
+    if (!flash_pl_armed) {
+        return len;
+    }
+    if (flash_pl_tripped) {
+        return 0;
+    }
+    if (len < flash_pl_remaining) {
+        flash_pl_remaining -= len;
+        return len;
+    }
+
+    len = flash_pl_remaining;
+    flash_pl_remaining = 0;
+    flash_pl_tripped = 1;
+    return len;
+}
+
+/**
+ * Notifies the power-loss callback the first time the budget runs out.
+ *
+ * @return                      1 if power was lost during the current
+ *                                  operation; 0 otherwise.
+ */
+static int
+flash_native_power_check(void)
+{
+    if (!flash_pl_tripped || flash_pl_reported) {
+        return 0;
+    }
+
+    flash_pl_reported = 1;
+    flash_stats.nfs_power_losses++;
+    if (flash_pl_cb != NULL) {
+        flash_pl_cb(flash_pl_arg);
+    }
+    return 1;
+}
+
 static void
 flash_native_file_open(char *name)
 {
@@ -143,7 +234,7 @@ flash_native_file_open(char *name)
 static void
 flash_native_ensure_file_open(void)
 {
-    if (file == 0) {
+    if (file_loc == NULL) {
         flash_native_file_open(NULL);
     }
 }
@@ -152,42 +243,57 @@ static int
 flash_native_write_internal(uint32_t address, const void *src, uint32_t length,
                             int allow_overwrite)
 {
-    static uint8_t buf[256];
-    uint32_t cur;
-    uint32_t end;
-    int chunk_sz;
-    int rc;
-    int i;
+    const uint8_t *sp;
+    uint8_t *dp;
+    uint32_t todo;
+    uint32_t i;
 
     if (length == 0) {
         return 0;
     }
 
-    end = address + length;
-
     flash_native_ensure_file_open();
 
-    cur = address;
-    while (cur < end) {
-        if (end - cur < sizeof buf) {
-            chunk_sz = end - cur;
-        } else {
-            chunk_sz = sizeof buf;
-        }
-
-        /* Ensure data is not being overwritten. */
-        if (!allow_overwrite) {
-            rc = native_flash_read(NULL, cur, buf, chunk_sz);
-            assert(rc == 0);
-            for (i = 0; i < chunk_sz; i++) {
-                assert(buf[i] == 0xff);
+    sp = src;
+    dp = (uint8_t *)file_loc + address;
+
+    if (!allow_overwrite) {
+        for (i = 0; i < length; i++) {
+            if (flash_nor) {
+                /* NOR flash can only clear bits; programming a 1 over a 0
+                 * fails.
+                 */
+                if ((dp[i] & sp[i]) != sp[i]) {
+                    return -1;
+                }
+            } else {
+                /* Ensure data is not being overwritten. */
+                assert(dp[i] == 0xff);
             }
         }
+    }
+
+    todo = flash_native_power_budget(length);
+    if (todo == 0 && flash_pl_tripped) {
+        /* Power is already gone; nothing is programmed or accounted for. */
+        flash_native_power_check();
+        return -1;
+    }
 
-        cur += chunk_sz;
+    if (flash_nor && !allow_overwrite) {
+        for (i = 0; i < todo; i++) {
+            dp[i] &= sp[i];
+        }
+    } else {
+        memcpy(dp, sp, todo);
     }
 
-    memcpy((char *)file_loc + address, src, length);
+    flash_stats.nfs_bytes_written += todo;
+    flash_native_busy((uint64_t)todo * flash_write_ns_per_byte);
+
+    if (flash_native_power_check() || todo != length) {
+        return -1;
+    }
 
     return 0;
 }
@@ -213,6 +319,7 @@ native_flash_read(const struct hal_flash *dev, uint32_t address, void *dst,
 {
     flash_native_ensure_file_open();
     memcpy(dst, (char *)file_loc + address, length);
+    flash_stats.nfs_bytes_read += length;
 
     return 0;
 }
@@ -249,6 +356,7 @@ native_flash_erase_sector(const struct hal_flash *dev, uint32_t sector_address)
 {
     int area_id;
     uint32_t len;
+    uint32_t todo;
 
     flash_native_ensure_file_open();
 
@@ -257,7 +365,22 @@ native_flash_erase_sector(const struct hal_flash *dev, uint32_t sector_address)
         return -1;
     }
     len = flash_sector_len(area_id);
-    flash_native_erase(sector_address, len);
+
+    /* An interrupted erase leaves the tail of the sector untouched. */
+    todo = flash_native_power_budget(len);
+    if (todo == 0 && flash_pl_tripped) {
+        flash_native_power_check();
+        return -1;
+    }
+    flash_native_erase(sector_address, todo);
+
+    flash_stats.nfs_sector_erases++;
+    flash_native_busy((uint64_t)flash_erase_us * 1000);
+
+    if (flash_native_power_check() || todo != len) {
+        return -1;
+    }
+
     return 0;
 }
 
@@ -287,3 +410,49 @@ native_flash_init(const struct hal_flash *dev)
 #endif
     return 0;
 }
+
+void
+native_flash_set_timing(uint32_t write_ns_per_byte, uint32_t erase_us)
+{
+    flash_write_ns_per_byte = write_ns_per_byte;
+    flash_erase_us = erase_us;
+}
+
+void
+native_flash_set_nor(int nor)
+{
+    flash_nor = nor;
+}
+
+void
+native_flash_stats_get(struct native_flash_stats *out_stats, int clear)
+{
+    if (out_stats != NULL) {
+        *out_stats = flash_stats;
+    }
+    if (clear) {
+        memset(&flash_stats, 0, sizeof flash_stats);
+    }
+}
+
+void
+native_flash_power_loss_arm(uint32_t byte_cnt, native_flash_power_loss_fn *cb,
+                            void *arg)
+{
+    flash_pl_armed = 1;
+    flash_pl_tripped = 0;
+    flash_pl_reported = 0;
+    flash_pl_remaining = byte_cnt;
+    flash_pl_cb = cb;
+    flash_pl_arg = arg;
+}
+
+void
+native_flash_power_loss_disarm(void)
+{
+    flash_pl_armed = 0;
+    flash_pl_tripped = 0;
+    flash_pl_reported = 0;
+    flash_pl_cb = NULL;
+    flash_pl_arg = NULL;
+}
@@ -25,7 +25,6 @@
 /*
  * For native cpu implementation.
  */
-static uint8_t native_timer_task_started;
 #define NATIVE_TIMER_STACK_SIZE   (1024)
 static os_stack_t native_timer_stack[NATIVE_TIMER_STACK_SIZE];
 static struct os_task native_timer_task_struct;
@@ -80,6 +79,24 @@ native_timer_task(void *arg)
     }
 }
 
+/*
+ * Unit tests initialize OS again for each test case, which drops all tasks,
+ * so timer task is created whenever it is not in the task list.
+ */
+static bool
+native_timer_task_started(void)
+{
+    struct os_task *t;
+
+    STAILQ_FOREACH(t, &g_os_task_list, t_os_task_list) {
+        if (t == &native_timer_task_struct) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
 int
 hal_timer_init(int num, void *cfg)
 {
@@ -104,14 +121,15 @@ hal_timer_config(int num, uint32_t clock_freq)
     nt->num = num;
     nt->cnt = 0;
     nt->last_ostime = os_time_get();
-    if (!native_timer_task_started) {
+    if (!native_timer_task_started()) {
+        /*
+         * Initialize the eventq first, task runs right away if OS is already
+         * started.
+         */
+        os_eventq_init(&native_timer_evq);
         os_task_init(&native_timer_task_struct, "native_timer",
           native_timer_task, NULL, OS_TASK_PRI_HIGHEST, OS_WAIT_FOREVER,
           native_timer_stack, NATIVE_TIMER_STACK_SIZE);
-
-        /* Initialize the eventq and task */
-        os_eventq_init(&native_timer_evq);
-        native_timer_task_started = 1;
     }
 
     /* Initialize the callout function */
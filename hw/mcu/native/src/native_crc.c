@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "syscfg/syscfg.h"
+
+#if MYNEWT_VAL(CRC_HW)
+
+#include <inttypes.h>
+#include <string.h>
+#include "crc/crc_hw.h"
+
+/*
+ * CRC backend for the simulator.  The only "engine" a host has is the
+ * SSE4.2 crc32 instruction, which implements the Castagnoli polynomial;
+ * everything else is left to software.
+ */
+
+#if defined(__i386__) || defined(__x86_64__)
+
+/* -1: not probed yet, 0: no SSE4.2, 1: SSE4.2 available. */
+static int native_crc_sse42 = -1;
+
+__attribute__((target("sse4.2")))
+static uint32_t
+native_crc32c_sse42(uint32_t crc, const uint8_t *ptr, int len)
+{
+    uint32_t word;
+
+    for (; len >= 4; len -= 4, ptr += 4) {
+        memcpy(&word, ptr, sizeof(word));
+        crc = __builtin_ia32_crc32si(crc, word);
+    }
+    for (; len > 0; len--) {
+        crc = __builtin_ia32_crc32qi(crc, *ptr++);
+    }
+
+    return crc;
+}
+
+int
+crc_hw_crc32c(uint32_t initial_crc, const void *buf, int len,
+              uint32_t *out_crc)
+{
+    if (native_crc_sse42 < 0) {
+        __builtin_cpu_init();
+        native_crc_sse42 = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+    }
+    if (!native_crc_sse42) {
+        return -1;
+    }
+
+    *out_crc = ~native_crc32c_sse42(~initial_crc, buf, len);
+    return 0;
+}
+
+#else
+
+int
+crc_hw_crc32c(uint32_t initial_crc, const void *buf, int len,
+              uint32_t *out_crc)
+{
+    return -1;
+}
+
+#endif
+
+int
+crc_hw_crc16_ccitt(uint16_t initial_crc, const void *buf, int len,
+                   uint16_t *out_crc)
+{
+    return -1;
+}
+
+int
+crc_hw_crc32(uint32_t initial_crc, const void *buf, int len,
+             uint32_t *out_crc)
+{
+    return -1;
+}
+
+#endif /* MYNEWT_VAL(CRC_HW) */
@@ -228,6 +228,56 @@ typedef union {
 typedef int (*sensor_data_func_t)(struct sensor *, void *, void *,
              sensor_type_t);
 
+/**
+ * A block of consecutive readings of a single sensor type, typically the
+ * contents of a hardware FIFO fetched in one bus transfer.  Reading i is
+ * located at sb_data + i * sb_stride and has the same format as the data
+ * passed to a sensor_data_func_t for that type.
+ */
+struct sensor_block {
+    /* The sensor type of all readings in the block */
+    sensor_type_t sb_type;
+
+    /* Number of readings in the block */
+    uint16_t sb_count;
+
+    /* Distance in bytes between consecutive readings */
+    uint16_t sb_stride;
+
+    /* The readings, oldest first */
+    void *sb_data;
+
+    /* os_cputime at which the newest (last) reading was taken */
+    uint32_t sb_cputime;
+
+    /* Sampling interval in microseconds, 0 if unknown.  Reading i was taken
+     * (sb_count - 1 - i) * sb_itvl_us before the newest one.
+     */
+    uint32_t sb_itvl_us;
+};
+
+/**
+ * Return a pointer to reading "idx" of a sensor data block.
+ */
+static inline void *
+sensor_block_data(const struct sensor_block *block, int idx)
+{
+    return (uint8_t *)block->sb_data + idx * block->sb_stride;
+}
+
+/**
+ * Callback for handling a block of sensor data, specified in a sensor
+ * listener or passed to sensor_read_block().
+ *
+ * @param sensor The sensor for which data is being returned
+ * @param arg The argument provided with the callback
+ * @param block The readings
+ *
+ * @return 0 on success, non-zero error code on failure.
+ */
+typedef int (*sensor_block_func_t)(struct sensor *, void *,
+             const struct sensor_block *);
+
 /**
  * Callback for sending trigger notification.
  *
@@ -288,6 +338,12 @@ struct sensor_listener {
     /* Argument for the sensor listener */
     void *sl_arg;
 
+    /* Optional block data handler.  If set, it is called instead of sl_func
+     * with all readings returned by a driver that supports block reads;
+     * sl_func is still used for drivers that do not.
+     */
+    sensor_block_func_t sl_block_func;
+
     /* Next item in the sensor listener list.  The head of this list is
      * contained within the sensor object.
      */
@@ -403,6 +459,24 @@ struct sensor_notify_os_ev {
 typedef int (*sensor_read_func_t)(struct sensor *, sensor_type_t,
         sensor_data_func_t, void *, uint32_t);
 
+/**
+ * Read all readings currently available from a sensor (e.g. the contents of
+ * its FIFO) in as few bus transfers as possible, and pass them to block_func
+ * in one or more blocks.
+ *
+ * @param sensor The sensor to read from
+ * @param type The type(s) of sensor values to read.
+ * @param block_func The function to call with each block of readings.
+ * @param arg The argument to pass to block_func.
+ * @param timeout Timeout, as for sensor_read_func_t.
+ *
+ * @return 0 on success, SYS_ENOTSUP if block reads are not possible in the
+ *         sensor's current configuration (the sensor manager then falls back
+ *         to sd_read), other non-zero error code on failure.
+ */
+typedef int (*sensor_read_block_func_t)(struct sensor *, sensor_type_t,
+        sensor_block_func_t, void *, uint32_t);
+
 /**
  * Get the configuration of the sensor for the sensor type.  This includes
  * the value type of the sensor.
@@ -505,6 +579,7 @@ struct sensor_driver {
     sensor_unset_notification_t sd_unset_notification;
     sensor_handle_interrupt_t sd_handle_interrupt;
     sensor_reset_t sd_reset;
+    sensor_read_block_func_t sd_read_block;
 };
 
 struct sensor_timestamp {
@@ -513,6 +588,19 @@ struct sensor_timestamp {
     uint32_t st_cputime;
 };
 
+/**
+ * Poll timing statistics of a sensor, kept when SENSOR_POLL_STATS is enabled.
+ * Lateness is the time between a poll's deadline and the start of the poll.
+ */
+struct sensor_poll_stats {
+    /* Number of polls */
+    uint32_t sps_polls;
+    /* Sum of the lateness of all polls, in OS ticks */
+    uint32_t sps_late_total;
+    /* Largest lateness of a poll, in OS ticks */
+    os_time_t sps_late_max;
+};
+
 struct sensor_int {
     uint8_t host_pin;
     uint8_t device_pin;
@@ -603,6 +691,16 @@ struct sensor {
     /* The next time at which we want to poll data from this sensor */
     os_time_t s_next_run;
 
+    /* Position in the sensor manager's poll queue plus one, 0 if the sensor
+     * is not being polled.
+     */
+    uint16_t s_poll_pos;
+
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+    /* Poll timing statistics */
+    struct sensor_poll_stats s_poll_stats;
+#endif
+
     /* Sensor driver specific functions, created by the device registering the
      * sensor.
      */
@@ -643,6 +741,7 @@ struct sensor {
  */
 struct sensor_read_ctx {
     sensor_data_func_t user_func;
+    sensor_block_func_t user_block_func;
     void *user_arg;
 };
 
@@ -797,6 +896,24 @@ int sensor_read(struct sensor *sensor, sensor_type_t type,
                 sensor_data_func_t data_func, void *arg,
                 uint32_t timeout);
 
+/**
+ * Read the data for sensor type "type" from the given sensor, delivering
+ * it in blocks.  Listeners are notified as for sensor_read().  If the
+ * driver does not support block reads, each reading is passed to
+ * block_func as a block of one.
+ *
+ * @param sensor The sensor to read data from
+ * @param type The type of sensor data to read from the sensor
+ * @param block_func The callback to call for each block of readings
+ * @param arg The argument to pass to this callback.
+ * @param timeout Timeout before aborting sensor read
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int sensor_read_block(struct sensor *sensor, sensor_type_t type,
+                      sensor_block_func_t block_func, void *arg,
+                      uint32_t timeout);
+
 /**
  * Set the driver functions for this sensor, along with the type of sensor
  * data available for the given sensor.
@@ -992,6 +1109,19 @@ int sensor_mgr_match_bytype(struct sensor *sensor, void *);
 int
 sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate);
 
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+/**
+ * Get the poll timing statistics of a sensor
+ *
+ * @param sensor The sensor
+ * @param stats Where to store the statistics
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+sensor_get_poll_stats(struct sensor *sensor, struct sensor_poll_stats *stats);
+#endif
+
 /**
  * Set the sensor poll rate multiple based on the device name, sensor type
  *
@@ -22,7 +22,10 @@
 
 TEST_SUITE(sensor_test_suite_poll)
 {
+    sensor_test_case_poll_sched();
+    sensor_test_case_poll_lock();
     sensor_test_case_poll_err();
+    sensor_test_case_block();
 }
 
 int
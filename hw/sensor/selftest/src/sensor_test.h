@@ -24,6 +24,9 @@
 #include "testutil/testutil.h"
 
 TEST_SUITE_DECL(sensor_test_suite_poll);
+TEST_CASE_DECL(sensor_test_case_poll_sched);
+TEST_CASE_DECL(sensor_test_case_poll_lock);
 TEST_CASE_DECL(sensor_test_case_poll_err);
+TEST_CASE_DECL(sensor_test_case_block);
 
 #endif
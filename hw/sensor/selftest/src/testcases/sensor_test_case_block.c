@@ -0,0 +1,200 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor/accel.h"
+#include "sensor_test.h"
+
+#define STCB_NUM_SAMPLES    5
+
+/** Return code of the block read; SYS_ENOTSUP makes it decline. */
+static int stcb_block_status;
+
+static int stcb_num_reads;
+static int stcb_num_block_reads;
+
+static int stcb_samples;
+static int stcb_blocks;
+static int stcb_block_samples;
+
+static struct sensor_accel_data stcb_data[STCB_NUM_SAMPLES];
+
+static int
+stcb_sensor_read(struct sensor *sensor, sensor_type_t type,
+                 sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    int rc;
+    int i;
+
+    stcb_num_reads++;
+
+    for (i = 0; i < STCB_NUM_SAMPLES; i++) {
+        rc = data_func(sensor, arg, &stcb_data[i], SENSOR_TYPE_ACCELEROMETER);
+        if (rc != 0) {
+            return rc;
+        }
+    }
+
+    return 0;
+}
+
+static int
+stcb_sensor_read_block(struct sensor *sensor, sensor_type_t type,
+                       sensor_block_func_t block_func, void *arg,
+                       uint32_t timeout)
+{
+    struct sensor_block block;
+
+    stcb_num_block_reads++;
+
+    if (stcb_block_status != 0) {
+        return stcb_block_status;
+    }
+
+    block.sb_type = SENSOR_TYPE_ACCELEROMETER;
+    block.sb_count = STCB_NUM_SAMPLES;
+    block.sb_stride = sizeof(stcb_data[0]);
+    block.sb_data = stcb_data;
+    block.sb_cputime = 0;
+    block.sb_itvl_us = 2500;
+
+    return block_func(sensor, arg, &block);
+}
+
+static int
+stcb_sample(struct sensor *sensor, void *arg, void *data, sensor_type_t type)
+{
+    /* Readings arrive in order. */
+    TEST_ASSERT(data == &stcb_data[stcb_samples % STCB_NUM_SAMPLES]);
+    TEST_ASSERT(type == SENSOR_TYPE_ACCELEROMETER);
+    stcb_samples++;
+
+    return 0;
+}
+
+static int
+stcb_block(struct sensor *sensor, void *arg,
+           const struct sensor_block *block)
+{
+    int i;
+
+    TEST_ASSERT(block->sb_type == SENSOR_TYPE_ACCELEROMETER);
+    for (i = 0; i < block->sb_count; i++) {
+        TEST_ASSERT(sensor_block_data(block, i) ==
+                    &stcb_data[(stcb_block_samples + i) % STCB_NUM_SAMPLES]);
+    }
+    stcb_blocks++;
+    stcb_block_samples += block->sb_count;
+
+    return 0;
+}
+
+static void
+stcb_reset(void)
+{
+    stcb_num_reads = 0;
+    stcb_num_block_reads = 0;
+    stcb_samples = 0;
+    stcb_blocks = 0;
+    stcb_block_samples = 0;
+}
+
+TEST_CASE_SELF(sensor_test_case_block)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcb_sensor_read,
+        .sd_read_block = stcb_sensor_read_block,
+    };
+    static struct sensor_listener sample_listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_func = stcb_sample,
+    };
+    static struct sensor_listener block_listener = {
+        .sl_sensor_type = SENSOR_TYPE_ACCELEROMETER,
+        .sl_block_func = stcb_block,
+    };
+
+    struct sensor sn;
+    int rc;
+
+    rc = sensor_init(&sn, NULL);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_driver(&sn, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    sensor_set_type_mask(&sn, SENSOR_TYPE_ALL);
+
+    rc = sensor_register_listener(&sn, &sample_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_register_listener(&sn, &block_listener);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /*** Block read; block listener gets one block, the other one each
+     * reading.
+     */
+    stcb_reset();
+    stcb_block_status = 0;
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_num_block_reads == 1);
+    TEST_ASSERT(stcb_num_reads == 0);
+    TEST_ASSERT(stcb_blocks == 1);
+    TEST_ASSERT(stcb_block_samples == STCB_NUM_SAMPLES);
+    TEST_ASSERT(stcb_samples == STCB_NUM_SAMPLES);
+
+    /*** Per-reading caller of a block read. */
+    stcb_reset();
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, stcb_sample,
+                     (void *)SENSOR_IGN_LISTENER, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_blocks == 0);
+    TEST_ASSERT(stcb_samples == STCB_NUM_SAMPLES);
+
+    /*** Block caller of a block read. */
+    stcb_reset();
+    rc = sensor_read_block(&sn, SENSOR_TYPE_ACCELEROMETER, stcb_block,
+                           (void *)SENSOR_IGN_LISTENER, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_blocks == 1);
+    TEST_ASSERT(stcb_block_samples == STCB_NUM_SAMPLES);
+    TEST_ASSERT(stcb_samples == 0);
+
+    /*** Driver declines the block read; falls back to single readings. */
+    stcb_reset();
+    stcb_block_status = SYS_ENOTSUP;
+    rc = sensor_read(&sn, SENSOR_TYPE_ACCELEROMETER, NULL, NULL,
+                     OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_num_block_reads == 1);
+    TEST_ASSERT(stcb_num_reads == 1);
+    TEST_ASSERT(stcb_blocks == STCB_NUM_SAMPLES);
+    TEST_ASSERT(stcb_block_samples == STCB_NUM_SAMPLES);
+    TEST_ASSERT(stcb_samples == STCB_NUM_SAMPLES);
+
+    /*** Block caller of a single reading read gets blocks of one. */
+    stcb_reset();
+    rc = sensor_read_block(&sn, SENSOR_TYPE_ACCELEROMETER, stcb_block,
+                           (void *)SENSOR_IGN_LISTENER, OS_TIMEOUT_NEVER);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stcb_blocks == STCB_NUM_SAMPLES);
+    TEST_ASSERT(stcb_block_samples == STCB_NUM_SAMPLES);
+}
@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+#if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
+static int stcpl_reads;
+
+static int
+stcpl_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    stcpl_reads++;
+    return 0;
+}
+#endif
+
+/**
+ * The poller takes a sensor's lock before its interface lock, like an
+ * application read does.  Here the test task holds the sensor lock while the
+ * poller comes due and then takes the interface lock; with the opposite
+ * order the poller would hold the interface lock and the two would deadlock.
+ * The bus driver has no interface lock, so there is nothing to test with it.
+ */
+TEST_CASE_TASK(sensor_test_case_poll_lock)
+{
+#if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    static struct sensor_driver driver = {
+        .sd_read = stcpl_sensor_read,
+    };
+    static struct os_dev dev = {
+        .od_name = "stcpl0",
+    };
+    static struct sensor sensor;
+    static struct os_mutex itf_lock;
+    static struct sensor_itf itf;
+    int rc;
+
+    rc = os_mutex_init(&itf_lock);
+    TEST_ASSERT_FATAL(rc == 0);
+    itf.si_lock = &itf_lock;
+
+    rc = sensor_init(&sensor, &dev);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_driver(&sensor, SENSOR_TYPE_ACCELEROMETER, &driver);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_interface(&sensor, &itf);
+    TEST_ASSERT_FATAL(rc == 0);
+    sensor_set_type_mask(&sensor, SENSOR_TYPE_ALL);
+    rc = sensor_mgr_register(&sensor);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_lock(&sensor);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = sensor_set_poll_rate_ms("stcpl0", 50);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    /* The poller comes due and waits for the sensor lock. */
+    os_time_delay(os_time_ms_to_ticks32(100));
+    TEST_ASSERT(stcpl_reads == 0);
+
+    rc = sensor_itf_lock(&itf, 100);
+    TEST_ASSERT_FATAL(rc == 0, "interface lock held by the poller");
+    sensor_itf_unlock(&itf);
+    sensor_unlock(&sensor);
+
+    /* Released, the poller reads the sensor. */
+    os_time_delay(os_time_ms_to_ticks32(20));
+    TEST_ASSERT(stcpl_reads >= 1);
+
+    rc = sensor_set_poll_rate_ms("stcpl0", 0);
+    TEST_ASSERT(rc == 0);
+#endif
+}
@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "sensor/sensor.h"
+#include "sensor_test.h"
+
+#define STCPS_NUM_SENSORS   4
+
+static struct os_dev stcps_devs[STCPS_NUM_SENSORS];
+static struct sensor stcps_sensors[STCPS_NUM_SENSORS];
+static int stcps_reads[STCPS_NUM_SENSORS];
+
+static int
+stcps_sensor_read(struct sensor *sensor, sensor_type_t type,
+                  sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    stcps_reads[sensor - stcps_sensors]++;
+    return 0;
+}
+
+static void
+stcps_assert_reads(int idx, int expected)
+{
+    TEST_ASSERT(stcps_reads[idx] >= expected - 1 &&
+                stcps_reads[idx] <= expected + 1,
+                "sensor %d: %d reads, expected %d", idx, stcps_reads[idx],
+                expected);
+}
+
+TEST_CASE_TASK(sensor_test_case_poll_sched)
+{
+    static struct sensor_driver driver = {
+        .sd_read = stcps_sensor_read,
+    };
+    static const char *names[STCPS_NUM_SENSORS] = {
+        "stcps0", "stcps1", "stcps2", "stcps3",
+    };
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+    struct sensor_poll_stats stats;
+#endif
+    int rc;
+    int i;
+
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        stcps_devs[i].od_name = names[i];
+
+        rc = sensor_init(&stcps_sensors[i], &stcps_devs[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        rc = sensor_set_driver(&stcps_sensors[i], SENSOR_TYPE_ACCELEROMETER,
+                               &driver);
+        TEST_ASSERT_FATAL(rc == 0);
+
+        sensor_set_type_mask(&stcps_sensors[i], SENSOR_TYPE_ALL);
+
+        rc = sensor_mgr_register(&stcps_sensors[i]);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    /*** Sensors at 100, 200, 300 and 100 ms.  SENSOR_POLL_MAX is 3 in this
+     * test, so the poll queue has grown to hold the fourth one.
+     */
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        rc = sensor_set_poll_rate_ms(names[i], (i % 3 + 1) * 100);
+        TEST_ASSERT_FATAL(rc == 0);
+    }
+
+    os_time_delay(os_time_ms_to_ticks32(1250));
+
+    stcps_assert_reads(0, 12);
+    stcps_assert_reads(1, 6);
+    stcps_assert_reads(2, 4);
+    stcps_assert_reads(3, 12);
+
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+    rc = sensor_get_poll_stats(&stcps_sensors[0], &stats);
+    TEST_ASSERT(rc == 0);
+    TEST_ASSERT(stats.sps_polls == stcps_reads[0]);
+#endif
+
+    /*** Stop polling the second sensor and slow down the fourth. */
+    rc = sensor_set_poll_rate_ms(names[1], 0);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = sensor_set_poll_rate_ms(names[3], 200);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    memset(stcps_reads, 0, sizeof stcps_reads);
+    os_time_delay(os_time_ms_to_ticks32(650));
+
+    stcps_assert_reads(0, 6);
+    TEST_ASSERT(stcps_reads[1] == 0);
+    stcps_assert_reads(2, 2);
+    stcps_assert_reads(3, 3);
+
+    for (i = 0; i < STCPS_NUM_SENSORS; i++) {
+        sensor_set_poll_rate_ms(names[i], 0);
+    }
+}
@@ -51,6 +51,8 @@ struct test_log {
 os_time_t smgr_wakeup[500];
 #endif
 
+static struct sensor *sensor_mgr_poll_buf[MYNEWT_VAL(SENSOR_POLL_MAX)];
+
 struct {
     struct os_mutex mgr_lock;
 
@@ -58,7 +60,19 @@ struct {
     struct os_eventq *mgr_eventq;
 
     SLIST_HEAD(, sensor) mgr_sensor_list;
-} sensor_mgr;
+    uint16_t mgr_sensor_cnt;
+
+    /* Periodically polled sensors, a min-heap ordered by s_next_run.  Starts
+     * out in sensor_mgr_poll_buf and is reallocated when more sensors are
+     * registered than it can hold, so every sensor can be polled.
+     */
+    struct sensor **mgr_poll_heap;
+    uint16_t mgr_poll_cap;
+    uint16_t mgr_poll_cnt;
+} sensor_mgr = {
+    .mgr_poll_heap = sensor_mgr_poll_buf,
+    .mgr_poll_cap = MYNEWT_VAL(SENSOR_POLL_MAX),
+};
 
 struct sensor_timestamp sensor_base_ts;
 struct os_callout st_up_osco;
@@ -104,43 +118,145 @@ sensor_mgr_unlock(void)
 }
 
 static void
-sensor_mgr_remove(struct sensor *sensor)
+sensor_mgr_insert(struct sensor *sensor)
 {
-    SLIST_REMOVE(&sensor_mgr.mgr_sensor_list, sensor, sensor, s_next);
+    struct sensor *cursor, *prev;
+
+    prev = NULL;
+    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
+        prev = cursor;
+    }
+
+    if (prev == NULL) {
+        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
+    } else {
+        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    }
 }
 
+/*
+ * Periodically polled sensors are kept in a binary min-heap ordered by
+ * s_next_run, so a wakeup only looks at the sensors that are due.  Each
+ * sensor records its heap position plus one in s_poll_pos.  All heap
+ * operations are done with the sensor manager locked.
+ */
 static void
-sensor_mgr_insert(struct sensor *sensor)
+sensor_poll_heap_set(int idx, struct sensor *sensor)
 {
-    struct sensor *cursor, *prev;
+    sensor_mgr.mgr_poll_heap[idx] = sensor;
+    sensor->s_poll_pos = idx + 1;
+}
 
-    prev = cursor = NULL;
-    if (!sensor->s_poll_rate) {
-        SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-            prev = cursor;
+static void
+sensor_poll_heap_up(int idx)
+{
+    struct sensor *sensor;
+    struct sensor *parent;
+
+    sensor = sensor_mgr.mgr_poll_heap[idx];
+    while (idx > 0) {
+        parent = sensor_mgr.mgr_poll_heap[(idx - 1) / 2];
+        if (!OS_TIME_TICK_LT(sensor->s_next_run, parent->s_next_run)) {
+            break;
         }
-        goto insert;
+        sensor_poll_heap_set(idx, parent);
+        idx = (idx - 1) / 2;
     }
+    sensor_poll_heap_set(idx, sensor);
+}
 
-    prev = cursor = NULL;
-    SLIST_FOREACH(cursor, &sensor_mgr.mgr_sensor_list, s_next) {
-        if (!cursor->s_poll_rate) {
+static void
+sensor_poll_heap_down(int idx)
+{
+    struct sensor *sensor;
+    struct sensor *child;
+    int cnt;
+    int c;
+
+    cnt = sensor_mgr.mgr_poll_cnt;
+    sensor = sensor_mgr.mgr_poll_heap[idx];
+    while (1) {
+        c = 2 * idx + 1;
+        if (c >= cnt) {
             break;
         }
-
-        if (OS_TIME_TICK_LT(sensor->s_next_run, cursor->s_next_run)) {
+        child = sensor_mgr.mgr_poll_heap[c];
+        if (c + 1 < cnt &&
+            OS_TIME_TICK_LT(sensor_mgr.mgr_poll_heap[c + 1]->s_next_run,
+                            child->s_next_run)) {
+            c++;
+            child = sensor_mgr.mgr_poll_heap[c];
+        }
+        if (!OS_TIME_TICK_LT(child->s_next_run, sensor->s_next_run)) {
             break;
         }
+        sensor_poll_heap_set(idx, child);
+        idx = c;
+    }
+    sensor_poll_heap_set(idx, sensor);
+}
 
-        prev = cursor;
+/**
+ * Makes room in the poll heap for cnt sensors.  Must be called with the
+ * sensor manager locked.
+ */
+static int
+sensor_poll_heap_reserve(int cnt)
+{
+    struct sensor **heap;
+    int cap;
+
+    if (cnt <= sensor_mgr.mgr_poll_cap) {
+        return 0;
     }
 
-insert:
-    if (prev == NULL) {
-        SLIST_INSERT_HEAD(&sensor_mgr.mgr_sensor_list, sensor, s_next);
-    } else {
-        SLIST_INSERT_AFTER(prev, sensor, s_next);
+    cap = max(sensor_mgr.mgr_poll_cap * 2, cnt);
+    heap = malloc(cap * sizeof *heap);
+    if (heap == NULL) {
+        return SYS_ENOMEM;
+    }
+
+    memcpy(heap, sensor_mgr.mgr_poll_heap,
+           sensor_mgr.mgr_poll_cnt * sizeof *heap);
+    if (sensor_mgr.mgr_poll_heap != sensor_mgr_poll_buf) {
+        free(sensor_mgr.mgr_poll_heap);
+    }
+    sensor_mgr.mgr_poll_heap = heap;
+    sensor_mgr.mgr_poll_cap = cap;
+
+    return 0;
+}
+
+static int
+sensor_poll_heap_insert(struct sensor *sensor)
+{
+    if (sensor_mgr.mgr_poll_cnt >= sensor_mgr.mgr_poll_cap) {
+        return SYS_ENOMEM;
     }
+
+    sensor_poll_heap_set(sensor_mgr.mgr_poll_cnt++, sensor);
+    sensor_poll_heap_up(sensor->s_poll_pos - 1);
+
+    return 0;
+}
+
+static void
+sensor_poll_heap_remove(struct sensor *sensor)
+{
+    struct sensor *last;
+    int idx;
+
+    idx = sensor->s_poll_pos - 1;
+    sensor->s_poll_pos = 0;
+
+    last = sensor_mgr.mgr_poll_heap[--sensor_mgr.mgr_poll_cnt];
+    if (last == sensor) {
+        return;
+    }
+
+    sensor_poll_heap_set(idx, last);
+    sensor_poll_heap_up(idx);
+    sensor_poll_heap_down(last->s_poll_pos - 1);
 }
 
 /**
@@ -292,24 +408,12 @@ err:
     return rc;
 }
 
-static void
-sensor_update_poll_rate(struct sensor *sensor, uint32_t poll_rate)
-{
-    sensor_lock(sensor);
-
-    sensor->s_poll_rate = poll_rate;
-
-    sensor_unlock(sensor);
-}
-
 static os_time_t
 sensor_calc_nextrun_delta(struct sensor *sensor, os_time_t now)
 {
     os_time_t sensor_ticks;
     int delta;
 
-    sensor_lock(sensor);
-
     delta = (int32_t)(sensor->s_next_run - now);
     if (delta < 0) {
         /* This fires the callout right away */
@@ -318,51 +422,70 @@ sensor_calc_nextrun_delta(struct sensor *sensor, os_time_t now)
         sensor_ticks = delta;
     }
 
-    sensor_unlock(sensor);
-
     return sensor_ticks;
 }
 
+/**
+ * Returns the polled sensor with the earliest deadline, or NULL if no sensor
+ * is polled.  Must be called with the sensor manager locked.
+ */
 static struct sensor *
 sensor_find_min_nextrun_sensor(os_time_t now, os_time_t *min_nextrun)
 {
     struct sensor *head;
 
-    head = NULL;
-
-    sensor_mgr_lock();
-
-    head = SLIST_FIRST(&sensor_mgr.mgr_sensor_list);
+    if (sensor_mgr.mgr_poll_cnt == 0) {
+        return NULL;
+    }
 
+    head = sensor_mgr.mgr_poll_heap[0];
     *min_nextrun = sensor_calc_nextrun_delta(head, now);
 
-    sensor_mgr_unlock();
-
     return head;
-
 }
 
+/**
+ * Computes the first deadline of a sensor whose poll rate was just set.
+ */
 static void
-sensor_update_nextrun(struct sensor *sensor, os_time_t now)
+sensor_init_nextrun(struct sensor *sensor, os_time_t now)
 {
     os_time_t sensor_ticks;
 
     os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
+    if (sensor_ticks == 0) {
+        sensor_ticks = 1;
+    }
 
-    sensor_lock(sensor);
-
-    /* Remove the sensor from the sensor list for insert. */
-    sensor_mgr_remove(sensor);
-
-    /* Set next wakeup, and insert the sensor back into the
-     * list.
+#if MYNEWT_VAL(SENSOR_POLL_ALIGN)
+    /* Deadlines are multiples of the period, so sensors whose poll rates
+     * are multiples of each other come due in the same wakeup.
      */
-    sensor->s_next_run = sensor_ticks + now;
+    sensor->s_next_run = now - now % sensor_ticks + sensor_ticks;
+#else
+    sensor->s_next_run = now + sensor_ticks;
+#endif
+}
 
-    /* Re-insert the sensor manager, with the new wakeup time. */
-    sensor_mgr_insert(sensor);
+/**
+ * Advances the deadline of a sensor that was just polled by one period,
+ * skipping any periods that were missed entirely.
+ */
+static void
+sensor_update_nextrun(struct sensor *sensor, os_time_t now)
+{
+    os_time_t sensor_ticks;
 
-    sensor_unlock(sensor);
+    os_time_ms_to_ticks(sensor->s_poll_rate, &sensor_ticks);
+    if (sensor_ticks == 0) {
+        sensor_ticks = 1;
+    }
+
+    sensor->s_next_run += sensor_ticks;
+    if (!OS_TIME_TICK_GT(sensor->s_next_run, now)) {
+        sensor->s_next_run += ((now - sensor->s_next_run) / sensor_ticks + 1) *
+                              sensor_ticks;
+    }
 }
 
 /**
@@ -377,37 +500,93 @@ sensor_set_poll_rate_ms(const char *devname, uint32_t poll_rate)
     struct sensor *sensor;
     os_time_t next_wakeup;
     os_time_t now;
+    uint32_t old_rate;
     int rc;
 
-    os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
-
     sensor = sensor_mgr_find_next_bydevname(devname, NULL);
     if (!sensor) {
         rc = SYS_EINVAL;
         goto err;
     }
 
-    sensor_lock(sensor);
+    sensor_mgr_lock();
 
-    now = os_time_get();
+    os_callout_stop(&sensor_mgr.mgr_wakeup_callout);
 
-    os_time_ms_to_ticks(poll_rate, &next_wakeup);
+    now = os_time_get();
 
-    sensor_update_poll_rate(sensor, poll_rate);
+    sensor_lock(sensor);
 
-    sensor_update_nextrun(sensor, now);
+    rc = 0;
+    old_rate = sensor->s_poll_rate;
+    sensor->s_poll_rate = poll_rate;
+    if (sensor->s_poll_pos != 0) {
+        sensor_poll_heap_remove(sensor);
+    }
+    if (poll_rate != 0) {
+        sensor_init_nextrun(sensor, now);
+        rc = sensor_poll_heap_insert(sensor);
+        if (rc != 0) {
+            /* Only a sensor that was not polled can fail to go in. */
+            sensor->s_poll_rate = old_rate;
+        }
+    }
 
     sensor_unlock(sensor);
 
-    sensor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+    if (sensor_find_min_nextrun_sensor(now, &next_wakeup) != NULL) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    }
 
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
+    sensor_mgr_unlock();
 
-    return 0;
 err:
     return rc;
 }
 
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+/**
+ * Get the poll timing statistics of a sensor
+ *
+ * @param The sensor
+ * @param Where to store the statistics
+ *
+ * @return 0 on success, non-zero on failure
+ */
+int
+sensor_get_poll_stats(struct sensor *sensor, struct sensor_poll_stats *stats)
+{
+    int rc;
+
+    rc = sensor_lock(sensor);
+    if (rc) {
+        return rc;
+    }
+
+    *stats = sensor->s_poll_stats;
+
+    sensor_unlock(sensor);
+
+    return 0;
+}
+
+static void
+sensor_poll_stats_update(struct sensor *sensor, os_time_t now)
+{
+    struct sensor_poll_stats *sps;
+    os_time_t late;
+
+    sps = &sensor->s_poll_stats;
+    late = now - sensor->s_next_run;
+
+    sps->sps_polls++;
+    sps->sps_late_total += late;
+    if (late > sps->sps_late_max) {
+        sps->sps_late_max = late;
+    }
+}
+#endif
+
 /**
  * Register the sensor with the global sensor list. This makes the sensor
  * searchable by other packages, who may want to look it up by type.
@@ -426,18 +605,29 @@ sensor_mgr_register(struct sensor *sensor)
         goto err;
     }
 
+    /* Every registered sensor must fit in the poll heap, so that setting
+     * a poll rate cannot fail for lack of room.
+     */
+    rc = sensor_poll_heap_reserve(sensor_mgr.mgr_sensor_cnt + 1);
+    if (rc != 0) {
+        goto err_unlock;
+    }
+
     rc = sensor_lock(sensor);
     if (rc != 0) {
-        goto err;
+        goto err_unlock;
     }
 
     sensor_mgr_insert(sensor);
+    sensor_mgr.mgr_sensor_cnt++;
 
     sensor_unlock(sensor);
 
     sensor_mgr_unlock();
 
     return (0);
+err_unlock:
+    sensor_mgr_unlock();
 err:
     return (rc);
 }
@@ -520,17 +710,55 @@ sensor_poll_per_type_trait(struct sensor *sensor, os_time_t now,
 }
 
 /**
- * Event that wakes up the sensor manager, this goes through the sensor
- * list and polls any active sensors.
+ * Poll one sensor that is due.
+ *
+ * @param The sensor
+ * @param The time of the wakeup
+ */
+static void
+sensor_mgr_poll(struct sensor *sensor, os_time_t now)
+{
+    sensor_lock(sensor);
+
+#if MYNEWT_VAL(SENSOR_POLL_STATS)
+    sensor_poll_stats_update(sensor, os_time_get());
+#endif
+
+    if (sensor_type_traits_empty(sensor)) {
+        sensor_mgr_poll_bytype(sensor, sensor->s_mask, NULL, now);
+    } else {
+        sensor_poll_per_type_trait(sensor, now, 0);
+    }
+
+    sensor_update_nextrun(sensor, now);
+
+    sensor_unlock(sensor);
+}
+
+/**
+ * Event that wakes up the sensor manager, this polls all sensors whose
+ * deadline has passed.
+ *
+ * Due sensors that share an interface lock are polled back to back while
+ * the lock is held, so other users of the bus cannot get in between them.
+ * Their sensor locks are taken before the interface lock, in the same order
+ * as sensor_read(), so a concurrent read cannot deadlock with the poller.
  *
  * @param OS event
  */
 static void
 sensor_mgr_wakeup_event(struct os_event *ev)
 {
+    struct sensor **due;
     struct sensor *cursor;
     os_time_t now;
     os_time_t next_wakeup;
+    int num_due;
+    int i;
+#if !MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    struct os_mutex *itf_lock;
+    int j;
+#endif
 
     now = os_time_get();
 
@@ -540,43 +768,75 @@ sensor_mgr_wakeup_event(struct os_event *ev)
 
     sensor_mgr_lock();
 
-    cursor = NULL;
+    /* Take all due sensors off the heap.  Each one is parked in the slot
+     * just past the end of the shrinking heap, so due[] ends up holding them
+     * in reverse deadline order.
+     */
+    num_due = 0;
     while (1) {
-
         cursor = sensor_find_min_nextrun_sensor(now, &next_wakeup);
+        if (cursor == NULL || next_wakeup > 0) {
+            break;
+        }
+        sensor_poll_heap_remove(cursor);
+        sensor_mgr.mgr_poll_heap[sensor_mgr.mgr_poll_cnt] = cursor;
+        num_due++;
+    }
+    due = &sensor_mgr.mgr_poll_heap[sensor_mgr.mgr_poll_cnt];
 
-        sensor_lock(cursor);
-        /* Sensors that are not periodic are inserted at the end of the sensor
-         * list.
-         */
-        if (!cursor->s_poll_rate) {
-            sensor_unlock(cursor);
-            sensor_mgr_unlock();
-            return;
+#if MYNEWT_VAL(BUS_DRIVER_PRESENT)
+    for (i = num_due - 1; i >= 0; i--) {
+        sensor_mgr_poll(due[i], now);
+    }
+#else
+    for (i = num_due - 1; i >= 0; i--) {
+        /* A polled sensor's deadline has moved past now. */
+        if (OS_TIME_TICK_GT(due[i]->s_next_run, now)) {
+            continue;
         }
 
-        /* List is sorted by what runs first.  If we reached the first element that
-         * doesn't run, break out.
+        /* All due sensors behind this interface lock are handled together.
+         * Any at a higher index would have taken this one with them.
          */
-        if (next_wakeup > 0) {
-            break;
+        itf_lock = due[i]->s_itf.si_lock;
+        for (j = i; j >= 0; j--) {
+            if (due[j]->s_itf.si_lock == itf_lock) {
+                sensor_lock(due[j]);
+            }
+        }
+        if (itf_lock != NULL) {
+            os_mutex_pend(itf_lock, OS_TIMEOUT_NEVER);
         }
 
-        if (sensor_type_traits_empty(cursor)) {
+        for (j = i; j >= 0; j--) {
+            if (due[j]->s_itf.si_lock == itf_lock) {
+                sensor_mgr_poll(due[j], now);
+            }
+        }
 
-            sensor_mgr_poll_bytype(cursor, cursor->s_mask, NULL, now);
-        } else {
-            sensor_poll_per_type_trait(cursor, now, next_wakeup);
+        if (itf_lock != NULL) {
+            os_mutex_release(itf_lock);
         }
+        for (j = i; j >= 0; j--) {
+            if (due[j]->s_itf.si_lock == itf_lock) {
+                sensor_unlock(due[j]);
+            }
+        }
+    }
+#endif
 
-        sensor_update_nextrun(cursor, now);
+    /* Put the sensors back with their new deadlines.  Inserting due[i] only
+     * touches heap slots up to its own, so due[i + 1] onwards stay intact.
+     */
+    for (i = 0; i < num_due; i++) {
+        (void)sensor_poll_heap_insert(due[i]);
+    }
 
-        sensor_unlock(cursor);
+    if (sensor_find_min_nextrun_sensor(now, &next_wakeup) != NULL) {
+        os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
     }
 
     sensor_mgr_unlock();
-
-    os_callout_reset(&sensor_mgr.mgr_wakeup_callout, next_wakeup);
 }
 
 /**
@@ -1159,20 +1419,42 @@ done:
     return (rc);
 }
 
+/**
+ * Fill in a block holding the single reading "data".
+ */
+static void
+sensor_block_one(struct sensor *sensor, struct sensor_block *block,
+                 void *data, sensor_type_t type)
+{
+    block->sb_type = type;
+    block->sb_count = 1;
+    block->sb_stride = 0;
+    block->sb_data = data;
+    block->sb_cputime = sensor->s_sts.st_cputime;
+    block->sb_itvl_us = 0;
+}
+
 static int
 sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
                       sensor_type_t type)
 {
     struct sensor_listener *listener;
     struct sensor_read_ctx *ctx;
+    struct sensor_block block;
 
     ctx = (struct sensor_read_ctx *) arg;
 
     if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
         /* Notify all listeners first */
         SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
-            if (listener->sl_sensor_type & type) {
+            if (!(listener->sl_sensor_type & type)) {
+                continue;
+            }
+            if (listener->sl_func != NULL) {
                 listener->sl_func(sensor, listener->sl_arg, data, type);
+            } else if (listener->sl_block_func != NULL) {
+                sensor_block_one(sensor, &block, data, type);
+                listener->sl_block_func(sensor, listener->sl_arg, &block);
             }
         }
     }
@@ -1181,6 +1463,60 @@ sensor_read_data_func(struct sensor *sensor, void *arg, void *data,
     if (ctx->user_func != NULL) {
         return (ctx->user_func(sensor, ctx->user_arg, data, type));
     }
+    if (ctx->user_block_func != NULL) {
+        sensor_block_one(sensor, &block, data, type);
+        return (ctx->user_block_func(sensor, ctx->user_arg, &block));
+    }
+
+    return (0);
+}
+
+/**
+ * Deliver a block of readings returned by a driver's sd_read_block.
+ * Listeners and callers that only take single readings get them one at a
+ * time.
+ */
+static int
+sensor_read_block_func(struct sensor *sensor, void *arg,
+                       const struct sensor_block *block)
+{
+    struct sensor_listener *listener;
+    struct sensor_read_ctx *ctx;
+    sensor_type_t type;
+    int rc;
+    int i;
+
+    ctx = (struct sensor_read_ctx *) arg;
+    type = block->sb_type;
+
+    if ((uint8_t)(uintptr_t)(ctx->user_arg) != SENSOR_IGN_LISTENER) {
+        SLIST_FOREACH(listener, &sensor->s_listener_list, sl_next) {
+            if (!(listener->sl_sensor_type & type)) {
+                continue;
+            }
+            if (listener->sl_block_func != NULL) {
+                listener->sl_block_func(sensor, listener->sl_arg, block);
+            } else if (listener->sl_func != NULL) {
+                for (i = 0; i < block->sb_count; i++) {
+                    listener->sl_func(sensor, listener->sl_arg,
+                                      sensor_block_data(block, i), type);
+                }
+            }
+        }
+    }
+
+    if (ctx->user_block_func != NULL) {
+        return (ctx->user_block_func(sensor, ctx->user_arg, block));
+    }
+    if (ctx->user_func != NULL) {
+        for (i = 0; i < block->sb_count; i++) {
+            rc = ctx->user_func(sensor, ctx->user_arg,
+                                sensor_block_data(block, i), type);
+            if (rc != 0) {
+                return (rc);
+            }
+        }
+    }
 
     return (0);
 }
@@ -2145,6 +2481,7 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
     assert(sensor_trig_lner != NULL);
 
     sensor_trig_lner->sl_func = sensor_generate_trig;
+    sensor_trig_lner->sl_block_func = NULL;
     sensor_trig_lner->sl_sensor_type = type;
     sensor_trig_lner->sl_arg = (void *)notify;
 
@@ -2154,23 +2491,10 @@ sensor_trigger_init(struct sensor *sensor, sensor_type_t type,
     }
 }
 
-/**
- * Read the data for sensor type "type," from the given sensor and
- * return the result into the "value" parameter.
- *
- * @param The sensor to read data from
- * @param The type of sensor data to read from the sensor
- * @param The callback to call for data returned from that sensor
- * @param The argument to pass to this callback.
- * @param Timeout before aborting sensor read
- *
- * @return 0 on success, non-zero on failure.
- */
-int
-sensor_read(struct sensor *sensor, sensor_type_t type,
-        sensor_data_func_t data_func, void *arg, uint32_t timeout)
+static int
+sensor_read_with_ctx(struct sensor *sensor, sensor_type_t type,
+                     struct sensor_read_ctx *src, uint32_t timeout)
 {
-    struct sensor_read_ctx src;
     int rc;
 
     rc = sensor_lock(sensor);
@@ -2178,9 +2502,6 @@ sensor_read(struct sensor *sensor, sensor_type_t type,
         goto err;
     }
 
-    src.user_func = data_func;
-    src.user_arg = arg;
-
     if (!sensor_mgr_match_bytype(sensor, (void *)&type)) {
         rc = SYS_ENOENT;
         goto err;
@@ -2188,8 +2509,19 @@ sensor_read(struct sensor *sensor, sensor_type_t type,
 
     sensor_up_timestamp(sensor);
 
-    rc = sensor->s_funcs->sd_read(sensor, type, sensor_read_data_func, &src,
-                                  timeout);
+    /* Prefer a block read; the driver may decline it in its current
+     * configuration.
+     */
+    rc = SYS_ENOTSUP;
+    if (sensor->s_funcs->sd_read_block != NULL) {
+        rc = sensor->s_funcs->sd_read_block(sensor, type,
+                                            sensor_read_block_func, src,
+                                            timeout);
+    }
+    if (rc == SYS_ENOTSUP) {
+        rc = sensor->s_funcs->sd_read(sensor, type, sensor_read_data_func,
+                                      src, timeout);
+    }
     if (rc) {
         if (sensor->s_err_fn != NULL) {
             sensor->s_err_fn(sensor, sensor->s_err_arg, rc);
@@ -2202,6 +2534,57 @@ err:
     return (rc);
 }
 
+/**
+ * Read the data for sensor type "type," from the given sensor and
+ * return the result into the "value" parameter.
+ *
+ * @param The sensor to read data from
+ * @param The type of sensor data to read from the sensor
+ * @param The callback to call for data returned from that sensor
+ * @param The argument to pass to this callback.
+ * @param Timeout before aborting sensor read
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int
+sensor_read(struct sensor *sensor, sensor_type_t type,
+        sensor_data_func_t data_func, void *arg, uint32_t timeout)
+{
+    struct sensor_read_ctx src;
+
+    src.user_func = data_func;
+    src.user_block_func = NULL;
+    src.user_arg = arg;
+
+    return sensor_read_with_ctx(sensor, type, &src, timeout);
+}
+
+/**
+ * Read the data for sensor type "type" from the given sensor, delivering
+ * it in blocks.
+ *
+ * @param The sensor to read data from
+ * @param The type of sensor data to read from the sensor
+ * @param The callback to call for each block of readings
+ * @param The argument to pass to this callback.
+ * @param Timeout before aborting sensor read
+ *
+ * @return 0 on success, non-zero on failure.
+ */
+int
+sensor_read_block(struct sensor *sensor, sensor_type_t type,
+                  sensor_block_func_t block_func, void *arg,
+                  uint32_t timeout)
+{
+    struct sensor_read_ctx src;
+
+    src.user_func = NULL;
+    src.user_block_func = block_func;
+    src.user_arg = arg;
+
+    return sensor_read_with_ctx(sensor, type, &src, timeout);
+}
+
 /**
  * Reset sensor
  *
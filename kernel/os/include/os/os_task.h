@@ -75,6 +75,8 @@ typedef enum os_task_state {
 #define OS_TASK_FLAG_MUTEX_WAIT     (0x04U)
 /** Task waiting on a event queue */
 #define OS_TASK_FLAG_EVQ_WAIT       (0x08U)
+/** Task stack usage warning has been reported */
+#define OS_TASK_FLAG_STACK_WARNED   (0x10U)
 
 typedef void (*os_task_func_t)(void *);
 
@@ -127,6 +129,11 @@ struct os_task {
     STAILQ_ENTRY(os_task) t_os_task_list;
     TAILQ_ENTRY(os_task) t_os_list;
     SLIST_ENTRY(os_task) t_obj_list;
+
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+    /** Lowest stack address known to have been used */
+    os_stack_t *t_stack_hwm;
+#endif
 };
 
 /** @cond INTERNAL_HIDDEN */
@@ -232,6 +239,27 @@ struct os_task_info {
 struct os_task *os_task_info_get_next(const struct os_task *,
         struct os_task_info *);
 
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+/**
+ * Called when a task's stack high-water mark crosses
+ * OS_TASK_STACK_HWM_WARN_PCT.  May be called from the context switch
+ * handler, so it must be safe to call from interrupt context.
+ *
+ * @param t     The task whose stack usage crossed the threshold.
+ * @param usage The task's stack usage, in os_stack_ts.
+ */
+typedef void os_task_stack_warn_fn(struct os_task *t, uint16_t usage);
+
+/**
+ * Sets the function called when a task's stack usage crosses
+ * OS_TASK_STACK_HWM_WARN_PCT.  Does nothing if OS_TASK_STACK_HWM_WARN_PCT
+ * is 0.
+ *
+ * @param cb The callback to set; NULL to clear it.
+ */
+void os_task_stack_warn_cb_set(os_task_stack_warn_fn *cb);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
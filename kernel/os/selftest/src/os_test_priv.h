@@ -32,6 +32,7 @@
 #include "mempool_test.h"
 #include "mutex_test.h"
 #include "sem_test.h"
+#include "task_test.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -0,0 +1,101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "os_test_priv.h"
+
+struct os_task task_test_task;
+os_stack_t task_test_stack[TASK_TEST_STACK_SIZE];
+
+static void
+task_test_handler(void *arg)
+{
+    while (1) {
+        os_time_delay(OS_TICKS_PER_SEC);
+    }
+}
+
+/*
+ * Creates a task that never gets to run; the test cases write to its stack
+ * directly to simulate usage.
+ */
+void
+task_test_init(void)
+{
+    int rc;
+
+    rc = os_task_init(&task_test_task, "task_test", task_test_handler, NULL,
+                      TASK1_PRIO, OS_WAIT_FOREVER, task_test_stack,
+                      TASK_TEST_STACK_SIZE);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+void
+task_test_cleanup(void)
+{
+    os_task_remove(&task_test_task);
+}
+
+/*
+ * Returns stack usage of the test task as reported by
+ * os_task_info_get_next().
+ */
+uint16_t
+task_test_stack_usage(void)
+{
+    struct os_task_info oti;
+    struct os_task *t;
+
+    t = NULL;
+    while ((t = os_task_info_get_next(t, &oti)) != NULL) {
+        if (t == &task_test_task) {
+            return oti.oti_stkusage;
+        }
+    }
+    TEST_ASSERT_FATAL(0, "test task not found");
+    return 0;
+}
+
+/*
+ * Simulates the test task's stack growing down to word idx by writing the
+ * words between idx and the current high-water mark.
+ */
+void
+task_test_stack_grow(int idx)
+{
+    int mark;
+    int i;
+
+    mark = TASK_TEST_STACK_SIZE - task_test_stack_usage();
+    for (i = idx; i < mark; i++) {
+        task_test_stack[i] = 0;
+    }
+}
+
+TEST_CASE_DECL(os_task_test_stack_hwm)
+TEST_CASE_DECL(os_task_test_stack_warn)
+
+TEST_SUITE(os_task_test_suite)
+{
+    os_task_test_stack_hwm();
+    os_task_test_stack_warn();
+}
@@ -0,0 +1,58 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+/**
+ * The mark follows stack growth down from its previous position, skips
+ * usage below a run of untouched fill pattern, and never goes up.
+ */
+TEST_CASE_SELF(os_task_test_stack_hwm)
+{
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+    uint16_t usage;
+    int i;
+
+    task_test_init();
+
+    usage = task_test_stack_usage();
+    TEST_ASSERT(usage < TASK_TEST_STACK_SIZE - 300);
+
+    task_test_stack_grow(300);
+    usage = task_test_stack_usage();
+    TEST_ASSERT(usage == TASK_TEST_STACK_SIZE - 300, "usage=%u", usage);
+
+    /* A word written below untouched stack is not scanned for. */
+    task_test_stack[50] = 0;
+    usage = task_test_stack_usage();
+    TEST_ASSERT(usage == TASK_TEST_STACK_SIZE - 300, "usage=%u", usage);
+
+    task_test_stack_grow(51);
+    usage = task_test_stack_usage();
+    TEST_ASSERT(usage == TASK_TEST_STACK_SIZE - 50, "usage=%u", usage);
+
+    /* The mark is a high-water mark; it stays after the stack shrinks. */
+    for (i = 50; i < 300; i++) {
+        task_test_stack[i] = OS_STACK_PATTERN;
+    }
+    usage = task_test_stack_usage();
+    TEST_ASSERT(usage == TASK_TEST_STACK_SIZE - 50, "usage=%u", usage);
+
+    task_test_cleanup();
+#endif
+}
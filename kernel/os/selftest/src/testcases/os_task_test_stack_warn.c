@@ -0,0 +1,71 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "os_test_priv.h"
+
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+static struct os_task *task_test_warn_task;
+static uint16_t task_test_warn_usage;
+static int task_test_warn_cnt;
+
+static void
+task_test_warn_cb(struct os_task *t, uint16_t usage)
+{
+    task_test_warn_task = t;
+    task_test_warn_usage = usage;
+    task_test_warn_cnt++;
+}
+#endif
+
+/**
+ * The warning callback runs once, when usage first crosses
+ * OS_TASK_STACK_HWM_WARN_PCT.
+ */
+TEST_CASE_SELF(os_task_test_stack_warn)
+{
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+    int below;
+    int above;
+
+    /* Word indices just below and above the threshold. */
+    above = TASK_TEST_STACK_SIZE -
+            TASK_TEST_STACK_SIZE * MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT) / 100;
+    below = above + 8;
+
+    task_test_warn_cnt = 0;
+    os_task_stack_warn_cb_set(task_test_warn_cb);
+    task_test_init();
+
+    task_test_stack_grow(below);
+    task_test_stack_usage();
+    TEST_ASSERT(task_test_warn_cnt == 0);
+
+    task_test_stack_grow(above);
+    task_test_stack_usage();
+    TEST_ASSERT_FATAL(task_test_warn_cnt == 1);
+    TEST_ASSERT(task_test_warn_task == &task_test_task);
+    TEST_ASSERT(task_test_warn_usage == TASK_TEST_STACK_SIZE - above);
+
+    task_test_stack_grow(0);
+    task_test_stack_usage();
+    TEST_ASSERT(task_test_warn_cnt == 1);
+
+    os_task_stack_warn_cb_set(NULL);
+    task_test_cleanup();
+#endif
+}
@@ -40,6 +40,10 @@ extern struct os_callout_list g_callout_list;
 void os_mempool_module_init(void);
 void os_msys_init(void);
 
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+void os_task_stack_hwm_sample(struct os_task *t, os_stack_t *sp);
+#endif
+
 /**
  * Prints information about a crash to the console.  This functionality is
  * defined as a macro rather than a function to ensure that it gets inlined,
@@ -82,6 +82,9 @@ os_sched_ctx_sw_hook(struct os_task *next_t)
     for (i = 0; i < MYNEWT_VAL(OS_CTX_SW_STACK_GUARD); i++) {
         assert(top[i] == OS_STACK_PATTERN);
     }
+#endif
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+    os_task_stack_hwm_sample(next_t, next_t->t_stackptr);
 #endif
     next_t->t_ctx_sw_cnt++;
     g_current_task->t_run_time += g_os_time - g_os_last_ctx_sw_time;
@@ -26,6 +26,10 @@ uint8_t g_task_id;
 
 struct os_task_stailq g_os_task_list;
 
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+static os_task_stack_warn_fn *os_task_stack_warn_cb;
+#endif
+
 static void
 _clear_stack(os_stack_t *stack_bottom, int size)
 {
@@ -97,6 +101,9 @@ os_task_init(struct os_task *t, const char *name, os_task_func_t func,
     t->t_stacksize = stack_size;
     t->t_stackptr = os_arch_task_stack_init(t, t->t_stacktop,
             t->t_stacksize);
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+    t->t_stack_hwm = t->t_stackptr;
+#endif
 
     STAILQ_FOREACH(task, &g_os_task_list, t_os_task_list) {
         assert(t->t_prio != task->t_prio);
@@ -168,13 +175,85 @@ os_task_remove(struct os_task *t)
     return rc;
 }
 
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+
+void
+os_task_stack_warn_cb_set(os_task_stack_warn_fn *cb)
+{
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+    os_task_stack_warn_cb = cb;
+#endif
+}
+
+/**
+ * Lowers a task's stack high-water mark if the specified stack pointer lies
+ * below it.  Must be called with interrupts disabled.
+ */
+void
+os_task_stack_hwm_sample(struct os_task *t, os_stack_t *sp)
+{
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+    uint16_t usage;
+#endif
+
+    if (sp >= t->t_stack_hwm) {
+        return;
+    }
+    t->t_stack_hwm = sp;
+
+#if MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)
+    if (t->t_flags & OS_TASK_FLAG_STACK_WARNED) {
+        return;
+    }
+
+    usage = t->t_stacktop - sp;
+    if ((uint32_t)usage * 100 >=
+        (uint32_t)t->t_stacksize * MYNEWT_VAL(OS_TASK_STACK_HWM_WARN_PCT)) {
+
+        t->t_flags |= OS_TASK_FLAG_STACK_WARNED;
+        if (os_task_stack_warn_cb != NULL) {
+            os_task_stack_warn_cb(t, usage);
+        }
+    }
+#endif
+}
+
+/**
+ * Lowers the task's high-water mark past stack words below it which no
+ * longer hold the fill pattern.  The scan starts at the current mark and
+ * stops at the first word still holding the pattern, so its cost is
+ * proportional to the growth since the previous scan, not to the stack
+ * size.  Usage below a run of untouched words, e.g. an unwritten local
+ * buffer, is found only if a context switch sampled the stack pointer
+ * below that run.
+ */
+static void
+os_task_stack_hwm_scan(struct os_task *t)
+{
+    os_stack_t *bottom;
+    os_stack_t *cur;
+    os_sr_t sr;
+
+    bottom = t->t_stacktop - t->t_stacksize;
+    cur = t->t_stack_hwm;
+    while (cur > bottom && *(cur - 1) != OS_STACK_PATTERN) {
+        cur--;
+    }
+
+    OS_ENTER_CRITICAL(sr);
+    os_task_stack_hwm_sample(t, cur);
+    OS_EXIT_CRITICAL(sr);
+}
+#endif
 
 struct os_task *
 os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
 {
     struct os_task *next;
+#if !MYNEWT_VAL(OS_TASK_STACK_HWM)
     os_stack_t *top;
     os_stack_t *bottom;
+#endif
 
     if (prev != NULL) {
         next = STAILQ_NEXT(prev, t_os_task_list);
@@ -193,6 +272,10 @@ os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
     oti->oti_taskid = next->t_taskid;
     oti->oti_state = next->t_state;
 
+#if MYNEWT_VAL(OS_TASK_STACK_HWM)
+    os_task_stack_hwm_scan(next);
+    oti->oti_stkusage = (uint16_t) (next->t_stacktop - next->t_stack_hwm);
+#else
     top = next->t_stacktop;
     bottom = next->t_stacktop - next->t_stacksize;
     while (bottom < top) {
@@ -203,6 +286,7 @@ os_task_info_get_next(const struct os_task *prev, struct os_task_info *oti)
     }
 
     oti->oti_stkusage = (uint16_t) (next->t_stacktop - bottom);
+#endif
     oti->oti_stksize = next->t_stacksize;
     oti->oti_cswcnt = next->t_ctx_sw_cnt;
     oti->oti_runtime = next->t_run_time;
@@ -27,6 +27,9 @@ extern "C" {
 #include <stdio.h>
 #include <setjmp.h>
 #include "os/mynewt.h"
+#if MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
+#include <pthread.h>
+#endif
 struct os_task;
 struct stack_frame;
 
@@ -34,6 +37,10 @@ struct stack_frame {
     int sf_mainsp;              /* stack on which main() is executing */
     sigjmp_buf sf_jb;
     struct os_task *sf_task;
+#if MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
+    pthread_t sf_thread;        /* host thread backing sf_task */
+    pthread_cond_t sf_cond;     /* signalled when sf_task is scheduled */
+#endif
 };
 
 void sim_task_start(struct stack_frame *sf, int rc);
@@ -45,6 +45,7 @@
 
 pid_t sim_pid;
 
+#if !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
 void
 sim_switch_tasks(void)
 {
@@ -80,6 +81,7 @@ sim_switch_tasks(void)
     sf = (struct stack_frame *) next_t->t_stackptr;
     sim_longjmp(sf->sf_jb, 1);
 }
+#endif /* !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS) */
 
 void
 sim_tick(void)
@@ -121,12 +123,41 @@ sim_tick(void)
     }
 }
 
+/**
+ * Advances OS time without waiting for it to elapse.  This is the idle
+ * handler used when MCU_NATIVE_VIRTUAL_TIME is enabled: the idle task asks to
+ * sleep until the next deadline and we jump straight to it.
+ *
+ * @param ticks                 The number of ticks until the next deadline;
+ *                                  0 if the deadline is too close to sleep.
+ */
+void
+sim_tick_virtual(os_time_t ticks)
+{
+    OS_ASSERT_CRITICAL();
+
+    /* Always make progress; otherwise a deadline less than
+     * OS_IDLE_TICKLESS_MS_MIN away would never be reached.
+     */
+    if (ticks == 0) {
+        ticks = 1;
+    }
+
+    os_time_advance(ticks);
+}
+
+#if !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
 static void
 sim_start_timer(void)
 {
     struct itimerval it;
     int rc;
 
+#if MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+    /* Time is advanced by the idle task; no wall-clock tick. */
+    return;
+#endif
+
     memset(&it, 0, sizeof(it));
     it.it_value.tv_sec = 0;
     it.it_value.tv_usec = OS_USEC_PER_TICK;
@@ -136,6 +167,7 @@ sim_start_timer(void)
     rc = setitimer(ITIMER_REAL, &it, NULL);
     assert(rc == 0);
 }
+#endif /* !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS) */
 
 static void
 sim_stop_timer(void)
@@ -175,6 +207,7 @@ sim_task_start(struct stack_frame *sf, int rc)
     assert(0);
 }
 
+#if !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
 os_stack_t *
 sim_task_stack_init(struct os_task *t, os_stack_t *stack_top, int size)
 {
@@ -215,6 +248,7 @@ sim_os_start(void)
 
     return 0;
 }
+#endif /* !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS) */
 
 /**
  * Stops the tick timer and clears the "started" flag.  This function is only
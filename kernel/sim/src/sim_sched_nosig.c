@@ -32,7 +32,7 @@
 
 #include "os/mynewt.h"
 
-#if !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS)
+#if !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) && !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
 
 #include <hal/hal_bsp.h>
 
@@ -159,6 +159,11 @@ sim_tick_idle(os_time_t ticks)
 
     OS_ASSERT_CRITICAL();
 
+#if MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+    sim_tick_virtual(ticks);
+    return;
+#endif
+
     if (ticks > 0) {
         /*
          * Enter tickless regime and set the timer to fire after 'ticks'
@@ -235,4 +240,5 @@ sim_signals_cleanup(void)
     assert(error == 0);
 }
 
-#endif /* !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) */
+#endif /* !MYNEWT_VAL(MCU_NATIVE_USE_SIGNALS) &&
+          !MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS) */
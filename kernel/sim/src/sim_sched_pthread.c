@@ -0,0 +1,338 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/**
+ * This file implements the "pthreads" version of sim.  Each Mynewt task is
+ * backed by its own host thread.  A global scheduler lock ensures that only
+ * the thread belonging to the current task ever runs; a context switch hands
+ * the CPU to the next task's thread and parks the calling thread until it is
+ * scheduled again.  Host tools (perf, gdb, sanitizers) therefore see one
+ * thread per task and attribute time and stacks accordingly.
+ *
+ * The OS tick is generated by a separate host thread which only sets a flag.
+ * The flag is serviced by the running task the next time it leaves a
+ * critical section, or by the idle task.  This gives the same priority
+ * semantics as the "signals" version (a sleeping high-priority task preempts
+ * a low-priority one when its timer expires) without interrupting tasks in
+ * the middle of system calls.  A task that spins without ever entering a
+ * critical section is not preempted.
+ *
+ * Task code runs on host thread stacks, not on the os_stack_t arrays passed
+ * to os_task_init(); only the stack frame at the top of each array is used.
+ * Stack usage reported by the OS is therefore not meaningful.
+ *
+ * Unit tests are not supported: test cases restart by longjmp()ing out of the
+ * test task into the main thread, which cannot cross threads.
+ *
+ * To use this version of sim, disable the MCU_NATIVE_USE_SIGNALS syscfg
+ * setting and enable MCU_NATIVE_USE_PTHREADS.
+ */
+
+/* Needed for pthread_setname_np(). */
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS)
+
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <assert.h>
+#include "sim/sim.h"
+#include "sim_priv.h"
+
+/* Protects g_current_task and the per-task condition variables. */
+static pthread_mutex_t sim_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/* Signalled by the tick thread to wake the idle task. */
+static pthread_cond_t sim_idle_cond = PTHREAD_COND_INITIALIZER;
+
+/* Never signalled; the main thread parks on it once the OS starts. */
+static pthread_cond_t sim_main_cond = PTHREAD_COND_INITIALIZER;
+
+static pthread_t sim_tick_thread;
+static int sim_tick_thread_started;
+static int tick_pending;
+
+static int ctx_sw_pending;
+static int interrupts_enabled = 1;
+
+/**
+ * Blocks the calling thread until the task owning the specified stack frame is
+ * the current task.  Must be called with sim_lock held.
+ */
+static void
+sim_wait_current(struct stack_frame *sf)
+{
+    while (os_sched_get_current_task() != sf->sf_task) {
+        pthread_cond_wait(&sf->sf_cond, &sim_lock);
+    }
+}
+
+/**
+ * Services an OS tick raised by the tick thread, if any.  Must be called with
+ * interrupts disabled.
+ */
+static void
+sim_tick_service(void)
+{
+    if (__atomic_exchange_n(&tick_pending, 0, __ATOMIC_ACQUIRE)) {
+        sim_tick();
+    }
+}
+
+static void *
+sim_tick_thread_main(void *arg)
+{
+    struct timespec ts;
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = OS_USEC_PER_TICK * 1000;
+
+    while (1) {
+        nanosleep(&ts, NULL);
+
+        __atomic_store_n(&tick_pending, 1, __ATOMIC_RELEASE);
+
+        pthread_mutex_lock(&sim_lock);
+        pthread_cond_signal(&sim_idle_cond);
+        pthread_mutex_unlock(&sim_lock);
+    }
+
+    return NULL;
+}
+
+static void *
+sim_task_thread_main(void *arg)
+{
+    struct stack_frame *sf;
+
+    sf = arg;
+
+    pthread_mutex_lock(&sim_lock);
+    sim_wait_current(sf);
+    pthread_mutex_unlock(&sim_lock);
+
+    sim_task_start(sf, 0);
+
+    return NULL;
+}
+
+void
+sim_switch_tasks(void)
+{
+    struct os_task *t, *next_t;
+    struct stack_frame *sf;
+
+    OS_ASSERT_CRITICAL();
+
+    t = os_sched_get_current_task();
+    next_t = os_sched_next_task();
+    if (t == next_t) {
+        /*
+         * Context switch not needed - just return.
+         */
+        return;
+    }
+
+    os_sched_ctx_sw_hook(next_t);
+
+    pthread_mutex_lock(&sim_lock);
+
+    os_sched_set_current_task(next_t);
+    sf = (struct stack_frame *)next_t->t_stackptr;
+    pthread_cond_signal(&sf->sf_cond);
+
+    /* Park this thread until its task is scheduled again. */
+    if (t != NULL) {
+        sim_wait_current((struct stack_frame *)t->t_stackptr);
+    }
+
+    pthread_mutex_unlock(&sim_lock);
+}
+
+void
+sim_ctx_sw(struct os_task *next_t)
+{
+    if (interrupts_enabled) {
+        /* Perform the context switch immediately. */
+        sim_switch_tasks();
+    } else {
+        /* Remember that we want to perform a context switch.  Perform it when
+         * interrupts are re-enabled.
+         */
+        ctx_sw_pending = 1;
+    }
+}
+
+os_sr_t
+sim_save_sr(void)
+{
+    if (!interrupts_enabled) {
+        return 1;
+    }
+
+    interrupts_enabled = 0;
+    return 0;
+}
+
+void
+sim_restore_sr(os_sr_t osr)
+{
+    OS_ASSERT_CRITICAL();
+    assert(osr == 0 || osr == 1);
+
+    if (osr == 1) {
+        /* Exiting a nested critical section */
+        return;
+    }
+
+    /* Leaving the outermost critical section is a preemption point. */
+    sim_tick_service();
+
+    if (ctx_sw_pending) {
+        /* A context switch was requested while interrupts were disabled.
+         * Perform it now that interrupts are enabled again.
+         */
+        ctx_sw_pending = 0;
+        sim_switch_tasks();
+    }
+    interrupts_enabled = 1;
+}
+
+int
+sim_in_critical(void)
+{
+    return !interrupts_enabled;
+}
+
+void
+sim_tick_idle(os_time_t ticks)
+{
+    OS_ASSERT_CRITICAL();
+
+#if MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+    sim_tick_virtual(ticks);
+    return;
+#endif
+
+    /*
+     * The tick thread runs continuously, so there is no tickless regime;
+     * just wait for the next tick.
+     */
+    pthread_mutex_lock(&sim_lock);
+    while (!__atomic_load_n(&tick_pending, __ATOMIC_ACQUIRE)) {
+        pthread_cond_wait(&sim_idle_cond, &sim_lock);
+    }
+    pthread_mutex_unlock(&sim_lock);
+
+    sim_tick_service();
+}
+
+os_stack_t *
+sim_task_stack_init(struct os_task *t, os_stack_t *stack_top, int size)
+{
+    struct stack_frame *sf;
+    char name[16];
+    int rc;
+
+    sf = (struct stack_frame *) ((uint8_t *) stack_top - sizeof(*sf));
+    sf->sf_task = t;
+
+    rc = pthread_cond_init(&sf->sf_cond, NULL);
+    assert(rc == 0);
+
+    rc = pthread_create(&sf->sf_thread, NULL, sim_task_thread_main, sf);
+    assert(rc == 0);
+
+#ifdef MN_LINUX
+    /* Linux limits thread names to 15 characters. */
+    strncpy(name, t->t_name, sizeof(name) - 1);
+    name[sizeof(name) - 1] = '\0';
+    pthread_setname_np(sf->sf_thread, name);
+#else
+    (void)name;
+#endif
+
+    return ((os_stack_t *)sf);
+}
+
+os_error_t
+sim_os_start(void)
+{
+    struct stack_frame *sf;
+    struct os_task *t;
+    os_sr_t sr;
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+    int rc;
+#endif
+
+    /*
+     * Disable interrupts before enabling any interrupt sources. Pending
+     * interrupts will be recognized when the first task starts executing.
+     */
+    OS_ENTER_CRITICAL(sr);
+    assert(sr == 0);
+
+#if !MYNEWT_VAL(MCU_NATIVE_VIRTUAL_TIME)
+    /* Enable the interrupt sources */
+    rc = pthread_create(&sim_tick_thread, NULL, sim_tick_thread_main, NULL);
+    assert(rc == 0);
+    sim_tick_thread_started = 1;
+#endif
+
+    pthread_mutex_lock(&sim_lock);
+
+    t = os_sched_next_task();
+    os_sched_set_current_task(t);
+
+    g_os_started = 1;
+
+    sf = (struct stack_frame *) t->t_stackptr;
+    pthread_cond_signal(&sf->sf_cond);
+
+    /* The main thread has no task; it never runs again. */
+    while (1) {
+        pthread_cond_wait(&sim_main_cond, &sim_lock);
+    }
+
+    return 0;
+}
+
+void
+sim_signals_init(void)
+{
+    tick_pending = 0;
+}
+
+void
+sim_signals_cleanup(void)
+{
+    if (sim_tick_thread_started) {
+        pthread_cancel(sim_tick_thread);
+        pthread_join(sim_tick_thread, NULL);
+        sim_tick_thread_started = 0;
+    }
+}
+
+#endif /* MYNEWT_VAL(MCU_NATIVE_USE_PTHREADS) */
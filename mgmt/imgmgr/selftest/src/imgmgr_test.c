@@ -0,0 +1,211 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "flash_map/flash_map.h"
+#include "bootutil/image.h"
+#include "cborattr/cborattr.h"
+#include "tinycbor/cbor.h"
+#include "tinycbor/cbor_mbuf_writer.h"
+#include "newtmgr/newtmgr.h"
+#include "mbedtls/sha256.h"
+#include "imgmgr_test.h"
+
+uint8_t imgmgr_test_img[IMGMGR_TEST_IMG_SIZE];
+uint8_t imgmgr_test_img_sha[32];
+
+int imgmgr_test_rsp_cnt;
+int imgmgr_test_rsp_rc;
+long long imgmgr_test_rsp_off;
+
+static struct nmgr_transport imgmgr_test_nt;
+
+static int
+imgmgr_test_out(struct nmgr_transport *nt, struct os_mbuf *m)
+{
+    struct nmgr_hdr hdr;
+    long long rc;
+    struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "rc",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rc,
+        },
+        [1] = {
+            .attribute = "off",
+            .type = CborAttrIntegerType,
+            .addr.integer = &imgmgr_test_rsp_off,
+        },
+        [2] = { 0 },
+    };
+
+    os_mbuf_copydata(m, 0, sizeof(hdr), &hdr);
+    rc = 0;
+    imgmgr_test_rsp_off = -1;
+    cbor_read_mbuf_attrs(m, sizeof(hdr), ntohs(hdr.nh_len), attrs);
+
+    imgmgr_test_rsp_rc = rc;
+    imgmgr_test_rsp_cnt++;
+
+    os_mbuf_free_chain(m);
+    return 0;
+}
+
+static uint16_t
+imgmgr_test_mtu(struct os_mbuf *m)
+{
+    return 256;
+}
+
+void
+imgmgr_test_init(void)
+{
+    struct image_header *hdr;
+    int rc;
+    int i;
+
+    rc = nmgr_transport_init(&imgmgr_test_nt, imgmgr_test_out,
+                             imgmgr_test_mtu);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    for (i = 0; i < IMGMGR_TEST_IMG_SIZE; i++) {
+        imgmgr_test_img[i] = i * 7 + 3;
+    }
+    hdr = (struct image_header *)imgmgr_test_img;
+    memset(hdr, 0, sizeof(*hdr));
+    hdr->ih_magic = IMAGE_MAGIC;
+    hdr->ih_hdr_size = sizeof(*hdr);
+    hdr->ih_img_size = IMGMGR_TEST_IMG_SIZE - sizeof(*hdr);
+
+    mbedtls_sha256(imgmgr_test_img, IMGMGR_TEST_IMG_SIZE,
+                   imgmgr_test_img_sha, 0);
+
+    imgmgr_test_rsp_cnt = 0;
+}
+
+/**
+ * Sends one chunk of the test image in an upload request.  The first chunk
+ * carries the image length and, if sha_len is nonzero, the image hash.
+ */
+void
+imgmgr_test_send_chunk(uint32_t off, const uint8_t *sha, int sha_len)
+{
+    struct cbor_mbuf_writer writer;
+    struct CborEncoder enc;
+    struct CborEncoder map;
+    struct nmgr_hdr hdr;
+    struct os_mbuf *m;
+    uint32_t len;
+    int rc;
+
+    m = os_msys_get_pkthdr(sizeof(hdr), 0);
+    TEST_ASSERT_FATAL(m != NULL);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.nh_op = NMGR_OP_WRITE;
+    hdr.nh_group = htons(MGMT_GROUP_ID_IMAGE);
+    hdr.nh_id = IMGMGR_NMGR_ID_UPLOAD;
+    rc = os_mbuf_append(m, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    len = IMGMGR_TEST_IMG_SIZE - off;
+    if (len > IMGMGR_TEST_CHUNK) {
+        len = IMGMGR_TEST_CHUNK;
+    }
+
+    cbor_mbuf_writer_init(&writer, m);
+    cbor_encoder_init(&enc, &writer.enc, 0);
+    rc = cbor_encoder_create_map(&enc, &map, CborIndefiniteLength);
+    rc |= cbor_encode_text_stringz(&map, "off");
+    rc |= cbor_encode_uint(&map, off);
+    rc |= cbor_encode_text_stringz(&map, "data");
+    rc |= cbor_encode_byte_string(&map, imgmgr_test_img + off, len);
+    if (off == 0) {
+        rc |= cbor_encode_text_stringz(&map, "len");
+        rc |= cbor_encode_uint(&map, IMGMGR_TEST_IMG_SIZE);
+        if (sha_len != 0) {
+            rc |= cbor_encode_text_stringz(&map, "sha");
+            rc |= cbor_encode_byte_string(&map, sha, sha_len);
+        }
+    }
+    rc |= cbor_encoder_close_container(&enc, &map);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    hdr.nh_len = htons(OS_MBUF_PKTLEN(m) - sizeof(hdr));
+    rc = os_mbuf_copyinto(m, 0, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = nmgr_rx_req(&imgmgr_test_nt, m);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Sleeps so that the upload writer task gets to run.
+ */
+void
+imgmgr_test_settle(void)
+{
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+}
+
+/**
+ * Checks a range of an image slot.  With a fill of 0 the range must match the
+ * test image; otherwise every byte must equal the fill value.
+ */
+void
+imgmgr_test_assert_area(int area_id, uint32_t off, uint32_t len,
+                        uint8_t fill)
+{
+    const struct flash_area *fa;
+    uint8_t buf[IMGMGR_TEST_CHUNK];
+    uint32_t i;
+    int rc;
+
+    TEST_ASSERT_FATAL(len <= sizeof(buf));
+
+    rc = flash_area_open(area_id, &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_read(fa, off, buf, len);
+    TEST_ASSERT_FATAL(rc == 0);
+    flash_area_close(fa);
+
+    for (i = 0; i < len; i++) {
+        if (fill != 0) {
+            TEST_ASSERT_FATAL(buf[i] == fill);
+        } else {
+            TEST_ASSERT_FATAL(buf[i] == imgmgr_test_img[off + i]);
+        }
+    }
+}
+
+TEST_CASE_DECL(imgmgr_test_upload_window)
+
+TEST_SUITE(imgmgr_test_all)
+{
+    imgmgr_test_upload_window();
+}
+
+int
+main(int argc, char **argv)
+{
+    imgmgr_test_all();
+    return tu_any_failed;
+}
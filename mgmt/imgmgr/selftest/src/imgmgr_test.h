@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _IMGMGR_TEST_H
+#define _IMGMGR_TEST_H
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "mgmt/mgmt.h"
+#include "imgmgr/imgmgr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IMGMGR_TEST_CHUNK       MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)
+#define IMGMGR_TEST_IMG_SIZE    (IMGMGR_TEST_CHUNK * 5)
+
+extern uint8_t imgmgr_test_img[IMGMGR_TEST_IMG_SIZE];
+extern uint8_t imgmgr_test_img_sha[32];
+
+/* Outcome of the most recent upload response. */
+extern int imgmgr_test_rsp_cnt;
+extern int imgmgr_test_rsp_rc;
+extern long long imgmgr_test_rsp_off;
+
+void imgmgr_test_init(void);
+void imgmgr_test_send_chunk(uint32_t off, const uint8_t *sha, int sha_len);
+void imgmgr_test_settle(void);
+void imgmgr_test_assert_area(int area_id, uint32_t off, uint32_t len,
+                             uint8_t fill);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IMGMGR_TEST_H */
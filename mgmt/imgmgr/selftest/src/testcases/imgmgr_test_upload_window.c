@@ -0,0 +1,115 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "imgmgr_test.h"
+
+static void
+imgmgr_test_upload_window_drain(void)
+{
+    int area_id;
+    int i;
+
+    area_id = imgmgr_find_best_area_id();
+    TEST_ASSERT_FATAL(area_id >= 0);
+
+    /* A full window is acknowledged before anything reaches flash. */
+    imgmgr_test_send_chunk(0, imgmgr_test_img_sha, 32);
+    TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == 1);
+    TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+    TEST_ASSERT(imgmgr_test_rsp_off == IMGMGR_TEST_CHUNK);
+
+    imgmgr_test_send_chunk(IMGMGR_TEST_CHUNK, NULL, 0);
+    TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == 2);
+    TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+    TEST_ASSERT(imgmgr_test_rsp_off == 2 * IMGMGR_TEST_CHUNK);
+
+    /* The slot is erased lazily, by the writer. */
+    imgmgr_test_assert_area(area_id, 0, IMGMGR_TEST_CHUNK, 0xff);
+
+    /* With every buffer queued, the next chunk waits for the writer. */
+    imgmgr_test_send_chunk(2 * IMGMGR_TEST_CHUNK, NULL, 0);
+    TEST_ASSERT(imgmgr_test_rsp_cnt == 2);
+
+    imgmgr_test_settle();
+    TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == 3);
+    TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+    TEST_ASSERT(imgmgr_test_rsp_off == 3 * IMGMGR_TEST_CHUNK);
+    imgmgr_test_assert_area(area_id, 0, IMGMGR_TEST_CHUNK, 0);
+    imgmgr_test_assert_area(area_id, IMGMGR_TEST_CHUNK, IMGMGR_TEST_CHUNK, 0);
+
+    /* The final chunk is acknowledged once the whole image is in flash. */
+    imgmgr_test_send_chunk(3 * IMGMGR_TEST_CHUNK, NULL, 0);
+    imgmgr_test_send_chunk(4 * IMGMGR_TEST_CHUNK, NULL, 0);
+    imgmgr_test_settle();
+    TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == 5);
+    TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+    TEST_ASSERT(imgmgr_test_rsp_off == IMGMGR_TEST_IMG_SIZE);
+
+    for (i = 0; i < IMGMGR_TEST_IMG_SIZE; i += IMGMGR_TEST_CHUNK) {
+        imgmgr_test_assert_area(area_id, i, IMGMGR_TEST_CHUNK, 0);
+    }
+}
+
+static void
+imgmgr_test_upload_window_sha_mismatch(void)
+{
+    uint8_t sha[32];
+    uint32_t off;
+    int cnt;
+
+    memcpy(sha, imgmgr_test_img_sha, sizeof(sha));
+    sha[sizeof(sha) - 1] ^= 0x01;
+
+    cnt = imgmgr_test_rsp_cnt;
+    for (off = 0; off < IMGMGR_TEST_IMG_SIZE; off += IMGMGR_TEST_CHUNK) {
+        imgmgr_test_send_chunk(off, sha, sizeof(sha));
+        imgmgr_test_settle();
+        TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == ++cnt);
+        if (off + IMGMGR_TEST_CHUNK < IMGMGR_TEST_IMG_SIZE) {
+            TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+        }
+    }
+
+    /* The data was written, but the hash the client sent does not match. */
+    TEST_ASSERT(imgmgr_test_rsp_rc == MGMT_ERR_ECORRUPT);
+
+    /* The upload is over; a new one starts from the beginning. */
+    imgmgr_test_send_chunk(0, imgmgr_test_img_sha, 32);
+    TEST_ASSERT_FATAL(imgmgr_test_rsp_cnt == cnt + 1);
+    TEST_ASSERT(imgmgr_test_rsp_rc == 0);
+    TEST_ASSERT(imgmgr_test_rsp_off == IMGMGR_TEST_CHUNK);
+    imgmgr_test_settle();
+}
+
+/**
+ * Upload chunks are acknowledged as soon as they are buffered, the last chunk
+ * only after the writer has drained every buffer, and a hash mismatch is
+ * reported on the last chunk.
+ */
+TEST_CASE_TASK(imgmgr_test_upload_window)
+{
+    int msys_free;
+
+    imgmgr_test_init();
+    msys_free = os_msys_num_free();
+
+    imgmgr_test_upload_window_drain();
+    imgmgr_test_upload_window_sha_mismatch();
+
+    TEST_ASSERT(os_msys_num_free() == msys_free);
+}
@@ -31,6 +31,12 @@
 #if MYNEWT_VAL(LOG_FCB_SLOT1)
 #include "log/log_fcb_slot1.h"
 #endif
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+#include "mbedtls/sha256.h"
+#endif
+#if MYNEWT_VAL(IMGMGR_DELTA)
+#include "bootutil/delta.h"
+#endif
 
 #include "imgmgr/imgmgr.h"
 #include "imgmgr_priv.h"
@@ -68,6 +74,12 @@ struct imgr_upload_action {
 
     /** Whether to erase the destination flash area. */
     bool erase;
+
+    /** Whether the upload is a delta image. */
+    bool delta;
+
+    /** The number of bytes the upload occupies in flash. */
+    uint32_t flash_size;
 };
 
 static const struct mgmt_handler imgr_nmgr_handlers[] = {
@@ -114,6 +126,8 @@ static struct mgmt_group imgr_nmgr_group = {
     .mg_handlers = (struct mgmt_handler *)imgr_nmgr_handlers,
     .mg_handlers_count = IMGR_HANDLER_CNT,
     .mg_group_id = MGMT_GROUP_ID_IMAGE,
+    /* Erase and upload touch flash; keep them off the mgmt event queue. */
+    .mg_max_inflight = 1,
 };
 
 /** Global state for upload in progress. */
@@ -130,13 +144,86 @@ static struct {
     /** Hash of image data; used for resumption of a partial upload. */
     uint8_t data_sha_len;
     uint8_t data_sha[IMGMGR_DATA_SHA_LEN];
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE) || MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
     int sector_id;
     uint32_t sector_end;
 #endif
+#if MYNEWT_VAL(IMGMGR_DELTA)
+    /** Set if the upload is a delta against the image in slot 0. */
+    bool delta;
+#endif
 
 } imgr_state;
 
+#if MYNEWT_VAL(IMGMGR_DELTA)
+
+/** Size of the buffer that aligns delta output to flash writes. */
+#define IMGR_DELTA_BUF_SZ   64
+
+/** Expands a delta upload into the upload slot. */
+static struct {
+    struct boot_delta dec;
+
+    /** The slot being written. */
+    const struct flash_area *fa;
+
+    /** Offset within the slot of buf[0]. */
+    uint32_t off;
+
+    uint8_t buf[IMGR_DELTA_BUF_SZ];
+    uint8_t buf_len;
+
+    /** Only accept an expanded image newer than the running one. */
+    bool upgrade;
+
+    const char *errstr;
+} imgr_delta;
+#endif
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+#define IMGR_WBUF_CNT   MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+/** An upload chunk waiting to be written to flash. */
+struct imgr_wbuf {
+    struct os_event iw_ev;
+    uint32_t iw_off;
+    uint32_t iw_len;
+    uint8_t iw_data[MYNEWT_VAL(IMGMGR_MAX_CHUNK_SIZE)];
+};
+
+/** Background writer for windowed uploads. */
+static struct {
+    struct os_task task;
+    struct os_eventq evq;
+
+    /** Held by the writer while it accesses flash or the fields below. */
+    struct os_mutex lock;
+
+    /** Counts buffers that are not queued for writing. */
+    struct os_sem free_sem;
+
+    /** Next buffer to fill; buffers are written in the order they fill. */
+    uint8_t next;
+
+    /** Nonzero if a write or erase failed; the upload must be restarted. */
+    int rc;
+    const char *errstr;
+
+    /** Area offset up to which sectors may be erased before written. */
+    uint32_t ahead_end;
+
+    /** Hash of the image data written so far. */
+    mbedtls_sha256_context sha;
+
+    struct imgr_wbuf bufs[IMGR_WBUF_CNT];
+} imgr_wr;
+
+static os_stack_t imgr_wr_stack[OS_STACK_ALIGN(MYNEWT_VAL(IMGMGR_UPLOAD_STACK_SIZE))];
+
+static void imgr_upload_drain(void);
+#endif
+
 static imgr_upload_fn *imgr_upload_cb;
 static void *imgr_upload_arg;
 
@@ -149,6 +236,9 @@ static const char *imgmgr_err_str_flash_open_failed = "fa open fail";
 static const char *imgmgr_err_str_flash_erase_failed = "fa erase fail";
 static const char *imgmgr_err_str_flash_write_failed = "fa write fail";
 static const char *imgmgr_err_str_downgrade = "downgrade";
+static const char *imgmgr_err_str_sha_mismatch = "sha mismatch";
+static const char *imgmgr_err_str_delta_base = "delta base mismatch";
+static const char *imgmgr_err_str_delta_corrupt = "delta corrupt";
 #else
 #define imgmgr_err_str_app_reject                   NULL
 #define imgmgr_err_str_hdr_malformed                NULL
@@ -158,6 +248,9 @@ static const char *imgmgr_err_str_downgrade = "downgrade";
 #define imgmgr_err_str_flash_erase_failed           NULL
 #define imgmgr_err_str_flash_write_failed           NULL
 #define imgmgr_err_str_downgrade                    NULL
+#define imgmgr_err_str_sha_mismatch                 NULL
+#define imgmgr_err_str_delta_base                   NULL
+#define imgmgr_err_str_delta_corrupt                NULL
 #endif
 
 #if MYNEWT_VAL(BOOTUTIL_IMAGE_FORMAT_V2)
@@ -447,6 +540,10 @@ imgr_erase(struct mgmt_cbuf *cb)
     int rc;
     CborError g_err = CborNoError;
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    imgr_upload_drain();
+#endif
+
     area_id = imgmgr_find_best_area_id();
     if (area_id >= 0) {
 #if MYNEWT_VAL(LOG_FCB_SLOT1)
@@ -498,6 +595,10 @@ imgr_erase_state(struct mgmt_cbuf *cb)
     int rc;
     CborError g_err = CborNoError;
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    imgr_upload_drain();
+#endif
+
     area_id = imgmgr_find_best_area_id();
     if (area_id >= 0) {
         rc = flash_area_open(area_id, &fa);
@@ -537,7 +638,33 @@ imgr_erase_state(struct mgmt_cbuf *cb)
     return 0;
 }
 
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE) || MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+/**
+ * Erases the sector following the last one erased for the upload in progress.
+ *
+ * @param fa       Flash area being traversed
+ *
+ * @return         0 if success
+ *                 ERROR_CODE if could not erase sector
+ */
+static int
+imgr_erase_next_sector(const struct flash_area *fa)
+{
+    struct flash_area sector;
+    int rc;
+
+    rc = flash_area_getnext_sector(fa->fa_id, &imgr_state.sector_id, &sector);
+    if (rc) {
+        return rc;
+    }
+    rc = flash_area_erase(&sector, 0, sector.fa_size);
+    if (rc) {
+        return rc;
+    }
+    imgr_state.sector_end = sector.fa_off + sector.fa_size;
+    return 0;
+}
 
 /**
  * Erases a flash sector as image upload crosses a sector boundary.
@@ -557,24 +684,463 @@ imgr_erase_state(struct mgmt_cbuf *cb)
 int
 imgr_erase_if_needed(const struct flash_area *fa, uint32_t off, uint32_t len)
 {
-    int rc = 0;
-    struct flash_area sector;
+    int rc;
 
     while ((fa->fa_off + off + len) > imgr_state.sector_end) {
-        rc = flash_area_getnext_sector(fa->fa_id, &imgr_state.sector_id, &sector);
+        rc = imgr_erase_next_sector(fa);
         if (rc) {
             return rc;
         }
-        rc = flash_area_erase(&sector, 0, sector.fa_size);
-        if (rc) {
-            return rc;
+    }
+    return 0;
+}
+#endif
+
+/**
+ * Writes image data to the upload slot, erasing sectors first if they are
+ * erased lazily.
+ */
+static int
+imgr_flash_write(const struct flash_area *fa, uint32_t off, const void *data,
+                 uint32_t len, const char **errstr)
+{
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE) || MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    /* erase as we cross sector boundaries */
+    if (imgr_erase_if_needed(fa, off, len) != 0) {
+        *errstr = imgmgr_err_str_flash_erase_failed;
+        return MGMT_ERR_EUNKNOWN;
+    }
+#endif
+
+    if (flash_area_write(fa, off, data, len) != 0) {
+        *errstr = imgmgr_err_str_flash_write_failed;
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    return 0;
+}
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+
+/**
+ * Checks whether the first chunk of an upload starts a delta image, and if
+ * so, that the delta was made against the image in slot 0.
+ */
+static int
+imgr_delta_inspect(const struct imgr_upload_req *req,
+                   struct imgr_upload_action *action, const char **errstr)
+{
+    const struct image_delta_hdr *dhdr;
+    uint8_t hash[IMGMGR_HASH_LEN];
+
+    dhdr = (const struct image_delta_hdr *)req->img_data;
+    if (req->data_len < sizeof *dhdr ||
+        dhdr->idh_magic != IMAGE_DELTA_MAGIC) {
+
+        return 0;
+    }
+
+    if (imgr_read_info(0, NULL, hash, NULL) != 0 ||
+        memcmp(hash, dhdr->idh_src_hash, sizeof hash) != 0) {
+
+        *errstr = imgmgr_err_str_delta_base;
+        return MGMT_ERR_EBADSTATE;
+    }
+
+    action->delta = true;
+    action->flash_size = dhdr->idh_dst_size;
+    return 0;
+}
+
+/**
+ * Receives the expanded image from the delta decoder and writes it in
+ * blocks that respect the flash write alignment.
+ */
+static int
+imgr_delta_write(const void *data, uint32_t len, void *arg)
+{
+    const uint8_t *u8p;
+    uint32_t chunk;
+    int rc;
+
+    u8p = data;
+    while (len > 0) {
+        chunk = sizeof imgr_delta.buf - imgr_delta.buf_len;
+        if (chunk > len) {
+            chunk = len;
+        }
+        memcpy(imgr_delta.buf + imgr_delta.buf_len, u8p, chunk);
+        imgr_delta.buf_len += chunk;
+        u8p += chunk;
+        len -= chunk;
+
+        if (imgr_delta.buf_len == sizeof imgr_delta.buf) {
+            rc = imgr_flash_write(imgr_delta.fa, imgr_delta.off,
+                                  imgr_delta.buf, sizeof imgr_delta.buf,
+                                  &imgr_delta.errstr);
+            if (rc != 0) {
+                return rc;
+            }
+            imgr_delta.off += sizeof imgr_delta.buf;
+            imgr_delta.buf_len = 0;
         }
-        imgr_state.sector_end = sector.fa_off + sector.fa_size;
     }
+
     return 0;
 }
+
+/**
+ * Writes the end of the expanded image, padded to the flash write alignment.
+ */
+static int
+imgr_delta_flush(void)
+{
+    uint32_t len;
+    uint8_t align;
+
+    if (imgr_delta.buf_len == 0) {
+        return 0;
+    }
+
+    align = flash_area_align(imgr_delta.fa);
+    len = (imgr_delta.buf_len + align - 1) / align * align;
+    memset(imgr_delta.buf + imgr_delta.buf_len,
+           flash_area_erased_val(imgr_delta.fa), len - imgr_delta.buf_len);
+
+    return imgr_flash_write(imgr_delta.fa, imgr_delta.off, imgr_delta.buf,
+                            len, &imgr_delta.errstr);
+}
+
+static int
+imgr_delta_start(const struct flash_area *fa,
+                 const struct imgr_upload_req *req, const char **errstr)
+{
+    const struct image_delta_hdr *dhdr;
+    const struct flash_area *src;
+    int rc;
+
+    dhdr = (const struct image_delta_hdr *)req->img_data;
+
+    rc = flash_area_open(flash_area_id_from_image_slot(0), &src);
+    if (rc != 0) {
+        *errstr = imgmgr_err_str_flash_open_failed;
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    rc = boot_delta_init(&imgr_delta.dec, dhdr, src, imgr_delta_write, NULL);
+    if (rc != 0) {
+        *errstr = imgmgr_err_str_delta_corrupt;
+        return MGMT_ERR_EINVAL;
+    }
+
+    imgr_delta.off = 0;
+    imgr_delta.buf_len = 0;
+    imgr_delta.upgrade = req->upgrade;
+    return 0;
+}
+
+/**
+ * For an upgrade-only delta upload, checks that the expanded image is newer
+ * than the running one.  If it is not, the expanded header is erased so the
+ * image cannot be marked for boot.
+ */
+static int
+imgr_delta_check_version(void)
+{
+    struct image_header hdr;
+    struct image_version cur_ver;
+    int rc;
+
+    if (!imgr_delta.upgrade) {
+        return 0;
+    }
+
+    rc = imgr_my_version(&cur_ver);
+    if (rc == 0) {
+        rc = flash_area_read(imgr_delta.fa, 0, &hdr, sizeof hdr);
+    }
+    if (rc != 0) {
+        return MGMT_ERR_EUNKNOWN;
+    }
+
+    if (hdr.ih_magic == IMAGE_MAGIC &&
+        imgr_vercmp(&cur_ver, &hdr.ih_ver) < 0) {
+
+        return 0;
+    }
+
+    flash_area_erase(imgr_delta.fa, 0, sizeof hdr);
+    imgr_delta.errstr = imgmgr_err_str_downgrade;
+    return MGMT_ERR_EBADSTATE;
+}
 #endif
 
+/**
+ * Writes received upload data to the upload slot, expanding it first if the
+ * upload is a delta image.
+ *
+ * @param fa            The upload slot.
+ * @param off           Offset of the data within the upload.
+ * @param data          The data to write.
+ * @param len           The number of bytes to write.
+ * @param errstr        On failure, points to the reason.
+ *
+ * @return              0 on success; MGMT_ERR code on failure.
+ */
+static int
+imgr_upload_write(const struct flash_area *fa, uint32_t off, const void *data,
+                  uint32_t len, const char **errstr)
+{
+#if MYNEWT_VAL(IMGMGR_DELTA)
+    int rc;
+
+    if (imgr_state.delta) {
+        imgr_delta.fa = fa;
+        imgr_delta.errstr = imgmgr_err_str_delta_corrupt;
+
+        rc = boot_delta_feed(&imgr_delta.dec, data, len);
+        if (rc == 0 && off + len == imgr_state.size) {
+            rc = boot_delta_finish(&imgr_delta.dec);
+            if (rc == 0) {
+                rc = imgr_delta_flush();
+            }
+            if (rc == 0) {
+                rc = imgr_delta_check_version();
+                if (rc != 0) {
+                    *errstr = imgr_delta.errstr;
+                    return rc;
+                }
+            }
+        }
+        if (rc != 0) {
+            *errstr = imgr_delta.errstr;
+            return MGMT_ERR_EUNKNOWN;
+        }
+        return 0;
+    }
+#endif
+
+    return imgr_flash_write(fa, off, data, len, errstr);
+}
+
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+
+static void
+imgr_wr_write(struct os_event *ev)
+{
+    const struct flash_area *fa;
+    struct imgr_wbuf *wb;
+    int rc;
+
+    wb = ev->ev_arg;
+
+    os_mutex_pend(&imgr_wr.lock, OS_TIMEOUT_NEVER);
+
+    /* After a failure, drop the remaining chunks of the upload. */
+    if (imgr_wr.rc == 0) {
+        rc = flash_area_open(imgr_state.area_id, &fa);
+        if (rc != 0) {
+            imgr_wr.errstr = imgmgr_err_str_flash_open_failed;
+        } else {
+            rc = imgr_upload_write(fa, wb->iw_off, wb->iw_data, wb->iw_len,
+                                   &imgr_wr.errstr);
+            flash_area_close(fa);
+        }
+
+        if (rc == 0) {
+            mbedtls_sha256_update(&imgr_wr.sha, wb->iw_data, wb->iw_len);
+        } else {
+            imgr_wr.rc = rc;
+        }
+    }
+
+    os_mutex_release(&imgr_wr.lock);
+    os_sem_release(&imgr_wr.free_sem);
+}
+
+/**
+ * Erases the next sector of the upload in progress if it starts before the
+ * erase-ahead limit, so that later writes do not have to wait for it.
+ *
+ * @return         true if a sector was erased; false if there was nothing to
+ *                 do.
+ */
+static bool
+imgr_wr_erase_ahead(void)
+{
+    const struct flash_area *fa;
+    bool erased;
+
+    erased = false;
+
+    os_mutex_pend(&imgr_wr.lock, OS_TIMEOUT_NEVER);
+
+    if (imgr_wr.rc == 0 && imgr_wr.ahead_end != 0 &&
+        flash_area_open(imgr_state.area_id, &fa) == 0) {
+
+        if (fa->fa_off + imgr_wr.ahead_end > imgr_state.sector_end) {
+            imgr_wr.rc = imgr_erase_next_sector(fa);
+            if (imgr_wr.rc != 0) {
+                imgr_wr.errstr = imgmgr_err_str_flash_erase_failed;
+            } else {
+                erased = true;
+            }
+        }
+        flash_area_close(fa);
+    }
+
+    os_mutex_release(&imgr_wr.lock);
+
+    return erased;
+}
+
+static void
+imgr_wr_main(void *arg)
+{
+    struct os_event *ev;
+
+    while (1) {
+        /* Erase ahead only while there is nothing to write. */
+        ev = os_eventq_get_no_wait(&imgr_wr.evq);
+        if (ev == NULL && !imgr_wr_erase_ahead()) {
+            ev = os_eventq_get(&imgr_wr.evq);
+        }
+        if (ev != NULL) {
+            ev->ev_cb(ev);
+        }
+    }
+}
+
+/**
+ * Waits until all queued chunks have been written and stops erasing ahead.
+ * The upload state may be modified once this returns.
+ */
+static void
+imgr_upload_drain(void)
+{
+    int i;
+
+    for (i = 0; i < IMGR_WBUF_CNT; i++) {
+        os_sem_pend(&imgr_wr.free_sem, OS_TIMEOUT_NEVER);
+    }
+
+    os_mutex_pend(&imgr_wr.lock, OS_TIMEOUT_NEVER);
+    imgr_wr.ahead_end = 0;
+    os_mutex_release(&imgr_wr.lock);
+
+    for (i = 0; i < IMGR_WBUF_CNT; i++) {
+        os_sem_release(&imgr_wr.free_sem);
+    }
+}
+
+/**
+ * Abandons the upload in progress after the writer failed.
+ */
+static int
+imgr_upload_abort(const char **errstr)
+{
+    imgr_upload_drain();
+
+    *errstr = imgr_wr.errstr;
+    imgr_wr.rc = 0;
+    imgr_state.area_id = -1;
+    imgmgr_dfu_stopped();
+
+    return MGMT_ERR_EUNKNOWN;
+}
+
+/**
+ * Hands a chunk to the writer and advances the upload offset.  Blocks while
+ * all buffers are in use.  The final chunk is not acknowledged until the whole
+ * image is in flash and its hash has been checked.
+ */
+static int
+imgr_upload_queue(const struct imgr_upload_req *req, int write_bytes,
+                  const char **errstr)
+{
+    uint8_t hash[IMGMGR_HASH_LEN];
+    struct imgr_wbuf *wb;
+    uint32_t ahead_end;
+
+    os_sem_pend(&imgr_wr.free_sem, OS_TIMEOUT_NEVER);
+
+    if (imgr_wr.rc != 0) {
+        os_sem_release(&imgr_wr.free_sem);
+        return imgr_upload_abort(errstr);
+    }
+
+    wb = &imgr_wr.bufs[imgr_wr.next];
+    imgr_wr.next = (imgr_wr.next + 1) % IMGR_WBUF_CNT;
+
+    wb->iw_off = req->off;
+    wb->iw_len = write_bytes;
+    memcpy(wb->iw_data, req->img_data, write_bytes);
+
+    ahead_end = req->off + write_bytes + MYNEWT_VAL(IMGMGR_UPLOAD_ERASE_AHEAD);
+    if (ahead_end > imgr_state.size) {
+        ahead_end = imgr_state.size;
+    }
+    imgr_wr.ahead_end = ahead_end;
+
+    os_eventq_put(&imgr_wr.evq, &wb->iw_ev);
+
+    imgr_state.off += write_bytes;
+    if (imgr_state.off != imgr_state.size) {
+        return 0;
+    }
+
+    /* Last chunk; report the outcome of the whole upload. */
+    imgr_upload_drain();
+    if (imgr_wr.rc != 0) {
+        return imgr_upload_abort(errstr);
+    }
+
+    imgr_state.area_id = -1;
+
+    mbedtls_sha256_finish(&imgr_wr.sha, hash);
+    if (imgr_state.data_sha_len == sizeof hash &&
+        memcmp(imgr_state.data_sha, hash, sizeof hash) != 0) {
+
+        imgmgr_dfu_stopped();
+        *errstr = imgmgr_err_str_sha_mismatch;
+        return MGMT_ERR_ECORRUPT;
+    }
+
+    imgmgr_dfu_pending();
+    return 0;
+}
+
+static void
+imgr_upload_init(void)
+{
+    struct imgr_wbuf *wb;
+    int rc;
+    int i;
+
+    for (i = 0; i < IMGR_WBUF_CNT; i++) {
+        wb = &imgr_wr.bufs[i];
+        wb->iw_ev.ev_cb = imgr_wr_write;
+        wb->iw_ev.ev_arg = wb;
+    }
+
+    rc = os_sem_init(&imgr_wr.free_sem, IMGR_WBUF_CNT);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    rc = os_mutex_init(&imgr_wr.lock);
+    SYSINIT_PANIC_ASSERT(rc == 0);
+
+    mbedtls_sha256_init(&imgr_wr.sha);
+
+    os_eventq_init(&imgr_wr.evq);
+    rc = os_task_init(&imgr_wr.task, "imgr_wr", imgr_wr_main, NULL,
+                      MYNEWT_VAL(IMGMGR_UPLOAD_PRIO), OS_WAIT_FOREVER,
+                      imgr_wr_stack,
+                      MYNEWT_VAL(IMGMGR_UPLOAD_STACK_SIZE));
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif /* MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW) */
+
 /**
  * Verifies an upload request and indicates the actions that should be taken
  * during processing of the request.  This is a "read only" function in the
@@ -624,9 +1190,16 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
             return MGMT_ERR_EINVAL;
         }
         action->size = req->size;
+        action->flash_size = req->size;
 
         hdr = (struct image_header *)req->img_data;
-        if (hdr->ih_magic != IMAGE_MAGIC) {
+#if MYNEWT_VAL(IMGMGR_DELTA)
+        rc = imgr_delta_inspect(req, action, errstr);
+        if (rc != 0) {
+            return rc;
+        }
+#endif
+        if (!action->delta && hdr->ih_magic != IMAGE_MAGIC) {
             *errstr = imgmgr_err_str_magic_mismatch;
             return MGMT_ERR_EINVAL;
         }
@@ -656,9 +1229,11 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
             return MGMT_ERR_ENOMEM;
         }
 
-        if (req->upgrade) {
+        if (req->upgrade && !action->delta) {
             /* User specified upgrade-only.  Make sure new image version is
-             * greater than that of the currently running image.
+             * greater than that of the currently running image.  The version
+             * of a delta image is not known until it has been expanded; it is
+             * checked once the last chunk has been received.
              */
             rc = imgr_my_version(&cur_ver);
             if (rc != 0) {
@@ -671,15 +1246,30 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
             }
         }
 
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
-        (void) empty;
-#else
         rc = flash_area_open(action->area_id, &fa);
         if (rc) {
             *errstr = imgmgr_err_str_flash_open_failed;
             return MGMT_ERR_EUNKNOWN;
         }
 
+        /* Reject an image that does not fit before erasing anything. */
+        if (action->flash_size > fa->fa_size) {
+            flash_area_close(fa);
+            *errstr = imgmgr_err_str_no_slot;
+            return MGMT_ERR_EINVAL;
+        }
+#if MYNEWT_VAL(IMGMGR_DELTA)
+        if (action->delta && flash_area_align(fa) > IMGR_DELTA_BUF_SZ) {
+            flash_area_close(fa);
+            *errstr = imgmgr_err_str_no_slot;
+            return MGMT_ERR_EINVAL;
+        }
+#endif
+
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE) || MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+        (void) empty;
+        flash_area_close(fa);
+#else
         rc = flash_area_is_empty(fa, &empty);
         flash_area_close(fa);
         if (rc) {
@@ -692,6 +1282,9 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
         /* Continuation of upload. */
         action->area_id = imgr_state.area_id;
         action->size = imgr_state.size;
+#if MYNEWT_VAL(IMGMGR_DELTA)
+        action->delta = imgr_state.delta;
+#endif
 
         if (req->off != imgr_state.off) {
             /*
@@ -704,9 +1297,10 @@ imgr_upload_inspect(const struct imgr_upload_req *req,
 
     /* Calculate size of flash write. */
     action->write_bytes = req->data_len;
-    if (req->off + req->data_len < action->size) {
+    if (req->off + req->data_len < action->size && !action->delta) {
         /*
-         * Respect flash write alignment if not in the last block
+         * Respect flash write alignment if not in the last block.  Delta
+         * output is aligned as it is expanded.
          */
         rc = flash_area_open(action->area_id, &fa);
         if (rc) {
@@ -823,6 +1417,14 @@ imgr_upload(struct mgmt_cbuf *cb)
         }
     }
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    if (req.off == 0) {
+        /* Let the writer finish with any earlier upload first. */
+        imgr_upload_drain();
+        imgr_wr.rc = 0;
+    }
+#endif
+
     /* Remember flash area ID and image size for subsequent upload requests. */
     imgr_state.area_id = action.area_id;
     imgr_state.size = action.size;
@@ -862,37 +1464,43 @@ imgr_upload(struct mgmt_cbuf *cb)
         }
 #endif
 
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+        mbedtls_sha256_starts(&imgr_wr.sha, 0);
+#endif
+
+#if MYNEWT_VAL(IMGMGR_LAZY_ERASE) || MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
         /* setup for lazy sector by sector erase */
         imgr_state.sector_id = -1;
         imgr_state.sector_end = 0;
 #else
-        /* erase the entire req.size all at once */
+        /* erase the entire image all at once */
         if (action.erase) {
-            rc = flash_area_erase(fa, 0, req.size);
+            rc = flash_area_erase(fa, 0, action.flash_size);
             if (rc != 0) {
                 rc = MGMT_ERR_EUNKNOWN;
                 errstr = imgmgr_err_str_flash_erase_failed;
             }
         }
 #endif
+
+#if MYNEWT_VAL(IMGMGR_DELTA)
+        imgr_state.delta = action.delta;
+        if (rc == 0 && action.delta) {
+            rc = imgr_delta_start(fa, &req, &errstr);
+        }
+#endif
     }
 
     /* Write the image data to flash. */
     if (rc == 0 && req.data_len != 0) {
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
-        /* erase as we cross sector boundaries */
-        if (imgr_erase_if_needed(fa, req.off, action.write_bytes) != 0) {
-            rc = MGMT_ERR_EUNKNOWN;
-            errstr = imgmgr_err_str_flash_erase_failed;
-            goto end;
-        }
-#endif
-        rc = flash_area_write(fa, req.off, req.img_data, action.write_bytes);
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+        /* Queue the data; the writer task erases and writes it. */
+        rc = imgr_upload_queue(&req, action.write_bytes, &errstr);
+#else
+        rc = imgr_upload_write(fa, req.off, req.img_data, action.write_bytes,
+                               &errstr);
         if (rc != 0) {
             imgmgr_dfu_stopped();
-            rc = MGMT_ERR_EUNKNOWN;
-            errstr = imgmgr_err_str_flash_write_failed;
         } else {
             imgr_state.off += action.write_bytes;
             if (imgr_state.off == imgr_state.size) {
@@ -901,11 +1509,9 @@ imgr_upload(struct mgmt_cbuf *cb)
                 imgr_state.area_id = -1;
             }
         }
+#endif
     }
 
-#if MYNEWT_VAL(IMGMGR_LAZY_ERASE)
-end:
-#endif
     flash_area_close(fa);
 
     if (rc != 0) {
@@ -968,6 +1574,10 @@ imgmgr_module_init(void)
     /* Ensure this function only gets called by sysinit. */
     SYSINIT_ASSERT_ACTIVE();
 
+#if MYNEWT_VAL(IMGMGR_UPLOAD_WINDOW)
+    imgr_upload_init();
+#endif
+
     rc = mgmt_group_register(&imgr_nmgr_group);
     SYSINIT_PANIC_ASSERT(rc == 0);
 
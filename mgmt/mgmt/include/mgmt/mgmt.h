@@ -98,6 +98,20 @@ struct mgmt_group {
     const struct mgmt_handler *mg_handlers;
     uint16_t mg_handlers_count;
     uint16_t mg_group_id;
+
+    /**
+     * Maximum number of this group's requests that may execute concurrently
+     * on the newtmgr worker tasks (NEWTMGR_PIPELINE).  0 runs the group's
+     * handlers inline on the mgmt event queue.  Set this for groups with
+     * long-running handlers (flash erase, log dumps, file transfer) so they
+     * do not hold up other requests.  Handlers of a group with a limit above
+     * 1 must be reentrant.
+     */
+    uint8_t mg_max_inflight;
+
+    /** Number of requests currently executing; owned by newtmgr. */
+    uint8_t mg_inflight;
+
     STAILQ_ENTRY(mgmt_group) mg_next;
 };
 
@@ -108,6 +122,7 @@ struct mgmt_group {
 
 int mgmt_group_register(struct mgmt_group *group);
 int mgmt_cbuf_setoerr(struct mgmt_cbuf *njb, int errcode);
+struct mgmt_group *mgmt_find_group(uint16_t group_id);
 const struct mgmt_handler *mgmt_find_handler(uint16_t group_id,
   uint16_t handler_id);
 
@@ -86,7 +86,7 @@ err:
     return (rc);
 }
 
-static struct mgmt_group *
+struct mgmt_group *
 mgmt_find_group(uint16_t group_id)
 {
     struct mgmt_group *group;
@@ -0,0 +1,192 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "cborattr/cborattr.h"
+#include "newtmgr_test.h"
+
+uint8_t newtmgr_test_rsp_seq[NEWTMGR_TEST_MAX_RSPS];
+int newtmgr_test_rsp_rc[NEWTMGR_TEST_MAX_RSPS];
+int newtmgr_test_rsp_cnt;
+int newtmgr_test_started;
+
+static struct nmgr_transport newtmgr_test_nt;
+static struct os_sem newtmgr_test_sem;
+
+static int
+newtmgr_test_block(struct mgmt_cbuf *cb)
+{
+    newtmgr_test_started++;
+    os_sem_pend(&newtmgr_test_sem, OS_TIMEOUT_NEVER);
+    return 0;
+}
+
+static int
+newtmgr_test_nop(struct mgmt_cbuf *cb)
+{
+    return 0;
+}
+
+static const struct mgmt_handler newtmgr_test_block_handlers[] = {
+    [0] = { newtmgr_test_block, newtmgr_test_block },
+};
+
+static const struct mgmt_handler newtmgr_test_nop_handlers[] = {
+    [0] = { newtmgr_test_nop, newtmgr_test_nop },
+};
+
+struct mgmt_group newtmgr_test_slow_group = {
+    .mg_handlers = newtmgr_test_block_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = NEWTMGR_TEST_GROUP_SLOW,
+    .mg_max_inflight = 1,
+};
+
+struct mgmt_group newtmgr_test_wide_group = {
+    .mg_handlers = newtmgr_test_block_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = NEWTMGR_TEST_GROUP_WIDE,
+    .mg_max_inflight = 2,
+};
+
+static struct mgmt_group newtmgr_test_fast_group = {
+    .mg_handlers = newtmgr_test_nop_handlers,
+    .mg_handlers_count = 1,
+    .mg_group_id = NEWTMGR_TEST_GROUP_FAST,
+};
+
+static int
+newtmgr_test_out(struct nmgr_transport *nt, struct os_mbuf *m)
+{
+    struct nmgr_hdr hdr;
+    long long rc;
+    struct cbor_attr_t attrs[] = {
+        [0] = {
+            .attribute = "rc",
+            .type = CborAttrIntegerType,
+            .addr.integer = &rc,
+        },
+        [1] = { 0 },
+    };
+    int idx;
+
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt < NEWTMGR_TEST_MAX_RSPS);
+
+    os_mbuf_copydata(m, 0, sizeof(hdr), &hdr);
+    rc = 0;
+    cbor_read_mbuf_attrs(m, sizeof(hdr), ntohs(hdr.nh_len), attrs);
+
+    idx = newtmgr_test_rsp_cnt++;
+    newtmgr_test_rsp_seq[idx] = hdr.nh_seq;
+    newtmgr_test_rsp_rc[idx] = rc;
+
+    os_mbuf_free_chain(m);
+    return 0;
+}
+
+static uint16_t
+newtmgr_test_mtu(struct os_mbuf *m)
+{
+    return 256;
+}
+
+void
+newtmgr_test_init(void)
+{
+    static int registered;
+    int rc;
+
+    /* The group list outlives sysinit; register only once. */
+    if (!registered) {
+        mgmt_group_register(&newtmgr_test_slow_group);
+        mgmt_group_register(&newtmgr_test_wide_group);
+        mgmt_group_register(&newtmgr_test_fast_group);
+        registered = 1;
+    }
+
+    rc = nmgr_transport_init(&newtmgr_test_nt, newtmgr_test_out,
+                             newtmgr_test_mtu);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = os_sem_init(&newtmgr_test_sem, 0);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    newtmgr_test_rsp_cnt = 0;
+    newtmgr_test_started = 0;
+}
+
+/**
+ * Sends a request with an empty payload.  The mgmt task has a higher
+ * priority than the test task, so by the time this returns the request has
+ * been executed inline or queued for a worker.
+ */
+void
+newtmgr_test_send(uint16_t group, uint8_t seq)
+{
+    struct nmgr_hdr hdr;
+    struct os_mbuf *m;
+    int rc;
+
+    m = os_msys_get_pkthdr(sizeof(hdr), 0);
+    TEST_ASSERT_FATAL(m != NULL);
+
+    memset(&hdr, 0, sizeof(hdr));
+    hdr.nh_op = NMGR_OP_READ;
+    hdr.nh_group = htons(group);
+    hdr.nh_seq = seq;
+    rc = os_mbuf_append(m, &hdr, sizeof(hdr));
+    TEST_ASSERT_FATAL(rc == 0);
+
+    rc = nmgr_rx_req(&newtmgr_test_nt, m);
+    TEST_ASSERT_FATAL(rc == 0);
+}
+
+/**
+ * Lets one blocked handler return.
+ */
+void
+newtmgr_test_release(void)
+{
+    os_sem_release(&newtmgr_test_sem);
+    newtmgr_test_settle();
+}
+
+/**
+ * Sleeps so that the lower priority worker tasks get to run.
+ */
+void
+newtmgr_test_settle(void)
+{
+    os_time_delay(OS_TICKS_PER_SEC / 10);
+}
+
+TEST_CASE_DECL(newtmgr_test_pipeline)
+
+TEST_SUITE(newtmgr_test_all)
+{
+    newtmgr_test_pipeline();
+}
+
+int
+main(int argc, char **argv)
+{
+    newtmgr_test_all();
+    return tu_any_failed;
+}
@@ -0,0 +1,60 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _NEWTMGR_TEST_H
+#define _NEWTMGR_TEST_H
+
+#include <string.h>
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "mgmt/mgmt.h"
+#include "newtmgr/newtmgr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NEWTMGR_TEST_MAX_RSPS   32
+
+/* Groups whose handlers block until released; see newtmgr_test_release(). */
+#define NEWTMGR_TEST_GROUP_SLOW (MGMT_GROUP_ID_PERUSER)
+#define NEWTMGR_TEST_GROUP_WIDE (MGMT_GROUP_ID_PERUSER + 1)
+/* Inline group with a handler that returns immediately. */
+#define NEWTMGR_TEST_GROUP_FAST (MGMT_GROUP_ID_PERUSER + 2)
+
+extern struct mgmt_group newtmgr_test_slow_group;
+extern struct mgmt_group newtmgr_test_wide_group;
+
+/* Sequence numbers and rc values of the responses, in transmit order. */
+extern uint8_t newtmgr_test_rsp_seq[NEWTMGR_TEST_MAX_RSPS];
+extern int newtmgr_test_rsp_rc[NEWTMGR_TEST_MAX_RSPS];
+extern int newtmgr_test_rsp_cnt;
+
+/* Number of blocking handler invocations so far. */
+extern int newtmgr_test_started;
+
+void newtmgr_test_init(void);
+void newtmgr_test_send(uint16_t group, uint8_t seq);
+void newtmgr_test_release(void);
+void newtmgr_test_settle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _NEWTMGR_TEST_H */
@@ -0,0 +1,108 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "newtmgr_test.h"
+
+/**
+ * Deferred requests are dispatched oldest first within their group's
+ * in-flight limit, inline requests overtake them, retransmissions are
+ * dropped and a request that finds no free slot is rejected.
+ */
+TEST_CASE_TASK(newtmgr_test_pipeline)
+{
+    int msys_free;
+
+    newtmgr_test_init();
+    msys_free = os_msys_num_free();
+
+    /*** Group limit of 1: the second request waits for the first. */
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 1);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 2);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_FAST, 3);
+
+    /* The inline request is answered right away. */
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 1);
+    TEST_ASSERT(newtmgr_test_rsp_seq[0] == 3);
+
+    newtmgr_test_settle();
+    TEST_ASSERT(newtmgr_test_started == 1);
+    TEST_ASSERT(newtmgr_test_slow_group.mg_inflight == 1);
+
+    newtmgr_test_release();
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 2);
+    TEST_ASSERT(newtmgr_test_rsp_seq[1] == 1);
+    TEST_ASSERT(newtmgr_test_started == 2);
+    TEST_ASSERT(newtmgr_test_slow_group.mg_inflight == 1);
+
+    newtmgr_test_release();
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 3);
+    TEST_ASSERT(newtmgr_test_rsp_seq[2] == 2);
+    TEST_ASSERT(newtmgr_test_slow_group.mg_inflight == 0);
+
+    /*** Group limit of 2: both workers run at once. */
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_WIDE, 4);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_WIDE, 5);
+    newtmgr_test_settle();
+    TEST_ASSERT(newtmgr_test_started == 4);
+    TEST_ASSERT(newtmgr_test_wide_group.mg_inflight == 2);
+
+    newtmgr_test_release();
+    newtmgr_test_release();
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 5);
+    TEST_ASSERT(newtmgr_test_rsp_seq[3] + newtmgr_test_rsp_seq[4] == 4 + 5);
+    TEST_ASSERT(newtmgr_test_wide_group.mg_inflight == 0);
+
+    /*** Retransmissions of running and of queued requests are dropped. */
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 6);
+    newtmgr_test_settle();
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 6);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 7);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 7);
+    newtmgr_test_settle();
+    TEST_ASSERT(newtmgr_test_rsp_cnt == 5);
+    TEST_ASSERT(newtmgr_test_started == 5);
+
+    newtmgr_test_release();
+    newtmgr_test_release();
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 7);
+    TEST_ASSERT(newtmgr_test_rsp_seq[5] == 6);
+    TEST_ASSERT(newtmgr_test_rsp_seq[6] == 7);
+    TEST_ASSERT(newtmgr_test_started == 6);
+
+    /*** With all slots taken, a request is rejected. */
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 8);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 9);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 10);
+    newtmgr_test_send(NEWTMGR_TEST_GROUP_SLOW, 11);
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 8);
+    TEST_ASSERT(newtmgr_test_rsp_seq[7] == 11);
+    TEST_ASSERT(newtmgr_test_rsp_rc[7] == MGMT_ERR_EBADSTATE);
+
+    newtmgr_test_release();
+    newtmgr_test_release();
+    newtmgr_test_release();
+    TEST_ASSERT_FATAL(newtmgr_test_rsp_cnt == 11);
+    TEST_ASSERT(newtmgr_test_rsp_seq[8] == 8);
+    TEST_ASSERT(newtmgr_test_rsp_seq[9] == 9);
+    TEST_ASSERT(newtmgr_test_rsp_seq[10] == 10);
+    TEST_ASSERT(newtmgr_test_rsp_rc[10] == 0);
+    TEST_ASSERT(newtmgr_test_slow_group.mg_inflight == 0);
+
+    /* Every request and response mbuf has been released. */
+    TEST_ASSERT(os_msys_num_free() == msys_free);
+}
@@ -33,18 +33,102 @@
 #include "tinycbor/cbor_mbuf_writer.h"
 #include "tinycbor/cbor_mbuf_reader.h"
 
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+#include "stats/stats.h"
+#endif
+
 /* Shared queue that newtmgr uses for work items. */
 struct os_eventq *nmgr_evq;
 
 /*
  * cbor buffer for newtmgr
  */
-static struct nmgr_cbuf {
+struct nmgr_cbuf {
     struct mgmt_cbuf n_b;
     struct cbor_mbuf_writer writer;
     struct cbor_mbuf_reader reader;
     struct os_mbuf *n_out_m;
-} nmgr_task_cbuf;
+};
+
+static struct nmgr_cbuf nmgr_task_cbuf;
+
+/*
+ * State of a single request as it moves from reception (nmgr_req_start()),
+ * through execution of its handler (nmgr_req_exec()), to transmission of the
+ * response (nmgr_req_finish()).  Start and finish always run on the mgmt
+ * event queue; execution runs there too, or on a worker task if the request
+ * is deferred.
+ */
+struct nmgr_req {
+    struct nmgr_transport *nr_nt;
+    struct nmgr_cbuf *nr_cbuf;
+    struct os_mbuf *nr_req;
+    struct os_mbuf *nr_rsp;
+    struct nmgr_hdr *nr_rsp_hdr;
+    const struct mgmt_handler *nr_handler;
+    struct nmgr_hdr nr_hdr;
+    uint16_t nr_mtu;
+    uint8_t nr_norsp;
+    int nr_rc;
+};
+
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+
+STATS_SECT_START(nmgr_stats)
+    STATS_SECT_ENTRY(inline)
+    STATS_SECT_ENTRY(queued)
+    STATS_SECT_ENTRY(busy)
+    STATS_SECT_ENTRY(dup)
+    STATS_SECT_ENTRY(qwait_ms)
+    STATS_SECT_ENTRY(run_ms)
+STATS_SECT_END
+
+static STATS_SECT_DECL(nmgr_stats) nmgr_stats;
+
+STATS_NAME_START(nmgr_stats)
+    STATS_NAME(nmgr_stats, inline)
+    STATS_NAME(nmgr_stats, queued)
+    STATS_NAME(nmgr_stats, busy)
+    STATS_NAME(nmgr_stats, dup)
+    STATS_NAME(nmgr_stats, qwait_ms)
+    STATS_NAME(nmgr_stats, run_ms)
+STATS_NAME_END(nmgr_stats)
+
+struct nmgr_worker {
+    struct os_task nw_task;
+    struct os_eventq nw_evq;
+    uint8_t nw_busy;
+};
+
+/*
+ * A deferred request.  Slots sit on nmgr_slot_pending until a worker and
+ * their group's concurrency limit allow them to run, then on no list while
+ * executing, and return to nmgr_slot_free once the response has been sent.
+ */
+struct nmgr_slot {
+    STAILQ_ENTRY(nmgr_slot) ns_next;
+    struct nmgr_req ns_req;
+    struct nmgr_cbuf ns_cbuf;
+    struct mgmt_group *ns_group;
+    struct nmgr_worker *ns_worker;
+    struct os_event ns_run_ev;
+    struct os_event ns_done_ev;
+    os_time_t ns_queued;
+    os_time_t ns_started;
+    os_time_t ns_finished;
+};
+
+static struct nmgr_slot nmgr_slots[MYNEWT_VAL(NEWTMGR_PIPELINE_SLOTS)];
+static STAILQ_HEAD(, nmgr_slot) nmgr_slot_free =
+    STAILQ_HEAD_INITIALIZER(nmgr_slot_free);
+static STAILQ_HEAD(, nmgr_slot) nmgr_slot_pending =
+    STAILQ_HEAD_INITIALIZER(nmgr_slot_pending);
+
+static struct nmgr_worker nmgr_workers[MYNEWT_VAL(NEWTMGR_PIPELINE_WORKERS)];
+static os_stack_t nmgr_worker_stacks[MYNEWT_VAL(NEWTMGR_PIPELINE_WORKERS)]
+    [OS_STACK_ALIGN(MYNEWT_VAL(NEWTMGR_PIPELINE_STACK_SIZE))];
+
+#endif
 
 struct os_eventq *
 mgmt_evq_get(void)
@@ -65,8 +149,16 @@ nmgr_cbuf_init(struct nmgr_cbuf *njb)
     return (0);
 }
 
+static struct os_mbuf *nmgr_rsp_frag_alloc(uint16_t frag_size, void *arg);
+
+/**
+ * Writes the response header to the supplied mbuf and prepares the encoder.
+ * If frag_len is nonzero, the payload is encoded directly into a list of
+ * packets no longer than frag_len bytes, linked through their packet headers.
+ */
 static struct nmgr_hdr *
-nmgr_init_rsp(struct os_mbuf *m, struct nmgr_hdr *src)
+nmgr_init_rsp(struct nmgr_cbuf *cb, struct os_mbuf *m, struct nmgr_hdr *src,
+              uint16_t frag_len)
 {
     struct nmgr_hdr *hdr;
 
@@ -84,45 +176,49 @@ nmgr_init_rsp(struct os_mbuf *m, struct nmgr_hdr *src)
     hdr->nh_id = src->nh_id;
 
     /* setup state for cbor encoding */
-    cbor_mbuf_writer_init(&nmgr_task_cbuf.writer, m);
-    cbor_encoder_init(&nmgr_task_cbuf.n_b.encoder, &nmgr_task_cbuf.writer.enc, 0);
-    nmgr_task_cbuf.n_out_m = m;
+    if (frag_len != 0) {
+        cbor_mbuf_writer_init_frag(&cb->writer, m, frag_len,
+                                   nmgr_rsp_frag_alloc, m);
+    } else {
+        cbor_mbuf_writer_init(&cb->writer, m);
+    }
+    cbor_encoder_init(&cb->n_b.encoder, &cb->writer.enc, 0);
+    cb->n_out_m = m;
     return hdr;
 }
 
 static void
-nmgr_send_err_rsp(struct nmgr_transport *nt, struct os_mbuf *m,
-                  struct nmgr_hdr *hdr, int status)
+nmgr_send_err_rsp(struct nmgr_cbuf *cb, struct nmgr_transport *nt,
+                  struct os_mbuf *m, struct nmgr_hdr *hdr, int status)
 {
     struct CborEncoder map;
     int rc;
 
-    hdr = nmgr_init_rsp(m, hdr);
+    hdr = nmgr_init_rsp(cb, m, hdr, 0);
     if (!hdr) {
         os_mbuf_free_chain(m);
         return;
     }
 
-    rc = cbor_encoder_create_map(&nmgr_task_cbuf.n_b.encoder, &map,
+    rc = cbor_encoder_create_map(&cb->n_b.encoder, &map,
                                  CborIndefiniteLength);
     if (rc != 0) {
         return;
     }
 
-    rc = mgmt_cbuf_setoerr(&nmgr_task_cbuf.n_b, status);
+    rc = mgmt_cbuf_setoerr(&cb->n_b, status);
     if (rc != 0) {
         return;
     }
 
-    rc = cbor_encoder_close_container(&nmgr_task_cbuf.n_b.encoder, &map);
+    rc = cbor_encoder_close_container(&cb->n_b.encoder, &map);
     if (rc != 0) {
         return;
     }
 
-    hdr->nh_len =
-        htons(cbor_encode_bytes_written(&nmgr_task_cbuf.n_b.encoder));
+    hdr->nh_len = htons(cbor_encode_bytes_written(&cb->n_b.encoder));
 
-    nt->nt_output(nt, nmgr_task_cbuf.n_out_m);
+    nt->nt_output(nt, cb->n_out_m);
 }
 
 /**
@@ -150,7 +246,26 @@ nmgr_rsp_frag_alloc(uint16_t frag_size, void *arg)
 }
 
 /**
- * Sends a newtmgr response, fragmenting it as needed.  The supplied response
+ * Frees the response fragments which follow the first one.
+ */
+static void
+nmgr_free_frags(struct os_mbuf *rsp)
+{
+    struct os_mbuf *frag;
+    struct os_mbuf *next;
+
+    frag = cbor_mbuf_writer_next_frag(rsp);
+    while (frag != NULL) {
+        next = cbor_mbuf_writer_next_frag(frag);
+        os_mbuf_free_chain(frag);
+        frag = next;
+    }
+}
+
+/**
+ * Sends a newtmgr response, fragmenting it as needed.  The response is
+ * normally already split into MTU-sized packets by the encoder; any packet
+ * that is still too large gets split here.  The supplied response
  * mbuf is consumed on success and in some failure cases.  If the mbuf is
  * consumed, the supplied pointer is set to NULL.
  *
@@ -169,6 +284,10 @@ nmgr_rsp_tx(struct nmgr_transport *nt, struct os_mbuf **rsp, uint16_t mtu)
         if (frag == NULL) {
             return MGMT_ERR_ENOMEM;
         }
+        if (*rsp == NULL) {
+            /* Move on to the next packet produced by the encoder. */
+            *rsp = cbor_mbuf_writer_next_frag(frag);
+        }
 
         rc = nt->nt_output(nt, frag);
         if (rc != 0) {
@@ -180,85 +299,107 @@ nmgr_rsp_tx(struct nmgr_transport *nt, struct os_mbuf **rsp, uint16_t mtu)
     return MGMT_ERR_EOK;
 }
 
+/**
+ * Parses the header of a received request and prepares the response mbuf.
+ * On return, nr_norsp is set if no response can be sent, and nr_rc holds
+ * the error to report otherwise.
+ */
 static void
-nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
+nmgr_req_start(struct nmgr_req *nr, struct nmgr_transport *nt,
+               struct os_mbuf *req)
 {
-    struct os_mbuf *rsp;
-    const struct mgmt_handler *handler;
-    CborEncoder payload_enc;
-    struct nmgr_hdr *rsp_hdr;
-    struct nmgr_hdr hdr;
-    uint16_t mtu;
     int rc;
 
-    rsp_hdr = NULL;
+    memset(nr, 0, sizeof(*nr));
+    nr->nr_nt = nt;
+    nr->nr_cbuf = &nmgr_task_cbuf;
+    nr->nr_req = req;
 
-    rsp = os_msys_get_pkthdr(512, OS_MBUF_USRHDR_LEN(req));
-    if (!rsp) {
-        rc = os_mbuf_copydata(req, 0, sizeof(hdr), &hdr);
+    nr->nr_rsp = os_msys_get_pkthdr(512, OS_MBUF_USRHDR_LEN(req));
+    if (!nr->nr_rsp) {
+        rc = os_mbuf_copydata(req, 0, sizeof(nr->nr_hdr), &nr->nr_hdr);
         if (rc < 0) {
-            goto err_norsp;
+            nr->nr_norsp = 1;
+            return;
         }
-        rsp = req;
-        req = NULL;
-        goto err;
+        /* Reuse the request mbuf for the error response. */
+        nr->nr_rsp = req;
+        nr->nr_req = NULL;
+        nr->nr_rc = MGMT_ERR_ENOMEM;
+        return;
     }
 
-    mtu = nt->nt_get_mtu(req);
-    if (mtu == 0) {
+    nr->nr_mtu = nt->nt_get_mtu(req);
+    if (nr->nr_mtu == 0) {
         /* The transport cannot support a transmission right now. */
-        goto err_norsp;
+        nr->nr_norsp = 1;
+        return;
     }
 
     /* Copy the request user header into the response. */
-    memcpy(OS_MBUF_USRHDR(rsp), OS_MBUF_USRHDR(req), OS_MBUF_USRHDR_LEN(req));
+    memcpy(OS_MBUF_USRHDR(nr->nr_rsp), OS_MBUF_USRHDR(req),
+           OS_MBUF_USRHDR_LEN(req));
 
-    rc = os_mbuf_copydata(req, 0, sizeof(hdr), &hdr);
+    rc = os_mbuf_copydata(req, 0, sizeof(nr->nr_hdr), &nr->nr_hdr);
     if (rc < 0) {
-        rc = MGMT_ERR_EINVAL;
-        goto err_norsp;
+        nr->nr_norsp = 1;
+        return;
     }
 
-    hdr.nh_len = ntohs(hdr.nh_len);
+    nr->nr_hdr.nh_len = ntohs(nr->nr_hdr.nh_len);
 
-    handler = mgmt_find_handler(ntohs(hdr.nh_group), hdr.nh_id);
-    if (!handler) {
-        rc = MGMT_ERR_ENOENT;
-        goto err;
+    nr->nr_handler = mgmt_find_handler(ntohs(nr->nr_hdr.nh_group),
+                                       nr->nr_hdr.nh_id);
+    if (!nr->nr_handler) {
+        nr->nr_rc = MGMT_ERR_ENOENT;
     }
+}
+
+/**
+ * Runs the request's handler, encoding its output into the response.
+ */
+static void
+nmgr_req_exec(struct nmgr_req *nr)
+{
+    const struct mgmt_handler *handler;
+    struct nmgr_cbuf *cb;
+    CborEncoder payload_enc;
+    int rc;
+
+    cb = nr->nr_cbuf;
+    handler = nr->nr_handler;
 
     /* Build response header apriori.  Then pass to the handlers
      * to fill out the response data, and adjust length & flags.
      */
-    rsp_hdr = nmgr_init_rsp(rsp, &hdr);
-    if (!rsp_hdr) {
-        rc = MGMT_ERR_ENOMEM;
-        goto err_norsp;
+    nr->nr_rsp_hdr = nmgr_init_rsp(cb, nr->nr_rsp, &nr->nr_hdr, nr->nr_mtu);
+    if (!nr->nr_rsp_hdr) {
+        nr->nr_norsp = 1;
+        return;
     }
 
-    cbor_mbuf_reader_init(&nmgr_task_cbuf.reader, req, sizeof(hdr));
-    cbor_parser_init(&nmgr_task_cbuf.reader.r, 0,
-                     &nmgr_task_cbuf.n_b.parser, &nmgr_task_cbuf.n_b.it);
+    cbor_mbuf_reader_init(&cb->reader, nr->nr_req, sizeof(nr->nr_hdr));
+    cbor_parser_init(&cb->reader.r, 0, &cb->n_b.parser, &cb->n_b.it);
 
     /* Begin response payload.  Response fields are inserted into the root
      * map as key value pairs.
      */
-    rc = cbor_encoder_create_map(&nmgr_task_cbuf.n_b.encoder, &payload_enc,
+    rc = cbor_encoder_create_map(&cb->n_b.encoder, &payload_enc,
                                  CborIndefiniteLength);
     if (rc != 0) {
-        rc = MGMT_ERR_ENOMEM;
-        goto err;
+        nr->nr_rc = MGMT_ERR_ENOMEM;
+        return;
     }
 
-    if (hdr.nh_op == NMGR_OP_READ) {
+    if (nr->nr_hdr.nh_op == NMGR_OP_READ) {
         if (handler->mh_read) {
-            rc = handler->mh_read(&nmgr_task_cbuf.n_b);
+            rc = handler->mh_read(&cb->n_b);
         } else {
             rc = MGMT_ERR_ENOENT;
         }
-    } else if (hdr.nh_op == NMGR_OP_WRITE) {
+    } else if (nr->nr_hdr.nh_op == NMGR_OP_WRITE) {
         if (handler->mh_write) {
-            rc = handler->mh_write(&nmgr_task_cbuf.n_b);
+            rc = handler->mh_write(&cb->n_b);
         } else {
             rc = MGMT_ERR_ENOENT;
         }
@@ -266,50 +407,315 @@ nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
         rc = MGMT_ERR_EINVAL;
     }
     if (rc != 0) {
-        goto err;
+        nr->nr_rc = rc;
+        return;
     }
 
     /* End response payload. */
-    rc = cbor_encoder_close_container(&nmgr_task_cbuf.n_b.encoder,
-                                      &payload_enc);
+    rc = cbor_encoder_close_container(&cb->n_b.encoder, &payload_enc);
     if (rc != 0) {
-        rc = MGMT_ERR_ENOMEM;
-        goto err;
+        nr->nr_rc = MGMT_ERR_ENOMEM;
+        return;
     }
 
-    rsp_hdr->nh_len += cbor_encode_bytes_written(&nmgr_task_cbuf.n_b.encoder);
-    rsp_hdr->nh_len = htons(rsp_hdr->nh_len);
+    nr->nr_rsp_hdr->nh_len += cbor_encode_bytes_written(&cb->n_b.encoder);
+    nr->nr_rsp_hdr->nh_len = htons(nr->nr_rsp_hdr->nh_len);
+}
+
+/**
+ * Sends the response, or an error response if the request failed, and
+ * releases the request's mbufs.
+ */
+static void
+nmgr_req_finish(struct nmgr_req *nr)
+{
+    int rc;
+
+    if (nr->nr_norsp) {
+        goto err_norsp;
+    }
+
+    if (nr->nr_rc == 0) {
+        rc = nmgr_rsp_tx(nr->nr_nt, &nr->nr_rsp, nr->nr_mtu);
+        if (rc == 0) {
+            os_mbuf_free_chain(nr->nr_rsp);
+            os_mbuf_free_chain(nr->nr_req);
+            return;
+        }
 
-    rc = nmgr_rsp_tx(nt, &rsp, mtu);
-    if (rc) {
         /* If the entire mbuf was consumed by the transport, don't attempt
          * to send an error response.
          */
-        if (rsp == NULL) {
+        if (nr->nr_rsp == NULL) {
             goto err_norsp;
-        } else {
-            goto err;
         }
+        nr->nr_rc = rc;
     }
 
-    os_mbuf_free_chain(rsp);
-    os_mbuf_free_chain(req);
-    return;
-
-err:
     /* Clear partially written response. */
-    os_mbuf_adj(rsp, OS_MBUF_PKTLEN(rsp));
+    if (nr->nr_rsp_hdr != NULL) {
+        nmgr_free_frags(nr->nr_rsp);
+    }
+    os_mbuf_adj(nr->nr_rsp, OS_MBUF_PKTLEN(nr->nr_rsp));
 
-    nmgr_send_err_rsp(nt, rsp, &hdr, rc);
-    os_mbuf_free_chain(req);
+    nmgr_send_err_rsp(nr->nr_cbuf, nr->nr_nt, nr->nr_rsp, &nr->nr_hdr,
+                      nr->nr_rc);
+    os_mbuf_free_chain(nr->nr_req);
     return;
 
 err_norsp:
-    os_mbuf_free_chain(rsp);
-    os_mbuf_free_chain(req);
-    return;
+    os_mbuf_free_chain(nr->nr_rsp);
+    os_mbuf_free_chain(nr->nr_req);
+}
+
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+
+static struct nmgr_worker *
+nmgr_worker_idle(void)
+{
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(NEWTMGR_PIPELINE_WORKERS); i++) {
+        if (!nmgr_workers[i].nw_busy) {
+            return &nmgr_workers[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * Hands pending requests to idle workers, oldest first, skipping requests
+ * whose group is already running as many requests as it allows.
+ */
+static void
+nmgr_pipeline_dispatch(void)
+{
+    struct nmgr_worker *worker;
+    struct nmgr_slot *slot;
+    struct nmgr_slot *prev;
+    struct nmgr_slot *next;
+
+    prev = NULL;
+    for (slot = STAILQ_FIRST(&nmgr_slot_pending); slot != NULL; slot = next) {
+        next = STAILQ_NEXT(slot, ns_next);
+
+        worker = nmgr_worker_idle();
+        if (worker == NULL) {
+            break;
+        }
+
+        if (slot->ns_group->mg_inflight >= slot->ns_group->mg_max_inflight) {
+            prev = slot;
+            continue;
+        }
+
+        if (prev == NULL) {
+            STAILQ_REMOVE_HEAD(&nmgr_slot_pending, ns_next);
+        } else {
+            STAILQ_REMOVE_AFTER(&nmgr_slot_pending, prev, ns_next);
+        }
+
+        slot->ns_group->mg_inflight++;
+        slot->ns_worker = worker;
+        worker->nw_busy = 1;
+        os_eventq_put(&worker->nw_evq, &slot->ns_run_ev);
+    }
 }
 
+/**
+ * Returns true if a request from the same peer with the same sequence number
+ * is already queued or executing, i.e., the request is a retransmission.
+ */
+static int
+nmgr_pipeline_is_dup(const struct nmgr_req *nr)
+{
+    const struct nmgr_req *other;
+    int i;
+
+    for (i = 0; i < MYNEWT_VAL(NEWTMGR_PIPELINE_SLOTS); i++) {
+        other = &nmgr_slots[i].ns_req;
+        if (other->nr_req != NULL &&
+            other->nr_nt == nr->nr_nt &&
+            other->nr_hdr.nh_seq == nr->nr_hdr.nh_seq &&
+            other->nr_hdr.nh_group == nr->nr_hdr.nh_group &&
+            other->nr_hdr.nh_id == nr->nr_hdr.nh_id &&
+            OS_MBUF_USRHDR_LEN(other->nr_req) ==
+                OS_MBUF_USRHDR_LEN(nr->nr_req) &&
+            memcmp(OS_MBUF_USRHDR(other->nr_req), OS_MBUF_USRHDR(nr->nr_req),
+                   OS_MBUF_USRHDR_LEN(nr->nr_req)) == 0) {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * Queues a request for execution on a worker task if its group asks for it.
+ *
+ * @return                      0 if the request was queued or dropped as a
+ *                                  duplicate; the caller must not touch it.
+ *                              1 if the request should be executed inline.
+ *                              MGMT_ERR_EBADSTATE if all slots are in use.
+ */
+static int
+nmgr_pipeline_submit(struct nmgr_req *nr)
+{
+    struct mgmt_group *group;
+    struct nmgr_slot *slot;
+
+    group = mgmt_find_group(ntohs(nr->nr_hdr.nh_group));
+    if (group == NULL || group->mg_max_inflight == 0) {
+        STATS_INC(nmgr_stats, inline);
+        return 1;
+    }
+
+    if (nmgr_pipeline_is_dup(nr)) {
+        STATS_INC(nmgr_stats, dup);
+        os_mbuf_free_chain(nr->nr_rsp);
+        os_mbuf_free_chain(nr->nr_req);
+        return 0;
+    }
+
+    slot = STAILQ_FIRST(&nmgr_slot_free);
+    if (slot == NULL) {
+        STATS_INC(nmgr_stats, busy);
+        return MGMT_ERR_EBADSTATE;
+    }
+    STAILQ_REMOVE_HEAD(&nmgr_slot_free, ns_next);
+
+    slot->ns_req = *nr;
+    slot->ns_req.nr_cbuf = &slot->ns_cbuf;
+    slot->ns_group = group;
+    slot->ns_queued = os_time_get();
+    STAILQ_INSERT_TAIL(&nmgr_slot_pending, slot, ns_next);
+    STATS_INC(nmgr_stats, queued);
+
+    nmgr_pipeline_dispatch();
+
+    return 0;
+}
+
+/**
+ * Worker task: executes a deferred request's handler and passes the result
+ * back to the mgmt event queue for transmission.
+ */
+static void
+nmgr_slot_run(struct os_event *ev)
+{
+    struct nmgr_slot *slot;
+
+    slot = ev->ev_arg;
+
+    slot->ns_started = os_time_get();
+    nmgr_req_exec(&slot->ns_req);
+    slot->ns_finished = os_time_get();
+
+    os_eventq_put(mgmt_evq_get(), &slot->ns_done_ev);
+}
+
+/**
+ * Mgmt event queue: sends a deferred request's response and frees its slot.
+ */
+static void
+nmgr_slot_done(struct os_event *ev)
+{
+    struct nmgr_slot *slot;
+
+    slot = ev->ev_arg;
+
+    STATS_INCN(nmgr_stats, qwait_ms,
+               os_time_ticks_to_ms32(slot->ns_started - slot->ns_queued));
+    STATS_INCN(nmgr_stats, run_ms,
+               os_time_ticks_to_ms32(slot->ns_finished - slot->ns_started));
+
+    slot->ns_worker->nw_busy = 0;
+    slot->ns_worker = NULL;
+    slot->ns_group->mg_inflight--;
+
+    nmgr_req_finish(&slot->ns_req);
+    memset(&slot->ns_req, 0, sizeof(slot->ns_req));
+    STAILQ_INSERT_HEAD(&nmgr_slot_free, slot, ns_next);
+
+    nmgr_pipeline_dispatch();
+}
+
+static void
+nmgr_worker_main(void *arg)
+{
+    struct nmgr_worker *worker;
+
+    worker = arg;
+    while (1) {
+        os_eventq_run(&worker->nw_evq);
+    }
+}
+
+static void
+nmgr_pipeline_init(void)
+{
+    struct nmgr_slot *slot;
+    int rc;
+    int i;
+
+    STAILQ_INIT(&nmgr_slot_free);
+    STAILQ_INIT(&nmgr_slot_pending);
+    for (i = 0; i < MYNEWT_VAL(NEWTMGR_PIPELINE_SLOTS); i++) {
+        slot = &nmgr_slots[i];
+        slot->ns_run_ev.ev_cb = nmgr_slot_run;
+        slot->ns_run_ev.ev_arg = slot;
+        slot->ns_done_ev.ev_cb = nmgr_slot_done;
+        slot->ns_done_ev.ev_arg = slot;
+        STAILQ_INSERT_TAIL(&nmgr_slot_free, slot, ns_next);
+    }
+
+    for (i = 0; i < MYNEWT_VAL(NEWTMGR_PIPELINE_WORKERS); i++) {
+        os_eventq_init(&nmgr_workers[i].nw_evq);
+        rc = os_task_init(&nmgr_workers[i].nw_task, "nmgr_worker",
+                          nmgr_worker_main, &nmgr_workers[i],
+                          MYNEWT_VAL(NEWTMGR_PIPELINE_PRIO) + i,
+                          OS_WAIT_FOREVER,
+                          nmgr_worker_stacks[i],
+                          MYNEWT_VAL(NEWTMGR_PIPELINE_STACK_SIZE));
+        SYSINIT_PANIC_ASSERT(rc == 0);
+    }
+
+    rc = stats_init_and_reg(STATS_HDR(nmgr_stats),
+                            STATS_SIZE_INIT_PARMS(nmgr_stats, STATS_SIZE_32),
+                            STATS_NAME_INIT_PARMS(nmgr_stats), "nmgr");
+    SYSINIT_PANIC_ASSERT(rc == 0);
+}
+
+#endif /* MYNEWT_VAL(NEWTMGR_PIPELINE) */
+
+static void
+nmgr_handle_req(struct nmgr_transport *nt, struct os_mbuf *req)
+{
+    struct nmgr_req nr;
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+    int rc;
+#endif
+
+    nmgr_req_start(&nr, nt, req);
+
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+    if (!nr.nr_norsp && nr.nr_rc == 0) {
+        rc = nmgr_pipeline_submit(&nr);
+        if (rc == 0) {
+            return;
+        }
+        if (rc != 1) {
+            nr.nr_rc = rc;
+        }
+    }
+#endif
+
+    if (!nr.nr_norsp && nr.nr_rc == 0) {
+        nmgr_req_exec(&nr);
+    }
+    nmgr_req_finish(&nr);
+}
 
 static void
 nmgr_process(struct nmgr_transport *nt)
@@ -390,4 +796,8 @@ nmgr_pkg_init(void)
     nmgr_cbuf_init(&nmgr_task_cbuf);
 
     mgmt_evq_set(os_eventq_dflt_get());
+
+#if MYNEWT_VAL(NEWTMGR_PIPELINE)
+    nmgr_pipeline_init();
+#endif
 }
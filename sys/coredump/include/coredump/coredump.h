@@ -34,6 +34,19 @@ extern "C" {
 #define COREDUMP_TLV_IMAGE          1   /* SHA256 of image creating this */
 #define COREDUMP_TLV_MEM            2   /* Memory dump */
 #define COREDUMP_TLV_REGS           3   /* CPU registers */
+#define COREDUMP_TLV_MEM_RLE        4   /* Run-length encoded memory dump */
+
+/*
+ * A COREDUMP_TLV_MEM_RLE payload describes memory starting at ct_off as a
+ * sequence of records operating on 32-bit words:
+ *     0x00 - 0x7f:     literal; (byte + 1) words follow verbatim.
+ *     0x80 - 0xff:     run; the next byte completes a 15-bit count
+ *                      (((byte & 0x7f) << 8) | next) + 1, followed by the
+ *                      word that is repeated count times.
+ */
+#define COREDUMP_RLE_LIT_MAX        0x80
+#define COREDUMP_RLE_RUN_FLAG       0x80
+#define COREDUMP_RLE_RUN_MAX        0x8000
 
 struct coredump_tlv {
     uint8_t ct_type;
@@ -52,6 +65,14 @@ struct coredump_header {
 
 void coredump_dump(void *regs, int regs_sz);
 
+/*
+ * Expands the payload of a COREDUMP_TLV_MEM_RLE TLV into dst.  Returns the
+ * number of bytes of memory it describes, or -1 if the payload is malformed
+ * or does not fit in dst_len bytes.
+ */
+int coredump_rle_decode(const void *src, uint16_t src_len, void *dst,
+  uint32_t dst_len);
+
 /*
  * Set this to non-zero to prevent coredump from taking place.
  */
@@ -0,0 +1,114 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "coredump_test.h"
+
+uint32_t coredump_test_src[COREDUMP_TEST_WORDS];
+uint32_t coredump_test_dst[COREDUMP_TEST_WORDS];
+
+const struct flash_area *
+coredump_test_area(void)
+{
+    const struct flash_area *fa;
+    int rc;
+
+    rc = flash_area_open(MYNEWT_VAL(COREDUMP_FLASH_AREA), &fa);
+    TEST_ASSERT_FATAL(rc == 0);
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0);
+
+    return fa;
+}
+
+/*
+ * Decodes the TLVs in [0, end) of the flash area into dst, where dst[0]
+ * corresponds to the dumped address base.  TLVs have to describe memory in
+ * order and without gaps.
+ *
+ * Returns the number of bytes restored; -1 on malformed data.
+ */
+int
+coredump_test_read_back(const struct flash_area *fa, uint32_t end,
+                        const void *base, void *dst, uint32_t dst_len)
+{
+    static uint8_t buf[0x10000];
+    struct coredump_tlv tlv;
+    uint32_t done;
+    uint32_t off;
+    int len;
+    int rc;
+
+    done = 0;
+    off = 0;
+    while (off < end) {
+        rc = flash_area_read(fa, off, &tlv, sizeof(tlv));
+        TEST_ASSERT_FATAL(rc == 0);
+        off += sizeof(tlv);
+        if (off + tlv.ct_len > end) {
+            return -1;
+        }
+        if (tlv.ct_off != (uint32_t)base + done) {
+            return -1;
+        }
+
+        rc = flash_area_read(fa, off, buf, tlv.ct_len);
+        TEST_ASSERT_FATAL(rc == 0);
+        off += tlv.ct_len;
+
+        switch (tlv.ct_type) {
+        case COREDUMP_TLV_MEM:
+            if (tlv.ct_len > dst_len - done) {
+                return -1;
+            }
+            memcpy((uint8_t *)dst + done, buf, tlv.ct_len);
+            len = tlv.ct_len;
+            break;
+        case COREDUMP_TLV_MEM_RLE:
+            len = coredump_rle_decode(buf, tlv.ct_len, (uint8_t *)dst + done,
+                                      dst_len - done);
+            if (len < 0) {
+                return -1;
+            }
+            break;
+        default:
+            return -1;
+        }
+        done += len;
+    }
+    return done;
+}
+
+TEST_CASE_DECL(coredump_test_rle_round_trip)
+TEST_CASE_DECL(coredump_test_rle_unaligned)
+TEST_CASE_DECL(coredump_test_rle_truncated)
+TEST_CASE_DECL(coredump_test_rle_malformed)
+
+TEST_SUITE(coredump_test_all)
+{
+    coredump_test_rle_round_trip();
+    coredump_test_rle_unaligned();
+    coredump_test_rle_truncated();
+    coredump_test_rle_malformed();
+}
+
+int
+main(int argc, char **argv)
+{
+    coredump_test_all();
+    return tu_any_failed;
+}
@@ -0,0 +1,48 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef _COREDUMP_TEST_H
+#define _COREDUMP_TEST_H
+
+#include <stdio.h>
+#include <string.h>
+
+#include "os/mynewt.h"
+#include "testutil/testutil.h"
+#include "flash_map/flash_map.h"
+#include "coredump/coredump.h"
+#include "coredump/../../src/coredump_priv.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define COREDUMP_TEST_WORDS     0x9000
+
+extern uint32_t coredump_test_src[COREDUMP_TEST_WORDS];
+extern uint32_t coredump_test_dst[COREDUMP_TEST_WORDS];
+
+const struct flash_area *coredump_test_area(void);
+int coredump_test_read_back(const struct flash_area *fa, uint32_t end,
+                            const void *base, void *dst, uint32_t dst_len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _COREDUMP_TEST_H */
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "coredump_test.h"
+
+TEST_CASE_SELF(coredump_test_rle_malformed)
+{
+    uint8_t src[16];
+    uint32_t dst[4];
+    int len;
+
+    /* Two literal words, then a run of three; does not fit in dst. */
+    memset(src, 0, sizeof(src));
+    src[0] = 1;
+    src[1] = 0x11;
+    src[5] = 0x22;
+    src[9] = COREDUMP_RLE_RUN_FLAG;
+    src[10] = 2;
+    src[11] = 0x33;
+    len = coredump_rle_decode(src, 15, dst, sizeof(dst));
+    TEST_ASSERT(len == -1);
+
+    /* Literal record claiming more data than present. */
+    len = coredump_rle_decode(src, 8, dst, sizeof(dst));
+    TEST_ASSERT(len == -1);
+
+    /* Truncated run record. */
+    len = coredump_rle_decode(src, 12, dst, sizeof(dst));
+    TEST_ASSERT(len == -1);
+
+    /* Run of two fits. */
+    src[10] = 1;
+    len = coredump_rle_decode(src, 15, dst, sizeof(dst));
+    TEST_ASSERT(len == sizeof(dst));
+    TEST_ASSERT(((uint8_t *)dst)[0] == 0x11);
+    TEST_ASSERT(((uint8_t *)dst)[4] == 0x22);
+    TEST_ASSERT(((uint8_t *)dst)[8] == 0x33);
+    TEST_ASSERT(((uint8_t *)dst)[12] == 0x33);
+}
@@ -0,0 +1,61 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "coredump_test.h"
+
+/**
+ * Memory made of zeroes, stack fill, a run longer than one record can hold
+ * and incompressible data must decode back to the original contents.
+ */
+TEST_CASE_SELF(coredump_test_rle_round_trip)
+{
+    const struct flash_area *fa;
+    uint32_t off;
+    int len;
+    int i;
+
+    for (i = 0; i < COREDUMP_TEST_WORDS; i++) {
+        if (i < 0x100) {
+            coredump_test_src[i] = 0;
+        } else if (i < 0x200) {
+            coredump_test_src[i] = i * 2654435761u;
+        } else if (i < 0x200 + COREDUMP_RLE_RUN_MAX + 5) {
+            coredump_test_src[i] = 0xdeadbeef;
+        } else if (i % 3) {
+            coredump_test_src[i] = i;
+        } else {
+            coredump_test_src[i] = 0;
+        }
+    }
+    memset(coredump_test_dst, 0xa5, sizeof(coredump_test_dst));
+
+    fa = coredump_test_area();
+    off = 0;
+    coredump_dump_region(fa, &off, (uint32_t)coredump_test_src,
+                         sizeof(coredump_test_src));
+
+    /* Runs must have been compressed. */
+    TEST_ASSERT(off < sizeof(coredump_test_src) / 2);
+
+    len = coredump_test_read_back(fa, off, coredump_test_src,
+                                  coredump_test_dst,
+                                  sizeof(coredump_test_dst));
+    TEST_ASSERT_FATAL(len == sizeof(coredump_test_src), "len=%d", len);
+    TEST_ASSERT(memcmp(coredump_test_src, coredump_test_dst,
+                       sizeof(coredump_test_src)) == 0);
+}
@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "coredump_test.h"
+
+/**
+ * When the flash area fills up, the dump stops on a record boundary and
+ * what was written still decodes to a prefix of the memory.
+ */
+TEST_CASE_SELF(coredump_test_rle_truncated)
+{
+    struct flash_area small;
+    uint32_t off;
+    int len;
+    int i;
+
+    for (i = 0; i < 1024; i++) {
+        coredump_test_src[i] = (i & 0x10) ? 0 : i * 2654435761u;
+    }
+    memset(coredump_test_dst, 0xa5, sizeof(coredump_test_dst));
+
+    small = *coredump_test_area();
+    small.fa_size = 301;
+
+    off = 0;
+    coredump_dump_region(&small, &off, (uint32_t)coredump_test_src,
+                         1024 * 4);
+    TEST_ASSERT_FATAL(off > 0 && off <= small.fa_size);
+
+    len = coredump_test_read_back(&small, off, coredump_test_src,
+                                  coredump_test_dst,
+                                  sizeof(coredump_test_dst));
+    TEST_ASSERT_FATAL(len > 0 && len < 1024 * 4, "len=%d", len);
+    TEST_ASSERT(memcmp(coredump_test_src, coredump_test_dst, len) == 0);
+}
@@ -0,0 +1,47 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "coredump_test.h"
+
+/**
+ * A region whose size is not a multiple of a word ends with a raw TLV.
+ */
+TEST_CASE_SELF(coredump_test_rle_unaligned)
+{
+    const struct flash_area *fa;
+    uint32_t size;
+    uint32_t off;
+    int len;
+    int i;
+
+    for (i = 0; i < 256; i++) {
+        coredump_test_src[i] = i < 128 ? 0 : i;
+    }
+    size = 256 * 4 - 1;
+    memset(coredump_test_dst, 0xa5, sizeof(coredump_test_dst));
+
+    fa = coredump_test_area();
+    off = 0;
+    coredump_dump_region(fa, &off, (uint32_t)coredump_test_src, size);
+
+    len = coredump_test_read_back(fa, off, coredump_test_src,
+                                  coredump_test_dst,
+                                  sizeof(coredump_test_dst));
+    TEST_ASSERT_FATAL(len == size, "len=%d", len);
+    TEST_ASSERT(memcmp(coredump_test_src, coredump_test_dst, size) == 0);
+}
@@ -19,15 +19,35 @@
 
 #include <stddef.h>
 #include <limits.h>
+#include <string.h>
 #include "os/mynewt.h"
 #include "hal/hal_bsp.h"
 #include "flash_map/flash_map.h"
 #include "bootutil/image.h"
 #include "imgmgr/imgmgr.h"
 #include "coredump/coredump.h"
+#include "coredump_priv.h"
 
 uint8_t coredump_disabled;
 
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+/*
+ * Stop adding records to an RLE TLV once its payload reaches this size; the
+ * records still pending then cannot overflow the 16-bit TLV length.
+ */
+#define COREDUMP_RLE_TLV_MAX    0xf000
+
+/*
+ * Compressed output is staged here so that flash is written in chunks rather
+ * than a few bytes per record.
+ */
+static struct {
+    uint32_t off;
+    uint16_t len;
+    uint8_t buf[128];
+} coredump_out;
+#endif
+
 static void
 dump_core_tlv(const struct flash_area *fa, uint32_t *off,
   struct coredump_tlv *tlv, void *data)
@@ -39,6 +59,294 @@ dump_core_tlv(const struct flash_area *fa, uint32_t *off,
     *off += tlv->ct_len;
 }
 
+static void
+dump_core_mem(const struct flash_area *fa, uint32_t *off, uint32_t area_off,
+  uint32_t area_size)
+{
+    struct coredump_tlv tlv;
+    uint32_t area_end;
+
+    tlv._pad = 0;
+    area_end = area_off + area_size;
+    while (area_off < area_end) {
+        tlv.ct_type = COREDUMP_TLV_MEM;
+        if (area_end - area_off > USHRT_MAX) {
+            tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
+        } else {
+            tlv.ct_len = area_end - area_off;
+        }
+        if (*off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
+            if (*off + sizeof(tlv) >= fa->fa_size) {
+                break;
+            }
+            tlv.ct_len = fa->fa_size - (*off + sizeof(tlv));
+        }
+        tlv.ct_off = area_off;
+        dump_core_tlv(fa, off, &tlv, (void *)area_off);
+        area_off += tlv.ct_len;
+    }
+}
+
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+static void
+dump_core_flush(const struct flash_area *fa)
+{
+    if (coredump_out.len > 0) {
+        flash_area_write(fa, coredump_out.off, coredump_out.buf,
+          coredump_out.len);
+        coredump_out.off += coredump_out.len;
+        coredump_out.len = 0;
+    }
+}
+
+/*
+ * Appends one record to the staged output.  Returns -1, writing nothing, if
+ * the record does not fit in the flash area.
+ */
+static int
+dump_core_rle_rec(const struct flash_area *fa, const uint8_t *rec, int rec_len,
+  const void *data, uint32_t data_len)
+{
+    const uint8_t *u8p;
+    uint32_t chunk;
+    uint32_t len;
+    int i;
+
+    if (coredump_out.off + coredump_out.len + rec_len + data_len >
+      fa->fa_size) {
+        return -1;
+    }
+
+    for (i = 0; i < 2; i++) {
+        if (i == 0) {
+            u8p = rec;
+            len = rec_len;
+        } else {
+            u8p = data;
+            len = data_len;
+        }
+        while (len > 0) {
+            chunk = sizeof(coredump_out.buf) - coredump_out.len;
+            if (chunk > len) {
+                chunk = len;
+            }
+            memcpy(coredump_out.buf + coredump_out.len, u8p, chunk);
+            coredump_out.len += chunk;
+            u8p += chunk;
+            len -= chunk;
+
+            if (coredump_out.len == sizeof(coredump_out.buf)) {
+                dump_core_flush(fa);
+            }
+        }
+    }
+    return 0;
+}
+
+static int
+dump_core_rle_lit(const struct flash_area *fa, const uint32_t *words,
+  uint32_t cnt)
+{
+    uint8_t rec;
+
+    rec = cnt - 1;
+    return dump_core_rle_rec(fa, &rec, 1, words, cnt * 4);
+}
+
+static int
+dump_core_rle_run(const struct flash_area *fa, const uint32_t *word,
+  uint32_t cnt)
+{
+    uint8_t rec[2];
+
+    rec[0] = COREDUMP_RLE_RUN_FLAG | ((cnt - 1) >> 8);
+    rec[1] = (cnt - 1) & 0xff;
+    return dump_core_rle_rec(fa, rec, 2, word, 4);
+}
+
+/*
+ * Writes one COREDUMP_TLV_MEM_RLE TLV covering a prefix of the given
+ * word-aligned memory.  Returns the number of bytes covered; 0 if the flash
+ * area is full.
+ */
+static uint32_t
+dump_core_rle_tlv(const struct flash_area *fa, uint32_t *off,
+  const uint32_t *words, uint32_t nwords)
+{
+    struct coredump_tlv tlv;
+    uint32_t tlv_off;
+    uint32_t done;
+    uint32_t lit;
+    uint32_t run;
+    uint32_t i;
+
+    if (*off + sizeof(tlv) >= fa->fa_size) {
+        return 0;
+    }
+    tlv_off = *off;
+    coredump_out.off = tlv_off + sizeof(tlv);
+    coredump_out.len = 0;
+
+    /*
+     * Words [done, i) are pending literals.
+     */
+    done = 0;
+    i = 0;
+    while (i < nwords &&
+      coredump_out.off + coredump_out.len - tlv_off < COREDUMP_RLE_TLV_MAX) {
+        run = 1;
+        while (i + run < nwords && run < COREDUMP_RLE_RUN_MAX &&
+          words[i + run] == words[i]) {
+            run++;
+        }
+
+        if (run == 1) {
+            i++;
+            lit = i - done;
+            if (lit == COREDUMP_RLE_LIT_MAX) {
+                if (dump_core_rle_lit(fa, &words[done], lit)) {
+                    break;
+                }
+                done = i;
+            }
+            continue;
+        }
+
+        lit = i - done;
+        if (lit > 0) {
+            if (dump_core_rle_lit(fa, &words[done], lit)) {
+                break;
+            }
+            done = i;
+        }
+        if (dump_core_rle_run(fa, &words[i], run)) {
+            break;
+        }
+        i += run;
+        done = i;
+    }
+    lit = i - done;
+    if (lit > 0 && dump_core_rle_lit(fa, &words[done], lit) == 0) {
+        done = i;
+    }
+    dump_core_flush(fa);
+
+    if (done == 0) {
+        return 0;
+    }
+
+    tlv.ct_type = COREDUMP_TLV_MEM_RLE;
+    tlv._pad = 0;
+    tlv.ct_len = coredump_out.off - (tlv_off + sizeof(tlv));
+    tlv.ct_off = (uint32_t)words;
+    flash_area_write(fa, tlv_off, &tlv, sizeof(tlv));
+
+    *off = coredump_out.off;
+    return done * 4;
+}
+#endif
+
+void
+coredump_dump_region(const struct flash_area *fa, uint32_t *off,
+  uint32_t area_off, uint32_t area_size)
+{
+#if MYNEWT_VAL(COREDUMP_COMPRESS)
+    uint32_t done;
+
+    if ((area_off & 3) == 0) {
+        while (area_size >= 4) {
+            done = dump_core_rle_tlv(fa, off, (const uint32_t *)area_off,
+              area_size / 4);
+            if (done == 0) {
+                return;
+            }
+            area_off += done;
+            area_size -= done;
+        }
+    }
+#endif
+    if (area_size > 0) {
+        dump_core_mem(fa, off, area_off, area_size);
+    }
+}
+
+int
+coredump_rle_decode(const void *src, uint16_t src_len, void *dst,
+  uint32_t dst_len)
+{
+    const uint8_t *sp;
+    const uint8_t *end;
+    uint8_t *dp;
+    uint32_t out;
+    uint32_t cnt;
+
+    sp = src;
+    end = sp + src_len;
+    dp = dst;
+    out = 0;
+    while (sp < end) {
+        if (sp[0] & COREDUMP_RLE_RUN_FLAG) {
+            if (end - sp < 2 + 4) {
+                return -1;
+            }
+            cnt = (((sp[0] & ~COREDUMP_RLE_RUN_FLAG) << 8) | sp[1]) + 1;
+            sp += 2;
+            if (cnt * 4 > dst_len - out) {
+                return -1;
+            }
+            while (cnt-- > 0) {
+                memcpy(dp + out, sp, 4);
+                out += 4;
+            }
+            sp += 4;
+        } else {
+            cnt = sp[0] + 1;
+            sp++;
+            if (end - sp < cnt * 4 || cnt * 4 > dst_len - out) {
+                return -1;
+            }
+            memcpy(dp + out, sp, cnt * 4);
+            out += cnt * 4;
+            sp += cnt * 4;
+        }
+    }
+    return out;
+}
+
+#if MYNEWT_VAL(COREDUMP_MINIMAL)
+static void
+dump_core_os(const struct flash_area *fa, uint32_t *off)
+{
+    struct os_mempool_info omi;
+    struct os_mempool *mp;
+    struct os_task *t;
+    uint32_t bottom;
+    uint32_t sp;
+    uint32_t top;
+
+    STAILQ_FOREACH(t, &g_os_task_list, t_os_task_list) {
+        coredump_dump_region(fa, off, (uint32_t)t, sizeof(*t));
+
+        /*
+         * The saved stack pointer of the running task is stale; dump its
+         * whole stack.
+         */
+        top = (uint32_t)t->t_stacktop;
+        bottom = (uint32_t)(t->t_stacktop - t->t_stacksize);
+        sp = (uint32_t)t->t_stackptr;
+        if (t == os_sched_get_current_task() || sp < bottom || sp > top) {
+            sp = bottom;
+        }
+        coredump_dump_region(fa, off, sp, top - sp);
+    }
+
+    mp = NULL;
+    while ((mp = os_mempool_info_get_next(mp, &omi)) != NULL) {
+        coredump_dump_region(fa, off, (uint32_t)mp, sizeof(*mp));
+    }
+}
+#endif
+
 void
 coredump_dump(void *regs, int regs_sz)
 {
@@ -46,11 +354,12 @@ coredump_dump(void *regs, int regs_sz)
     struct coredump_tlv tlv;
     const struct flash_area *fa;
     struct image_version ver;
+#if !MYNEWT_VAL(COREDUMP_MINIMAL)
     const struct hal_bsp_mem_dump *mem, *cur;
     int area_cnt, i;
+#endif
     uint8_t hash[IMGMGR_HASH_LEN];
     uint32_t off;
-    uint32_t area_off, area_end;
     int slot;
 
     if (coredump_disabled) {
@@ -102,29 +411,16 @@ coredump_dump(void *regs, int regs_sz)
         dump_core_tlv(fa, &off, &tlv, hash);
     }
 
+#if MYNEWT_VAL(COREDUMP_MINIMAL)
+    dump_core_os(fa, &off);
+#else
     mem = hal_bsp_core_dump(&area_cnt);
     for (i = 0; i < area_cnt; i++) {
         cur = &mem[i];
-        area_off = (uint32_t)cur->hbmd_start;
-        area_end = area_off + cur->hbmd_size;
-        while (area_off < area_end) {
-            tlv.ct_type = COREDUMP_TLV_MEM;
-            if (area_end - area_off > USHRT_MAX) {
-                tlv.ct_len = USHRT_MAX - 3; /* 0xfffc */
-            } else {
-                tlv.ct_len = area_end - area_off;
-            }
-            if (off + tlv.ct_len + sizeof(tlv) > fa->fa_size) {
-                if (off + sizeof(tlv) >= fa->fa_size) {
-                    break;
-                }
-                tlv.ct_len = fa->fa_size - (off + sizeof(tlv));
-            }
-            tlv.ct_off = area_off;
-            dump_core_tlv(fa, &off, &tlv, (void *)area_off);
-            area_off += tlv.ct_len;
-        }
+        coredump_dump_region(fa, &off, (uint32_t)cur->hbmd_start,
+          cur->hbmd_size);
     }
+#endif
     hdr.ch_magic = COREDUMP_MAGIC;
     hdr.ch_size = off;
 
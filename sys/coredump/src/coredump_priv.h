@@ -0,0 +1,42 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#ifndef __SYS_COREDUMP_PRIV_H_
+#define __SYS_COREDUMP_PRIV_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_area;
+
+/*
+ * Appends TLVs describing memory [addr, addr + size) to the corefile at *off,
+ * RLE compressed if COREDUMP_COMPRESS is set.  Stops when the flash area is
+ * full.
+ */
+void coredump_dump_region(const struct flash_area *fa, uint32_t *off,
+  uint32_t addr, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
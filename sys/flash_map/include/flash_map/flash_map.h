@@ -43,6 +43,10 @@ extern "C" {
  */
 #include <stdbool.h>
 #include <inttypes.h>
+#include "syscfg/syscfg.h"
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+#include "hal/hal_flash_async.h"
+#endif
 
 struct flash_area {
     uint8_t fa_id;
@@ -87,6 +91,17 @@ int flash_area_write(const struct flash_area *, uint32_t off, const void *src,
   uint32_t len);
 int flash_area_erase(const struct flash_area *, uint32_t off, uint32_t len);
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+/*
+ * Submit asynchronous read/write/erase, see hal_flash_req_submit().
+ * req->fr_addr is offset within flash area; on success it, and
+ * req->fr_flash_id, are replaced with flash device address and ID.
+ * Request must not be queued already.  Not supported for wear leveled area.
+ */
+int flash_area_req_submit(const struct flash_area *,
+  struct hal_flash_req *req);
+#endif
+
 /*
  * Whether the whole area is empty.
  */
@@ -0,0 +1,73 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_FLASH_MAP_FLASH_WL_
+#define H_FLASH_MAP_FLASH_WL_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Wear leveling layer.
+ *
+ * Sectors of a physical flash area (FLASH_MAP_WL_AREA) are presented as
+ * a logical flash area (FLASH_MAP_WL_ID), accessed with the regular
+ * flash_area_read/write/erase() calls.  Erasing a logical sector moves it to
+ * the least worn free physical sector; rarely erased (cold) sectors are
+ * moved to worn ones when difference in erase counts exceeds
+ * FLASH_MAP_WL_THRESHOLD.
+ *
+ * Each physical sector starts with a small header holding logical sector
+ * number and erase count, so logical sectors are slightly smaller than
+ * physical ones.  Users must get sector layout of the logical area with
+ * flash_area_to_sectors() or flash_area_to_sector_ranges().
+ *
+ * Only users going through flash_area_* API (fcb, fcb2, config, log) can
+ * use the logical area; it is not visible through hal_flash.
+ */
+
+#include <inttypes.h>
+
+struct flash_wl_stats {
+    /* Erase counts of physical sectors, persistent */
+    uint32_t fws_erase_min;
+    uint32_t fws_erase_max;
+    uint32_t fws_erase_total;
+    /* Since flash_wl_init() */
+    uint32_t fws_log_erases;        /* Logical sector erases */
+    uint32_t fws_log_erase_max;     /* Most erases of single logical sector */
+    uint32_t fws_moves;             /* Cold sectors moved to worn ones */
+};
+
+/*
+ * Mounts wear leveled area. Called from flash_map_init().
+ */
+int flash_wl_init(void);
+
+/*
+ * Returns erase statistics of the wear leveled area.
+ */
+int flash_wl_stats_get(struct flash_wl_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_FLASH_MAP_FLASH_WL_ */
@@ -26,23 +26,94 @@
 #include "hal/hal_bsp.h"
 #include "hal/hal_flash.h"
 #include "hal/hal_flash_int.h"
+#include "flash_map_test.h"
 
 struct flash_area *fa_sectors;
 
+struct hal_flash_req flash_map_test_reqs[FLASH_MAP_TEST_REQS];
+int flash_map_test_done[FLASH_MAP_TEST_REQS];
+int flash_map_test_status[FLASH_MAP_TEST_REQS];
+static int flash_map_test_done_cnt;
+static struct os_sem flash_map_test_sem;
+
 /*
  * Max number sectors per area (for native BSP)
  */
 #define SELFTEST_FA_SECTOR_COUNT    64
 
+static void
+flash_map_test_async_cb(struct hal_flash_req *req, int status, void *arg)
+{
+    int idx = req - flash_map_test_reqs;
+
+    flash_map_test_done[idx] = ++flash_map_test_done_cnt;
+    flash_map_test_status[idx] = status;
+    os_sem_release(&flash_map_test_sem);
+}
+
+void
+flash_map_test_async_init(void)
+{
+    os_sem_init(&flash_map_test_sem, 0);
+    memset(flash_map_test_reqs, 0, sizeof(flash_map_test_reqs));
+    memset(flash_map_test_done, 0, sizeof(flash_map_test_done));
+    memset(flash_map_test_status, 0, sizeof(flash_map_test_status));
+    flash_map_test_done_cnt = 0;
+}
+
+/*
+ * Submits request idx for range of flash area fa.
+ */
+int
+flash_map_test_async_submit(int idx, const struct flash_area *fa, uint8_t op,
+                            uint32_t off, uint32_t len, void *buf)
+{
+    struct hal_flash_req *req = &flash_map_test_reqs[idx];
+
+    req->fr_op = op;
+    req->fr_flash_id = 0;
+    req->fr_addr = off;
+    req->fr_len = len;
+    req->fr_buf = buf;
+    req->fr_cb = flash_map_test_async_cb;
+
+    return flash_area_req_submit(fa, req);
+}
+
+/*
+ * Waits for cnt more completions, up to 5 s for each.
+ */
+int
+flash_map_test_async_wait(int cnt)
+{
+    while (cnt--) {
+        if (os_sem_pend(&flash_map_test_sem, OS_TICKS_PER_SEC * 5)) {
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 TEST_CASE_DECL(flash_map_test_case_1)
 TEST_CASE_DECL(flash_map_test_case_2)
 TEST_CASE_DECL(flash_map_test_case_3)
+TEST_CASE_DECL(flash_map_test_case_wl)
+TEST_CASE_DECL(flash_map_test_case_async)
+TEST_CASE_DECL(flash_map_test_case_async_prio)
+TEST_CASE_DECL(flash_map_test_case_async_overlap)
+TEST_CASE_DECL(flash_map_test_case_async_cancel)
 
 TEST_SUITE(flash_map_test_suite)
 {
     flash_map_test_case_1();
     flash_map_test_case_2();
     flash_map_test_case_3();
+    flash_map_test_case_wl();
+    flash_map_test_case_async();
+    flash_map_test_case_async_prio();
+    flash_map_test_case_async_overlap();
+    flash_map_test_case_async_cancel();
 }
 
 int
@@ -32,7 +32,21 @@
 extern "C" {
 #endif
 
-/* This space intentionally left blank */
+#define FLASH_MAP_TEST_REQS     8
+
+/*
+ * Asynchronous requests of a test case; completion order (starting from 1,
+ * 0 if not completed) and status of each.
+ */
+extern struct hal_flash_req flash_map_test_reqs[FLASH_MAP_TEST_REQS];
+extern int flash_map_test_done[FLASH_MAP_TEST_REQS];
+extern int flash_map_test_status[FLASH_MAP_TEST_REQS];
+
+void flash_map_test_async_init(void);
+int flash_map_test_async_submit(int idx, const struct flash_area *fa,
+                                uint8_t op, uint32_t off, uint32_t len,
+                                void *buf);
+int flash_map_test_async_wait(int cnt);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,97 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ * 
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+extern struct flash_area *fa_sectors;
+
+#define ASYNC_WRITES    4
+#define ASYNC_WLEN      64
+
+/*
+ * Test asynchronous requests: erase, adjacent writes and read back.
+ */
+TEST_CASE_TASK(flash_map_test_case_async)
+{
+    struct hal_flash_req bad;
+    const struct flash_area *fa;
+    uint8_t wd[ASYNC_WRITES][ASYNC_WLEN];
+    uint8_t rd[ASYNC_WRITES * ASYNC_WLEN];
+    uint8_t rd2[ASYNC_WLEN];
+    int sec_cnt;
+    int i;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_0, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0 && sec_cnt > 1, "flash_area_to_sectors failed");
+
+    flash_map_test_async_init();
+
+    /* Erase first sector */
+    rc = flash_map_test_async_submit(0, fa, HAL_FLASH_OP_ERASE, 0,
+                                     fa_sectors[0].fa_size, NULL);
+    TEST_ASSERT_FATAL(rc == 0, "erase submit fail");
+
+    /* Adjacent writes, may be merged */
+    for (i = 0; i < ASYNC_WRITES; i++) {
+        memset(wd[i], i + 1, ASYNC_WLEN);
+        rc = flash_map_test_async_submit(1 + i, fa, HAL_FLASH_OP_WRITE,
+                                         i * ASYNC_WLEN, ASYNC_WLEN, wd[i]);
+        TEST_ASSERT_FATAL(rc == 0, "write submit fail");
+    }
+
+    /* Read of written data must not overtake the writes */
+    rc = flash_map_test_async_submit(1 + ASYNC_WRITES, fa, HAL_FLASH_OP_READ,
+                                     0, sizeof(rd), rd);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    /* Unrelated read can be done in any order */
+    rc = flash_map_test_async_submit(2 + ASYNC_WRITES, fa, HAL_FLASH_OP_READ,
+                                     fa_sectors[1].fa_off - fa->fa_off,
+                                     sizeof(rd2), rd2);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    /* Out of area */
+    memset(&bad, 0, sizeof(bad));
+    bad.fr_op = HAL_FLASH_OP_READ;
+    bad.fr_addr = fa->fa_size;
+    bad.fr_len = 1;
+    bad.fr_buf = rd2;
+    bad.fr_cb = flash_map_test_reqs[0].fr_cb;
+    rc = flash_area_req_submit(fa, &bad);
+    TEST_ASSERT(rc == SYS_EINVAL);
+
+    rc = flash_map_test_async_wait(3 + ASYNC_WRITES);
+    TEST_ASSERT_FATAL(rc == 0, "request not completed");
+
+    for (i = 0; i < 3 + ASYNC_WRITES; i++) {
+        TEST_ASSERT(flash_map_test_status[i] == 0);
+    }
+    for (i = 1; i <= ASYNC_WRITES; i++) {
+        TEST_ASSERT(flash_map_test_done[i] > flash_map_test_done[0]);
+        TEST_ASSERT(flash_map_test_done[i] <
+                    flash_map_test_done[1 + ASYNC_WRITES]);
+    }
+
+    for (i = 0; i < ASYNC_WRITES; i++) {
+        TEST_ASSERT(memcmp(rd + i * ASYNC_WLEN, wd[i], ASYNC_WLEN) == 0);
+    }
+}
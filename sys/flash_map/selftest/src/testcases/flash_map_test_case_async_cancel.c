@@ -0,0 +1,91 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+extern struct flash_area *fa_sectors;
+
+/*
+ * Test cancelling queued and completed requests.
+ */
+TEST_CASE_TASK(flash_map_test_case_async_cancel)
+{
+    const struct flash_area *fa;
+    uint8_t rd1[32];
+    uint8_t rd2[32];
+    uint8_t exp[32];
+    uint32_t off;
+    int sec_cnt;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_0, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0 && sec_cnt > 1, "flash_area_to_sectors failed");
+
+    flash_map_test_async_init();
+
+    /* Never submitted */
+    rc = hal_flash_req_cancel(&flash_map_test_reqs[0]);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    /* Device task runs below us, so these stay queued until we block */
+    rc = flash_map_test_async_submit(0, fa, HAL_FLASH_OP_READ, 0,
+                                     sizeof(rd1), rd1);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    off = fa_sectors[1].fa_off - fa->fa_off;
+    memset(rd2, 0xee, sizeof(rd2));
+    memset(exp, 0xee, sizeof(exp));
+    rc = flash_map_test_async_submit(1, fa, HAL_FLASH_OP_READ, off,
+                                     sizeof(rd2), rd2);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    /* Queued request can not be submitted again */
+    rc = flash_area_req_submit(fa, &flash_map_test_reqs[0]);
+    TEST_ASSERT(rc == SYS_EBUSY);
+
+    rc = hal_flash_req_cancel(&flash_map_test_reqs[1]);
+    TEST_ASSERT(rc == 0);
+    rc = hal_flash_req_cancel(&flash_map_test_reqs[1]);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    rc = flash_map_test_async_wait(1);
+    TEST_ASSERT_FATAL(rc == 0, "request not completed");
+    TEST_ASSERT(flash_map_test_status[0] == 0);
+
+    /* Queue is empty now; cancelled request was not done */
+    TEST_ASSERT(flash_map_test_done[0] == 1);
+    TEST_ASSERT(flash_map_test_done[1] == 0);
+    TEST_ASSERT(memcmp(rd2, exp, sizeof(rd2)) == 0);
+
+    /* Completed request can not be cancelled */
+    rc = hal_flash_req_cancel(&flash_map_test_reqs[0]);
+    TEST_ASSERT(rc == SYS_ENOENT);
+
+    /* Cancelled request can be submitted again */
+    rc = flash_map_test_async_submit(1, fa, HAL_FLASH_OP_READ, off,
+                                     sizeof(rd2), rd2);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    rc = flash_map_test_async_wait(1);
+    TEST_ASSERT_FATAL(rc == 0, "request not completed");
+    TEST_ASSERT(flash_map_test_status[1] == 0);
+    TEST_ASSERT(flash_map_test_done[1] == 2);
+}
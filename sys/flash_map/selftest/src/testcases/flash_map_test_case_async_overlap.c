@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+extern struct flash_area *fa_sectors;
+
+#define ASYNC_LEN       32
+
+static int
+flash_map_test_filled(const uint8_t *buf, uint8_t val, int len)
+{
+    while (len--) {
+        if (*buf++ != val) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/*
+ * Test that requests which overlap are done in the order they were
+ * submitted, regardless of their priority, while non-overlapping read
+ * overtakes them all.
+ */
+TEST_CASE_TASK(flash_map_test_case_async_overlap)
+{
+    const struct flash_area *fa;
+    uint8_t wd[ASYNC_LEN];
+    uint8_t rd1[ASYNC_LEN];
+    uint8_t rd2[ASYNC_LEN];
+    uint8_t rd3[ASYNC_LEN];
+    uint32_t off;
+    int sec_cnt;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_0, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0 && sec_cnt > 2, "flash_area_to_sectors failed");
+
+    off = fa_sectors[1].fa_off - fa->fa_off;
+    rc = flash_area_erase(fa, off, fa_sectors[1].fa_size);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+    memset(wd, 0xaa, sizeof(wd));
+    rc = flash_area_write(fa, off, wd, sizeof(wd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+
+    flash_map_test_async_init();
+
+    /* Erase, read, write and read again of the same sector */
+    rc = flash_map_test_async_submit(0, fa, HAL_FLASH_OP_ERASE, off,
+                                     fa_sectors[1].fa_size, NULL);
+    TEST_ASSERT_FATAL(rc == 0, "erase submit fail");
+
+    memset(rd1, 0, sizeof(rd1));
+    rc = flash_map_test_async_submit(1, fa, HAL_FLASH_OP_READ, off,
+                                     sizeof(rd1), rd1);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    memset(wd, 0x55, sizeof(wd));
+    rc = flash_map_test_async_submit(2, fa, HAL_FLASH_OP_WRITE, off,
+                                     sizeof(wd), wd);
+    TEST_ASSERT_FATAL(rc == 0, "write submit fail");
+
+    memset(rd2, 0, sizeof(rd2));
+    rc = flash_map_test_async_submit(3, fa, HAL_FLASH_OP_READ, off,
+                                     sizeof(rd2), rd2);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    /* Read from another sector */
+    rc = flash_map_test_async_submit(4, fa, HAL_FLASH_OP_READ,
+                                     fa_sectors[2].fa_off - fa->fa_off,
+                                     sizeof(rd3), rd3);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    rc = flash_map_test_async_wait(5);
+    TEST_ASSERT_FATAL(rc == 0, "request not completed");
+
+    TEST_ASSERT(flash_map_test_status[0] == 0);
+    TEST_ASSERT(flash_map_test_status[1] == 0);
+    TEST_ASSERT(flash_map_test_status[2] == 0);
+    TEST_ASSERT(flash_map_test_status[3] == 0);
+    TEST_ASSERT(flash_map_test_status[4] == 0);
+
+    TEST_ASSERT(flash_map_test_done[4] == 1);
+    TEST_ASSERT(flash_map_test_done[0] == 2);
+    TEST_ASSERT(flash_map_test_done[1] == 3);
+    TEST_ASSERT(flash_map_test_done[2] == 4);
+    TEST_ASSERT(flash_map_test_done[3] == 5);
+
+    /* First read sees erased flash, second one the written data */
+    TEST_ASSERT(flash_map_test_filled(rd1, flash_area_erased_val(fa), sizeof(rd1)));
+    TEST_ASSERT(flash_map_test_filled(rd2, 0x55, sizeof(rd2)));
+}
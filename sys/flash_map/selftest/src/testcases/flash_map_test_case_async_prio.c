@@ -0,0 +1,80 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+
+extern struct flash_area *fa_sectors;
+
+/*
+ * Test that reads overtake queued writes and erases, and writes overtake
+ * queued erases, when they do not overlap.
+ */
+TEST_CASE_TASK(flash_map_test_case_async_prio)
+{
+    const struct flash_area *fa;
+    uint8_t wd[32];
+    uint8_t rd[32];
+    uint32_t off;
+    int sec_cnt;
+    int rc;
+
+    rc = flash_area_open(FLASH_AREA_IMAGE_0, &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_to_sectors(FLASH_AREA_IMAGE_0, &sec_cnt, fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0 && sec_cnt > 2, "flash_area_to_sectors failed");
+
+    rc = flash_area_erase(fa, 0, fa_sectors[0].fa_size);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+
+    flash_map_test_async_init();
+
+    off = fa_sectors[1].fa_off - fa->fa_off;
+    rc = flash_map_test_async_submit(0, fa, HAL_FLASH_OP_ERASE, off,
+                                     fa_sectors[1].fa_size, NULL);
+    TEST_ASSERT_FATAL(rc == 0, "erase submit fail");
+
+    off = fa_sectors[2].fa_off - fa->fa_off;
+    rc = flash_map_test_async_submit(1, fa, HAL_FLASH_OP_ERASE, off,
+                                     fa_sectors[2].fa_size, NULL);
+    TEST_ASSERT_FATAL(rc == 0, "erase submit fail");
+
+    memset(wd, 0x5a, sizeof(wd));
+    rc = flash_map_test_async_submit(2, fa, HAL_FLASH_OP_WRITE, 0,
+                                     sizeof(wd), wd);
+    TEST_ASSERT_FATAL(rc == 0, "write submit fail");
+
+    /* Same sector as the write, but not the same bytes */
+    rc = flash_map_test_async_submit(3, fa, HAL_FLASH_OP_READ, sizeof(wd),
+                                     sizeof(rd), rd);
+    TEST_ASSERT_FATAL(rc == 0, "read submit fail");
+
+    rc = flash_map_test_async_wait(4);
+    TEST_ASSERT_FATAL(rc == 0, "request not completed");
+
+    TEST_ASSERT(flash_map_test_status[0] == 0);
+    TEST_ASSERT(flash_map_test_status[1] == 0);
+    TEST_ASSERT(flash_map_test_status[2] == 0);
+    TEST_ASSERT(flash_map_test_status[3] == 0);
+
+    /* Read, write, then erases in the order they were submitted */
+    TEST_ASSERT(flash_map_test_done[3] == 1);
+    TEST_ASSERT(flash_map_test_done[2] == 2);
+    TEST_ASSERT(flash_map_test_done[0] == 3);
+    TEST_ASSERT(flash_map_test_done[1] == 4);
+}
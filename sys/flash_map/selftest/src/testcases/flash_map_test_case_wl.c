@@ -0,0 +1,113 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+#include "flash_map_test.h"
+#include "flash_map/flash_wl.h"
+
+extern struct flash_area *fa_sectors;
+
+static void
+flash_map_test_wl_fill(uint8_t *buf, int len, uint8_t seed)
+{
+    int i;
+
+    for (i = 0; i < len; i++) {
+        buf[i] = seed + i;
+    }
+}
+
+/*
+ * Test wear leveled area
+ */
+TEST_CASE_SELF(flash_map_test_case_wl)
+{
+    const struct flash_area *fa;
+    struct flash_wl_stats stats;
+    bool empty;
+    int sec_cnt;
+    int i;
+    int rc;
+    uint8_t wd[256];
+    uint8_t rd[256];
+
+    rc = flash_area_open(MYNEWT_VAL(FLASH_MAP_WL_ID), &fa);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_open() fail");
+
+    rc = flash_area_to_sectors(MYNEWT_VAL(FLASH_MAP_WL_ID), &sec_cnt,
+                               fa_sectors);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_to_sectors failed");
+    TEST_ASSERT_FATAL(sec_cnt >= 2);
+    TEST_ASSERT(fa_sectors[0].fa_device_id ==
+                MYNEWT_VAL(FLASH_MAP_WL_DEVICE_ID));
+    TEST_ASSERT(fa_sectors[sec_cnt - 1].fa_off +
+                fa_sectors[sec_cnt - 1].fa_size == fa->fa_size);
+
+    rc = flash_area_erase(fa, 0, fa->fa_size);
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+    rc = flash_area_is_empty(fa, &empty);
+    TEST_ASSERT(rc == 0 && empty);
+
+    /* Write beginning and end of every logical sector */
+    for (i = 0; i < sec_cnt; i++) {
+        flash_map_test_wl_fill(wd, sizeof(wd), i);
+        rc = flash_area_write(&fa_sectors[i], 0, wd, sizeof(wd));
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+        rc = flash_area_write(&fa_sectors[i],
+                              fa_sectors[i].fa_size - sizeof(wd), wd,
+                              sizeof(wd));
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+    }
+
+    /* Keep erasing and rewriting first sector only */
+    for (i = 0; i < 4 * MYNEWT_VAL(FLASH_MAP_WL_THRESHOLD) * sec_cnt; i++) {
+        rc = flash_area_erase(&fa_sectors[0], 0, fa_sectors[0].fa_size);
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_erase() fail");
+
+        rc = flash_area_read_is_empty(&fa_sectors[0], 0, rd, sizeof(rd));
+        TEST_ASSERT_FATAL(rc == 1, "sector not erased");
+
+        flash_map_test_wl_fill(wd, sizeof(wd), i);
+        rc = flash_area_write(&fa_sectors[0], 0, wd, sizeof(wd));
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_write() fail");
+    }
+
+    /* Wear is spread over all physical sectors */
+    rc = flash_wl_stats_get(&stats);
+    TEST_ASSERT_FATAL(rc == 0);
+    TEST_ASSERT(stats.fws_moves > 0);
+    TEST_ASSERT(stats.fws_erase_max - stats.fws_erase_min <=
+                MYNEWT_VAL(FLASH_MAP_WL_THRESHOLD) + 1);
+
+    /* Contents survive remapping and remount */
+    rc = flash_wl_init();
+    TEST_ASSERT_FATAL(rc == 0, "flash_wl_init() fail");
+    rc = flash_area_read(&fa_sectors[0], 0, rd, sizeof(rd));
+    TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+    TEST_ASSERT(memcmp(wd, rd, sizeof(rd)) == 0);
+    for (i = 1; i < sec_cnt; i++) {
+        flash_map_test_wl_fill(wd, sizeof(wd), i);
+        rc = flash_area_read(&fa_sectors[i], 0, rd, sizeof(rd));
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+        TEST_ASSERT(memcmp(wd, rd, sizeof(rd)) == 0);
+        rc = flash_area_read(&fa_sectors[i],
+                             fa_sectors[i].fa_size - sizeof(rd), rd,
+                             sizeof(rd));
+        TEST_ASSERT_FATAL(rc == 0, "flash_area_read() fail");
+        TEST_ASSERT(memcmp(wd, rd, sizeof(rd)) == 0);
+    }
+}
@@ -27,10 +27,35 @@
 #include "hal/hal_flash_int.h"
 #include "mfg/mfg.h"
 #include "flash_map/flash_map.h"
+#if MYNEWT_VAL(FLASH_MAP_WL)
+#include "flash_wl_priv.h"
+#endif
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+#include "bootutil/bootutil.h"
+#endif
 
 const struct flash_area *flash_map;
 int flash_map_entries;
 
+#if MYNEWT_VAL(FLASH_MAP_WL)
+static inline bool
+flash_area_is_wl(const struct flash_area *fa)
+{
+    return fa->fa_device_id == MYNEWT_VAL(FLASH_MAP_WL_DEVICE_ID);
+}
+#endif
+
+static const struct hal_flash *
+flash_map_flash_dev(uint8_t device_id)
+{
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (device_id == MYNEWT_VAL(FLASH_MAP_WL_DEVICE_ID)) {
+        return flash_wl_dev();
+    }
+#endif
+    return hal_bsp_flash_dev(device_id);
+}
+
 int
 flash_area_open(uint8_t id, const struct flash_area **fap)
 {
@@ -41,6 +66,12 @@ flash_area_open(uint8_t id, const struct flash_area **fap)
         return SYS_EACCES;
     }
 
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (id == MYNEWT_VAL(FLASH_MAP_WL_ID)) {
+        return flash_wl_area_open(fap);
+    }
+#endif
+
     for (i = 0; i < flash_map_entries; i++) {
         area = flash_map + i;
         if (area->fa_id == id) {
@@ -69,7 +100,7 @@ flash_area_to_sectors(int id, int *cnt, struct flash_area *ret)
 
     *cnt = 0;
 
-    hf = hal_bsp_flash_dev(fa->fa_device_id);
+    hf = flash_map_flash_dev(fa->fa_device_id);
     for (i = 0; i < hf->hf_sector_cnt; i++) {
         hf->hf_itf->hff_sector_info(hf, i, &start, &size);
         if (start >= fa->fa_off && start < fa->fa_off + fa->fa_size) {
@@ -128,7 +159,7 @@ flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
         current = &sr;
     }
 
-    hf = hal_bsp_flash_dev(fa->fa_device_id);
+    hf = flash_map_flash_dev(fa->fa_device_id);
     for (i = 0; i < hf->hf_sector_cnt; i++) {
         hf->hf_itf->hff_sector_info(hf, i, &start, &size);
         if (start >= fa->fa_off && start < fa->fa_off + fa->fa_size) {
@@ -165,7 +196,7 @@ flash_area_to_sector_ranges(int id, int *cnt, struct flash_sector_range *ret)
             current->fsr_sector_count = 1;
             current->fsr_first_sector = (uint16_t)sector_in_ranges;
             current->fsr_range_start = offset;
-            current->fsr_align = hal_flash_align(fa->fa_device_id);
+            current->fsr_align = flash_area_align(fa);
         }
     }
     *cnt = range_count;
@@ -192,7 +223,7 @@ flash_area_getnext_sector(int id, int *sec_id, struct flash_area *ret)
         rc = SYS_EINVAL;
         goto end;
     }
-    hf = hal_bsp_flash_dev(fa->fa_device_id);
+    hf = flash_map_flash_dev(fa->fa_device_id);
     i = *sec_id + 1;
     for (; i < hf->hf_sector_cnt; i++) {
         hf->hf_itf->hff_sector_info(hf, i, &start, &size);
@@ -219,6 +250,11 @@ flash_area_read(const struct flash_area *fa, uint32_t off, void *dst,
     if (off > fa->fa_size || off + len > fa->fa_size) {
         return -1;
     }
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_read(fa->fa_off + off, dst, len);
+    }
+#endif
     return hal_flash_read(fa->fa_device_id, fa->fa_off + off, dst, len);
 }
 
@@ -229,6 +265,16 @@ flash_area_write(const struct flash_area *fa, uint32_t off, const void *src,
     if (off > fa->fa_size || off + len > fa->fa_size) {
         return -1;
     }
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    if (fa->fa_id == FLASH_AREA_IMAGE_0) {
+        boot_validated_revoke(fa, off, len);
+    }
+#endif
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_write(fa->fa_off + off, src, len);
+    }
+#endif
     return hal_flash_write(fa->fa_device_id, fa->fa_off + off,
                            (void *)src, len);
 }
@@ -239,18 +285,72 @@ flash_area_erase(const struct flash_area *fa, uint32_t off, uint32_t len)
     if (off > fa->fa_size || off + len > fa->fa_size) {
         return -1;
     }
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    if (fa->fa_id == FLASH_AREA_IMAGE_0) {
+        boot_validated_revoke(fa, off, len);
+    }
+#endif
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_erase(fa->fa_off + off, len);
+    }
+#endif
     return hal_flash_erase(fa->fa_device_id, fa->fa_off + off, len);
 }
 
+#if MYNEWT_VAL(HAL_FLASH_ASYNC)
+int
+flash_area_req_submit(const struct flash_area *fa, struct hal_flash_req *req)
+{
+    uint8_t flash_id;
+    uint32_t off;
+    int rc;
+
+    flash_id = req->fr_flash_id;
+    off = req->fr_addr;
+    if (off > fa->fa_size || req->fr_len > fa->fa_size - off) {
+        return SYS_EINVAL;
+    }
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return SYS_ENOTSUP;
+    }
+#endif
+#if MYNEWT_VAL(BOOTUTIL_VALIDATE_CACHE)
+    if (fa->fa_id == FLASH_AREA_IMAGE_0 && req->fr_op != HAL_FLASH_OP_READ) {
+        boot_validated_revoke(fa, off, req->fr_len);
+    }
+#endif
+    req->fr_flash_id = fa->fa_device_id;
+    req->fr_addr = fa->fa_off + off;
+    rc = hal_flash_req_submit(req);
+    if (rc) {
+        req->fr_flash_id = flash_id;
+        req->fr_addr = off;
+    }
+    return rc;
+}
+#endif
+
 uint8_t
 flash_area_align(const struct flash_area *fa)
 {
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_dev()->hf_align;
+    }
+#endif
     return hal_flash_align(fa->fa_device_id);
 }
 
 uint32_t
 flash_area_erased_val(const struct flash_area *fa)
 {
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_dev()->hf_erased_val;
+    }
+#endif
     return hal_flash_erased_val(fa->fa_device_id);
 }
 
@@ -273,6 +373,11 @@ flash_area_is_empty(const struct flash_area *fa, bool *empty)
     int rc;
 
     *empty = false;
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        rc = flash_wl_is_empty_no_buf(fa->fa_off, fa->fa_size);
+    } else
+#endif
     rc = hal_flash_isempty_no_buf(fa->fa_device_id, fa->fa_off, fa->fa_size);
     if (rc < 0) {
         return rc;
@@ -287,6 +392,11 @@ int
 flash_area_read_is_empty(const struct flash_area *fa, uint32_t off, void *dst,
                          uint32_t len)
 {
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    if (flash_area_is_wl(fa)) {
+        return flash_wl_is_empty(fa->fa_off + off, dst, len);
+    }
+#endif
     return hal_flash_isempty(fa->fa_device_id, fa->fa_off + off, dst, len);
 }
 
@@ -424,4 +534,9 @@ flash_map_init(void)
         flash_map = mfg_areas;
         flash_map_entries = num_areas;
     }
+
+#if MYNEWT_VAL(FLASH_MAP_WL)
+    rc = flash_wl_init();
+    SYSINIT_PANIC_ASSERT(rc == 0);
+#endif
 }
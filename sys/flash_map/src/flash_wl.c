@@ -0,0 +1,666 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+
+#if MYNEWT_VAL(FLASH_MAP_WL)
+
+#include <string.h>
+#include <assert.h>
+
+#include "hal/hal_flash.h"
+#include "hal/hal_flash_int.h"
+#include "crc/crc8.h"
+#include "flash_map/flash_map.h"
+#include "flash_map/flash_wl.h"
+#include "flash_wl_priv.h"
+
+/*
+ * Physical sector layout:
+ *
+ * | header | logical sector data ...                         |
+ *
+ * Header is written after sector is erased (or after data has been copied
+ * to it), it tells which logical sector is stored there and how many times
+ * physical sector has been erased. A logical sector can have stale copies
+ * in free sectors; the one with the highest sequence number is the valid
+ * one. A physical sector without valid header is free.
+ */
+#define FLASH_WL_MAGIC          0x31304c57  /* "WL01" */
+#define FLASH_WL_NONE           0xffff
+#define FLASH_WL_HDR_MAX        32
+#define FLASH_WL_COPY_BUF_SZ    32
+
+struct flash_wl_hdr {
+    uint32_t fwh_magic;
+    uint32_t fwh_seq;
+    uint32_t fwh_erase_cnt;
+    uint16_t fwh_lsector;
+    uint8_t fwh_pad;
+    uint8_t fwh_crc8;
+};
+
+struct flash_wl {
+    const struct flash_area *fw_phys;
+    uint32_t fw_sector_size;        /* Physical sector size */
+    uint32_t fw_hdr_size;           /* Header size, rounded up to alignment */
+    uint32_t fw_seq;                /* Last used sequence number */
+    uint16_t fw_phys_cnt;
+    uint16_t fw_log_cnt;
+    uint16_t fw_map[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)];   /* log -> phys */
+    uint16_t fw_owner[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)]; /* phys -> log */
+    uint32_t fw_erase_cnt[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)];
+    uint32_t fw_log_erase_cnt[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)];
+    uint32_t fw_moves;
+    struct os_mutex fw_lock;
+};
+
+static struct flash_wl flash_wl;
+
+static int flash_wl_sector_info(const struct hal_flash *dev, int idx,
+                                uint32_t *address, uint32_t *size);
+
+static const struct hal_flash_funcs flash_wl_funcs = {
+    .hff_sector_info = flash_wl_sector_info,
+};
+
+static struct hal_flash flash_wl_hal_dev = {
+    .hf_itf = &flash_wl_funcs,
+};
+
+static struct flash_area flash_wl_area;
+
+static inline uint32_t
+flash_wl_log_size(void)
+{
+    return flash_wl.fw_sector_size - flash_wl.fw_hdr_size;
+}
+
+static inline uint32_t
+flash_wl_phys_addr(uint16_t phys)
+{
+    return flash_wl.fw_phys->fa_off + phys * flash_wl.fw_sector_size;
+}
+
+static int
+flash_wl_sector_info(const struct hal_flash *dev, int idx, uint32_t *address,
+                     uint32_t *size)
+{
+    *address = idx * flash_wl_log_size();
+    *size = flash_wl_log_size();
+    return 0;
+}
+
+static uint8_t
+flash_wl_hdr_crc(struct flash_wl_hdr *hdr)
+{
+    return crc8_calc(crc8_init(), hdr, offsetof(struct flash_wl_hdr, fwh_crc8));
+}
+
+static int
+flash_wl_hdr_read(uint16_t phys, struct flash_wl_hdr *hdr)
+{
+    int rc;
+
+    rc = hal_flash_read(flash_wl.fw_phys->fa_device_id,
+                        flash_wl_phys_addr(phys), hdr, sizeof(*hdr));
+    if (rc) {
+        return rc;
+    }
+    if (hdr->fwh_magic != FLASH_WL_MAGIC ||
+        hdr->fwh_crc8 != flash_wl_hdr_crc(hdr) ||
+        hdr->fwh_lsector >= flash_wl.fw_log_cnt) {
+        return SYS_ENOENT;
+    }
+
+    return 0;
+}
+
+/*
+ * Makes physical sector the home of logical sector.
+ */
+static int
+flash_wl_hdr_write(uint16_t phys, uint16_t log)
+{
+    uint8_t buf[FLASH_WL_HDR_MAX];
+    struct flash_wl_hdr hdr;
+    int rc;
+
+    hdr.fwh_magic = FLASH_WL_MAGIC;
+    hdr.fwh_seq = ++flash_wl.fw_seq;
+    hdr.fwh_erase_cnt = flash_wl.fw_erase_cnt[phys];
+    hdr.fwh_lsector = log;
+    hdr.fwh_pad = 0xff;
+    hdr.fwh_crc8 = flash_wl_hdr_crc(&hdr);
+
+    /* Rest of the header space up to write alignment is left erased */
+    memset(buf, flash_area_erased_val(flash_wl.fw_phys), sizeof(buf));
+    memcpy(buf, &hdr, sizeof(hdr));
+
+    rc = hal_flash_write(flash_wl.fw_phys->fa_device_id,
+                         flash_wl_phys_addr(phys), buf, flash_wl.fw_hdr_size);
+    if (rc) {
+        return rc;
+    }
+
+    if (flash_wl.fw_map[log] != FLASH_WL_NONE) {
+        flash_wl.fw_owner[flash_wl.fw_map[log]] = FLASH_WL_NONE;
+    }
+    flash_wl.fw_map[log] = phys;
+    flash_wl.fw_owner[phys] = log;
+
+    return 0;
+}
+
+static int
+flash_wl_phys_erase(uint16_t phys)
+{
+    int rc;
+
+    rc = hal_flash_erase_sector(flash_wl.fw_phys->fa_device_id,
+                                flash_wl_phys_addr(phys));
+    if (rc == 0) {
+        flash_wl.fw_erase_cnt[phys]++;
+    }
+
+    return rc;
+}
+
+/*
+ * Returns free physical sector with the lowest (or highest) erase count.
+ */
+static uint16_t
+flash_wl_find_free(bool most_worn)
+{
+    uint16_t found = FLASH_WL_NONE;
+    uint16_t i;
+
+    for (i = 0; i < flash_wl.fw_phys_cnt; i++) {
+        if (flash_wl.fw_owner[i] != FLASH_WL_NONE) {
+            continue;
+        }
+        if (found == FLASH_WL_NONE ||
+            (most_worn &&
+             flash_wl.fw_erase_cnt[i] > flash_wl.fw_erase_cnt[found]) ||
+            (!most_worn &&
+             flash_wl.fw_erase_cnt[i] < flash_wl.fw_erase_cnt[found])) {
+            found = i;
+        }
+    }
+
+    return found;
+}
+
+/*
+ * Copies contents of one physical sector to another. Only programmed
+ * (non-erased) write units are written, so that the copy can be appended to
+ * later like the original.
+ */
+static int
+flash_wl_copy(uint16_t from, uint16_t to)
+{
+    uint8_t buf[FLASH_WL_COPY_BUF_SZ];
+    uint8_t erased_val;
+    uint8_t dev_id;
+    uint32_t align;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t off;
+    uint32_t cnt;
+    uint32_t start;
+    uint32_t end;
+    uint32_t i;
+    int rc;
+
+    dev_id = flash_wl.fw_phys->fa_device_id;
+    erased_val = flash_area_erased_val(flash_wl.fw_phys);
+    align = flash_area_align(flash_wl.fw_phys);
+    src = flash_wl_phys_addr(from);
+    dst = flash_wl_phys_addr(to);
+
+    for (off = flash_wl.fw_hdr_size; off < flash_wl.fw_sector_size;
+         off += cnt) {
+        cnt = min(sizeof(buf), flash_wl.fw_sector_size - off);
+        rc = hal_flash_read(dev_id, src + off, buf, cnt);
+        if (rc) {
+            return rc;
+        }
+        /* Write runs of non-erased units */
+        start = 0;
+        while (start < cnt) {
+            for (i = start; i < cnt && buf[i] == erased_val; i++) {
+            }
+            if (i >= cnt) {
+                break;
+            }
+            start = i - i % align;
+            for (end = start; end < cnt; end += align) {
+                for (i = end; i < end + align && buf[i] == erased_val; i++) {
+                }
+                if (i == end + align) {
+                    break;
+                }
+            }
+            rc = hal_flash_write(dev_id, dst + off + start, &buf[start],
+                                 end - start);
+            if (rc) {
+                return rc;
+            }
+            start = end;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * Static wear leveling: if the least erased sector in use is far behind the
+ * most worn free one, its (cold) contents are moved to the worn sector, and
+ * the least erased sector is returned to the free pool. Logical sector
+ * about to be remapped is not considered, it is going to move anyway.
+ */
+static int
+flash_wl_level(uint16_t log)
+{
+    uint16_t cold = FLASH_WL_NONE;
+    uint16_t worn;
+    uint16_t i;
+    int rc;
+
+    worn = flash_wl_find_free(true);
+    if (worn == FLASH_WL_NONE) {
+        return 0;
+    }
+
+    for (i = 0; i < flash_wl.fw_phys_cnt; i++) {
+        if (flash_wl.fw_owner[i] != FLASH_WL_NONE &&
+            flash_wl.fw_owner[i] != log &&
+            (cold == FLASH_WL_NONE ||
+             flash_wl.fw_erase_cnt[i] < flash_wl.fw_erase_cnt[cold])) {
+            cold = i;
+        }
+    }
+    if (cold == FLASH_WL_NONE ||
+        flash_wl.fw_erase_cnt[worn] <= flash_wl.fw_erase_cnt[cold] +
+        MYNEWT_VAL(FLASH_MAP_WL_THRESHOLD)) {
+        return 0;
+    }
+
+    rc = flash_wl_phys_erase(worn);
+    if (rc) {
+        return rc;
+    }
+    rc = flash_wl_copy(cold, worn);
+    if (rc) {
+        return rc;
+    }
+    /* Header goes last; until then old copy is the valid one */
+    rc = flash_wl_hdr_write(worn, flash_wl.fw_owner[cold]);
+    if (rc) {
+        return rc;
+    }
+    flash_wl.fw_moves++;
+
+    return 0;
+}
+
+/*
+ * Assigns a freshly erased physical sector to logical sector. Previous
+ * physical sector, if any, becomes free.
+ */
+static int
+flash_wl_remap(uint16_t log)
+{
+    uint16_t phys;
+    int rc;
+
+    rc = flash_wl_level(log);
+    if (rc) {
+        return rc;
+    }
+
+    phys = flash_wl_find_free(false);
+    assert(phys != FLASH_WL_NONE);
+
+    rc = flash_wl_phys_erase(phys);
+    if (rc) {
+        return rc;
+    }
+
+    return flash_wl_hdr_write(phys, log);
+}
+
+int
+flash_wl_area_open(const struct flash_area **fap)
+{
+    if (flash_wl.fw_phys == NULL) {
+        return SYS_ENOENT;
+    }
+    *fap = &flash_wl_area;
+    return 0;
+}
+
+const struct hal_flash *
+flash_wl_dev(void)
+{
+    return &flash_wl_hal_dev;
+}
+
+static int
+flash_wl_check(uint32_t addr, uint32_t len)
+{
+    if (flash_wl.fw_phys == NULL) {
+        return SYS_ENOENT;
+    }
+    if (addr > flash_wl_area.fa_size || addr + len > flash_wl_area.fa_size) {
+        return SYS_EINVAL;
+    }
+    return 0;
+}
+
+int
+flash_wl_read(uint32_t addr, void *dst, uint32_t len)
+{
+    uint32_t log_size;
+    uint32_t off;
+    uint32_t cnt;
+    uint16_t phys;
+    int rc;
+
+    rc = flash_wl_check(addr, len);
+    if (rc) {
+        return rc;
+    }
+    log_size = flash_wl_log_size();
+
+    os_mutex_pend(&flash_wl.fw_lock, OS_TIMEOUT_NEVER);
+    while (len) {
+        off = addr % log_size;
+        cnt = min(len, log_size - off);
+        phys = flash_wl.fw_map[addr / log_size];
+        if (phys == FLASH_WL_NONE) {
+            /* Never written since erase */
+            memset(dst, flash_area_erased_val(flash_wl.fw_phys), cnt);
+        } else {
+            rc = hal_flash_read(flash_wl.fw_phys->fa_device_id,
+                                flash_wl_phys_addr(phys) +
+                                flash_wl.fw_hdr_size + off, dst, cnt);
+            if (rc) {
+                break;
+            }
+        }
+        addr += cnt;
+        dst = (uint8_t *)dst + cnt;
+        len -= cnt;
+    }
+    os_mutex_release(&flash_wl.fw_lock);
+
+    return rc;
+}
+
+int
+flash_wl_write(uint32_t addr, const void *src, uint32_t len)
+{
+    uint32_t log_size;
+    uint32_t off;
+    uint32_t cnt;
+    uint16_t log;
+    int rc;
+
+    rc = flash_wl_check(addr, len);
+    if (rc) {
+        return rc;
+    }
+    log_size = flash_wl_log_size();
+
+    os_mutex_pend(&flash_wl.fw_lock, OS_TIMEOUT_NEVER);
+    while (len) {
+        off = addr % log_size;
+        cnt = min(len, log_size - off);
+        log = addr / log_size;
+        if (flash_wl.fw_map[log] == FLASH_WL_NONE) {
+            rc = flash_wl_remap(log);
+            if (rc) {
+                break;
+            }
+        }
+        rc = hal_flash_write(flash_wl.fw_phys->fa_device_id,
+                             flash_wl_phys_addr(flash_wl.fw_map[log]) +
+                             flash_wl.fw_hdr_size + off, src, cnt);
+        if (rc) {
+            break;
+        }
+        addr += cnt;
+        src = (const uint8_t *)src + cnt;
+        len -= cnt;
+    }
+    os_mutex_release(&flash_wl.fw_lock);
+
+    return rc;
+}
+
+/*
+ * Like hal_flash_erase(), erases all logical sectors which overlap the
+ * range.
+ */
+int
+flash_wl_erase(uint32_t addr, uint32_t len)
+{
+    uint32_t log_size;
+    uint16_t log;
+    uint16_t end;
+    int rc;
+
+    rc = flash_wl_check(addr, len);
+    if (rc || len == 0) {
+        return rc;
+    }
+    log_size = flash_wl_log_size();
+
+    os_mutex_pend(&flash_wl.fw_lock, OS_TIMEOUT_NEVER);
+    end = (addr + len + log_size - 1) / log_size;
+    for (log = addr / log_size; log < end; log++) {
+        rc = flash_wl_remap(log);
+        if (rc) {
+            break;
+        }
+        flash_wl.fw_log_erase_cnt[log]++;
+    }
+    os_mutex_release(&flash_wl.fw_lock);
+
+    return rc;
+}
+
+int
+flash_wl_is_empty(uint32_t addr, void *dst, uint32_t len)
+{
+    uint8_t erased_val;
+    uint32_t i;
+    int rc;
+
+    rc = flash_wl_read(addr, dst, len);
+    if (rc) {
+        return rc;
+    }
+
+    erased_val = flash_area_erased_val(flash_wl.fw_phys);
+    for (i = 0; i < len; i++) {
+        if (((uint8_t *)dst)[i] != erased_val) {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+int
+flash_wl_is_empty_no_buf(uint32_t addr, uint32_t len)
+{
+    uint8_t buf[FLASH_WL_COPY_BUF_SZ];
+    uint32_t off;
+    int rc;
+
+    for (off = 0; off < len; off += sizeof(buf)) {
+        rc = flash_wl_is_empty(addr + off, buf, min(sizeof(buf), len - off));
+        if (rc != 1) {
+            return rc;
+        }
+    }
+
+    return 1;
+}
+
+int
+flash_wl_stats_get(struct flash_wl_stats *stats)
+{
+    uint16_t i;
+
+    if (flash_wl.fw_phys == NULL) {
+        return SYS_ENOENT;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+
+    os_mutex_pend(&flash_wl.fw_lock, OS_TIMEOUT_NEVER);
+    stats->fws_erase_min = UINT32_MAX;
+    for (i = 0; i < flash_wl.fw_phys_cnt; i++) {
+        stats->fws_erase_min = min(stats->fws_erase_min,
+                                   flash_wl.fw_erase_cnt[i]);
+        stats->fws_erase_max = max(stats->fws_erase_max,
+                                   flash_wl.fw_erase_cnt[i]);
+        stats->fws_erase_total += flash_wl.fw_erase_cnt[i];
+    }
+    for (i = 0; i < flash_wl.fw_log_cnt; i++) {
+        stats->fws_log_erases += flash_wl.fw_log_erase_cnt[i];
+        stats->fws_log_erase_max = max(stats->fws_log_erase_max,
+                                       flash_wl.fw_log_erase_cnt[i]);
+    }
+    stats->fws_moves = flash_wl.fw_moves;
+    os_mutex_release(&flash_wl.fw_lock);
+
+    return 0;
+}
+
+int
+flash_wl_init(void)
+{
+    struct flash_wl_hdr hdr;
+    const struct flash_area *fa;
+    struct flash_area sector;
+    uint32_t seq[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)];
+    uint32_t erase_max;
+    uint32_t align;
+    uint16_t cnt;
+    uint16_t cur;
+    uint16_t i;
+    bool valid[MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS)];
+    int sec_id;
+    int rc;
+
+    memset(&flash_wl, 0, sizeof(flash_wl));
+    os_mutex_init(&flash_wl.fw_lock);
+
+    rc = flash_area_open(MYNEWT_VAL(FLASH_MAP_WL_AREA), &fa);
+    if (rc) {
+        return rc;
+    }
+
+    /* Physical sectors must be of the same size and adjacent */
+    cnt = 0;
+    sec_id = -1;
+    while (flash_area_getnext_sector(fa->fa_id, &sec_id, &sector) == 0) {
+        if (cnt == 0) {
+            flash_wl.fw_sector_size = sector.fa_size;
+        }
+        if (cnt >= MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS) ||
+            sector.fa_size != flash_wl.fw_sector_size ||
+            sector.fa_off != fa->fa_off + cnt * flash_wl.fw_sector_size) {
+            return SYS_EINVAL;
+        }
+        cnt++;
+    }
+    if (cnt <= MYNEWT_VAL(FLASH_MAP_WL_SPARE_SECTORS) ||
+        MYNEWT_VAL(FLASH_MAP_WL_SPARE_SECTORS) < 1) {
+        return SYS_EINVAL;
+    }
+
+    align = flash_area_align(fa);
+    flash_wl.fw_hdr_size = (sizeof(struct flash_wl_hdr) + align - 1) &
+                           ~(align - 1);
+    if (flash_wl.fw_hdr_size > FLASH_WL_HDR_MAX ||
+        flash_wl.fw_hdr_size >= flash_wl.fw_sector_size) {
+        return SYS_EINVAL;
+    }
+
+    flash_wl.fw_phys = fa;
+    flash_wl.fw_phys_cnt = cnt;
+    flash_wl.fw_log_cnt = cnt - MYNEWT_VAL(FLASH_MAP_WL_SPARE_SECTORS);
+    for (i = 0; i < MYNEWT_VAL(FLASH_MAP_WL_MAX_SECTORS); i++) {
+        flash_wl.fw_map[i] = FLASH_WL_NONE;
+        flash_wl.fw_owner[i] = FLASH_WL_NONE;
+    }
+
+    /* Newest copy of each logical sector is the valid one */
+    erase_max = 0;
+    for (i = 0; i < cnt; i++) {
+        valid[i] = flash_wl_hdr_read(i, &hdr) == 0;
+        if (!valid[i]) {
+            continue;
+        }
+        seq[i] = hdr.fwh_seq;
+        flash_wl.fw_erase_cnt[i] = hdr.fwh_erase_cnt;
+        erase_max = max(erase_max, hdr.fwh_erase_cnt);
+        if (flash_wl.fw_seq == 0 ||
+            (int32_t)(hdr.fwh_seq - flash_wl.fw_seq) > 0) {
+            flash_wl.fw_seq = hdr.fwh_seq;
+        }
+
+        cur = flash_wl.fw_map[hdr.fwh_lsector];
+        if (cur == FLASH_WL_NONE || (int32_t)(seq[i] - seq[cur]) > 0) {
+            if (cur != FLASH_WL_NONE) {
+                flash_wl.fw_owner[cur] = FLASH_WL_NONE;
+            }
+            flash_wl.fw_map[hdr.fwh_lsector] = i;
+            flash_wl.fw_owner[i] = hdr.fwh_lsector;
+        }
+    }
+    /*
+     * Erase count of sectors without header is not known (never used, or
+     * power was lost before header was written), assume the worst.
+     */
+    for (i = 0; i < cnt; i++) {
+        if (!valid[i]) {
+            flash_wl.fw_erase_cnt[i] = erase_max;
+        }
+    }
+
+    flash_wl_area.fa_id = MYNEWT_VAL(FLASH_MAP_WL_ID);
+    flash_wl_area.fa_device_id = MYNEWT_VAL(FLASH_MAP_WL_DEVICE_ID);
+    flash_wl_area.fa_off = 0;
+    flash_wl_area.fa_size = flash_wl.fw_log_cnt * flash_wl_log_size();
+
+    flash_wl_hal_dev.hf_size = flash_wl_area.fa_size;
+    flash_wl_hal_dev.hf_sector_cnt = flash_wl.fw_log_cnt;
+    flash_wl_hal_dev.hf_align = align;
+    flash_wl_hal_dev.hf_erased_val = flash_area_erased_val(fa);
+
+    return 0;
+}
+
+#endif /* MYNEWT_VAL(FLASH_MAP_WL) */
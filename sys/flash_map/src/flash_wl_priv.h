@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef H_FLASH_WL_PRIV_
+#define H_FLASH_WL_PRIV_
+
+#include <inttypes.h>
+#include "flash_map/flash_map.h"
+#include "flash_map/flash_wl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct hal_flash;
+
+/*
+ * Interface used by flash_map for areas with
+ * fa_device_id == MYNEWT_VAL(FLASH_MAP_WL_DEVICE_ID).
+ * Addresses are offsets within the logical area.
+ */
+int flash_wl_area_open(const struct flash_area **fap);
+const struct hal_flash *flash_wl_dev(void);
+int flash_wl_read(uint32_t addr, void *dst, uint32_t len);
+int flash_wl_write(uint32_t addr, const void *src, uint32_t len);
+int flash_wl_erase(uint32_t addr, uint32_t len);
+int flash_wl_is_empty(uint32_t addr, void *dst, uint32_t len);
+int flash_wl_is_empty_no_buf(uint32_t addr, uint32_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* H_FLASH_WL_PRIV_ */
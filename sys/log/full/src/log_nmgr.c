@@ -766,6 +766,8 @@ log_nmgr_register_group(void)
 
     MGMT_GROUP_SET_HANDLERS(&log_nmgr_group, log_nmgr_group_handlers);
     log_nmgr_group.mg_group_id = MGMT_GROUP_ID_LOGS;
+    /* Log dumps walk whole logs; run them on a newtmgr worker. */
+    log_nmgr_group.mg_max_inflight = 1;
 
     rc = mgmt_group_register(&log_nmgr_group);
     if (rc) {
@@ -32,6 +32,7 @@ static void *g_shell_nlip_in_arg;
 static struct os_mqueue g_shell_nlip_mq;
 static struct os_mbuf *g_nlip_mbuf;
 static uint16_t g_nlip_expected_len;
+static bool g_nlip_have_len;
 
 void
 shell_nlip_clear_pkt(void)
@@ -41,46 +42,63 @@ shell_nlip_clear_pkt(void)
         g_nlip_mbuf = NULL;
     }
     g_nlip_expected_len = 0;
+    g_nlip_have_len = false;
 }
 
 int
 shell_nlip_process(char *data, int len)
 {
-    uint16_t copy_len;
-    int rc;
+    struct base64_decoder bd;
     struct os_mbuf *m;
+    uint16_t prev_len;
+    uint16_t pkt_len;
     uint16_t crc;
-
-    rc = base64_decode(data, data);
-    if (rc < 0) {
-        goto err;
-    }
-    len = rc;
+    int rc;
 
     if (g_nlip_mbuf == NULL) {
-        if (len < 2) {
+        g_nlip_mbuf = os_msys_get_pkthdr(BASE64_DECODE_SIZE(len), 0);
+        if (!g_nlip_mbuf) {
             rc = -1;
             goto err;
         }
+        g_nlip_expected_len = 0;
+        g_nlip_have_len = false;
+    }
 
-        g_nlip_expected_len = ntohs(*(uint16_t *) data);
-        g_nlip_mbuf = os_msys_get_pkthdr(g_nlip_expected_len, 0);
-        if (!g_nlip_mbuf) {
+    /* Decode the line straight onto the end of the packet. */
+    prev_len = OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len;
+    base64_decoder_init(&bd);
+    rc = base64_decoder_feed_mbuf(&bd, data, len, g_nlip_mbuf);
+    if (rc >= 0) {
+        rc = base64_decoder_finish(&bd);
+    }
+    if (rc < 0) {
+        if (!g_nlip_have_len) {
+            shell_nlip_clear_pkt();
+        } else {
+            /* Drop this line; the packet so far is still good. */
+            os_mbuf_adj(g_nlip_mbuf,
+                        -(OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len - prev_len));
+        }
+        goto err;
+    }
+
+    if (!g_nlip_have_len) {
+        /* First line of the packet; it starts with the packet length. */
+        if (OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len < sizeof(uint16_t)) {
+            shell_nlip_clear_pkt();
             rc = -1;
             goto err;
         }
-
-        data += sizeof(uint16_t);
-        len -= sizeof(uint16_t);
+        os_mbuf_copydata(g_nlip_mbuf, 0, sizeof(pkt_len), &pkt_len);
+        os_mbuf_adj(g_nlip_mbuf, sizeof(pkt_len));
+        g_nlip_expected_len = ntohs(pkt_len);
+        g_nlip_have_len = true;
     }
 
-    copy_len = min(g_nlip_expected_len - OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len,
-            len);
-
-    rc = os_mbuf_copyinto(g_nlip_mbuf, OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len,
-            data, copy_len);
-    if (rc != 0) {
-        goto err;
+    pkt_len = OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len;
+    if (pkt_len > g_nlip_expected_len) {
+        os_mbuf_adj(g_nlip_mbuf, -(pkt_len - g_nlip_expected_len));
     }
 
     if (OS_MBUF_PKTHDR(g_nlip_mbuf)->omp_len == g_nlip_expected_len) {
@@ -100,6 +118,7 @@ shell_nlip_process(char *data, int len)
         }
         g_nlip_mbuf = NULL;
         g_nlip_expected_len = 0;
+        g_nlip_have_len = false;
     }
 
     return (0);
@@ -0,0 +1,64 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _CRC32_H_
+#define _CRC32_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CRC32_INITIAL_CRC       0       /* what to seed crc32 with */
+
+/**
+ * Calculates the IEEE 802.3 CRC32 (zlib, PNG, ethernet) of a buffer.
+ *
+ * The pre- and post-inversion are done internally, so the result of one
+ * call can be passed as the initial_crc of the next to checksum data in
+ * pieces.
+ *
+ * @param initial_crc           CRC32_INITIAL_CRC, or the result of a
+ *                                  previous call.
+ * @param buf                   The data to checksum.
+ * @param len                   The number of bytes in buf.
+ *
+ * @return                      The updated CRC.
+ */
+uint32_t crc32_ieee(uint32_t initial_crc, const void *buf, int len);
+
+/**
+ * Calculates the Castagnoli CRC32 (iSCSI, SSE4.2, ext4) of a buffer.
+ * Chains the same way as crc32_ieee().
+ *
+ * @param initial_crc           CRC32_INITIAL_CRC, or the result of a
+ *                                  previous call.
+ * @param buf                   The data to checksum.
+ * @param len                   The number of bytes in buf.
+ *
+ * @return                      The updated CRC.
+ */
+uint32_t crc32c(uint32_t initial_crc, const void *buf, int len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CRC32_H_ */
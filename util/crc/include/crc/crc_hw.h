@@ -0,0 +1,52 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _CRC_HW_H_
+#define _CRC_HW_H_
+
+#include <inttypes.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Hardware CRC backend.  When CRC_HW is enabled, util/crc offers every
+ * computation of at least CRC_HW_MIN_LEN bytes to these functions before
+ * falling back to software.  They are provided by the MCU package.
+ *
+ * Each function takes the same initial_crc as its software counterpart
+ * (crc16_ccitt(), crc32_ieee(), crc32c()) and must produce an identical
+ * result.  Return 0 and write *out_crc if the CRC was computed; return
+ * nonzero to have the software implementation handle the request (e.g.,
+ * the engine is busy, does not support the polynomial, or cannot access
+ * the buffer).
+ */
+int crc_hw_crc16_ccitt(uint16_t initial_crc, const void *buf, int len,
+                       uint16_t *out_crc);
+int crc_hw_crc32(uint32_t initial_crc, const void *buf, int len,
+                 uint32_t *out_crc);
+int crc_hw_crc32c(uint32_t initial_crc, const void *buf, int len,
+                  uint32_t *out_crc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _CRC_HW_H_ */
@@ -0,0 +1,54 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+/* Standard check values: the CRC of the ASCII string "123456789". */
+TEST_CASE_SELF(crc_test_case_check)
+{
+    static const char check[] = "123456789";
+    uint32_t crc32;
+    uint16_t crc16;
+
+    crc16 = crc16_ccitt(CRC16_INITIAL_CRC, check, 9);
+    TEST_ASSERT(crc16 == 0x31c3);
+
+    crc32 = crc32_ieee(CRC32_INITIAL_CRC, check, 9);
+    TEST_ASSERT(crc32 == 0xcbf43926);
+
+    crc32 = crc32c(CRC32_INITIAL_CRC, check, 9);
+    TEST_ASSERT(crc32 == 0xe3069283);
+
+    /* Chaining. */
+    crc32 = crc32_ieee(CRC32_INITIAL_CRC, check, 4);
+    crc32 = crc32_ieee(crc32, check + 4, 5);
+    TEST_ASSERT(crc32 == 0xcbf43926);
+
+    crc32 = crc32c(CRC32_INITIAL_CRC, check, 5);
+    crc32 = crc32c(crc32, check + 5, 4);
+    TEST_ASSERT(crc32 == 0xe3069283);
+
+    /* Empty input leaves the CRC unchanged. */
+    TEST_ASSERT(crc16_ccitt(0x1234, check, 0) == 0x1234);
+    TEST_ASSERT(crc32_ieee(0x12345678, check, 0) == 0x12345678);
+    TEST_ASSERT(crc32c(0x12345678, check, 0) == 0x12345678);
+}
@@ -0,0 +1,85 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include "os/mynewt.h"
+#include "crc/crc16.h"
+#include "crc/crc32.h"
+#include "crc_test.h"
+
+/*
+ * Bitwise reference implementations.  The library is compared against these
+ * at every length and alignment that exercises the 4- and 8-byte loops and
+ * their byte-at-a-time tails, whatever CRC16_SLICE / CRC32_SLICE is set to.
+ */
+static uint16_t
+crc_test_ref16(uint16_t crc, const uint8_t *buf, int len)
+{
+    int i;
+
+    while (len--) {
+        crc ^= (uint16_t)*buf++ << 8;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static uint32_t
+crc_test_ref32(uint32_t poly, uint32_t crc, const uint8_t *buf, int len)
+{
+    int i;
+
+    crc = ~crc;
+    while (len--) {
+        crc ^= *buf++;
+        for (i = 0; i < 8; i++) {
+            crc = (crc & 1) ? (crc >> 1) ^ poly : crc >> 1;
+        }
+    }
+    return ~crc;
+}
+
+TEST_CASE_SELF(crc_test_case_slice)
+{
+    static uint8_t data[96];
+    const uint8_t *p;
+    uint32_t seed;
+    int off;
+    int len;
+    int i;
+
+    seed = 1;
+    for (i = 0; i < sizeof(data); i++) {
+        seed = seed * 1103515245 + 12345;
+        data[i] = seed >> 16;
+    }
+
+    for (off = 0; off < 8; off++) {
+        p = data + off;
+        for (len = 0; len <= sizeof(data) - 8; len++) {
+            TEST_ASSERT(crc16_ccitt(0x1d0f, p, len) ==
+                        crc_test_ref16(0x1d0f, p, len));
+            TEST_ASSERT(crc32_ieee(0x1234abcd, p, len) ==
+                        crc_test_ref32(0xedb88320, 0x1234abcd, p, len));
+            TEST_ASSERT(crc32c(0x1234abcd, p, len) ==
+                        crc_test_ref32(0x82f63b78, 0x1234abcd, p, len));
+        }
+    }
+}